@@ -14,23 +14,65 @@ void Input::Init(GLFWwindow* window)
 
 void Input::Update()
 {
-	float smoothFactory = 0.2f;
+	std::lock_guard<std::mutex> lock(s_Mutex);
+
+	for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; key++)
+	{
+		s_SampledKeys[key] = glfwGetKey(s_Window, key) == GLFW_PRESS;
+	}
+	for (int button = 0; button <= GLFW_MOUSE_BUTTON_LAST; button++)
+	{
+		s_SampledMouseButtons[button] = glfwGetMouseButton(s_Window, button) == GLFW_PRESS;
+	}
 
-	s_DeltaMousePosition = glm::mix(s_DeltaMousePosition, s_DeltaMousePositionAccumulator, 1 - smoothFactory);
+	if (s_IsMouseLocked != s_MouseLockRequest)
+	{
+		int cursorMode = s_MouseLockRequest ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL;
+		glfwSetInputMode(s_Window, GLFW_CURSOR, cursorMode);
+		glfwSetInputMode(s_Window, GLFW_RAW_MOUSE_MOTION, s_MouseLockRequest);
+
+		s_IsMouseLocked = s_MouseLockRequest;
 
+		if (s_IsMouseLocked)
+		{
+			s_DeltaMousePositionAccumulator = { 0, 0 };
+			s_PendingDeltaMousePosition = { 0, 0 };
+			s_ResetDeltaMousePosition = true;
+		}
+	}
+
+	s_PendingDeltaMousePosition += s_DeltaMousePositionAccumulator;
 	s_DeltaMousePositionAccumulator = { 0, 0 };
 }
 
+void Input::BeginStep()
+{
+	float smoothFactory = 0.2f;
+
+	std::lock_guard<std::mutex> lock(s_Mutex);
+
+	s_Keys = s_SampledKeys;
+	s_MouseButtons = s_SampledMouseButtons;
+
+	if (s_ResetDeltaMousePosition)
+	{
+		s_DeltaMousePosition = { 0, 0 };
+		s_ResetDeltaMousePosition = false;
+	}
+
+	s_DeltaMousePosition = glm::mix(s_DeltaMousePosition, s_PendingDeltaMousePosition, 1 - smoothFactory);
+
+	s_PendingDeltaMousePosition = { 0, 0 };
+}
+
 bool Input::GetKey(int key)
 {
-	int state = glfwGetKey(s_Window, key);
-	return state == GLFW_PRESS;
+	return key >= 0 && key <= GLFW_KEY_LAST && s_Keys[key];
 }
 
 bool Input::GetMouseButton(int button)
 {
-	int state = glfwGetMouseButton(s_Window, button);
-	return state == GLFW_PRESS;
+	return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && s_MouseButtons[button];
 }
 
 glm::vec2 Input::GetMousePosition()
@@ -47,26 +89,8 @@ glm::vec2 Input::GetDeltaMousePosition()
 
 void Input::LockMouse(bool locked)
 {
-	if (s_IsMouseLocked != locked)
-	{
-		int cursorMode = locked ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL;
-		glfwSetInputMode(s_Window, GLFW_CURSOR, cursorMode);
-		glfwSetInputMode(s_Window, GLFW_RAW_MOUSE_MOTION, locked);
-
-		s_IsMouseLocked = locked;
-	}
-
-	if (locked && s_FirstLocked)
-	{
-		s_FirstLocked = false;
-
-		s_DeltaMousePosition = { 0, 0 };
-		s_DeltaMousePositionAccumulator = { 0, 0 };
-	}
-	if (!locked && !s_FirstLocked)
-	{
-		s_FirstLocked = true;
-	}
+	std::lock_guard<std::mutex> lock(s_Mutex);
+	s_MouseLockRequest = locked;
 }
 
 void Input::MousePosCallBack(GLFWwindow* window, double xpos, double ypos)
@@ -78,13 +102,27 @@ void Input::MousePosCallBack(GLFWwindow* window, double xpos, double ypos)
 
 GLFWwindow* Input::s_Window;
 
-bool Input::s_IsMouseLocked = false;
+std::mutex Input::s_Mutex;
 
-bool Input::s_FirstLocked = true;
+bool Input::s_IsMouseLocked = false;
 
 glm::vec2 Input::s_LastMousePosition;
 
-glm::vec2 Input::s_DeltaMousePosition(0, 0);
-
 glm::vec2 Input::s_DeltaMousePositionAccumulator(0, 0);
 
+std::array<bool, GLFW_KEY_LAST + 1> Input::s_SampledKeys{};
+
+std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> Input::s_SampledMouseButtons{};
+
+glm::vec2 Input::s_PendingDeltaMousePosition(0, 0);
+
+bool Input::s_MouseLockRequest = false;
+
+bool Input::s_ResetDeltaMousePosition = false;
+
+std::array<bool, GLFW_KEY_LAST + 1> Input::s_Keys{};
+
+std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> Input::s_MouseButtons{};
+
+glm::vec2 Input::s_DeltaMousePosition(0, 0);
+
@@ -1,18 +1,24 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #pragma once
+#include <array>
+#include <mutex>
 
+// Hàm GLFW chỉ được gọi từ luồng chính: Update (luồng chính, sau windowPollEvents) chụp trạng thái phím/chuột,
+// BeginStep (đầu mỗi bước simulation, có thể trên luồng khác) lấy bản chụp mới nhất.
+// GetKey/GetMouseButton/GetDeltaMousePosition đọc bản chụp của bước, LockMouse chỉ ghi yêu cầu và được áp dụng ở Update kế tiếp.
 class Input
 {
 public:
 	Input() = delete;
-	
+
 	static void Init(GLFWwindow* window);
 
 	static void Update();
-	
+	static void BeginStep();
+
 	static bool GetKey(int key);
 	static bool GetMouseButton(int button);
-	static glm::vec2 GetMousePosition();
+	static glm::vec2 GetMousePosition();	// Gọi GLFW: chỉ dùng trên luồng chính.
 	static glm::vec2 GetDeltaMousePosition();
 
 	static void LockMouse(bool locked);
@@ -21,11 +27,23 @@ public:
 private:
 	static GLFWwindow* s_Window;
 
-	static bool s_IsMouseLocked;
-	static bool s_FirstLocked;
+	static std::mutex s_Mutex;	// Bảo vệ bản chụp chung giữa Update và BeginStep.
 
+	// --- Luồng chính ---
+	static bool s_IsMouseLocked;
 	static glm::vec2 s_LastMousePosition;
-	static glm::vec2 s_DeltaMousePosition;
 	static glm::vec2 s_DeltaMousePositionAccumulator;
 
+	// --- Bản chụp chung ---
+	static std::array<bool, GLFW_KEY_LAST + 1> s_SampledKeys;
+	static std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> s_SampledMouseButtons;
+	static glm::vec2 s_PendingDeltaMousePosition;	// Tổng delta từ BeginStep trước.
+	static bool s_MouseLockRequest;
+	static bool s_ResetDeltaMousePosition;			// Chuột vừa bị khóa: bỏ delta đã làm mượt.
+
+	// --- Luồng simulation ---
+	static std::array<bool, GLFW_KEY_LAST + 1> s_Keys;
+	static std::array<bool, GLFW_MOUSE_BUTTON_LAST + 1> s_MouseButtons;
+	static glm::vec2 s_DeltaMousePosition;
+
 };
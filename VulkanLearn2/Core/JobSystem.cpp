@@ -0,0 +1,119 @@
+#include "pch.h"
+#include "JobSystem.h"
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+	if (workerCount == 0)
+	{
+		// Chừa lại một nhân cho luồng chính (luồng chính cũng tham gia thực thi job).
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	m_Workers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; i++)
+	{
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_WakeCondition.notify_all();
+
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::ParallelFor(uint32_t jobCount, const JobFunc& job)
+{
+	if (jobCount == 0) return;
+
+	// Một job duy nhất: chạy thẳng trên luồng chính, tránh chi phí đánh thức worker.
+	if (jobCount == 1)
+	{
+		job(0, GetMainThreadIndex());
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_CurrentJob = &job;
+		m_JobCount = jobCount;
+		m_NextJobIndex.store(0);
+		m_ActiveWorkers = static_cast<uint32_t>(m_Workers.size());
+		m_FirstException = nullptr;
+		++m_Generation;
+	}
+	m_WakeCondition.notify_all();
+
+	// Luồng chính cũng nhận job thay vì ngồi chờ.
+	RunJobs(GetMainThreadIndex());
+
+	std::exception_ptr exception;
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCondition.wait(lock, [this]() { return m_ActiveWorkers == 0; });
+		m_CurrentJob = nullptr;
+		exception = m_FirstException;
+	}
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+}
+
+void JobSystem::WorkerLoop(uint32_t threadIndex)
+{
+	uint64_t seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCondition.wait(lock, [&]() { return m_Stop || m_Generation != seenGeneration; });
+
+			if (m_Stop) return;
+			seenGeneration = m_Generation;
+		}
+
+		RunJobs(threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_ActiveWorkers == 0)
+			{
+				m_DoneCondition.notify_one();
+			}
+		}
+	}
+}
+
+void JobSystem::RunJobs(uint32_t threadIndex)
+{
+	while (true)
+	{
+		uint32_t jobIndex = m_NextJobIndex.fetch_add(1);
+		if (jobIndex >= m_JobCount) break;
+
+		try
+		{
+			(*m_CurrentJob)(jobIndex, threadIndex);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (!m_FirstException)
+			{
+				m_FirstException = std::current_exception();
+			}
+		}
+	}
+}
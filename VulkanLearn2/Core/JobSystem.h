@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+// =================================================================================================
+// Class: JobSystem
+// Mô tả:
+//      Thread pool đơn giản với số lượng worker cố định, phục vụ các tác vụ song song kiểu fork-join
+//      (ví dụ: ghi command buffer phụ cho từng đoạn draw call).
+//      Mỗi luồng tham gia (các worker + luồng chính) có một "thread index" ổn định trong khoảng
+//      [0, GetThreadCount()), cho phép các hệ thống khác gắn tài nguyên riêng cho từng luồng
+//      (command pool, bộ nhớ tạm...) mà không cần khóa.
+//      LƯU Ý: ParallelFor chỉ được gọi từ một luồng cố định ("luồng chính" của JobSystem) và không được lồng nhau.
+//      Luồng khác cần chạy song song (ví dụ SimulationThread) dùng một JobSystem riêng.
+// =================================================================================================
+class JobSystem
+{
+public:
+	// Hàm xử lý một job. jobIndex: chỉ số job trong lần dispatch. threadIndex: luồng đang thực thi.
+	using JobFunc = std::function<void(uint32_t jobIndex, uint32_t threadIndex)>;
+
+	// Constructor: Khởi tạo các worker thread.
+	// Tham số:
+	//      workerCount: Số lượng worker. 0 = tự chọn theo số nhân CPU (trừ luồng chính).
+	JobSystem(uint32_t workerCount = 0);
+
+	// Destructor: Dừng và join toàn bộ worker.
+	~JobSystem();
+
+	// Cấm sao chép.
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Thực thi `job` cho mọi jobIndex trong [0, jobCount) trên các worker và luồng chính.
+	// Hàm block cho đến khi toàn bộ job hoàn thành. Exception đầu tiên (nếu có) được ném lại trên luồng chính.
+	void ParallelFor(uint32_t jobCount, const JobFunc& job);
+
+	// Tổng số luồng có thể thực thi job (worker + luồng chính).
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()) + 1; }
+
+	// Thread index dành cho luồng chính (luôn là index cuối cùng).
+	uint32_t GetMainThreadIndex() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+private:
+	// --- Dữ liệu nội bộ ---
+	std::vector<std::thread> m_Workers;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_WakeCondition;	// Báo cho worker có lô job mới (hoặc yêu cầu dừng).
+	std::condition_variable m_DoneCondition;	// Báo cho luồng chính khi worker cuối cùng xong việc.
+
+	const JobFunc* m_CurrentJob = nullptr;		// Lô job đang được thực thi.
+	uint32_t m_JobCount = 0;
+	std::atomic<uint32_t> m_NextJobIndex{ 0 };	// Job kế tiếp chưa được nhận.
+	uint32_t m_ActiveWorkers = 0;				// Số worker chưa xong lô job hiện tại.
+	uint64_t m_Generation = 0;					// Tăng mỗi lần dispatch để đánh thức worker.
+	bool m_Stop = false;
+
+	std::exception_ptr m_FirstException;
+
+	// --- Hàm helper private ---
+
+	// Helper: Vòng lặp chính của mỗi worker.
+	void WorkerLoop(uint32_t threadIndex);
+
+	// Helper: Nhận và thực thi job cho đến khi hết lô hiện tại.
+	void RunJobs(uint32_t threadIndex);
+};
@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "SimulationThread.h"
+
+SimulationThread::SimulationThread(float stepTime, bool threaded, StepFunc step) :
+	m_StepTime(stepTime),
+	m_StepDuration(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(stepTime))),
+	m_Step(std::move(step)),
+	m_Threaded(threaded)
+{
+	if (m_StepTime <= 0.0f)
+	{
+		throw std::runtime_error("LỖI: SimulationThread: Độ dài bước phải lớn hơn 0!");
+	}
+
+	m_NextStepTime = Clock::now();
+	RunStep(m_NextStepTime);
+
+	if (m_Threaded)
+	{
+		m_Thread = std::thread(&SimulationThread::ThreadLoop, this);
+	}
+}
+
+SimulationThread::~SimulationThread()
+{
+	if (!m_Thread.joinable()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Condition.notify_all();
+	m_Thread.join();
+}
+
+void SimulationThread::Extract(const ExtractFunc& extract)
+{
+	if (!m_Threaded)
+	{
+		const Clock::time_point now = Clock::now();
+		while (m_NextStepTime <= now)
+		{
+			RunStep(now);
+		}
+		extract(ComputeAlpha(now));
+		return;
+	}
+
+	// Báo trước khi lấy khóa: luồng simulation kiểm tra cờ giữa hai bước và nhường khóa
+	// (std::mutex không đảm bảo luồng đang đợi được lấy khóa trước).
+	m_ExtractPending.store(true);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_ExtractPending.store(false);
+
+		if (m_Exception)
+		{
+			std::rethrow_exception(m_Exception);
+		}
+		extract(ComputeAlpha(Clock::now()));
+	}
+	m_Condition.notify_all();
+}
+
+void SimulationThread::ThreadLoop()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (true)
+	{
+		// Cả hai lần đợi đều nhả khóa, luồng render có thể Extract trong lúc này.
+		m_Condition.wait_until(lock, m_NextStepTime, [this]() { return m_Stop; });
+		m_Condition.wait(lock, [this]() { return m_Stop || !m_ExtractPending.load(); });
+		if (m_Stop) return;
+
+		const Clock::time_point now = Clock::now();
+		if (now < m_NextStepTime) continue;
+
+		try
+		{
+			RunStep(now);
+		}
+		catch (...)
+		{
+			// Simulation dừng hẳn, Extract kế tiếp ném lại exception trên luồng render.
+			m_Exception = std::current_exception();
+			return;
+		}
+	}
+}
+
+void SimulationThread::RunStep(Clock::time_point now)
+{
+	// Tụt lại quá xa: bỏ phần thời gian thừa, chỉ chạy bước này.
+	if (now - m_NextStepTime > std::chrono::duration<float>(MAX_CATCH_UP_TIME))
+	{
+		m_NextStepTime = now;
+	}
+
+	m_Step(m_StepTime);
+	m_StepCount.fetch_add(1);
+	m_NextStepTime += m_StepDuration;
+}
+
+float SimulationThread::ComputeAlpha(Clock::time_point now) const
+{
+	// Bước gần nhất ứng với thời điểm m_NextStepTime - m_StepDuration.
+	const float elapsed = std::chrono::duration<float>(now - (m_NextStepTime - m_StepDuration)).count();
+	return std::clamp(elapsed / m_StepTime, 0.0f, 1.0f);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <exception>
+
+// =================================================================================================
+// Class: SimulationThread
+// Mô tả:
+//      Chạy simulation (điều khiển, transform, camera...) theo bước thời gian cố định trên một luồng riêng,
+//      song song với việc ghi lệnh và submit của luồng render.
+//        - Luồng simulation giữ khóa trong suốt mỗi bước: registry chỉ bị sửa khi đang giữ khóa.
+//        - Mỗi frame luồng render gọi Extract: đợi bước đang chạy xong rồi chép dữ liệu cần vẽ từ registry
+//          sang bản sao của renderer (RenderProxyManager, SceneBVH, camera UBO...) trong lúc simulation đứng
+//          yên. Sau Extract luồng render chỉ đọc bản sao, simulation chạy bước kế tiếp cùng lúc.
+//        - Bước đến hạn khi thời gian thực vượt thời điểm của nó. Tụt lại quá MAX_CATCH_UP_TIME (máy quá chậm,
+//          breakpoint) thì phần thời gian thừa bị bỏ, tránh vòng xoáy chạy bù.
+//      Không chạy luồng riêng (`threaded` = false): các bước đến hạn được chạy ngay trong Extract, trước khi
+//      chép dữ liệu, vẫn theo bước thời gian cố định.
+//      Exception của một bước dừng simulation và được ném lại trên luồng render ở lần Extract kế tiếp.
+// =================================================================================================
+class SimulationThread
+{
+public:
+	// Hàm chạy một bước simulation. deltaTime: độ dài bước (giây), luôn bằng stepTime.
+	using StepFunc = std::function<void(float deltaTime)>;
+
+	// Hàm chép dữ liệu cho render. alpha: vị trí của thời điểm hiện tại giữa hai bước gần nhất, trong [0, 1],
+	// dùng để nội suy giữa trạng thái của hai bước (trễ thêm một bước).
+	using ExtractFunc = std::function<void(float alpha)>;
+
+	// Constructor: Chạy bước đầu tiên ngay trên luồng gọi (frame đầu tiên đã có dữ liệu), rồi khởi động luồng.
+	SimulationThread(float stepTime, bool threaded, StepFunc step);
+
+	// Destructor: Dừng và join luồng simulation (đợi bước đang chạy xong).
+	~SimulationThread();
+
+	// Cấm sao chép.
+	SimulationThread(const SimulationThread&) = delete;
+	SimulationThread& operator=(const SimulationThread&) = delete;
+
+	// Chạy `extract` khi simulation đang đứng giữa hai bước. Gọi từ luồng render, mỗi frame một lần.
+	void Extract(const ExtractFunc& extract);
+
+	// --- Getters ---
+	float GetStepTime() const { return m_StepTime; }
+	uint64_t GetStepCount() const { return m_StepCount.load(); }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// --- Cấu hình ---
+	static constexpr float MAX_CATCH_UP_TIME = 0.1f;	// Giống Core::Time: không chạy bù quá 0.1s.
+
+	// --- Dữ liệu nội bộ ---
+	const float m_StepTime;
+	const Clock::duration m_StepDuration;
+	const StepFunc m_Step;
+	const bool m_Threaded;
+
+	std::thread m_Thread;
+	std::mutex m_Mutex;							// Giữ trong mỗi bước và trong Extract.
+	std::condition_variable m_Condition;		// Báo cho luồng simulation khi Extract xong (hoặc yêu cầu dừng).
+	std::atomic<bool> m_ExtractPending{ false };	// Luồng render đang đợi khóa: simulation nhường trước bước kế tiếp.
+	bool m_Stop = false;
+
+	Clock::time_point m_NextStepTime;			// Thời điểm (thời gian thực) của bước kế tiếp.
+	std::atomic<uint64_t> m_StepCount{ 0 };
+	std::exception_ptr m_Exception;
+
+	// --- Hàm helper private ---
+
+	// Helper: Vòng lặp của luồng simulation.
+	void ThreadLoop();
+
+	// Helper: Chạy một bước và dời thời điểm bước kế tiếp. Gọi khi đang giữ m_Mutex (hoặc không có luồng riêng).
+	void RunStep(Clock::time_point now);
+
+	// Helper: Vị trí của `now` giữa bước gần nhất và bước kế tiếp, trong [0, 1].
+	float ComputeAlpha(Clock::time_point now) const;
+};
@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "VulkanBarrierBatch.h"
+
+// Các bit access là lệnh ghi, chỉ những bit này cần được "make available" ở phía src của barrier.
+static constexpr VkAccessFlags2 WRITE_ACCESS_MASK =
+	VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+	VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+	VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+bool VulkanBarrierBatch::ResolveTransition(VulkanImageState& state, VkImageLayout newLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+	bool discardContents, VkImageMemoryBarrier2& barrier)
+{
+	const bool isWrite = (dstAccessMask & WRITE_ACCESS_MASK) != 0;
+	const bool layoutChanged = state.layout != newLayout;
+
+	// Đọc tiếp một image đã ở đúng layout và đã thấy lần ghi gần nhất ở stage này: không cần barrier.
+	// readStageMask chứa ALL_COMMANDS nghĩa là lần ghi đã hiển thị với mọi stage (ví dụ: sau khi chờ semaphore).
+	const bool visibleToAllStages = (state.readStageMask & VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT) != 0;
+	if (!isWrite && !layoutChanged && (visibleToAllStages || (state.readStageMask & dstStageMask) == dstStageMask))
+	{
+		return false;
+	}
+
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.oldLayout = discardContents ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+	// Đọc không đổi layout chỉ cần đợi lần ghi; ghi hoặc chuyển layout phải đợi cả các lần đọc trước đó.
+	// Với synchronization2, stage NONE ở phía src hợp lệ (image mới, chưa có truy cập nào cần đợi).
+	barrier.srcStageMask = state.writeStageMask;
+	if (isWrite || layoutChanged) barrier.srcStageMask |= state.readStageMask;
+	barrier.srcAccessMask = state.writeAccessMask;
+	barrier.dstStageMask = dstStageMask;
+	barrier.dstAccessMask = dstAccessMask;
+
+	// Cập nhật trạng thái sau barrier.
+	state.layout = newLayout;
+	if (isWrite)
+	{
+		state.writeStageMask = dstStageMask;
+		state.writeAccessMask = dstAccessMask & WRITE_ACCESS_MASK;
+		state.readStageMask = VK_PIPELINE_STAGE_2_NONE;
+	}
+	else
+	{
+		state.readStageMask = layoutChanged ? dstStageMask : (state.readStageMask | dstStageMask);
+	}
+
+	return true;
+}
+
+bool VulkanBarrierBatch::TransitionImage(VulkanImage* image, VkImageLayout newLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+	bool discardContents)
+{
+	VkImageMemoryBarrier2 barrier{};
+	if (!ResolveTransition(image->GetState(), newLayout, dstStageMask, dstAccessMask, discardContents, barrier))
+	{
+		return false;
+	}
+
+	barrier.image = image->GetHandles().image;
+	barrier.subresourceRange.aspectMask = image->GetAspectFlags();
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+	m_ImageBarriers.push_back(barrier);
+	return true;
+}
+
+void VulkanBarrierBatch::AddImageBarrier(VkImage image, VkImageAspectFlags aspectMask,
+	VkImageLayout oldLayout, VkImageLayout newLayout,
+	VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+	VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+	uint32_t baseMipLevel, uint32_t levelCount)
+{
+	VkImageMemoryBarrier2 barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcStageMask = srcStageMask;
+	barrier.srcAccessMask = srcAccessMask;
+	barrier.dstStageMask = dstStageMask;
+	barrier.dstAccessMask = dstAccessMask;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = aspectMask;
+	barrier.subresourceRange.baseMipLevel = baseMipLevel;
+	barrier.subresourceRange.levelCount = levelCount;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+
+	m_ImageBarriers.push_back(barrier);
+}
+
+void VulkanBarrierBatch::AddBufferBarrier(VkBuffer buffer,
+	VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+	VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+	VkDeviceSize offset, VkDeviceSize size)
+{
+	VkBufferMemoryBarrier2 barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+	barrier.srcStageMask = srcStageMask;
+	barrier.srcAccessMask = srcAccessMask;
+	barrier.dstStageMask = dstStageMask;
+	barrier.dstAccessMask = dstAccessMask;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = buffer;
+	barrier.offset = offset;
+	barrier.size = size;
+
+	m_BufferBarriers.push_back(barrier);
+}
+
+void VulkanBarrierBatch::Flush(const VkCommandBuffer& cmdBuffer)
+{
+	if (IsEmpty()) return;
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_BufferBarriers.size());
+	dependencyInfo.pBufferMemoryBarriers = m_BufferBarriers.data();
+	dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_ImageBarriers.size());
+	dependencyInfo.pImageMemoryBarriers = m_ImageBarriers.data();
+
+	vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+
+	Clear();
+}
+
+void VulkanBarrierBatch::Clear()
+{
+	// clear() giữ lại dung lượng, lần gom tiếp theo không cần cấp phát lại.
+	m_ImageBarriers.clear();
+	m_BufferBarriers.clear();
+}
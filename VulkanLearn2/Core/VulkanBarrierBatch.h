@@ -0,0 +1,61 @@
+#pragma once
+#include "VulkanImage.h"
+#include <vector>
+
+// =================================================================================================
+// Class: VulkanBarrierBatch
+// Mô tả:
+//      Gom nhiều image/buffer barrier (synchronization2) và ghi tất cả bằng MỘT lệnh
+//      vkCmdPipelineBarrier2 khi Flush(). Khác với vkCmdPipelineBarrier cũ (một cặp stage mask
+//      cho cả lệnh), mỗi barrier mang stage mask src/dst riêng nên các image không liên quan
+//      không bị buộc phải đợi lẫn nhau.
+//      TransitionImage() dùng trạng thái được VulkanImage theo dõi làm phía src và bỏ qua
+//      các lần chuyển thừa (ví dụ: đọc tiếp một image đã ở đúng layout).
+//      Đối tượng được tái sử dụng: Flush() xóa danh sách nhưng giữ lại dung lượng đã cấp phát.
+// =================================================================================================
+class VulkanBarrierBatch
+{
+public:
+	// Chuyển `image` sang `newLayout` để được truy cập ở (`dstStageMask`, `dstAccessMask`).
+	// Phía src lấy từ trạng thái hiện tại của image, trạng thái được cập nhật ngay khi gọi.
+	// `discardContents`: Bỏ nội dung cũ (oldLayout UNDEFINED), dùng khi image sắp bị ghi đè toàn bộ.
+	// Trả về false nếu barrier thừa và bị bỏ qua.
+	bool TransitionImage(VulkanImage* image, VkImageLayout newLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+		bool discardContents = false);
+
+	// Thêm một image barrier với đầy đủ thông tin (không theo dõi trạng thái).
+	// Dùng cho image không thuộc VulkanImage (swapchain) hoặc khi chỉ chuyển một phần mip level.
+	void AddImageBarrier(VkImage image, VkImageAspectFlags aspectMask,
+		VkImageLayout oldLayout, VkImageLayout newLayout,
+		VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+		VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+		uint32_t baseMipLevel = 0, uint32_t levelCount = VK_REMAINING_MIP_LEVELS);
+
+	// Thêm một buffer barrier (ví dụ: dữ liệu compute ghi xong trước khi được đọc làm vertex/indirect).
+	void AddBufferBarrier(VkBuffer buffer,
+		VkPipelineStageFlags2 srcStageMask, VkAccessFlags2 srcAccessMask,
+		VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+		VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+	// Ghi toàn bộ barrier đã gom bằng một lệnh vkCmdPipelineBarrier2 và xóa danh sách.
+	// Không ghi gì nếu danh sách rỗng.
+	void Flush(const VkCommandBuffer& cmdBuffer);
+
+	// Bỏ các barrier đã gom mà không ghi.
+	void Clear();
+
+	bool IsEmpty() const { return m_ImageBarriers.empty() && m_BufferBarriers.empty(); }
+
+	// Phương thức Static: ResolveTransition
+	// Mô tả: Tính barrier cần thiết để đưa một image từ `state` sang trạng thái truy cập mới và cập nhật `state`.
+	//        Chỉ điền layout, stage và access của `barrier` (image và subresourceRange do bên gọi điền).
+	//        Dùng chung cho TransitionImage() và RenderGraph (tính trước barrier khi Compile).
+	// Trả về: false nếu không cần barrier.
+	static bool ResolveTransition(VulkanImageState& state, VkImageLayout newLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask,
+		bool discardContents, VkImageMemoryBarrier2& barrier);
+
+private:
+	// --- Dữ liệu nội bộ ---
+	std::vector<VkImageMemoryBarrier2> m_ImageBarriers;
+	std::vector<VkBufferMemoryBarrier2> m_BufferBarriers;
+};
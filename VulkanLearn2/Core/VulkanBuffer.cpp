@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommandManager.h"
+#include "VulkanSyncManager.h"
 
 VulkanBuffer::VulkanBuffer(const VulkanHandles& vulkanHandles, VulkanCommandManager* const vulkanCommandManager, VkBufferCreateInfo& bufferInfo, VmaMemoryUsage memoryUsage)
 	: m_VulkanHandles(vulkanHandles)
@@ -104,9 +105,14 @@ void VulkanBuffer::UploadData(const void* pSrcData, VkDeviceSize updateDataSize,
 
 		vkCmdCopyBuffer(cmd, stagingBuffer, m_Handles.buffer, 1, &region);
 
-		m_CommandManager->EndSingleTimeCmdBuffer(cmd);
+		// Submit mà không block CPU. Frame render kế tiếp sẽ chờ lần upload này trên GPU.
+		m_CommandManager->SubmitSingleTimeCmdBuffer(cmd);
 
-		// 4. Hủy staging buffer tạm thời ngay sau khi sao chép xong.
-		vmaDestroyBuffer(m_VulkanHandles.allocator, stagingBuffer, stagingAllocation);
+		// 4. Staging buffer chỉ được hủy khi GPU đã thực thi xong lệnh sao chép.
+		VmaAllocator allocator = m_VulkanHandles.allocator;
+		m_CommandManager->GetSyncManager()->DeferDestroy([allocator, stagingBuffer, stagingAllocation]()
+		{
+			vmaDestroyBuffer(allocator, stagingBuffer, stagingAllocation);
+		});
 	}
 }
\ No newline at end of file
@@ -1,48 +1,149 @@
 #include "pch.h"
 #include "VulkanCommandManager.h"
 #include "VulkanContext.h"
+#include "VulkanSyncManager.h"
 
 
-VulkanCommandManager::VulkanCommandManager(const VulkanHandles& vulkanHandles, int MAX_FRAME_IN_FLIGHT):
-	m_VulkanHandles(vulkanHandles)
+VulkanCommandManager::VulkanCommandManager(const VulkanHandles& vulkanHandles, VulkanSyncManager* syncManager, int MAX_FRAME_IN_FLIGHT, uint32_t recordingThreadCount):
+	m_VulkanHandles(vulkanHandles),
+	m_SyncManager(syncManager)
 {
-	CreateCommandPool();
-	CreateCommandBuffers(MAX_FRAME_IN_FLIGHT);
+	CreateCommandPools();
+	m_FrameCmdBuffers.resize(MAX_FRAME_IN_FLIGHT);
+	CreateSecondaryCommandPools(MAX_FRAME_IN_FLIGHT, recordingThreadCount);
 }
 
 VulkanCommandManager::~VulkanCommandManager()
 {
-	// Giải phóng các command buffer chính.
-	// LƯU Ý: Không cần gọi vkDestroyCommandBuffer vì chúng được giải phóng cùng với command pool.
-	// vkFreeCommandBuffers chỉ đơn giản là trả chúng về pool.
-	vkFreeCommandBuffers(m_VulkanHandles.device, m_Handles.commandPool, m_Handles.commandBuffers.size(), m_Handles.commandBuffers.data());
-	
 	// Hủy command pool, hành động này cũng sẽ giải phóng tất cả command buffer đã được cấp phát từ nó.
 	vkDestroyCommandPool(m_VulkanHandles.device, m_Handles.commandPool, nullptr);
+	vkDestroyCommandPool(m_VulkanHandles.device, m_Handles.computeCommandPool, nullptr);
+
+	// Hủy các secondary pool (kèm theo các secondary command buffer của chúng).
+	for (auto& framePools : m_SecondaryPools)
+	{
+		for (auto& secondaryPool : framePools)
+		{
+			vkDestroyCommandPool(m_VulkanHandles.device, secondaryPool.commandPool, nullptr);
+		}
+	}
 }
 
-void VulkanCommandManager::CreateCommandPool()
+void VulkanCommandManager::CreateCommandPools()
+{
+	m_Handles.commandPool = CreateResettableCommandPool(m_VulkanHandles.queueFamilyIndices.GraphicQueueIndex);
+	m_Handles.computeCommandPool = CreateResettableCommandPool(m_VulkanHandles.queueFamilyIndices.ComputeQueueIndex);
+}
+
+VkCommandPool VulkanCommandManager::CreateResettableCommandPool(uint32_t queueFamilyIndex)
 {
 	VkCommandPoolCreateInfo commandPoolInfo{};
 	commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	commandPoolInfo.queueFamilyIndex = m_VulkanHandles.queueFamilyIndices.GraphicQueueIndex;
+	commandPoolInfo.queueFamilyIndex = queueFamilyIndex;
 	// Cờ này cho phép các command buffer có thể được reset riêng lẻ.
 	commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
-	VK_CHECK(vkCreateCommandPool(m_VulkanHandles.device, &commandPoolInfo, nullptr, &m_Handles.commandPool), "LỖI: Tạo command pool thất bại!");
+	VkCommandPool commandPool = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateCommandPool(m_VulkanHandles.device, &commandPoolInfo, nullptr, &commandPool), "LỖI: Tạo command pool thất bại!");
+	return commandPool;
 }
 
-void VulkanCommandManager::CreateCommandBuffers(int MAX_FRAMES_IN_FLIGHT)
+VkCommandBuffer VulkanCommandManager::GetFrameCmdBuffer(uint32_t currentFrame, uint32_t submissionIndex, QueueType queue)
 {
-	m_Handles.commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+	std::vector<FrameCommandBuffer>& frameCmdBuffers = m_FrameCmdBuffers[currentFrame];
+	if (submissionIndex >= frameCmdBuffers.size())
+	{
+		frameCmdBuffers.resize(submissionIndex + 1);
+	}
+
+	FrameCommandBuffer& frameCmdBuffer = frameCmdBuffers[submissionIndex];
+	if (frameCmdBuffer.commandBuffer != VK_NULL_HANDLE)
+	{
+		// Một lần submit luôn gửi lên cùng một queue (thứ tự submit của RenderGraph cố định sau Compile).
+		if (frameCmdBuffer.queue != queue)
+		{
+			throw std::runtime_error("LỖI: Command buffer của lần submit " + std::to_string(submissionIndex) + " đã được cấp phát cho queue khác!");
+		}
+		return frameCmdBuffer.commandBuffer;
+	}
 
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY; // Buffer chính, có thể submit trực tiếp lên queue.
-	allocInfo.commandPool = m_Handles.commandPool;
-	allocInfo.commandBufferCount = MAX_FRAMES_IN_FLIGHT;
+	allocInfo.commandPool = queue == QueueType::Compute ? m_Handles.computeCommandPool : m_Handles.commandPool;
+	allocInfo.commandBufferCount = 1;
+
+	VK_CHECK(vkAllocateCommandBuffers(m_VulkanHandles.device, &allocInfo, &frameCmdBuffer.commandBuffer), "LỖI: Cấp phát command buffer thất bại!");
+	frameCmdBuffer.queue = queue;
+
+	return frameCmdBuffer.commandBuffer;
+}
+
+void VulkanCommandManager::CreateSecondaryCommandPools(int MAX_FRAMES_IN_FLIGHT, uint32_t recordingThreadCount)
+{
+	m_SecondaryPools.resize(MAX_FRAMES_IN_FLIGHT);
+
+	VkCommandPoolCreateInfo commandPoolInfo{};
+	commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	commandPoolInfo.queueFamilyIndex = m_VulkanHandles.queueFamilyIndices.GraphicQueueIndex;
+	// Các buffer chỉ sống trong một frame và được reset theo cả pool, không cần reset riêng lẻ.
+	commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+	for (auto& framePools : m_SecondaryPools)
+	{
+		framePools.resize(recordingThreadCount);
+		for (auto& secondaryPool : framePools)
+		{
+			VK_CHECK(vkCreateCommandPool(m_VulkanHandles.device, &commandPoolInfo, nullptr, &secondaryPool.commandPool), "LỖI: Tạo secondary command pool thất bại!");
+		}
+	}
+}
+
+VkCommandBuffer VulkanCommandManager::BeginSecondaryCmdBuffer(uint32_t currentFrame, uint32_t threadIndex, const VkCommandBufferInheritanceRenderingInfo& renderingInfo)
+{
+	SecondaryCommandPool& secondaryPool = m_SecondaryPools[currentFrame][threadIndex];
+
+	// Cấp phát thêm buffer khi pool đã dùng hết, các buffer cũ được tái sử dụng ở các frame sau.
+	if (secondaryPool.usedCount == secondaryPool.commandBuffers.size())
+	{
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = secondaryPool.commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer newCmdBuffer;
+		VK_CHECK(vkAllocateCommandBuffers(m_VulkanHandles.device, &allocInfo, &newCmdBuffer), "LỖI: Cấp phát secondary command buffer thất bại!");
+		secondaryPool.commandBuffers.push_back(newCmdBuffer);
+	}
+
+	VkCommandBuffer cmdBuffer = secondaryPool.commandBuffers[secondaryPool.usedCount++];
+
+	// Secondary buffer được thực thi bên trong vkCmdBeginRendering của primary,
+	// nên phải khai báo các định dạng attachment thông qua inheritance info.
+	VkCommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.pNext = &renderingInfo;
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
 
-	VK_CHECK(vkAllocateCommandBuffers(m_VulkanHandles.device, &allocInfo, m_Handles.commandBuffers.data()), "LỖI: Cấp phát command buffer thất bại!");
+	VK_CHECK(vkBeginCommandBuffer(cmdBuffer, &beginInfo), "LỖI: Bắt đầu ghi secondary command buffer thất bại!");
+
+	return cmdBuffer;
+}
+
+void VulkanCommandManager::ResetSecondaryCmdBuffers(uint32_t currentFrame)
+{
+	for (auto& secondaryPool : m_SecondaryPools[currentFrame])
+	{
+		if (secondaryPool.usedCount == 0) continue;
+
+		VK_CHECK(vkResetCommandPool(m_VulkanHandles.device, secondaryPool.commandPool, 0), "LỖI: Reset secondary command pool thất bại!");
+		secondaryPool.usedCount = 0;
+	}
 }
 
 VkCommandBuffer VulkanCommandManager::BeginSingleTimeCmdBuffer()
@@ -72,22 +173,63 @@ VkCommandBuffer VulkanCommandManager::BeginSingleTimeCmdBuffer()
 
 void VulkanCommandManager::EndSingleTimeCmdBuffer(VkCommandBuffer cmdBuffer)
 {
-	// 1. Kết thúc ghi command.
+	// 1. Kết thúc ghi command và submit kèm một giá trị timeline mới.
+	uint64_t signalValue = SubmitWithTimeline(cmdBuffer);
+
+	// 2. Chỉ đợi đúng lần submit này hoàn thành thay vì vkDeviceWaitIdle.
+	m_SyncManager->WaitForTimelineValue(signalValue);
+
+	// 3. Giải phóng command buffer.
+	vkFreeCommandBuffers(m_VulkanHandles.device, m_Handles.commandPool, 1, &cmdBuffer);
+}
+
+uint64_t VulkanCommandManager::SubmitSingleTimeCmdBuffer(VkCommandBuffer cmdBuffer)
+{
+	uint64_t signalValue = SubmitWithTimeline(cmdBuffer);
+
+	// Frame render kế tiếp phải chờ lần upload này trước khi đọc dữ liệu.
+	m_SyncManager->SetLastUploadValue(signalValue);
+
+	// Command buffer chỉ được trả về pool khi GPU đã thực thi xong.
+	VkDevice device = m_VulkanHandles.device;
+	VkCommandPool commandPool = m_Handles.commandPool;
+	m_SyncManager->DeferDestroy([device, commandPool, cmdBuffer]()
+	{
+		vkFreeCommandBuffers(device, commandPool, 1, &cmdBuffer);
+	});
+
+	return signalValue;
+}
+
+uint64_t VulkanCommandManager::SubmitWithTimeline(VkCommandBuffer cmdBuffer)
+{
 	vkEndCommandBuffer(cmdBuffer);
 
-	// 2. Submit command buffer lên graphics queue.
+	// Chờ (phía GPU) toàn bộ các lần submit trước đó để tránh ghi đè dữ liệu mà frame đang bay còn đọc.
+	// Giá trị báo hiệu là giá trị kế tiếp trên timeline chung.
+	uint64_t waitValue = m_SyncManager->GetLastSubmittedValue();
+	uint64_t signalValue = m_SyncManager->AcquireTimelineValue();
+	VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = 1;
+	timelineInfo.pWaitSemaphoreValues = &waitValue;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &signalValue;
+
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &cmdBuffer;
+	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.pWaitSemaphores = &m_SyncManager->getTimelineSemaphore();
+	submitInfo.pWaitDstStageMask = &waitStage;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &m_SyncManager->getTimelineSemaphore();
 
-	vkQueueSubmit(m_VulkanHandles.graphicQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	
-	// 3. Đợi cho queue thực thi xong.
-	// LƯU Ý: vkDeviceWaitIdle là cách đơn giản nhất nhưng không hiệu quả nhất.
-	// Một giải pháp tốt hơn là dùng fence để chỉ đợi command buffer này hoàn thành.
-	vkDeviceWaitIdle(m_VulkanHandles.device);
+	VK_CHECK(vkQueueSubmit(m_VulkanHandles.graphicQueue, 1, &submitInfo, VK_NULL_HANDLE), "LỖI: Submit command buffer dùng một lần thất bại!");
 
-	// 4. Giải phóng command buffer.
-	vkFreeCommandBuffers(m_VulkanHandles.device, m_Handles.commandPool, 1, &cmdBuffer);
+	return signalValue;
 }
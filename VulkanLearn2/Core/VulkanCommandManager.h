@@ -2,55 +2,114 @@
 #include "VulkanContext.h"
 #include <vector>
 
+// Forward declarations
+class VulkanSyncManager;
+
 // =================================================================================================
 // Struct: CommandManagerHandles
 // Mô tả: Chứa các handle nội bộ của VulkanCommandManager.
-//        Bao gồm VkCommandPool và danh sách các VkCommandBuffer.
+//        Bao gồm command pool của graphics queue và compute queue.
 // =================================================================================================
 struct CommandManagerHandles
+{
+	VkCommandPool commandPool = VK_NULL_HANDLE;			// Pool của graphics queue family.
+	VkCommandPool computeCommandPool = VK_NULL_HANDLE;	// Pool của compute queue family (async compute).
+};
+
+// =================================================================================================
+// Struct: FrameCommandBuffer
+// Mô tả: Primary command buffer của một lần submit trong frame, gắn với queue mà nó được submit lên.
+// =================================================================================================
+struct FrameCommandBuffer
+{
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	QueueType queue = QueueType::Graphics;
+};
+
+// =================================================================================================
+// Struct: SecondaryCommandPool
+// Mô tả: Command pool dành riêng cho một cặp (frame-in-flight, luồng ghi lệnh).
+//        Các secondary command buffer được cấp phát một lần và tái sử dụng mỗi frame;
+//        toàn bộ pool được reset cùng lúc khi frame tương ứng bắt đầu.
+// =================================================================================================
+struct SecondaryCommandPool
 {
 	VkCommandPool commandPool = VK_NULL_HANDLE;
-	std::vector<VkCommandBuffer> commandBuffers;
+	std::vector<VkCommandBuffer> commandBuffers;	// Các buffer đã cấp phát từ pool này.
+	uint32_t usedCount = 0;							// Số buffer đã được dùng trong frame hiện tại.
 };
 
 // =================================================================================================
 // Class: VulkanCommandManager
 // Mô tả: 
 //      Quản lý việc tạo và sử dụng các command buffer.
-//      Bao gồm một command pool và các command buffer chính cho các frame-in-flight,
-//      cũng như các hàm tiện ích để tạo command buffer dùng một lần.
+//      Bao gồm các command buffer chính cho mỗi lần submit của các frame-in-flight (trên graphics hoặc compute queue),
+//      các hàm tiện ích để tạo command buffer dùng một lần, và các command pool riêng cho
+//      từng luồng ghi lệnh (secondary command buffer) để nhiều luồng có thể ghi song song mà không cần khóa.
 // =================================================================================================
 class VulkanCommandManager
 {
 public:
-	// Constructor: Khởi tạo command pool và cấp phát các command buffer chính.
+	// Constructor: Khởi tạo các command pool. Command buffer chính được cấp phát khi cần (GetFrameCmdBuffer).
 	// Tham số:
 	//      vulkanHandles: Tham chiếu đến các handle Vulkan chung.
+	//      syncManager: Con trỏ tới SyncManager, cung cấp timeline semaphore cho các lần submit dùng một lần.
 	//      MAX_FRAME_IN_FLIGHT: Số lượng frame được xử lý song song tối đa.
-	VulkanCommandManager(const VulkanHandles& vulkanHandles, int MAX_FRAME_IN_FLIGHT);
+	//      recordingThreadCount: Số luồng có thể ghi secondary command buffer (xem JobSystem::GetThreadCount).
+	VulkanCommandManager(const VulkanHandles& vulkanHandles, VulkanSyncManager* syncManager, int MAX_FRAME_IN_FLIGHT, uint32_t recordingThreadCount = 1);
 	~VulkanCommandManager();
 	
 	// Getter: Lấy các handle nội bộ.
 	const CommandManagerHandles& getHandles() const { return m_Handles; }
+	VulkanSyncManager* GetSyncManager() const { return m_SyncManager; }
 
 	// Bắt đầu một command buffer để thực hiện các tác vụ chỉ diễn ra một lần (ví dụ: copy buffer).
 	VkCommandBuffer BeginSingleTimeCmdBuffer();
+
+	// Lấy primary command buffer của lần submit thứ `submissionIndex` trong frame `currentFrame`,
+	// cấp phát từ pool của `queue` ở lần gọi đầu tiên. Buffer được tái sử dụng ở các frame sau.
+	// LƯU Ý: Chỉ reset/ghi lại sau khi GPU đã thực thi xong lần submit trước đó của frame này.
+	VkCommandBuffer GetFrameCmdBuffer(uint32_t currentFrame, uint32_t submissionIndex, QueueType queue);
 	
 	// Kết thúc, submit, và giải phóng command buffer dùng một lần.
+	// CPU chỉ chờ đúng lần submit này hoàn thành (qua timeline semaphore), không đợi cả device.
 	void EndSingleTimeCmdBuffer(VkCommandBuffer cmdBuffer);
 
+	// Kết thúc và submit command buffer dùng một lần mà KHÔNG block CPU.
+	// Trả về giá trị timeline sẽ được báo hiệu khi GPU thực thi xong. Command buffer được giải phóng
+	// thông qua hàng đợi hủy của SyncManager, và lần submit render kế tiếp sẽ chờ giá trị này trên GPU.
+	uint64_t SubmitSingleTimeCmdBuffer(VkCommandBuffer cmdBuffer);
+
+	// Lấy một secondary command buffer từ pool của luồng `threadIndex` và bắt đầu ghi lệnh
+	// bên trong một vùng dynamic rendering (RENDER_PASS_CONTINUE).
+	// LƯU Ý: Mỗi luồng chỉ được dùng đúng threadIndex của mình. Người gọi tự gọi vkEndCommandBuffer.
+	VkCommandBuffer BeginSecondaryCmdBuffer(uint32_t currentFrame, uint32_t threadIndex, const VkCommandBufferInheritanceRenderingInfo& renderingInfo);
+
+	// Reset toàn bộ secondary pool của một frame.
+	// LƯU Ý: Chỉ gọi sau khi GPU đã thực thi xong frame này.
+	void ResetSecondaryCmdBuffers(uint32_t currentFrame);
+
 private:
 	// --- Tham chiếu Vulkan ---
 	const VulkanHandles& m_VulkanHandles;
+	VulkanSyncManager* const m_SyncManager;
 
 	// --- Dữ liệu nội bộ ---
 	CommandManagerHandles m_Handles;
+	std::vector<std::vector<FrameCommandBuffer>> m_FrameCmdBuffers;	// [frame][submissionIndex]
+	std::vector<std::vector<SecondaryCommandPool>> m_SecondaryPools;	// [frame][threadIndex]
 
 	// --- Hàm helper private ---
 	
-	// Helper: Tạo command pool.
-	void CreateCommandPool();
-	
-	// Helper: Cấp phát các command buffer chính.
-	void CreateCommandBuffers(int MAX_FRAME_IN_FLIGHT);
+	// Helper: Tạo command pool cho graphics và compute queue.
+	void CreateCommandPools();
+
+	// Helper: Tạo một command pool cho phép reset từng command buffer riêng lẻ.
+	VkCommandPool CreateResettableCommandPool(uint32_t queueFamilyIndex);
+
+	// Helper: Tạo command pool cho từng cặp (frame, luồng ghi lệnh).
+	void CreateSecondaryCommandPools(int MAX_FRAME_IN_FLIGHT, uint32_t recordingThreadCount);
+
+	// Helper: Kết thúc command buffer và submit, báo hiệu một giá trị timeline mới. Trả về giá trị đó.
+	uint64_t SubmitWithTimeline(VkCommandBuffer cmdBuffer);
 };
\ No newline at end of file
@@ -155,7 +155,11 @@ void VulkanContext::CreateLogicalDevice()
 	const float queuePriority = 1.0f;
 
 	// Sử dụng std::set để tự động loại bỏ các queue family index trùng lặp (ví dụ: graphic và present là cùng một queue).
-	std::set<uint32_t> uniqueQueueFamilyIndices = { m_Handles.queueFamilyIndices.GraphicQueueIndex, m_Handles.queueFamilyIndices.PresentQueueIndex };
+	std::set<uint32_t> uniqueQueueFamilyIndices = {
+		m_Handles.queueFamilyIndices.GraphicQueueIndex,
+		m_Handles.queueFamilyIndices.PresentQueueIndex,
+		m_Handles.queueFamilyIndices.ComputeQueueIndex
+	};
 	
 	for (uint32_t queueFamilyIndex : uniqueQueueFamilyIndices)
 	{
@@ -168,10 +172,38 @@ void VulkanContext::CreateLogicalDevice()
 		queueCreateInfos.push_back(queueInfo);
 	}
 
+	// Kiểm tra các tính năng tùy chọn mà GPU hỗ trợ (dùng cho GPU-driven rendering).
+	VkPhysicalDeviceVulkan12Features supportedVulkan12Features{};
+	supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 supportedFeatures{};
+	supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	supportedFeatures.pNext = &supportedVulkan12Features;
+	vkGetPhysicalDeviceFeatures2(m_Handles.physicalDevice, &supportedFeatures);
+
+	// vkCmdDrawIndexedIndirectCount cần drawIndirectCount, nhiều lệnh vẽ trong một lần gọi cần multiDrawIndirect,
+	// và lệnh vẽ do compute shader sinh ra dùng firstInstance để chọn instance.
+	m_Handles.drawIndirectCountSupported =
+		supportedVulkan12Features.drawIndirectCount &&
+		supportedFeatures.features.multiDrawIndirect &&
+		supportedFeatures.features.drawIndirectFirstInstance;
+
+	// Multiview là tính năng bắt buộc từ Vulkan 1.1, chỉ cần truy vấn giới hạn số view.
+	VkPhysicalDeviceMultiviewProperties multiviewProperties{};
+	multiviewProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 deviceProperties{};
+	deviceProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	deviceProperties.pNext = &multiviewProperties;
+	vkGetPhysicalDeviceProperties2(m_Handles.physicalDevice, &deviceProperties);
+	m_Handles.maxMultiviewViewCount = multiviewProperties.maxMultiviewViewCount;
+
 	// Các tính năng của physical device mà chúng ta muốn sử dụng.
 	VkPhysicalDeviceFeatures features{};
 	features.fillModeNonSolid = VK_TRUE; // Cho phép vẽ wireframe
 	features.samplerAnisotropy = VK_TRUE; // Cho phép lọc bất đẳng hướng
+	features.multiDrawIndirect = m_Handles.drawIndirectCountSupported;
+	features.drawIndirectFirstInstance = m_Handles.drawIndirectCountSupported;
 
 	// Feature Cho Dynamic Rendering
 	// Feature không thuộc về physical như trên cần nối chuỗi qua pNext.
@@ -179,13 +211,30 @@ void VulkanContext::CreateLogicalDevice()
 	dynamicRenderingFT.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
 	dynamicRenderingFT.dynamicRendering = true;
 
-	// Feature cho Descriptor Indexing (để hỗ trợ partially bound descriptors)
-	VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{};
-	descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
-	descriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
-	descriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
-	descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
-	descriptorIndexingFeatures.pNext = &dynamicRenderingFT; // Nối chuỗi với dynamic rendering feature
+	// Feature của Vulkan 1.2 (gộp trong một struct, không được nối chung với các struct feature riêng lẻ tương ứng):
+	//      - Descriptor Indexing: hỗ trợ partially bound descriptors.
+	//      - Timeline Semaphore: đồng hồ frame dùng chung cho mọi lần submit.
+	//      - Draw Indirect Count: số lệnh vẽ indirect do GPU quyết định.
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+	vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+	vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	vulkan12Features.timelineSemaphore = VK_TRUE;
+	vulkan12Features.drawIndirectCount = m_Handles.drawIndirectCountSupported;
+	vulkan12Features.pNext = &dynamicRenderingFT; // Nối chuỗi với dynamic rendering feature
+
+	// Feature của Vulkan 1.1: Multiview - vẽ vào nhiều layer của attachment trong một lần vẽ (shadow map của mọi đèn).
+	VkPhysicalDeviceVulkan11Features vulkan11Features{};
+	vulkan11Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
+	vulkan11Features.multiview = VK_TRUE;
+	vulkan11Features.pNext = &vulkan12Features;
+
+	// Feature cho Synchronization2 (Vulkan 1.3) - vkCmdPipelineBarrier2 với stage mask riêng cho từng barrier.
+	VkPhysicalDeviceSynchronization2Features synchronization2Features{};
+	synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES;
+	synchronization2Features.synchronization2 = VK_TRUE;
+	synchronization2Features.pNext = &vulkan11Features;
 
 	// Thông tin để tạo logical device.
 	VkDeviceCreateInfo deviceInfo{};
@@ -195,13 +244,28 @@ void VulkanContext::CreateLogicalDevice()
 	deviceInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	deviceInfo.pQueueCreateInfos = queueCreateInfos.data();
 	deviceInfo.pEnabledFeatures = &features;
-	deviceInfo.pNext = &descriptorIndexingFeatures; // Trỏ pNext chính vào descriptor indexing features
+	deviceInfo.pNext = &synchronization2Features; // Trỏ pNext chính vào đầu chuỗi feature
 
 	VK_CHECK(vkCreateDevice(m_Handles.physicalDevice, &deviceInfo, nullptr, &m_Handles.device), "LỖI: Tạo logical device thất bại!");
 
 	// Lấy handle của các queue từ logical device.
 	vkGetDeviceQueue(m_Handles.device, m_Handles.queueFamilyIndices.GraphicQueueIndex, 0, &m_Handles.graphicQueue);
 	vkGetDeviceQueue(m_Handles.device, m_Handles.queueFamilyIndices.PresentQueueIndex, 0, &m_Handles.presentQueue);
+	vkGetDeviceQueue(m_Handles.device, m_Handles.queueFamilyIndices.ComputeQueueIndex, 0, &m_Handles.computeQueue);
+
+	if (m_Handles.HasAsyncCompute())
+	{
+		Log::Info("Sử dụng compute queue riêng (family " + std::to_string(m_Handles.queueFamilyIndices.ComputeQueueIndex) + ") cho async compute.");
+	}
+	else
+	{
+		Log::Warning("GPU không có compute queue family riêng, các pass async compute sẽ chạy trên graphics queue.");
+	}
+
+	if (!m_Handles.drawIndirectCountSupported)
+	{
+		Log::Warning("GPU không hỗ trợ drawIndirectCount / multiDrawIndirect, lệnh vẽ sẽ được ghi trên CPU.");
+	}
 }
 
 void VulkanContext::CreateVMAAllocator()
@@ -250,6 +314,19 @@ bool VulkanContext::isPhysicalDeviceSuitable(VkPhysicalDevice physDevice)
 		}
 	}
 
+	// Tìm queue family chỉ hỗ trợ compute (không có graphics) để chạy async compute song song với graphics queue.
+	// Không có thì dùng chung graphics queue family (mọi graphics family đều hỗ trợ compute).
+	m_Handles.queueFamilyIndices.ComputeQueueIndex = m_Handles.queueFamilyIndices.GraphicQueueIndex;
+	for (uint32_t i = 0; i < queueFamilyCount; i++)
+	{
+		const VkQueueFlags flags = queueFamilyProperties[i].queueFlags;
+		if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+		{
+			m_Handles.queueFamilyIndices.ComputeQueueIndex = i;
+			break;
+		}
+	}
+
 	// --- Kiểm tra các device extension được yêu cầu --- 
 	uint32_t physExtensionCount = 0;
 	vkEnumerateDeviceExtensionProperties(physDevice, nullptr, &physExtensionCount, nullptr);
@@ -12,6 +12,17 @@ struct QueueFamilyIndices
 {
 	uint32_t GraphicQueueIndex; // Index cho graphics queue family
 	uint32_t PresentQueueIndex; // Index cho presentation queue family
+	uint32_t ComputeQueueIndex; // Index cho compute queue family (ưu tiên family riêng, không hỗ trợ graphics)
+};
+
+// =================================================================================================
+// Enum: QueueType
+// Mô tả: Queue mà một lần submit được gửi tới.
+// =================================================================================================
+enum class QueueType
+{
+	Graphics,	// graphicQueue
+	Compute		// computeQueue (async compute). Trùng với graphicQueue nếu GPU không có compute family riêng.
 };
 
 // =================================================================================================
@@ -30,6 +41,20 @@ struct VulkanHandles
 	QueueFamilyIndices queueFamilyIndices{};
 	VkQueue graphicQueue = VK_NULL_HANDLE;
 	VkQueue presentQueue = VK_NULL_HANDLE;
+	VkQueue computeQueue = VK_NULL_HANDLE;
+
+	// GPU hỗ trợ vkCmdDrawIndexedIndirectCount (cùng multiDrawIndirect, drawIndirectFirstInstance) hay không.
+	bool drawIndirectCountSupported = false;
+
+	// Số view tối đa của một lần render multiview (Vulkan 1.1, tối thiểu là 6). Dùng để vẽ mọi shadow map trong một pass.
+	uint32_t maxMultiviewViewCount = 0;
+
+	// Có compute queue riêng, chạy song song được với graphics queue hay không.
+	bool HasAsyncCompute() const { return queueFamilyIndices.ComputeQueueIndex != queueFamilyIndices.GraphicQueueIndex; }
+
+	// Lấy queue và queue family tương ứng với `type`.
+	VkQueue GetQueue(QueueType type) const { return type == QueueType::Compute ? computeQueue : graphicQueue; }
+	uint32_t GetQueueFamilyIndex(QueueType type) const { return type == QueueType::Compute ? queueFamilyIndices.ComputeQueueIndex : queueFamilyIndices.GraphicQueueIndex; }
 };
 
 // =================================================================================================
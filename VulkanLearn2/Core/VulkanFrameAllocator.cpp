@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "VulkanFrameAllocator.h"
+#include "VulkanBuffer.h"
+
+VulkanFrameAllocator::VulkanFrameAllocator(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, VkDeviceSize frameCapacity, uint32_t maxFramesInFlight) :
+	m_VulkanHandles(vulkanHandles)
+{
+	// Dynamic offset phải là bội số của min{Uniform,Storage}BufferOffsetAlignment.
+	// Dùng giá trị lớn hơn để một vùng cấp phát có thể được bind dưới cả hai dạng.
+	VkPhysicalDeviceProperties deviceProperties{};
+	vkGetPhysicalDeviceProperties(m_VulkanHandles.physicalDevice, &deviceProperties);
+	m_Alignment = std::max(
+		deviceProperties.limits.minUniformBufferOffsetAlignment,
+		deviceProperties.limits.minStorageBufferOffsetAlignment);
+
+	// Căn chỉnh dung lượng mỗi vùng để điểm bắt đầu vùng của mọi frame đều hợp lệ.
+	m_FrameCapacity = AlignUp(frameCapacity, m_Alignment);
+	m_Heads.resize(maxFramesInFlight, 0);
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	bufferInfo.queueFamilyIndexCount = 1;
+	bufferInfo.pQueueFamilyIndices = &m_VulkanHandles.queueFamilyIndices.GraphicQueueIndex;
+	bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	bufferInfo.size = m_FrameCapacity * maxFramesInFlight;
+
+	// CPU_TO_GPU: VulkanBuffer sẽ map sẵn vùng nhớ này vĩnh viễn.
+	m_Buffer = new VulkanBuffer(m_VulkanHandles, commandManager, bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU);
+}
+
+VulkanFrameAllocator::~VulkanFrameAllocator()
+{
+	delete(m_Buffer);
+}
+
+FrameAllocation VulkanFrameAllocator::Allocate(uint32_t currentFrame, VkDeviceSize size)
+{
+	VkDeviceSize alignedHead = AlignUp(m_Heads[currentFrame], m_Alignment);
+	if (alignedHead + size > m_FrameCapacity)
+	{
+		throw std::runtime_error("LỖI: VulkanFrameAllocator đã hết dung lượng cho frame hiện tại!");
+	}
+
+	m_Heads[currentFrame] = alignedHead + size;
+
+	VkDeviceSize absoluteOffset = m_FrameCapacity * currentFrame + alignedHead;
+
+	FrameAllocation allocation{};
+	allocation.offset = static_cast<uint32_t>(absoluteOffset);
+	allocation.size = size;
+	allocation.pMappedData = reinterpret_cast<char*>(m_Buffer->GetHandles().pMappedData) + absoluteOffset;
+
+	return allocation;
+}
+
+uint32_t VulkanFrameAllocator::Push(uint32_t currentFrame, const void* pSrcData, VkDeviceSize size)
+{
+	FrameAllocation allocation = Allocate(currentFrame, size);
+	memcpy(allocation.pMappedData, pSrcData, size);
+
+	return allocation.offset;
+}
+
+void VulkanFrameAllocator::Reset(uint32_t currentFrame)
+{
+	m_Heads[currentFrame] = 0;
+}
+
+void VulkanFrameAllocator::Flush(uint32_t currentFrame)
+{
+	if (m_Heads[currentFrame] == 0) return;
+
+	// vmaFlushAllocation là no-op nếu bộ nhớ đã là HOST_COHERENT.
+	vmaFlushAllocation(m_VulkanHandles.allocator, m_Buffer->GetHandles().allocation, m_FrameCapacity * currentFrame, m_Heads[currentFrame]);
+}
+
+VkDeviceSize VulkanFrameAllocator::AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	if (alignment == 0) return value;
+	return (value + alignment - 1) & ~(alignment - 1);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "VulkanContext.h"
+#include <vector>
+
+// Forward declarations
+class VulkanBuffer;
+class VulkanCommandManager;
+
+// =================================================================================================
+// Struct: FrameAllocation
+// Mô tả: Kết quả của một lần cấp phát từ VulkanFrameAllocator.
+//        `offset` được dùng trực tiếp làm dynamic offset khi bind descriptor set.
+// =================================================================================================
+struct FrameAllocation
+{
+	uint32_t offset = 0;			// Vị trí (byte) của vùng nhớ trong buffer chung.
+	VkDeviceSize size = 0;			// Kích thước vùng nhớ đã cấp phát (byte).
+	void* pMappedData = nullptr;	// Con trỏ CPU để ghi dữ liệu trực tiếp.
+};
+
+// =================================================================================================
+// Class: VulkanFrameAllocator
+// Mô tả:
+//      Bộ cấp phát tuyến tính (bump allocator) cho dữ liệu tạm thời thay đổi mỗi frame
+//      (camera UBO, dữ liệu đèn, ...).
+//      Toàn bộ dữ liệu nằm trong MỘT buffer được map vĩnh viễn, chia thành các vùng bằng nhau,
+//      mỗi vùng dành cho một frame-in-flight. Mỗi lần cấp phát chỉ là tăng con trỏ đầu vùng,
+//      shader đọc dữ liệu thông qua descriptor UNIFORM_BUFFER_DYNAMIC / STORAGE_BUFFER_DYNAMIC
+//      với dynamic offset trả về từ Allocate().
+//      Vùng của một frame được Reset() sau khi timeline đã đạt tới giá trị submit trước đó của frame.
+// =================================================================================================
+class VulkanFrameAllocator
+{
+public:
+	// Constructor: Tạo buffer chung và chia vùng cho từng frame.
+	// Tham số:
+	//      vulkanHandles: Tham chiếu đến các handle Vulkan chung.
+	//      commandManager: Con trỏ tới CommandManager (yêu cầu bởi VulkanBuffer).
+	//      frameCapacity: Dung lượng tối đa (byte) cho dữ liệu của một frame.
+	//      maxFramesInFlight: Số lượng frame được xử lý song song tối đa.
+	VulkanFrameAllocator(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, VkDeviceSize frameCapacity, uint32_t maxFramesInFlight);
+	~VulkanFrameAllocator();
+
+	// Cấm sao chép.
+	VulkanFrameAllocator(const VulkanFrameAllocator&) = delete;
+	VulkanFrameAllocator& operator=(const VulkanFrameAllocator&) = delete;
+
+	// Cấp phát một vùng nhớ `size` byte trong vùng của frame hiện tại.
+	// Offset trả về luôn được căn theo min{Uniform,Storage}BufferOffsetAlignment của thiết bị.
+	FrameAllocation Allocate(uint32_t currentFrame, VkDeviceSize size);
+
+	// Cấp phát và sao chép dữ liệu vào vùng nhớ vừa cấp phát. Trả về dynamic offset.
+	uint32_t Push(uint32_t currentFrame, const void* pSrcData, VkDeviceSize size);
+
+	// Thu hồi toàn bộ vùng nhớ của một frame.
+	// LƯU Ý: Chỉ gọi sau khi GPU đã thực thi xong frame này (VulkanSyncManager::WaitForFrame).
+	void Reset(uint32_t currentFrame);
+
+	// Flush phần dữ liệu đã ghi của frame (cần thiết khi bộ nhớ không phải HOST_COHERENT).
+	void Flush(uint32_t currentFrame);
+
+	// --- Getters ---
+	const VulkanBuffer* GetBuffer() const { return m_Buffer; }
+	VkDeviceSize GetFrameCapacity() const { return m_FrameCapacity; }
+
+private:
+	// --- Tham chiếu Vulkan ---
+	const VulkanHandles& m_VulkanHandles;
+
+	// --- Dữ liệu nội bộ ---
+	VulkanBuffer* m_Buffer = nullptr;
+	VkDeviceSize m_FrameCapacity = 0;	// Dung lượng mỗi vùng (đã căn chỉnh).
+	VkDeviceSize m_Alignment = 0;		// Căn chỉnh tối thiểu của dynamic offset.
+	std::vector<VkDeviceSize> m_Heads;	// Vị trí cấp phát tiếp theo (tương đối) trong vùng của từng frame.
+
+	// --- Hàm helper private ---
+	static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment);
+};
@@ -2,6 +2,7 @@
 #include "VulkanImage.h"
 #include "VulkanBuffer.h"
 #include "VulkanCommandManager.h"
+#include "VulkanBarrierBatch.h"
 
 VulkanImage::VulkanImage(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI, const VulkanImageViewCreateInfo& imageViewCI)
 	: m_VulkanHandles(vulkanHandles)
@@ -10,6 +11,13 @@ VulkanImage::VulkanImage(const VulkanHandles& vulkanHandles, const VulkanImageCr
 	CreateImageView(imageViewCI);
 }
 
+VulkanImage::VulkanImage(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI, const VulkanImageViewCreateInfo& imageViewCI, VmaAllocation aliasMemory)
+	: m_VulkanHandles(vulkanHandles)
+{
+	CreateAliasingImage(imageCI, aliasMemory);
+	CreateImageView(imageViewCI);
+}
+
 VulkanImage::VulkanImage(const VulkanHandles& vulkanHandles, const char* filePath, VkFormat imageFormat, bool createMipmaps)
 	: m_VulkanHandles(vulkanHandles)
 {
@@ -42,10 +50,12 @@ VulkanImage::~VulkanImage()
 	// Hủy VkImageView.
 	vkDestroyImageView(m_VulkanHandles.device, m_Handles.imageView, nullptr);
 	// Hủy VkImage và giải phóng bộ nhớ đã cấp phát bởi VMA.
+	// Với image aliasing, allocation là VK_NULL_HANDLE nên chỉ VkImage bị hủy, vùng nhớ chung được giữ nguyên.
 	vmaDestroyImage(m_VulkanHandles.allocator, m_Handles.image, m_Handles.allocation);
 }
 
-void VulkanImage::CreateImage(const VulkanImageCreateInfo& imageCI)
+VkImageCreateInfo VulkanImage::BuildImageCreateInfo(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI,
+	std::array<uint32_t, 2>& queueFamilyIndices)
 {
 	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -54,15 +64,48 @@ void VulkanImage::CreateImage(const VulkanImageCreateInfo& imageCI)
 	imageInfo.extent.height = imageCI.height;
 	imageInfo.extent.depth = 1;
 	imageInfo.mipLevels = imageCI.mipLevels;
-	imageInfo.arrayLayers = 1;
+	imageInfo.arrayLayers = imageCI.arrayLayers;
 	imageInfo.format = imageCI.format;
 	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	imageInfo.usage = imageCI.imageUsageFlags;
 	imageInfo.samples = imageCI.samples;
-	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	imageInfo.queueFamilyIndexCount = 1;
-	imageInfo.pQueueFamilyIndices = &m_VulkanHandles.queueFamilyIndices.GraphicQueueIndex;
+
+	queueFamilyIndices = { vulkanHandles.queueFamilyIndices.GraphicQueueIndex, vulkanHandles.queueFamilyIndices.ComputeQueueIndex };
+	if (imageCI.shareWithComputeQueue && vulkanHandles.HasAsyncCompute())
+	{
+		imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		imageInfo.queueFamilyIndexCount = 2;
+	}
+	else
+	{
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.queueFamilyIndexCount = 1;
+	}
+	imageInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+	return imageInfo;
+}
+
+VkMemoryRequirements VulkanImage::GetMemoryRequirements(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI)
+{
+	std::array<uint32_t, 2> queueFamilyIndices{};
+	VkImageCreateInfo imageInfo = BuildImageCreateInfo(vulkanHandles, imageCI, queueFamilyIndices);
+
+	VkDeviceImageMemoryRequirements requirementsInfo{};
+	requirementsInfo.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+	requirementsInfo.pCreateInfo = &imageInfo;
+
+	VkMemoryRequirements2 requirements{};
+	requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+	vkGetDeviceImageMemoryRequirements(vulkanHandles.device, &requirementsInfo, &requirements);
+
+	return requirements.memoryRequirements;
+}
+
+void VulkanImage::CreateImage(const VulkanImageCreateInfo& imageCI)
+{
+	std::array<uint32_t, 2> queueFamilyIndices{};
+	VkImageCreateInfo imageInfo = BuildImageCreateInfo(m_VulkanHandles, imageCI, queueFamilyIndices);
 
 	VmaAllocationCreateInfo allocInfo{};
 	allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY; // Image thường nằm trên bộ nhớ GPU để tối ưu hiệu suất.
@@ -72,18 +115,30 @@ void VulkanImage::CreateImage(const VulkanImageCreateInfo& imageCI)
 		"Lỗi: Không thể tạo Vulkan Image!");
 }
 
+void VulkanImage::CreateAliasingImage(const VulkanImageCreateInfo& imageCI, VmaAllocation aliasMemory)
+{
+	std::array<uint32_t, 2> queueFamilyIndices{};
+	VkImageCreateInfo imageInfo = BuildImageCreateInfo(m_VulkanHandles, imageCI, queueFamilyIndices);
+
+	// Image không sở hữu vùng nhớ, m_Handles.allocation giữ nguyên VK_NULL_HANDLE.
+	VK_CHECK(vmaCreateAliasingImage(m_VulkanHandles.allocator, aliasMemory, &imageInfo, &m_Handles.image),
+		"Lỗi: Không thể tạo Vulkan Image trên vùng nhớ aliasing!");
+}
+
 void VulkanImage::CreateImageView(const VulkanImageViewCreateInfo& imageViewCI)
 {
+	m_AspectFlags = imageViewCI.aspectFlags;
+
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewInfo.image = m_Handles.image;
-	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.viewType = imageViewCI.viewType;
 	viewInfo.format = imageViewCI.format;
 	viewInfo.subresourceRange.aspectMask = imageViewCI.aspectFlags;
 	viewInfo.subresourceRange.baseMipLevel = 0;
 	viewInfo.subresourceRange.levelCount = imageViewCI.mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
-	viewInfo.subresourceRange.layerCount = 1;
+	viewInfo.subresourceRange.layerCount = imageViewCI.layerCount;
 
 	VK_CHECK(vkCreateImageView(m_VulkanHandles.device, &viewInfo, nullptr, &m_Handles.imageView), "Lỗi: Tạo VkImageView thất bại!");
 }
@@ -148,14 +203,15 @@ VulkanBuffer* VulkanImage::UploadTextureData(VulkanCommandManager* cmdManager, V
 	m_Handles.textureInfo.pixels = nullptr;
 
 	// --- 2. Copy dữ liệu từ Staging Buffer sang Image ---
+	VulkanBarrierBatch barriers;
+	const uint32_t mipLevels = m_Handles.textureInfo.mipLevels;
 
-	// Chuyển đổi layout của image từ VK_IMAGE_LAYOUT_UNDEFINED sang VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-	// để image sẵn sàng nhận dữ liệu từ staging buffer.
-	TransitionLayout(cmdBuffer, m_Handles.image, m_Handles.textureInfo.mipLevels,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-		0, VK_ACCESS_TRANSFER_WRITE_BIT, 0, m_Handles.textureInfo.mipLevels
-	);
+	// Chuyển toàn bộ image sang VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL để nhận dữ liệu từ staging buffer
+	// (mip 0 được ghi bằng copy, các mip còn lại được ghi bằng blit khi tạo mipmap).
+	barriers.TransitionImage(this, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_PIPELINE_STAGE_2_COPY_BIT | (mipLevels > 1 ? VK_PIPELINE_STAGE_2_BLIT_BIT : VK_PIPELINE_STAGE_2_NONE),
+		VK_ACCESS_2_TRANSFER_WRITE_BIT, true);
+	barriers.Flush(cmdBuffer);
 
 	// Định nghĩa vùng dữ liệu cần sao chép.
 	VkBufferImageCopy region{};
@@ -174,19 +230,16 @@ VulkanBuffer* VulkanImage::UploadTextureData(VulkanCommandManager* cmdManager, V
 
 	// --- 3. Tạo Mipmaps (nếu có) ---
 	// Mipmap được tạo từ mip level 0. Sau khi copy, layout của mip 0 là TRANSFER_DST.
-	// Các mip level khác vẫn là UNDEFINED hoặc chưa được sử dụng.
-	if (m_Handles.textureInfo.mipLevels > 1)
+	if (mipLevels > 1)
 	{
-		GenerateMipmaps(cmdBuffer, m_Handles.image, m_Handles.textureInfo.width, m_Handles.textureInfo.height, m_Handles.textureInfo.mipLevels);
+		GenerateMipmaps(cmdBuffer, barriers, m_Handles.image, m_Handles.textureInfo.width, m_Handles.textureInfo.height, mipLevels);
 	}
 	else
 	{
 		// Nếu không có mipmap, chỉ cần chuyển layout sang SHADER_READ_ONLY_OPTIMAL để shader có thể đọc.
-		TransitionLayout(cmdBuffer, m_Handles.image, m_Handles.textureInfo.mipLevels,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT
-		);
+		barriers.TransitionImage(this, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+		barriers.Flush(cmdBuffer);
 	}
 
 	// QUAN TRỌNG: Staging buffer được trả về và phải được giải phóng bởi caller
@@ -194,56 +247,7 @@ VulkanBuffer* VulkanImage::UploadTextureData(VulkanCommandManager* cmdManager, V
 	return stagingBuffer;
 }
 
-void VulkanImage::TransitionLayout(
-	const VkCommandBuffer& cmdBuffer,const VkImage& image, uint32_t totalMipLevels,
-	VkImageLayout oldLayout, VkImageLayout newLayout,
-	VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage,
-	VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
-	uint32_t baseMipLevel, uint32_t levelCount)
-{
-	VkImageMemoryBarrier barrier{};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.oldLayout = oldLayout;
-	barrier.newLayout = newLayout;
-	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.image = image;
-	barrier.srcAccessMask = srcAccessMask;
-	barrier.dstAccessMask = dstAccessMask;
-
-	// Cấu hình subresourceRange dựa trên layout mới.
-	// Nếu là depth/stencil attachment, sử dụng VK_IMAGE_ASPECT_DEPTH_BIT.
-	// TODO: Cần kiểm tra định dạng có stencil component hay không để thêm VK_IMAGE_ASPECT_STENCIL_BIT.
-	if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL || oldLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-	{
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
-	}
-	else if(newLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL || oldLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
-	{
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-	}
-	else
-	{
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	}
-
-	barrier.subresourceRange.baseMipLevel = baseMipLevel;
-	// Nếu levelCount là 0, áp dụng cho tất cả các mip level còn lại từ baseMipLevel.
-	barrier.subresourceRange.levelCount = (levelCount == 0) ? (totalMipLevels - baseMipLevel) : levelCount;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
-
-	// Ghi lệnh pipeline barrier vào command buffer.
-	vkCmdPipelineBarrier(cmdBuffer,
-		srcStage, dstStage,
-		0, // dependencyFlags
-		0, nullptr, // memoryBarriers
-		0, nullptr, // bufferMemoryBarriers
-		1, &barrier // imageMemoryBarriers
-	);
-}
-
-void VulkanImage::GenerateMipmaps(VkCommandBuffer& cmdBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels)
+void VulkanImage::GenerateMipmaps(VkCommandBuffer& cmdBuffer, VulkanBarrierBatch& barriers, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels)
 {
 	// TODO: Đảm bảo physical device hỗ trợ blitting với linear filter.
 	// (Cần kiểm tra trong quá trình khởi tạo VulkanContext để đảm bảo tính tương thích).
@@ -255,13 +259,16 @@ void VulkanImage::GenerateMipmaps(VkCommandBuffer& cmdBuffer, VkImage image, uin
 	for (uint32_t i = 1; i < mipLevels; i++)
 	{
 		// Chuyển đổi layout của mip level (i-1) sang VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
-		// để nó có thể làm nguồn cho lệnh blit.
-		TransitionLayout(cmdBuffer, image, mipLevels,
+		// để nó có thể làm nguồn cho lệnh blit. Mip 0 được ghi bằng copy, các mip khác bằng blit.
+		barriers.AddImageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT,
 			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+			(i == 1) ? VK_PIPELINE_STAGE_2_COPY_BIT : VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_READ_BIT,
 			i - 1, 1);
 
+		// Một lệnh barrier cho cả mip (i-1) và barrier SHADER_READ của mip (i-2) từ vòng trước.
+		barriers.Flush(cmdBuffer);
+
 		// Thực hiện lệnh blit (sao chép và thay đổi kích thước) từ mip (i-1) sang mip (i).
 		VkImageBlit blit{};
 		blit.srcOffsets[0] = { 0, 0, 0 };
@@ -285,11 +292,12 @@ void VulkanImage::GenerateMipmaps(VkCommandBuffer& cmdBuffer, VkImage image, uin
 			VK_FILTER_LINEAR); // Sử dụng bộ lọc tuyến tính để làm mịn mipmap.
 
 		// Chuyển đổi layout của mip (i-1) sang VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-		// vì nó đã hoàn thành vai trò là nguồn và sẵn sàng cho shader đọc.
-		TransitionLayout(cmdBuffer, image, mipLevels,
+		// vì nó đã hoàn thành vai trò là nguồn. Mip (i-1) chỉ bị đọc nên không có access nào cần "make available".
+		// Barrier này chưa cần ngay, được gom với barrier của vòng lặp tiếp theo.
+		barriers.AddImageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT,
 			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_NONE,
+			VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
 			i - 1, 1);
 
 		// Cập nhật kích thước cho mip level tiếp theo.
@@ -299,9 +307,17 @@ void VulkanImage::GenerateMipmaps(VkCommandBuffer& cmdBuffer, VkImage image, uin
 
 	// Sau khi vòng lặp kết thúc, mip level cuối cùng (mipLevels - 1) vẫn đang ở
 	// VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL. Cần chuyển nó sang SHADER_READ_ONLY_OPTIMAL.
-	TransitionLayout(cmdBuffer, image, mipLevels,
+	barriers.AddImageBarrier(image, VK_IMAGE_ASPECT_COLOR_BIT,
 		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+		VK_PIPELINE_STAGE_2_BLIT_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
 		mipLevels - 1, 1);
+	barriers.Flush(cmdBuffer);
+
+	// Các barrier trên chỉ chuyển từng mip nên trạng thái theo dõi được cập nhật thủ công:
+	// toàn bộ image đã ở SHADER_READ_ONLY và lần ghi cuối (blit) đã hiển thị cho fragment shader.
+	m_State.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	m_State.writeStageMask = VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT;
+	m_State.writeAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	m_State.readStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
 }
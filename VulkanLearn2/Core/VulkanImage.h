@@ -1,9 +1,11 @@
 #pragma once
 #include "VulkanContext.h"
+#include <array>
 
 // Forward declarations
 class VulkanBuffer;
 class VulkanCommandManager;
+class VulkanBarrierBatch;
 
 // =================================================================================================
 // Struct: TextureInfo
@@ -47,10 +49,13 @@ struct VulkanImageCreateInfo
 	uint32_t width = 0;					// Chiều rộng của image.
 	uint32_t height = 0;					// Chiều cao của image.
 	uint32_t mipLevels = 1;				// Số lượng mipmap level.
+	uint32_t arrayLayers = 1;				// Số layer (> 1 cho texture array, ví dụ: shadow map của mọi đèn).
 	VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;	// Số lượng sample cho multisampling.
 	VkFormat format = VK_FORMAT_UNDEFINED;		// Định dạng pixel của image.
 	VkImageUsageFlags imageUsageFlags = 0;		// Cờ sử dụng của image (ví dụ: VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT).
 	VkMemoryPropertyFlags memoryFlags = 0;		// Cờ thuộc tính bộ nhớ (ví dụ: VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT).
+	bool shareWithComputeQueue = false;			// Dùng chung giữa graphics và compute queue (VK_SHARING_MODE_CONCURRENT),
+												// tránh phải chuyển quyền sở hữu queue family. Bỏ qua nếu hai queue cùng family.
 };
 
 // =================================================================================================
@@ -64,6 +69,21 @@ struct VulkanImageViewCreateInfo
 	VkFormat format = VK_FORMAT_UNDEFINED;		// Định dạng của image view.
 	VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_NONE;	// Các khía cạnh của image view (ví dụ: VK_IMAGE_ASPECT_COLOR_BIT).
 	uint32_t mipLevels = 1;				// Số lượng mipmap level mà view này có thể truy cập.
+	VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D;	// VK_IMAGE_VIEW_TYPE_2D_ARRAY để truy cập mọi layer của texture array.
+	uint32_t layerCount = 1;				// Số layer mà view này có thể truy cập.
+};
+
+// =================================================================================================
+// Struct: VulkanImageState
+// Mô tả: Trạng thái đồng bộ hiện tại của một image theo thứ tự ghi lệnh trên queue.
+//        Được VulkanBarrierBatch dùng làm phía src của barrier và để bỏ qua các lần chuyển thừa.
+// =================================================================================================
+struct VulkanImageState
+{
+	VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;				// Layout hiện tại.
+	VkPipelineStageFlags2 writeStageMask = VK_PIPELINE_STAGE_2_NONE;	// Stage của lần ghi gần nhất.
+	VkAccessFlags2 writeAccessMask = VK_ACCESS_2_NONE;				// Access của lần ghi gần nhất.
+	VkPipelineStageFlags2 readStageMask = VK_PIPELINE_STAGE_2_NONE;	// Các stage đã đọc (và đã thấy lần ghi gần nhất).
 };
 
 // =================================================================================================
@@ -72,7 +92,9 @@ struct VulkanImageViewCreateInfo
 //      Đóng gói và quản lý một VkImage cùng các tài nguyên liên quan (VkImageView, VmaAllocation).
 //      Cung cấp các phương thức để tạo và quản lý các loại image khác nhau
 //      như texture, depth buffer, color attachment, v.v.
-//      Hỗ trợ tải texture từ file, tạo mipmap và chuyển đổi layout image.
+//      Hỗ trợ tải texture từ file và tạo mipmap.
+//      Image tự theo dõi layout hiện tại (VulkanImageState), việc chuyển layout được thực hiện
+//      thông qua VulkanBarrierBatch.
 // =================================================================================================
 class VulkanImage
 {
@@ -84,6 +106,12 @@ public:
 	//      imageViewCI: Thông tin tạo VkImageView.
 	VulkanImage(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI, const VulkanImageViewCreateInfo& imageViewCI);
 
+	// Constructor: Tạo image trên một vùng nhớ có sẵn (aliasing), dùng cho các attachment tạm thời của RenderGraph.
+	// Image không sở hữu vùng nhớ: `aliasMemory` phải sống lâu hơn image và do bên gọi giải phóng.
+	// Tham số:
+	//      aliasMemory: Vùng nhớ đã được cấp phát, đủ lớn theo GetMemoryRequirements().
+	VulkanImage(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI, const VulkanImageViewCreateInfo& imageViewCI, VmaAllocation aliasMemory);
+
 	// Constructor: Để tải texture từ file.
 	// Tham số:
 	//      vulkanHandles: Tham chiếu đến các handle Vulkan chung của ứng dụng.
@@ -114,41 +142,38 @@ public:
 
 	// Getter: Lấy các handle và thông tin của image.
 	const VulkanImageHandles& GetHandles() const { return m_Handles; }
+	VkImageAspectFlags GetAspectFlags() const { return m_AspectFlags; }
 
-	// Phương thức Static: TransitionLayout
-	// Mô tả: Chuyển đổi layout của một image bằng pipeline barrier.
-	// Tham số:
-	//      cmdBuffer: Command buffer để ghi lệnh barrier.
-	//      image: VkImage cần chuyển đổi layout.
-	//      totalMipLevels: Tổng số mipmap level.
-	//      oldLayout: Layout hiện tại.
-	//      newLayout: Layout mong muốn.
-	//      srcStage, dstStage: Các giai đoạn pipeline nguồn/đích.
-	//      srcAccessMask, dstAccessMask: Các quyền truy cập nguồn/đích.
-	static void TransitionLayout(
-		const VkCommandBuffer& cmdBuffer,
-		const VkImage& image,
-		uint32_t totalMipLevels,
-		VkImageLayout oldLayout,
-		VkImageLayout newLayout,
-		VkPipelineStageFlags srcStage,
-		VkPipelineStageFlags dstStage,
-		VkAccessFlags srcAccessMask = 0,
-		VkAccessFlags dstAccessMask = 0,
-		uint32_t baseMipLevel = 0,
-		uint32_t levelCount = 0
-	);
+	// Trạng thái đồng bộ hiện tại, được cập nhật bởi VulkanBarrierBatch::TransitionImage().
+	// LƯU Ý: Image do RenderGraph quản lý không dùng trạng thái này (barrier được tính trước khi Compile).
+	VulkanImageState& GetState() { return m_State; }
+	const VulkanImageState& GetState() const { return m_State; }
+
+	// Phương thức Static: GetMemoryRequirements
+	// Mô tả: Truy vấn yêu cầu bộ nhớ của một image mà không cần tạo image (Vulkan 1.3).
+	//        Dùng để tính kích thước vùng nhớ chung trước khi tạo các image aliasing.
+	static VkMemoryRequirements GetMemoryRequirements(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI);
 
 private:
 	// --- Dữ liệu nội bộ ---
 	VulkanImageHandles m_Handles;			// Các handle và thông tin của image.
 	const VulkanHandles& m_VulkanHandles;	// Tham chiếu đến các handle Vulkan chung.
+	VkImageAspectFlags m_AspectFlags = VK_IMAGE_ASPECT_NONE;	// Aspect của image (lấy từ thông tin tạo view).
+	VulkanImageState m_State;				// Trạng thái đồng bộ hiện tại.
 
 	// --- Hàm khởi tạo và helper ---
 	
+	// Helper: Điền VkImageCreateInfo từ thông tin cung cấp (dùng chung cho mọi cách tạo image).
+	// `queueFamilyIndices`: Vùng chứa danh sách queue family mà kết quả trỏ tới, phải sống tới khi dùng xong kết quả.
+	static VkImageCreateInfo BuildImageCreateInfo(const VulkanHandles& vulkanHandles, const VulkanImageCreateInfo& imageCI,
+		std::array<uint32_t, 2>& queueFamilyIndices);
+
 	// Helper: Tạo một VkImage dựa trên thông tin cung cấp.
 	void CreateImage(const VulkanImageCreateInfo& imageCI);
 
+	// Helper: Tạo một VkImage và bind vào vùng nhớ có sẵn.
+	void CreateAliasingImage(const VulkanImageCreateInfo& imageCI, VmaAllocation aliasMemory);
+
 	// Helper: Tạo một VkImageView dựa trên thông tin cung cấp.
 	void CreateImageView(const VulkanImageViewCreateInfo& imageViewCI);
 
@@ -156,6 +181,6 @@ private:
 	void LoadImageDataFromFile(const char* filePath, bool createMipmaps);
 
 	// Helper: Tạo mipmap cho VkImage đã cho.
-	// Sử dụng lệnh vkCmdBlitImage để tạo các mipmap level.
-	void GenerateMipmaps(VkCommandBuffer& cmdBuffer, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels);
+	// Sử dụng lệnh vkCmdBlitImage để tạo các mipmap level, barrier của các mip được gom qua `barriers`.
+	void GenerateMipmaps(VkCommandBuffer& cmdBuffer, VulkanBarrierBatch& barriers, VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels);
 };
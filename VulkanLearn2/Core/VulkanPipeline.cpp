@@ -12,7 +12,7 @@ VulkanPipeline::VulkanPipeline(const VulkanPipelineCreateInfo* pipelineInfo)
 	VkShaderModule fragShaderModule = CreateShaderModule(pipelineInfo->fragmentShaderFilePath);
 
 	// Tạo Pipeline Layout, định nghĩa các descriptor set và push constant mà pipeline sẽ sử dụng.
-	CreatePipelineLayout(*pipelineInfo->descriptors, pipelineInfo->pushConstantDataSize);
+	CreatePipelineLayout(*pipelineInfo->descriptors, pipelineInfo->pushConstantDataSize, VK_SHADER_STAGE_VERTEX_BIT);
 
 	// Tạo Graphics Pipeline với tất cả các cấu hình cần thiết.
 	CreateGraphicsPipeline(pipelineInfo, vertShaderModule, fragShaderModule);
@@ -22,6 +22,27 @@ VulkanPipeline::VulkanPipeline(const VulkanPipelineCreateInfo* pipelineInfo)
 	vkDestroyShaderModule(m_VulkanHandles.device, vertShaderModule, nullptr);
 }
 
+VulkanPipeline::VulkanPipeline(const VulkanComputePipelineCreateInfo* pipelineInfo)
+	: m_VulkanHandles(*pipelineInfo->vulkanHandles)
+{
+	VkShaderModule compShaderModule = CreateShaderModule(pipelineInfo->computeShaderFilePath);
+
+	CreatePipelineLayout(*pipelineInfo->descriptors, pipelineInfo->pushConstantDataSize, VK_SHADER_STAGE_COMPUTE_BIT);
+
+	// Compute pipeline chỉ có một stage duy nhất.
+	VkComputePipelineCreateInfo computePipelineInfo{};
+	computePipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	computePipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	computePipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	computePipelineInfo.stage.module = compShaderModule;
+	computePipelineInfo.stage.pName = "main";
+	computePipelineInfo.layout = m_Handles.pipelineLayout;
+
+	VK_CHECK(vkCreateComputePipelines(m_VulkanHandles.device, VK_NULL_HANDLE, 1, &computePipelineInfo, nullptr, &m_Handles.pipeline), "LỖI: Tạo compute pipeline thất bại!");
+
+	vkDestroyShaderModule(m_VulkanHandles.device, compShaderModule, nullptr);
+}
+
 VulkanPipeline::~VulkanPipeline()
 {
 	// Hủy pipeline và layout của nó.
@@ -65,7 +86,7 @@ VkShaderModule VulkanPipeline::CreateShaderModule(const std::string& shaderFileP
 	return shaderModule;
 }
 
-void VulkanPipeline::CreatePipelineLayout(const std::vector<VulkanDescriptor*>& descriptors, VkDeviceSize pushConstantDataSize)
+void VulkanPipeline::CreatePipelineLayout(const std::vector<VulkanDescriptor*>& descriptors, VkDeviceSize pushConstantDataSize, VkShaderStageFlags pushConstantStages)
 {
 	// Sắp xếp các descriptor set layout theo chỉ số set (set index) để đảm bảo thứ tự đúng.
 	std::map<uint32_t, VkDescriptorSetLayout> sortedLayouts;
@@ -81,9 +102,9 @@ void VulkanPipeline::CreatePipelineLayout(const std::vector<VulkanDescriptor*>&
 		descSetLayouts.push_back(pair.second);
 	}
 
-	// Định nghĩa một dải push constant để truyền ma trận model vào vertex shader.
+	// Định nghĩa một dải push constant (ví dụ: truyền ma trận model vào vertex shader).
 	VkPushConstantRange pushConstantRange{};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.stageFlags = pushConstantStages;
 	pushConstantRange.offset = 0;
 	pushConstantRange.size = pushConstantDataSize;
 
@@ -92,7 +113,7 @@ void VulkanPipeline::CreatePipelineLayout(const std::vector<VulkanDescriptor*>&
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descSetLayouts.size()); 
 	pipelineLayoutInfo.pSetLayouts = descSetLayouts.data();
-	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pushConstantRangeCount = pushConstantDataSize > 0 ? 1 : 0;
 	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
 	VK_CHECK(vkCreatePipelineLayout(m_VulkanHandles.device, &pipelineLayoutInfo, nullptr, &m_Handles.pipelineLayout), "LỖI: Tạo pipeline layout thất bại!");
@@ -200,7 +221,7 @@ void VulkanPipeline::CreateGraphicsPipeline(
 	VkPipelineDepthStencilStateCreateInfo depthStencil{};
 	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencil.depthTestEnable = pipelineInfo->depthFormat != VK_FORMAT_UNDEFINED;
-	depthStencil.depthWriteEnable = pipelineInfo->depthFormat != VK_FORMAT_UNDEFINED;
+	depthStencil.depthWriteEnable = pipelineInfo->depthFormat != VK_FORMAT_UNDEFINED && pipelineInfo->depthWriteEnable;
 	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
 	depthStencil.depthBoundsTestEnable = VK_FALSE;
 	depthStencil.stencilTestEnable = pipelineInfo->stencilFormat != VK_FORMAT_UNDEFINED;
@@ -221,7 +242,7 @@ void VulkanPipeline::CreateGraphicsPipeline(
 
 
 	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	colorBlendAttachment.colorWriteMask = pipelineInfo->colorWriteMask;
 	colorBlendAttachment.blendEnable = VK_FALSE;
 
 	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
@@ -266,6 +287,7 @@ void VulkanPipeline::CreateGraphicsPipeline(
 	}
 	renderingCreatInfo.depthAttachmentFormat = pipelineInfo->depthFormat;
 	renderingCreatInfo.stencilAttachmentFormat = pipelineInfo->stencilFormat;
+	renderingCreatInfo.viewMask = pipelineInfo->viewMask;
 
 	// 11. Tổng hợp và tạo Graphics Pipeline
 	VkGraphicsPipelineCreateInfo graphicPipelineInfo{};
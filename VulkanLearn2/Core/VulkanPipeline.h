@@ -43,15 +43,32 @@ struct VulkanPipelineCreateInfo
 	VkFormat stencilFormat = VK_FORMAT_UNDEFINED;
 
 	bool enableDepthBias = false;
+	bool depthWriteEnable = true;		// false: chỉ test depth (ví dụ hộp bao của occlusion query).
+	VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 	VkCullModeFlags cullingMode = VK_CULL_MODE_BACK_BIT;
 	VkDeviceSize pushConstantDataSize = sizeof(PushConstantData);
+	uint32_t viewMask = 0;		// Multiview: phải trùng với VkRenderingInfo::viewMask khi vẽ (0: không dùng multiview).
+};
+
+// =================================================================================================
+// Struct: VulkanComputePipelineCreateInfo
+// Mô tả: Chứa thông tin cần thiết để khởi tạo một Compute Pipeline.
+// =================================================================================================
+struct VulkanComputePipelineCreateInfo
+{
+	const VulkanHandles* vulkanHandles;
+	std::vector<VulkanDescriptor*>* descriptors;
+
+	std::string computeShaderFilePath;
+
+	VkDeviceSize pushConstantDataSize = 0;	// 0: Không dùng push constant.
 };
 
 
 // =================================================================================================
 // Class: VulkanPipeline
 // Mô tả: 
-//      Quản lý việc tạo ra một Graphics Pipeline hoàn chỉnh.
+//      Quản lý việc tạo ra một Graphics Pipeline hoặc Compute Pipeline hoàn chỉnh.
 //      Bao gồm việc đọc shader, tạo pipeline layout và cấu hình tất cả các giai đoạn
 //      của pipeline (vertex input, rasterization, color blending, v.v.).
 // =================================================================================================
@@ -63,6 +80,11 @@ public:
 	//      pipelineInfo: Con trỏ đến struct chứa thông tin khởi tạo.
 	VulkanPipeline(const VulkanPipelineCreateInfo* pipelineInfo);
 
+	// Constructor: Khởi tạo Compute Pipeline.
+	// Tham số:
+	//      pipelineInfo: Con trỏ đến struct chứa thông tin khởi tạo.
+	VulkanPipeline(const VulkanComputePipelineCreateInfo* pipelineInfo);
+
 	// Destructor: Hủy pipeline và layout.
 	~VulkanPipeline();
 
@@ -85,7 +107,8 @@ private:
 	VkShaderModule CreateShaderModule(const std::string& shaderFilePath);
 
 	// Helper: Tạo pipeline layout từ danh sách các descriptor set layout.
-	void CreatePipelineLayout(const std::vector<VulkanDescriptor*>& descriptors, VkDeviceSize pushConstantDataSize);
+	// Push constant (nếu `pushConstantDataSize` > 0) được khai báo cho các stage `pushConstantStages`.
+	void CreatePipelineLayout(const std::vector<VulkanDescriptor*>& descriptors, VkDeviceSize pushConstantDataSize, VkShaderStageFlags pushConstantStages);
 
 	// Helper: Hàm chính để tạo Graphics Pipeline.
 	void CreateGraphicsPipeline(
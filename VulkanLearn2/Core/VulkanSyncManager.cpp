@@ -9,6 +9,9 @@ VulkanSyncManager::VulkanSyncManager(const VulkanHandles& vulkanHandles, int MAX
 
 VulkanSyncManager::~VulkanSyncManager()
 {
+	// Các tác vụ hủy còn sót lại (nếu có) phải chạy trước khi semaphore bị hủy.
+	FlushDeferredDestroys();
+
 	// Hủy tất cả các đối tượng đồng bộ hóa đã tạo.
 	for (VkSemaphore s : m_Handles.imageAvailableSemaphores)
 	{
@@ -20,18 +23,77 @@ VulkanSyncManager::~VulkanSyncManager()
 		vkDestroySemaphore(m_VulkanHandles.device, s, nullptr);
 	}
 
-	for (VkFence f : m_Handles.inFlightFences)
+	vkDestroySemaphore(m_VulkanHandles.device, m_Handles.timelineSemaphore, nullptr);
+	vkDestroySemaphore(m_VulkanHandles.device, m_Handles.computeTimelineSemaphore, nullptr);
+}
+
+uint64_t VulkanSyncManager::AcquireTimelineValue()
+{
+	return ++m_LastSubmittedValue;
+}
+
+uint64_t VulkanSyncManager::AcquireTimelineValue(QueueType queue)
+{
+	return queue == QueueType::Compute ? ++m_LastComputeSubmittedValue : AcquireTimelineValue();
+}
+
+uint64_t VulkanSyncManager::GetCompletedValue() const
+{
+	uint64_t value = 0;
+	VK_CHECK(vkGetSemaphoreCounterValue(m_VulkanHandles.device, m_Handles.timelineSemaphore, &value), "LỖI: Đọc giá trị timeline semaphore thất bại!");
+	return value;
+}
+
+void VulkanSyncManager::WaitForTimelineValue(uint64_t value, QueueType queue) const
+{
+	// Giá trị 0 là trạng thái khởi tạo, luôn được coi là đã hoàn thành.
+	if (value == 0) return;
+
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &getTimelineSemaphore(queue);
+	waitInfo.pValues = &value;
+
+	VK_CHECK(vkWaitSemaphores(m_VulkanHandles.device, &waitInfo, UINT64_MAX), "LỖI: Chờ timeline semaphore thất bại!");
+}
+
+void VulkanSyncManager::WaitForFrame(int currentFrame) const
+{
+	WaitForTimelineValue(m_FrameTimelineValues[currentFrame], m_FrameTimelineQueues[currentFrame]);
+}
+
+void VulkanSyncManager::DeferDestroy(std::function<void()>&& destroyFunc)
+{
+	// Tài nguyên có thể đang được dùng bởi bất kỳ lần submit nào đã cấp giá trị,
+	// do đó chỉ an toàn để hủy khi GPU vượt qua giá trị gần nhất.
+	m_DeferredDestroys.emplace_back(m_LastSubmittedValue, std::move(destroyFunc));
+}
+
+void VulkanSyncManager::CollectGarbage()
+{
+	if (m_DeferredDestroys.empty()) return;
+
+	const uint64_t completedValue = GetCompletedValue();
+
+	// Hàng đợi được sắp xếp theo giá trị tăng dần, dừng ở phần tử đầu tiên chưa hoàn thành.
+	while (!m_DeferredDestroys.empty() && m_DeferredDestroys.front().first <= completedValue)
 	{
-		vkDestroyFence(m_VulkanHandles.device, f, nullptr);
+		m_DeferredDestroys.front().second();
+		m_DeferredDestroys.pop_front();
 	}
 }
 
-const VkFence& VulkanSyncManager::getCurrentFence(int currentFrame) const 
+void VulkanSyncManager::FlushDeferredDestroys()
 {
-	return m_Handles.inFlightFences[currentFrame];
+	for (auto& [value, destroyFunc] : m_DeferredDestroys)
+	{
+		destroyFunc();
+	}
+	m_DeferredDestroys.clear();
 }
 
-const VkSemaphore& VulkanSyncManager::getCurrentImageAvailableSemaphore(int currentFrame) const 
+const VkSemaphore& VulkanSyncManager::getCurrentImageAvailableSemaphore(int currentFrame) const
 {
 	return m_Handles.imageAvailableSemaphores[currentFrame];
 }
@@ -44,22 +106,18 @@ const VkSemaphore& VulkanSyncManager::getCurrentRenderFinishedSemaphore(int imag
 void VulkanSyncManager::CreateSyncObjects(int MAX_FRAMES_IN_FLIGHT, int swapchainImageCount)
 {
 	// Cấp phát bộ nhớ cho các vector chứa handle.
-	m_Handles.inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
 	m_Handles.imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
 	m_Handles.renderFinishedSemaphores.resize(swapchainImageCount);
+	// Giá trị 0: chưa có lần submit nào, vòng lặp render đầu tiên sẽ không bị block.
+	m_FrameTimelineValues.resize(MAX_FRAMES_IN_FLIGHT, 0);
+	m_FrameTimelineQueues.resize(MAX_FRAMES_IN_FLIGHT, QueueType::Graphics);
 
 	VkSemaphoreCreateInfo semaphoreInfo{};
 	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	VkFenceCreateInfo fenceInfo{};
-	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	// Tạo fence ở trạng thái đã được báo hiệu (signaled) để vòng lặp render đầu tiên không bị block.
-	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-	// Tạo các đối tượng đồng bộ cho mỗi frame-in-flight.
+	// Tạo semaphore báo hiệu image sẵn sàng cho mỗi frame-in-flight.
 	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
 	{
-		VK_CHECK(vkCreateFence(m_VulkanHandles.device, &fenceInfo, nullptr, &m_Handles.inFlightFences[i]), "LỖI: Tạo in-flight fence thất bại!");
 		VK_CHECK(vkCreateSemaphore(m_VulkanHandles.device, &semaphoreInfo, nullptr, &m_Handles.imageAvailableSemaphores[i]), "LỖI: Tạo image available semaphore thất bại!");
 	}
 
@@ -69,4 +127,17 @@ void VulkanSyncManager::CreateSyncObjects(int MAX_FRAMES_IN_FLIGHT, int swapchai
 	{
 		VK_CHECK(vkCreateSemaphore(m_VulkanHandles.device, &semaphoreInfo, nullptr, &m_Handles.renderFinishedSemaphores[i]), "LỖI: Tạo render finished semaphore thất bại!");
 	}
-}
\ No newline at end of file
+
+	// Tạo timeline semaphore (Vulkan 1.2) với giá trị khởi đầu là 0.
+	VkSemaphoreTypeCreateInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	timelineInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo timelineSemaphoreInfo{};
+	timelineSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	timelineSemaphoreInfo.pNext = &timelineInfo;
+
+	VK_CHECK(vkCreateSemaphore(m_VulkanHandles.device, &timelineSemaphoreInfo, nullptr, &m_Handles.timelineSemaphore), "LỖI: Tạo timeline semaphore thất bại!");
+	VK_CHECK(vkCreateSemaphore(m_VulkanHandles.device, &timelineSemaphoreInfo, nullptr, &m_Handles.computeTimelineSemaphore), "LỖI: Tạo compute timeline semaphore thất bại!");
+}
@@ -1,12 +1,14 @@
 #pragma once
 #include "VulkanContext.h"
 #include <vector>
+#include <deque>
+#include <functional>
 
 
 // =================================================================================================
 // Struct: SyncManagerHandles
 // Mô tả: Chứa các handle cho các đối tượng đồng bộ hóa.
-//        Bao gồm Semaphores và Fences.
+//        Bao gồm binary semaphores (dùng cho swapchain) và timeline semaphore (đồng hồ frame).
 // =================================================================================================
 struct SyncManagerHandles
 {
@@ -14,15 +16,26 @@ struct SyncManagerHandles
 	std::vector<VkSemaphore> imageAvailableSemaphores;
 	// Semaphores để báo hiệu rằng việc render vào một image đã hoàn tất.
 	std::vector<VkSemaphore> renderFinishedSemaphores;
-	// Fences để đồng bộ hóa CPU-GPU, đảm bảo frame trước đã xong trước khi bắt đầu frame mới.
-	std::vector<VkFence> inFlightFences;
+	// Timeline semaphore: mỗi lần submit (render, upload, ...) báo hiệu một giá trị tăng dần.
+	// Thay thế cho mảng in-flight fences trong việc đồng bộ hóa CPU-GPU.
+	VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+	// Timeline riêng cho compute queue (async compute). Giá trị của một timeline phải tăng theo đúng thứ tự
+	// thực thi, hai queue chạy song song không thể báo hiệu chung một timeline.
+	VkSemaphore computeTimelineSemaphore = VK_NULL_HANDLE;
 };
 
 // =================================================================================================
 // Class: VulkanSyncManager
-// Mô tả: 
-//      Quản lý việc tạo và hủy các đối tượng đồng bộ hóa (semaphores và fences)
-//      cần thiết cho vòng lặp render.
+// Mô tả:
+//      Quản lý việc tạo và hủy các đối tượng đồng bộ hóa cần thiết cho vòng lặp render.
+//      Cung cấp một "đồng hồ" timeline duy nhất cho toàn bộ các lần submit lên GPU:
+//      - Mỗi lần submit lấy một giá trị mới qua AcquireTimelineValue() và báo hiệu giá trị đó.
+//      - CPU chờ một frame/upload cụ thể bằng WaitForTimelineValue().
+//      - Tài nguyên cần hủy được xếp hàng bằng DeferDestroy() và chỉ bị hủy khi GPU
+//        đã vượt qua giá trị timeline tại thời điểm xếp hàng (CollectGarbage()).
+//      Các lần submit lên compute queue dùng một timeline thứ hai (AcquireTimelineValue(QueueType::Compute)),
+//      việc chuyển giao giữa hai queue là chờ giá trị trên timeline của queue còn lại.
+//      LƯU Ý: Binary semaphores vẫn được giữ lại vì WSI (acquire/present) không hỗ trợ timeline.
 // =================================================================================================
 class VulkanSyncManager
 {
@@ -35,17 +48,73 @@ public:
 	VulkanSyncManager(const VulkanHandles& vulkanHandles, int MAX_FRAMES_IN_FLIGHT, int swapchainImageCount);
 	~VulkanSyncManager();
 
+	// --- Timeline ---
+
+	// Cấp một giá trị timeline mới cho lần submit sắp tới. Giá trị luôn tăng dần.
+	// LƯU Ý: Các lần submit trên cùng một queue phải báo hiệu theo đúng thứ tự giá trị được cấp.
+	uint64_t AcquireTimelineValue();
+
+	// Cấp một giá trị mới trên timeline của `queue` (graphics: timeline chung ở trên).
+	uint64_t AcquireTimelineValue(QueueType queue);
+
+	// Giá trị lớn nhất đã được cấp (tương ứng với lần submit gần nhất).
+	uint64_t GetLastSubmittedValue() const { return m_LastSubmittedValue; }
+
+	// Giá trị mà GPU đã hoàn thành (đọc trực tiếp từ timeline semaphore).
+	uint64_t GetCompletedValue() const;
+
+	// Block CPU cho đến khi timeline của `queue` đạt tới `value`. Trả về ngay nếu giá trị đã hoàn thành.
+	void WaitForTimelineValue(uint64_t value, QueueType queue = QueueType::Graphics) const;
+
+	// --- Frame-in-flight ---
+
+	// Chờ lần submit trước đó của frame này hoàn thành (thay cho vkWaitForFences).
+	void WaitForFrame(int currentFrame) const;
+
+	// Ghi nhận giá trị timeline mà lần submit hiện tại của frame sẽ báo hiệu (trên timeline của `queue`).
+	void SetFrameTimelineValue(int currentFrame, uint64_t value, QueueType queue = QueueType::Graphics)
+	{
+		m_FrameTimelineValues[currentFrame] = value;
+		m_FrameTimelineQueues[currentFrame] = queue;
+	}
+
+	// --- Upload ---
+
+	// Ghi nhận giá trị timeline của lần upload gần nhất.
+	// Lần submit render kế tiếp sẽ chờ (phía GPU) giá trị này trước khi đọc dữ liệu.
+	void SetLastUploadValue(uint64_t value) { m_LastUploadValue = std::max(m_LastUploadValue, value); }
+	uint64_t GetLastUploadValue() const { return m_LastUploadValue; }
+
+	// --- Deferred deletion ---
+
+	// Xếp hàng một tác vụ hủy tài nguyên. Tác vụ sẽ chạy khi GPU đã hoàn thành mọi lần submit
+	// đã được cấp giá trị tính đến thời điểm gọi hàm này.
+	void DeferDestroy(std::function<void()>&& destroyFunc);
+
+	// Thực thi các tác vụ hủy đã an toàn. Gọi mỗi frame sau khi đã chờ frame hiện tại.
+	void CollectGarbage();
+
+	// Thực thi toàn bộ tác vụ hủy còn lại.
+	// LƯU Ý: Chỉ gọi sau khi device đã idle (ví dụ: trước khi hủy các manager).
+	void FlushDeferredDestroys();
+
 	// --- Getters ---
-	
-	// Lấy fence cho frame hiện tại.
-	const VkFence& getCurrentFence(int currentFrame) const;
-	
+
+	// Lấy timeline semaphore dùng chung.
+	const VkSemaphore& getTimelineSemaphore() const { return m_Handles.timelineSemaphore; }
+
+	// Lấy timeline semaphore của `queue`.
+	const VkSemaphore& getTimelineSemaphore(QueueType queue) const
+	{
+		return queue == QueueType::Compute ? m_Handles.computeTimelineSemaphore : m_Handles.timelineSemaphore;
+	}
+
 	// Lấy semaphore báo hiệu image sẵn sàng cho frame hiện tại.
 	const VkSemaphore& getCurrentImageAvailableSemaphore(int currentFrame) const;
-	
+
 	// Lấy semaphore báo hiệu render hoàn tất cho image index tương ứng.
 	const VkSemaphore& getCurrentRenderFinishedSemaphore(int imageIndex) const;
-	
+
 private:
 	// --- Tham chiếu Vulkan ---
 	const VulkanHandles& m_VulkanHandles;
@@ -53,8 +122,17 @@ private:
 	// --- Dữ liệu nội bộ ---
 	SyncManagerHandles m_Handles;
 
+	uint64_t m_LastSubmittedValue = 0;					// Giá trị timeline đã cấp gần nhất.
+	uint64_t m_LastComputeSubmittedValue = 0;			// Giá trị đã cấp gần nhất trên timeline của compute queue.
+	uint64_t m_LastUploadValue = 0;						// Giá trị timeline của lần upload gần nhất.
+	std::vector<uint64_t> m_FrameTimelineValues;		// Giá trị timeline mà mỗi frame-in-flight đã báo hiệu lần cuối.
+	std::vector<QueueType> m_FrameTimelineQueues;		// Queue (timeline) của giá trị trên.
+
+	// Hàng đợi hủy tài nguyên, sắp xếp tăng dần theo giá trị timeline.
+	std::deque<std::pair<uint64_t, std::function<void()>>> m_DeferredDestroys;
+
 	// --- Hàm helper private ---
-	
+
 	// Helper: Tạo các đối tượng đồng bộ hóa.
 	void CreateSyncObjects(int MAX_FRAMES_IN_FLIGHT, int swapchainImageCount);
-};
\ No newline at end of file
+};
@@ -81,11 +81,82 @@ struct PushConstantData
 
 
 // =================================================================================================
-// Struct: ShadowMapPushConstantData
-// Mô tả: Dữ liệu push constant dùng riêng cho pass tạo shadow map.
+// Struct: GPUInstanceData
+// Mô tả: Dữ liệu của một instance (một mesh của một entity) trong instance buffer của GPUScene.
+//        Vertex shader đọc phần tử thứ gl_InstanceIndex, compute shader culling đọc bounding sphere
+//        và mesh range để sinh VkDrawIndexedIndirectCommand. Layout khớp với std430.
+//        Normal matrix được tính sẵn trên CPU (chỉ khi transform thay đổi), vertex shader không phải
+//        tính inverse 3x3 cho từng vertex. mat3 trong std430 gồm 3 cột vec4, nên dùng glm::mat3x4.
+//        shadowViewMask: bit i bật nếu instance đổ bóng vào shadow map (layer) thứ i, vertex shader của
+//        ShadowMapPass loại bỏ instance khỏi các view còn lại. GPU-driven: do GPUCullingPass ghi.
+//        visibilityIndex: vị trí của instance trong visibility buffer của GPUScene (chỉ số proxy), giữ kết quả
+//        occlusion culling giữa các frame dù thứ tự instance thay đổi.
+//        maxDrawDistanceSq, minScreenSizeSq, maxShadowDistanceSq: ngưỡng cull của proxy (xem RenderProxy), GPUCullingPass
+//        test cùng với frustum như FrustumCuller.
 // =================================================================================================
-struct ShadowMapPushConstantData
+struct GPUInstanceData
 {
-	alignas(16) glm::mat4 model;
-	alignas(16) glm::mat4 lightMatrix;
-};
\ No newline at end of file
+	glm::mat4 model;
+	glm::mat3x4 normalMatrix;
+	glm::vec4 boundingSphere;	// xyz: Tâm (world space), w: Bán kính (world space).
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t vertexOffset;
+	uint32_t materialIndex;
+	uint32_t shadowViewMask;
+	uint32_t visibilityIndex;
+	float maxDrawDistanceSq;
+	float minScreenSizeSq;
+	float maxShadowDistanceSq;
+	uint32_t padding[3];		// std430 làm tròn kích thước struct lên bội số của 16 byte.
+};
+
+// =================================================================================================
+// Struct: GPUViewData
+// Mô tả: Frustum của một view (camera, từng shadow map) trong view buffer của GPUScene (std430).
+// =================================================================================================
+struct GPUViewData
+{
+	glm::vec4 frustumPlanes[6];	// xyz: Pháp tuyến hướng vào trong, w: Khoảng cách.
+	glm::vec4 casterExtrusion;	// Chỉ dùng cho shadow view, xem ShadowCasterVolume::extrusion.
+	glm::mat4 viewProj;			// Chỉ dùng cho view camera: chiếu bounding sphere lên Hi-Z (occlusion culling).
+	glm::vec4 detailOrigin;		// Chỉ dùng cho view camera, xem FrustumCuller::BuildDetailOrigin.
+};
+
+// =================================================================================================
+// Struct: GPUCullPushConstantData
+// Mô tả: Dữ liệu push constant cho compute shader culling, một lần dispatch cho mỗi draw list.
+//        Instance được giữ lại nếu nằm trong frustum của ít nhất một view trong khoảng [firstView, firstView + viewCount).
+//        shadowCasterCulling != 0: các view là shadow view, instance chỉ được giữ lại cho view mà bóng của nó có thể
+//        rơi vào frustum camera (view CAMERA_VIEW), kết quả được ghi vào GPUInstanceData::shadowViewMask.
+//        occlusionPhase (chỉ cho view camera, xem GPUCullingPass):
+//          OCCLUSION_PHASE_NONE: chỉ cull theo frustum.
+//          OCCLUSION_PHASE_EARLY: chỉ giữ instance nhìn thấy ở frame trước (theo visibility buffer).
+//          OCCLUSION_PHASE_LATE: test với Hi-Z của frame hiện tại, ghi lại visibility buffer và chỉ giữ
+//                                instance vừa mới nhìn thấy (chưa được vẽ ở pha đầu).
+// =================================================================================================
+struct GPUCullPushConstantData
+{
+	uint32_t firstView;
+	uint32_t viewCount;
+	uint32_t drawListIndex;		// Vị trí bộ đếm và vùng lệnh vẽ của draw list trong buffer.
+	uint32_t instanceCount;
+	uint32_t maxDrawCount;		// Số lệnh vẽ tối đa của một draw list (khoảng cách giữa các vùng lệnh vẽ).
+	uint32_t shadowCasterCulling;
+	uint32_t occlusionPhase;
+
+	static constexpr uint32_t OCCLUSION_PHASE_NONE = 0;
+	static constexpr uint32_t OCCLUSION_PHASE_EARLY = 1;
+	static constexpr uint32_t OCCLUSION_PHASE_LATE = 2;
+};
+
+// =================================================================================================
+// Struct: OcclusionQueryPushConstantData
+// Mô tả: Dữ liệu push constant cho shader vẽ hộp bao của occlusion query (OcclusionQueryCuller).
+//        viewProj được push một lần cho mỗi command buffer, boundingSphere cho từng query.
+// =================================================================================================
+struct OcclusionQueryPushConstantData
+{
+	glm::mat4 viewProj;
+	glm::vec4 boundingSphere;	// xyz: Tâm (world space), w: Bán kính. Hộp bao là khối lập phương cạnh 2 * bán kính.
+};
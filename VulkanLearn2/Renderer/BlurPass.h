@@ -18,16 +18,13 @@ struct BlurPassCreateInfo
 {
 	const VulkanHandles* vulkanHandles;
 	const SwapchainHandles* vulkanSwapchainHandles;
-	VkSampleCountFlagBits MSAA_SAMPLES;
 
 	const std::vector<VulkanImage*>* inputTextures;	// Ảnh đầu vào cần được làm mờ.
 	const VulkanSampler* vulkanSampler;				// Sampler để đọc ảnh đầu vào.
 
-	std::string fragShaderFilePath;					// Đường dẫn đến fragment shader (ví dụ: blur_horizontal.frag).
-	std::string vertShaderFilePath;					// Đường dẫn đến vertex shader (thường là shader vẽ quad toàn màn hình).
+	std::string compShaderFilePath;					// Đường dẫn đến compute shader (ví dụ: BlurH_Shader.comp.spv).
 
-	VkClearColorValue BackgroundColor;
-	const std::vector<VulkanImage*>* outputImages;	// Ảnh đầu ra để ghi kết quả đã làm mờ.
+	const std::vector<VulkanImage*>* outputImages;	// Ảnh đầu ra để ghi kết quả đã làm mờ (cần VK_IMAGE_USAGE_STORAGE_BIT).
 };
 
 // =================================================================================================
@@ -36,7 +33,7 @@ struct BlurPassCreateInfo
 // =================================================================================================
 struct BlurPassHandles
 {
-	VulkanPipeline* pipeline;						// Pipeline đồ họa dành riêng cho pass này.
+	VulkanPipeline* pipeline;						// Compute pipeline dành riêng cho pass này.
 	std::vector<VulkanDescriptor*> descriptors;		// Danh sách các descriptor set (một cho mỗi frame-in-flight).
 };
 
@@ -44,10 +41,10 @@ struct BlurPassHandles
 // Class: BlurPass
 // Mô tả: 
 //      Thực hiện một bước làm mờ Gaussian (theo chiều ngang hoặc dọc) trên một ảnh đầu vào.
-//      Pass này vẽ một quad toàn màn hình và áp dụng shader làm mờ. Nó nhận một ảnh đầu vào,
-//      đọc từ nó bằng sampler, và ghi kết quả đã làm mờ vào một ảnh đầu ra.
+//      Pass này dispatch một compute shader trên toàn bộ ảnh: đọc ảnh đầu vào bằng sampler
+//      và ghi kết quả đã làm mờ vào ảnh đầu ra (storage image).
 //      Thường được sử dụng hai lần liên tiếp (một lần cho chiều ngang, một lần cho chiều dọc)
-//      để tạo hiệu ứng blur hoàn chỉnh.
+//      để tạo hiệu ứng blur hoàn chỉnh. Có thể chạy trên compute queue (async compute).
 // =================================================================================================
 class BlurPass : public IRenderPass
 {
@@ -56,38 +53,36 @@ public:
 	BlurPass(const BlurPassCreateInfo& blurInfo);
 	~BlurPass();
 
-	// Thực thi pass render.
+	// Thực thi pass.
 	void Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame) override;
 	
 	// Getter: Lấy các handle nội bộ.
 	const BlurPassHandles& GetHandles() const { return m_Handles; }
 
 private:
+	// Kích thước workgroup, phải khớp với local_size trong các shader blur.
+	static constexpr uint32_t WORKGROUP_SIZE = 8;
+
 	BlurPassHandles m_Handles;
 
 	// --- Tham chiếu đến các tài nguyên bên ngoài ---
 	const VulkanHandles* m_VulkanHandles;
 	VkExtent2D m_SwapchainExtent;
-	VkClearColorValue m_BackgroundColor;
 	
 	// --- Tài nguyên dành riêng cho pass ---
-	std::vector<VulkanDescriptor*> m_TextureDescriptors; // Descriptors cho ảnh đầu vào.
-	const std::vector<VulkanImage*>* m_OutputImages;     // Ảnh đầu ra.
+	std::vector<VulkanDescriptor*> m_TextureDescriptors; // Descriptors cho ảnh đầu vào (sampler) và ảnh đầu ra (storage image).
 
 	// --- Hàm khởi tạo ---
 	
 	// Helper: Tạo descriptor sets.
-	void CreateDescriptor(const std::vector<VulkanImage*>& inputTextures, const VulkanSampler* vulkanSampler);
+	void CreateDescriptor(const std::vector<VulkanImage*>& inputTextures, const std::vector<VulkanImage*>& outputImages, const VulkanSampler* vulkanSampler);
 	
-	// Helper: Tạo pipeline đồ họa.
+	// Helper: Tạo compute pipeline.
 	void CreatePipeline(const BlurPassCreateInfo& blurInfo);
 
 	// --- Hàm thực thi ---
 	
-	// Helper: Bind các descriptor set trước khi vẽ.
+	// Helper: Bind các descriptor set trước khi dispatch.
 	void BindDescriptors(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame);
-	
-	// Helper: Vẽ một hình chữ nhật full-screen để chạy fragment shader.
-	void DrawQuad(const VkCommandBuffer* cmdBuffer);
 };
 
@@ -18,16 +18,13 @@ struct BrightFilterPassCreateInfo
 	const VulkanHandles* vulkanHandles;
 	const SwapchainHandles* vulkanSwapchainHandles;
 	const VulkanSampler* vulkanSampler;
-	VkSampleCountFlagBits MSAA_SAMPLES;
 	uint32_t MAX_FRAMES_IN_FLIGHT;
 
 	const std::vector<VulkanImage*>* inputTextures; // Ảnh đầu vào (thường là ảnh scene đã render).
 
-	std::string fragShaderFilePath;
-	std::string vertShaderFilePath;
+	std::string compShaderFilePath;
 
-	VkClearColorValue BackgroundColor;
-	const std::vector<VulkanImage*>* outputImage;   // Ảnh đầu ra chỉ chứa các vùng sáng.
+	const std::vector<VulkanImage*>* outputImage;   // Ảnh đầu ra chỉ chứa các vùng sáng (cần VK_IMAGE_USAGE_STORAGE_BIT).
 };
 
 // =================================================================================================
@@ -47,6 +44,8 @@ struct BrightFilterPassHandles
 //      Đây là bước đầu tiên của hiệu ứng bloom. Pass này nhận ảnh đã render của scene,
 //      và tạo ra một ảnh mới chỉ chứa các pixel có độ sáng cao hơn một giá trị nhất định (threshold).
 //      Kết quả của pass này sẽ được dùng làm đầu vào cho các bước blur.
+//      Pass chạy bằng compute shader (ghi storage image) nên có thể được submit lên compute queue
+//      và chạy song song với các pass đồ họa của frame kế tiếp (async compute).
 // =================================================================================================
 class BrightFilterPass : public IRenderPass
 {
@@ -55,37 +54,35 @@ public:
 	BrightFilterPass(const BrightFilterPassCreateInfo& brightFilterInfo);
 	~BrightFilterPass();
 
-	// Thực thi pass render.
+	// Thực thi pass.
 	void Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame) override;
 	
 	// Getter: Lấy các handle nội bộ.
 	const BrightFilterPassHandles& GetHandles() const { return m_Handles; }
 
 private:
+	// Kích thước workgroup, phải khớp với local_size trong Bright_Shader.comp.
+	static constexpr uint32_t WORKGROUP_SIZE = 8;
+
 	BrightFilterPassHandles m_Handles;
 
 	// --- Tham chiếu đến các tài nguyên bên ngoài ---
 	const VulkanHandles* m_VulkanHandles;
 	VkExtent2D m_SwapchainExtent;
-	VkClearColorValue m_BackgroundColor;
 
 	// --- Tài nguyên dành riêng cho pass ---
-	std::vector<VulkanDescriptor*> m_TextureDescriptors; // Descriptors cho ảnh đầu vào.
-	const std::vector<VulkanImage*>* m_OutputImage;      // Ảnh đầu ra.
+	std::vector<VulkanDescriptor*> m_TextureDescriptors; // Descriptors cho ảnh đầu vào (sampler) và ảnh đầu ra (storage image).
 
 	// --- Hàm khởi tạo ---
 	
 	// Helper: Tạo descriptor sets.
-	void CreateDescriptor(const std::vector<VulkanImage*>& textureImages, const VulkanSampler* vulkanSampler);
+	void CreateDescriptor(const std::vector<VulkanImage*>& textureImages, const std::vector<VulkanImage*>& outputImages, const VulkanSampler* vulkanSampler);
 	
-	// Helper: Tạo pipeline đồ họa.
+	// Helper: Tạo compute pipeline.
 	void CreatePipeline(const BrightFilterPassCreateInfo& brightFilterInfo);
 
 	// --- Hàm thực thi ---
 	
-	// Helper: Bind các descriptor set trước khi vẽ.
+	// Helper: Bind các descriptor set trước khi dispatch.
 	void BindDescriptors(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame);
-	
-	// Helper: Vẽ một hình chữ nhật full-screen để chạy fragment shader.
-	void DrawQuad(VkCommandBuffer cmdBuffer);
 };
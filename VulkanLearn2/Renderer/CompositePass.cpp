@@ -12,8 +12,7 @@ CompositePass::CompositePass(const CompositePassCreateInfo& compositeInfo) :
 	m_VulkanHandles(compositeInfo.vulkanHandles),
 	m_VulkanSwapchainHandles(compositeInfo.vulkanSwapchainHandles),
 	m_SwapchainExtent(compositeInfo.vulkanSwapchainHandles->swapChainExtent),
-	m_BackgroundColor(compositeInfo.BackgroundColor),
-	m_MainColorImage(compositeInfo.mainColorImage)
+	m_BackgroundColor(compositeInfo.BackgroundColor)
 {
 	CreateDescriptor(*compositeInfo.inputTextures0, *compositeInfo.inputTextures1, compositeInfo.vulkanSampler);
 	CreatePipeline(compositeInfo);
@@ -26,24 +25,9 @@ CompositePass::~CompositePass()
 
 void CompositePass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame)
 {
-	// --- 1. Chuyển đổi Layout cho các Attachment ---
-	// Chuyển layout của attachment màu (MSAA) để có thể ghi vào.
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, m_MainColorImage->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-		0, 1);
-
-	// Chuyển layout của swapchain image để nó có thể nhận kết quả resolve từ attachment màu (MSAA).
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, m_VulkanSwapchainHandles->swapchainImages[imageIndex], 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-		0, 1);
-
-	// --- 2. Thiết lập và Bắt đầu Dynamic Rendering ---
+	// Swapchain image được RenderGraph chuyển sang COLOR_ATTACHMENT trước pass và sang PRESENT_SRC sau pass cuối.
+
+	// --- 1. Thiết lập và Bắt đầu Dynamic Rendering ---
 	// Cấu hình attachment màu, bao gồm cả việc resolve MSAA.
 	VkRenderingAttachmentInfo colorAttachment{};
 	colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
@@ -66,21 +50,12 @@ void CompositePass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageInde
 
 	vkCmdBeginRendering(*cmdBuffer, &renderingInfo);
 
-	// --- 3. Thực hiện Vẽ ---
+	// --- 2. Thực hiện Vẽ ---
 	vkCmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipeline);
 	BindDescriptors(cmdBuffer, currentFrame);
 	DrawQuad(cmdBuffer);
 
 	vkCmdEndRendering(*cmdBuffer);
-
-	// --- 4. Chuyển đổi Layout sau khi Render ---
-	// Chuyển layout của swapchain image sang PRESENT_SRC_KHR để sẵn sàng cho việc trình chiếu lên màn hình.
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, m_VulkanSwapchainHandles->swapchainImages[imageIndex], 1,
-		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0,
-		0, 1);
 }
 
 void CompositePass::CreateDescriptor(const std::vector<VulkanImage*>& inputTextures0, const std::vector<VulkanImage*>& inputTextures1, const VulkanSampler* vulkanSampler)
@@ -27,7 +27,6 @@ struct CompositePassCreateInfo
 	std::string vertShaderFilePath;
 
 	VkClearColorValue BackgroundColor;
-	VulkanImage* mainColorImage;       // Attachment màu (MSAA) để vẽ.
 };
 
 // =================================================================================================
@@ -45,8 +44,8 @@ struct CompositePassHandles
 // Mô tả: 
 //      Tổng hợp (composite) ảnh scene gốc và ảnh hiệu ứng (bloom) để tạo ra ảnh cuối cùng.
 //      Đây là bước cuối cùng trong chuỗi render. Pass này nhận hai ảnh đầu vào,
-//      cộng chúng lại với nhau trong fragment shader, và vẽ kết quả vào một attachment màu (MSAA).
-//      Sau đó, kết quả này được resolve vào swapchain image, sẵn sàng để được trình chiếu lên màn hình.
+//      cộng chúng lại với nhau trong fragment shader, và vẽ kết quả trực tiếp lên swapchain image,
+//      sẵn sàng để được trình chiếu lên màn hình.
 // =================================================================================================
 class CompositePass : public IRenderPass
 {
@@ -72,7 +71,6 @@ private:
 
 	// --- Tài nguyên dành riêng cho pass ---
 	std::vector<VulkanDescriptor*> m_TextureDescriptors; // Descriptors cho 2 ảnh đầu vào.
-	VulkanImage* m_MainColorImage;
 
 	// --- Hàm khởi tạo ---
 	
@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "DrawList.h"
+#include "RenderProxyManager.h"
+#include "FrustumCuller.h"
+#include <bit>
+
+uint64_t DrawSortKey::Make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float viewDepth)
+{
+	auto field = [](uint64_t value, uint32_t bits, uint32_t shift) { return (value & ((1ull << bits) - 1)) << shift; };
+
+	// Số thực không âm có thứ tự bit trùng với thứ tự giá trị, lấy các bit cao nhất làm depth.
+	// Đối tượng phía sau camera (depth âm) được xếp lên đầu như depth 0.
+	const uint32_t depthBits = std::bit_cast<uint32_t>(std::max(viewDepth, 0.0f)) >> (32 - DEPTH_BITS);
+
+	return field(pass, PASS_BITS, PASS_SHIFT)
+		| field(pipeline, PIPELINE_BITS, PIPELINE_SHIFT)
+		| field(material, MATERIAL_BITS, MATERIAL_SHIFT)
+		| field(mesh, MESH_BITS, MESH_SHIFT)
+		| field(depthBits, DEPTH_BITS, DEPTH_SHIFT);
+}
+
+void DrawList::Build(const RenderProxyManager& proxyManager, const glm::mat4& view, const FrustumCuller* culler)
+{
+	const std::vector<RenderProxy>& proxies = proxyManager.GetProxies();
+	const uint32_t itemCount = static_cast<uint32_t>(proxies.size());
+
+	// Giữ lại dung lượng đã cấp phát từ frame trước.
+	m_SortKeys.resize(itemCount);
+	m_SortIndices.resize(itemCount);
+	m_Batches.clear();
+	m_VisibleBatchCount = 0;
+
+	// --- 1. Tính sort key ---
+	// Chỉ hàng thứ 3 của ma trận view cần cho độ sâu (camera nhìn theo -Z).
+	// Có kết quả culling: mặc định item chỉ dùng cho shadow (hoặc bị loại nếu không đổ bóng vào đèn nào),
+	// các item nhìn thấy được chuyển về PASS_OPAQUE bên dưới.
+	const std::vector<uint32_t>* shadowViewMasks = culler ? &culler->GetShadowViewMasks() : nullptr;
+	const glm::vec4 depthRow = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+	for (uint32_t i = 0; i < itemCount; i++)
+	{
+		const RenderProxy& proxy = proxies[i];
+		const float viewDepth = glm::dot(depthRow, glm::vec4(glm::vec3(proxy.worldBoundingSphere), 1.0f));
+		const uint32_t pass = !culler ? PASS_OPAQUE : ((*shadowViewMasks)[i] != 0 ? PASS_SHADOW_ONLY : PASS_CULLED);
+
+		// Mỗi pass hiện chỉ có một pipeline, trường pipeline luôn là 0.
+		m_SortKeys[i] = DrawSortKey::Make(pass, 0, proxy.materialIndex, proxy.meshId, viewDepth);
+		m_SortIndices[i] = i;
+	}
+
+	if (culler)
+	{
+		constexpr uint64_t passMask = ((1ull << DrawSortKey::PASS_BITS) - 1) << DrawSortKey::PASS_SHIFT;
+		for (uint32_t proxyIndex : culler->GetVisibleProxies())
+		{
+			m_SortKeys[proxyIndex] = (m_SortKeys[proxyIndex] & ~passMask) | (uint64_t(PASS_OPAQUE) << DrawSortKey::PASS_SHIFT);
+		}
+	}
+
+	// --- 2. Sắp xếp theo sort key ---
+	RadixSort();
+
+	// --- 3. Sắp xếp lại và gom các item liên tiếp cùng mesh (và cùng pass) thành batch ---
+	// So sánh mesh thật sự (không dùng các bit của key) để việc gom luôn đúng kể cả khi trường mesh bị cắt bớt.
+	// Item PASS_CULLED nằm cuối danh sách sau khi sắp xếp, dừng tại item đầu tiên.
+	m_Items.clear();
+	m_ShadowViewMasks.clear();
+	m_ProxyIndices.clear();
+	uint32_t previousPass = PASS_OPAQUE;
+	for (uint32_t i = 0; i < itemCount; i++)
+	{
+		const uint32_t pass = static_cast<uint32_t>(m_SortKeys[i] >> DrawSortKey::PASS_SHIFT);
+		if (pass == PASS_CULLED) break;
+
+		const RenderProxy* proxy = &proxies[m_SortIndices[i]];
+		m_Items.push_back(proxy);
+		m_ShadowViewMasks.push_back(culler ? (*shadowViewMasks)[m_SortIndices[i]] : ~0u);
+		m_ProxyIndices.push_back(m_SortIndices[i]);
+
+		if (m_Batches.empty() || m_Batches.back().mesh != proxy->mesh || pass != previousPass)
+		{
+			m_Batches.push_back({ proxy->mesh, i, 0 });
+		}
+		m_Batches.back().instanceCount++;
+		previousPass = pass;
+
+		// Item nhìn thấy đứng trước mọi item chỉ dùng cho shadow.
+		if (pass == PASS_OPAQUE)
+		{
+			m_VisibleBatchCount = GetBatchCount();
+		}
+	}
+}
+
+uint32_t DrawList::GetJobCount(uint32_t batchCount, uint32_t threadCount) const
+{
+	if (batchCount == 0) return 0;
+
+	uint32_t jobCount = (batchCount + MIN_DRAWS_PER_JOB - 1) / MIN_DRAWS_PER_JOB;
+	return std::clamp(jobCount, 1u, std::max(threadCount, 1u));
+}
+
+void DrawList::GetJobRange(uint32_t batchCount, uint32_t jobCount, uint32_t jobIndex, uint32_t& first, uint32_t& end) const
+{
+	// Chia đều, phần dư được rải vào các đoạn đầu.
+	const uint64_t count = batchCount;
+	first = static_cast<uint32_t>(count * jobIndex / jobCount);
+	end = static_cast<uint32_t>(count * (jobIndex + 1) / jobCount);
+}
+
+void DrawList::RadixSort()
+{
+	constexpr uint32_t RADIX_BITS = 8;
+	constexpr uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+	constexpr uint32_t PASS_COUNT = 64 / RADIX_BITS;
+
+	const size_t count = m_SortKeys.size();
+	if (count < 2) return;
+
+	// Đếm histogram của cả 8 byte trong một lần duyệt.
+	uint32_t histograms[PASS_COUNT][RADIX_SIZE] = {};
+	for (uint64_t key : m_SortKeys)
+	{
+		for (uint32_t pass = 0; pass < PASS_COUNT; pass++)
+		{
+			histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+		}
+	}
+
+	m_TempKeys.resize(count);
+	m_TempIndices.resize(count);
+
+	for (uint32_t pass = 0; pass < PASS_COUNT; pass++)
+	{
+		uint32_t* histogram = histograms[pass];
+		const uint32_t shift = pass * RADIX_BITS;
+
+		// Mọi key có cùng byte này: lượt này không thay đổi thứ tự.
+		if (histogram[(m_SortKeys[0] >> shift) & (RADIX_SIZE - 1)] == count) continue;
+
+		// Prefix sum: vị trí bắt đầu của mỗi giá trị byte.
+		uint32_t offset = 0;
+		for (uint32_t bucket = 0; bucket < RADIX_SIZE; bucket++)
+		{
+			const uint32_t bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint32_t destination = histogram[(m_SortKeys[i] >> shift) & (RADIX_SIZE - 1)]++;
+			m_TempKeys[destination] = m_SortKeys[i];
+			m_TempIndices[destination] = m_SortIndices[i];
+		}
+
+		m_SortKeys.swap(m_TempKeys);
+		m_SortIndices.swap(m_TempIndices);
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <vector>
+
+// Forward declarations
+struct Mesh;
+struct RenderProxy;
+class RenderProxyManager;
+class FrustumCuller;
+
+// =================================================================================================
+// Struct: DrawBatch
+// Mô tả: Một lệnh vẽ instanced: `instanceCount` item liên tiếp (bắt đầu từ `firstInstance`)
+//        dùng chung một mesh. Chỉ số item cũng là chỉ số trong instance buffer của GPUScene,
+//        nên `firstInstance` được truyền thẳng vào vkCmdDrawIndexed.
+// =================================================================================================
+struct DrawBatch
+{
+	const Mesh* mesh;
+	uint32_t firstInstance;
+	uint32_t instanceCount;
+};
+
+// =================================================================================================
+// Struct: DrawSortKey
+// Mô tả: Bố cục sort key 64-bit của một item, từ bit cao tới bit thấp:
+//          [pass: 2][pipeline: 6][material: 12][mesh: 20][depth: 24]
+//        Sắp xếp tăng dần theo key gom các lệnh vẽ theo trạng thái (pass -> pipeline -> material -> mesh),
+//        trong cùng một mesh các instance được xếp từ gần tới xa (front-to-back) để tận dụng early-Z.
+//        Depth là các bit cao của số thực không âm (IEEE 754 giữ nguyên thứ tự khi so sánh như số nguyên),
+//        nên không cần biết trước near/far.
+// =================================================================================================
+struct DrawSortKey
+{
+	static constexpr uint32_t DEPTH_BITS = 24;
+	static constexpr uint32_t MESH_BITS = 20;
+	static constexpr uint32_t MATERIAL_BITS = 12;
+	static constexpr uint32_t PIPELINE_BITS = 6;
+	static constexpr uint32_t PASS_BITS = 2;
+
+	static constexpr uint32_t DEPTH_SHIFT = 0;
+	static constexpr uint32_t MESH_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+	static constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+	static constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+	static constexpr uint32_t PASS_SHIFT = PIPELINE_SHIFT + PIPELINE_BITS;
+
+	static_assert(PASS_SHIFT + PASS_BITS == 64, "DrawSortKey phải dùng đủ 64 bit.");
+
+	// Tạo key. Các trường vượt quá số bit bị cắt bớt: chỉ làm giảm chất lượng sắp xếp,
+	// việc gom batch vẫn đúng vì DrawList so sánh mesh thật sự.
+	static uint64_t Make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float viewDepth);
+};
+
+// =================================================================================================
+// Class: DrawList
+// Mô tả:
+//      Hàng đợi render của frame hiện tại, được xây dựng một lần trên luồng chính từ mảng
+//      RenderProxy liên tục của RenderProxyManager (không duyệt registry hay Model). Các pass
+//      (Geometry, ShadowMap) chỉ đọc danh sách này, nhờ đó có thể chia thành nhiều đoạn và ghi
+//      song song vào các secondary command buffer.
+//      Mỗi item (một proxy) có một DrawSortKey, danh sách được radix sort theo key mỗi frame. Các item liên tiếp
+//      dùng chung mesh tạo thành một DrawBatch (một lệnh vẽ instanced), nên một đám đông cùng một
+//      nhân vật chỉ tốn số lệnh vẽ bằng số mesh của model, và các lệnh vẽ được phát theo thứ tự trạng thái.
+//      Khi có kết quả culling (FrustumCuller), item nằm ngoài frustum camera nhưng còn đổ bóng vào ít nhất một
+//      shadow map được gán pass PASS_SHADOW_ONLY nên được xếp sau mọi item nhìn thấy, item không đóng góp gì
+//      bị loại khỏi danh sách: GeometryPass chỉ vẽ các batch [0, GetVisibleBatchCount()), ShadowMapPass vẽ
+//      toàn bộ batch và dùng shadow view mask của mỗi item để bỏ qua các đèn mà nó không đổ bóng vào.
+// =================================================================================================
+class DrawList
+{
+public:
+	// Pass của sort key.
+	static constexpr uint32_t PASS_OPAQUE = 0;		// Nhìn thấy từ camera, vẽ bởi GeometryPass và ShadowMapPass.
+	static constexpr uint32_t PASS_SHADOW_ONLY = 1;	// Nằm ngoài frustum camera, chỉ vẽ vào shadow map.
+	static constexpr uint32_t PASS_CULLED = 2;		// Không nhìn thấy và không đổ bóng, bị loại sau khi sắp xếp.
+
+	// Xây dựng lại danh sách từ các proxy hiện có, sắp xếp theo sort key.
+	// `view`: Ma trận view của camera chính, dùng để tính độ sâu front-to-back.
+	// `culler`: Kết quả Cull của frame (proxy nhìn thấy và shadow view mask), nullptr: mọi proxy đều nhìn thấy và đổ bóng vào mọi đèn.
+	void Build(const RenderProxyManager& proxyManager, const glm::mat4& view, const FrustumCuller* culler = nullptr);
+
+	// --- Getters ---
+	// Proxy đã được sắp xếp theo sort key (các item của cùng một batch nằm liên tiếp).
+	// Con trỏ trỏ vào mảng của RenderProxyManager, hợp lệ tới lần Sync kế tiếp.
+	const std::vector<const RenderProxy*>& GetItems() const { return m_Items; }
+	const std::vector<uint32_t>& GetShadowViewMasks() const { return m_ShadowViewMasks; } // Một mask mỗi item (bit i: layer shadow map i).
+	const std::vector<uint32_t>& GetProxyIndices() const { return m_ProxyIndices; } // Chỉ số proxy (trong RenderProxyManager) của mỗi item.
+	uint32_t GetCount() const { return static_cast<uint32_t>(m_Items.size()); }
+	const std::vector<DrawBatch>& GetBatches() const { return m_Batches; }
+	uint32_t GetBatchCount() const { return static_cast<uint32_t>(m_Batches.size()); }
+	uint32_t GetVisibleBatchCount() const { return m_VisibleBatchCount; } // Số batch đầu tiên nhìn thấy từ camera.
+
+	// Số đoạn (job) nên chia để ghi song song `batchCount` batch đầu tiên trên `threadCount` luồng.
+	// Mỗi đoạn có tối thiểu MIN_DRAWS_PER_JOB lệnh vẽ (batch) để chi phí tạo secondary buffer không lấn át lợi ích.
+	uint32_t GetJobCount(uint32_t batchCount, uint32_t threadCount) const;
+
+	// Khoảng batch [first, end) của đoạn thứ `jobIndex` khi chia `batchCount` batch đầu tiên thành `jobCount` đoạn.
+	void GetJobRange(uint32_t batchCount, uint32_t jobCount, uint32_t jobIndex, uint32_t& first, uint32_t& end) const;
+
+private:
+	// --- Cấu hình ---
+	static constexpr uint32_t MIN_DRAWS_PER_JOB = 64;
+
+	// --- Dữ liệu nội bộ ---
+	std::vector<const RenderProxy*> m_Items;
+	std::vector<uint32_t> m_ShadowViewMasks;
+	std::vector<uint32_t> m_ProxyIndices;
+	std::vector<DrawBatch> m_Batches;
+	uint32_t m_VisibleBatchCount = 0;
+
+	// Bộ nhớ tạm của Build, giữ lại giữa các frame để không phải cấp phát lại.
+	std::vector<uint64_t> m_SortKeys;
+	std::vector<uint32_t> m_SortIndices;
+	std::vector<uint64_t> m_TempKeys;
+	std::vector<uint32_t> m_TempIndices;
+
+	// --- Hàm helper private ---
+
+	// Helper: LSD radix sort (8 bit mỗi lượt) m_SortKeys kèm m_SortIndices, ổn định.
+	// Lượt nào mà mọi key có cùng giá trị byte thì được bỏ qua (thường gặp với pass/pipeline).
+	void RadixSort();
+};
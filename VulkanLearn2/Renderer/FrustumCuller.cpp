@@ -0,0 +1,351 @@
+#include "pch.h"
+#include "FrustumCuller.h"
+#include "RenderProxyManager.h"
+#include "Scene/LightData.h"
+#include "Scene/Component.h"
+#include "Scene/SceneBVH.h"
+#include "OcclusionCuller.h"
+#include "OcclusionQueryCuller.h"
+#include <bit>
+#include <limits>
+
+// Chọn tập lệnh SIMD theo cờ biên dịch (MSVC định nghĩa __AVX__ với /arch:AVX và /arch:AVX2).
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_SSE
+#endif
+
+std::array<glm::vec4, 6> FrustumCuller::ExtractFrustumPlanes(const glm::mat4& viewProj)
+{
+	// Phương pháp Gribb-Hartmann: mỗi mặt phẳng là tổ hợp các hàng của ma trận clip.
+	// GLM lưu theo cột nên hàng i là (m[0][i], m[1][i], m[2][i], m[3][i]).
+	auto row = [&](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+
+	std::array<glm::vec4, 6> planes = {
+		row(3) + row(0),	// Trái
+		row(3) - row(0),	// Phải
+		row(3) + row(1),	// Dưới
+		row(3) - row(1),	// Trên
+		row(2),				// Gần (depth [0, 1] - GLM_FORCE_DEPTH_ZERO_TO_ONE)
+		row(3) - row(2)		// Xa
+	};
+
+	// Chuẩn hóa để w là khoảng cách có dấu thật sự, so sánh trực tiếp được với bán kính.
+	for (glm::vec4& plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+
+	return planes;
+}
+
+ShadowCasterVolume FrustumCuller::BuildShadowCasterVolume(const GPULight& light)
+{
+	ShadowCasterVolume volume{};
+	volume.planes = ExtractFrustumPlanes(light.lightSpaceMatrix);
+
+	const LightType type = static_cast<LightType>(static_cast<int>(light.position.w));
+	if (type == LightType::Directional)
+	{
+		// Hai mặt gần/xa song song, tổng khoảng cách của chúng là độ sâu của frustum orthographic:
+		// bóng không thể kéo dài quá độ sâu này trong shadow map.
+		const float depthRange = volume.planes[4].w + volume.planes[5].w;
+		volume.extrusion = glm::vec4(glm::normalize(glm::vec3(light.direction)) * depthRange, 0.0f);
+
+		// Bỏ mặt gần: mọi điểm đều nằm phía trong.
+		volume.planes[4] = glm::vec4(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::max());
+	}
+	else
+	{
+		// w = 0 là dấu hiệu của đèn directional: range 0 (hoặc âm) được kẹp về một giá trị dương nhỏ.
+		volume.extrusion = glm::vec4(glm::vec3(light.position), std::max(MIN_SPOT_EXTRUSION_RANGE, light.direction.w));
+	}
+
+	return volume;
+}
+
+glm::vec4 FrustumCuller::BuildDetailOrigin(const glm::vec3& cameraPosition, const glm::mat4& cameraProj)
+{
+	// proj[1][1] = 1 / tan(fovY / 2) (đổi dấu khi lật trục Y cho Vulkan), bình phương nên không phụ thuộc dấu.
+	return glm::vec4(cameraPosition, cameraProj[1][1] * cameraProj[1][1]);
+}
+
+void FrustumCuller::Cull(const RenderProxyManager& proxyManager, const glm::mat4& cameraViewProj, const glm::vec4& detailOrigin, const std::vector<GPULight>& lights, const SceneBVH* sceneBVH)
+{
+	const std::array<glm::vec4, 6> cameraPlanes = ExtractFrustumPlanes(cameraViewProj);
+	const RenderProxyBounds& bounds = proxyManager.GetBounds();
+	const uint32_t count = proxyManager.GetProxyCount();
+
+	// --- 1. Frustum camera và ngưỡng khoảng cách/kích thước ---
+	CullSpheres(cameraPlanes, &detailOrigin, bounds, count, m_VisibleProxies);
+
+	// --- 2. Caster của từng shadow map ---
+	// Pha 1 (SceneBVH hoặc SIMD): sphere nằm trong caster volume của đèn. Pha 2 (vô hướng, chỉ trên các ứng viên):
+	// caster nằm trong khoảng cách đổ bóng và bóng của sphere có thể rơi vào frustum camera.
+	m_ShadowViewMasks.assign(count, 0);
+	for (const GPULight& light : lights)
+	{
+		// Chỉ đèn directional/spot có shadow map (giống LightManager::UpdateLightSpaceMatrices).
+		const LightType type = static_cast<LightType>(static_cast<int>(light.position.w));
+		if (light.params.z < 0 || type == LightType::Point) continue;
+
+		const ShadowCasterVolume volume = BuildShadowCasterVolume(light);
+		const uint32_t layerBit = 1u << static_cast<uint32_t>(light.params.z);
+
+		if (sceneBVH != nullptr)
+		{
+			QueryCasterCandidates(*sceneBVH, proxyManager, volume.planes);
+		}
+		else
+		{
+			CullSpheres(volume.planes, nullptr, bounds, count, m_CasterCandidates);
+		}
+		for (uint32_t proxyIndex : m_CasterCandidates)
+		{
+			const glm::vec3 center(bounds.centerX[proxyIndex], bounds.centerY[proxyIndex], bounds.centerZ[proxyIndex]);
+			const glm::vec3 toCamera = center - glm::vec3(detailOrigin);
+			if (glm::dot(toCamera, toCamera) > bounds.maxShadowDistanceSq[proxyIndex]) continue;
+
+			if (IsShadowVisible(cameraPlanes, center, bounds.radius[proxyIndex], volume.extrusion))
+			{
+				m_ShadowViewMasks[proxyIndex] |= layerBit;
+			}
+		}
+	}
+}
+
+void FrustumCuller::CullOccluded(const OcclusionCuller& occlusionCuller, const RenderProxyManager& proxyManager)
+{
+	occlusionCuller.CullOccluded(proxyManager.GetBounds(), m_VisibleProxies);
+}
+
+void FrustumCuller::CullOccluded(OcclusionQueryCuller& occlusionQueryCuller, const RenderProxyManager& proxyManager)
+{
+	occlusionQueryCuller.CullOccluded(proxyManager, m_VisibleProxies);
+}
+
+void FrustumCuller::CullSpheres(const std::array<glm::vec4, 6>& planes, const glm::vec4* detailOrigin, const RenderProxyBounds& bounds, uint32_t count, std::vector<uint32_t>& output)
+{
+	// Cấp phát trường hợp xấu nhất (mọi sphere đều nhìn thấy), cắt bớt sau khi ghi xong.
+	output.resize(count);
+
+	uint32_t processedEnd = 0;
+	uint32_t visibleCount = CullSpheresSimd(planes, detailOrigin, bounds, count, output.data(), processedEnd);
+	visibleCount += CullSpheresScalar(planes, detailOrigin, bounds, processedEnd, count, output.data() + visibleCount);
+
+	output.resize(visibleCount);
+}
+
+void FrustumCuller::QueryCasterCandidates(const SceneBVH& sceneBVH, const RenderProxyManager& proxyManager, const std::array<glm::vec4, 6>& planes)
+{
+	m_CasterEntities.clear();
+	sceneBVH.QueryFrustum(planes, SceneBVH::CATEGORY_RENDERABLE, m_CasterEntities);
+
+	// Cây chỉ biết AABB của cả entity, từng proxy của entity vẫn được test với volume.
+	const RenderProxyBounds& bounds = proxyManager.GetBounds();
+	m_CasterCandidates.clear();
+	for (entt::entity entity : m_CasterEntities)
+	{
+		const RenderProxyComponent* proxyRange = proxyManager.GetProxyRange(entity);
+		if (proxyRange == nullptr) continue;
+
+		const size_t offset = m_CasterCandidates.size();
+		m_CasterCandidates.resize(offset + proxyRange->proxyCount);
+		const uint32_t candidateCount = CullSpheresScalar(planes, nullptr, bounds, proxyRange->firstProxy, proxyRange->firstProxy + proxyRange->proxyCount, m_CasterCandidates.data() + offset);
+		m_CasterCandidates.resize(offset + candidateCount);
+	}
+}
+
+bool FrustumCuller::IsShadowVisible(const std::array<glm::vec4, 6>& cameraPlanes, const glm::vec3& center, float radius, const glm::vec4& extrusion)
+{
+	// Bóng là hình con nhộng: sphere quét từ tâm tới `shadowEnd`.
+	glm::vec3 shadowEnd;
+	if (extrusion.w == 0.0f)
+	{
+		shadowEnd = center + glm::vec3(extrusion);
+	}
+	else
+	{
+		// Đèn spot: bóng kéo dài theo tia từ đèn qua tâm, tới hết range của đèn.
+		const glm::vec3 toCaster = center - glm::vec3(extrusion);
+		const float distanceToLight = glm::length(toCaster);
+		shadowEnd = distanceToLight > 0.0f ? glm::vec3(extrusion) + toCaster * (extrusion.w / distanceToLight) : center;
+	}
+
+	// Loại bỏ khi cả hai đầu nằm hẳn phía ngoài cùng một mặt phẳng (cả đoạn thẳng cũng vậy).
+	for (const glm::vec4& plane : cameraPlanes)
+	{
+		const float startDistance = glm::dot(glm::vec3(plane), center) + plane.w;
+		const float endDistance = glm::dot(glm::vec3(plane), shadowEnd) + plane.w;
+		if (startDistance < -radius && endDistance < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t FrustumCuller::CullSpheresScalar(const std::array<glm::vec4, 6>& planes, const glm::vec4* detailOrigin, const RenderProxyBounds& bounds, uint32_t first, uint32_t end, uint32_t* output)
+{
+	uint32_t visibleCount = 0;
+	for (uint32_t i = first; i < end; i++)
+	{
+		bool visible = true;
+		for (const glm::vec4& plane : planes)
+		{
+			const float distance = plane.x * bounds.centerX[i] + plane.y * bounds.centerY[i] + plane.z * bounds.centerZ[i] + plane.w;
+			visible &= distance >= -bounds.radius[i];
+		}
+
+		if (detailOrigin != nullptr)
+		{
+			const float dx = bounds.centerX[i] - detailOrigin->x;
+			const float dy = bounds.centerY[i] - detailOrigin->y;
+			const float dz = bounds.centerZ[i] - detailOrigin->z;
+			const float distanceSq = dx * dx + dy * dy + dz * dz;
+			visible &= distanceSq <= bounds.maxDrawDistanceSq[i];
+			visible &= bounds.radius[i] * bounds.radius[i] * detailOrigin->w >= bounds.minScreenSizeSq[i] * distanceSq;
+		}
+
+		if (visible)
+		{
+			output[visibleCount++] = i;
+		}
+	}
+	return visibleCount;
+}
+
+uint32_t FrustumCuller::CullSpheresSimd(const std::array<glm::vec4, 6>& planes, const glm::vec4* detailOrigin, const RenderProxyBounds& bounds, uint32_t count, uint32_t* output, uint32_t& processedEnd)
+{
+	const float* centerX = bounds.centerX.data();
+	const float* centerY = bounds.centerY.data();
+	const float* centerZ = bounds.centerZ.data();
+	const float* radius = bounds.radius.data();
+	const float* maxDrawDistanceSq = bounds.maxDrawDistanceSq.data();
+	const float* minScreenSizeSq = bounds.minScreenSizeSq.data();
+
+	// Nhánh này giống nhau cho mọi vòng lặp nên không ảnh hưởng tới dự đoán rẽ nhánh.
+	const bool detailCulling = detailOrigin != nullptr;
+	const glm::vec4 origin = detailCulling ? *detailOrigin : glm::vec4(0.0f);
+
+	// Ghi chỉ số của các bit được bật trong `mask` (bit i ứng với sphere base + i).
+	auto emitVisible = [&](uint32_t mask, uint32_t base, uint32_t visibleCount)
+		{
+			while (mask != 0)
+			{
+				output[visibleCount++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+				mask &= mask - 1;
+			}
+			return visibleCount;
+		};
+
+	uint32_t visibleCount = 0;
+	const uint32_t simdEnd = count & ~7u;
+
+#if defined(FRUSTUM_CULLER_AVX)
+	// Mỗi thành phần của mặt phẳng được broadcast ra cả thanh ghi một lần cho toàn bộ vòng lặp.
+	__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = _mm256_set1_ps(planes[p].x);
+		planeY[p] = _mm256_set1_ps(planes[p].y);
+		planeZ[p] = _mm256_set1_ps(planes[p].z);
+		planeW[p] = _mm256_set1_ps(planes[p].w);
+	}
+	const __m256 originX = _mm256_set1_ps(origin.x);
+	const __m256 originY = _mm256_set1_ps(origin.y);
+	const __m256 originZ = _mm256_set1_ps(origin.z);
+	const __m256 screenScaleSq = _mm256_set1_ps(origin.w);
+
+	for (uint32_t i = 0; i < simdEnd; i += 8)
+	{
+		const __m256 x = _mm256_loadu_ps(centerX + i);
+		const __m256 y = _mm256_loadu_ps(centerY + i);
+		const __m256 z = _mm256_loadu_ps(centerZ + i);
+		const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+
+		// Nhìn thấy khi khoảng cách tới mọi mặt phẳng >= -radius.
+		__m256 inside = _mm256_cmp_ps(negRadius, negRadius, _CMP_EQ_OQ); // Toàn bit 1 (trừ radius NaN).
+		for (int p = 0; p < 6; p++)
+		{
+			const __m256 distance = _mm256_add_ps(
+				_mm256_add_ps(_mm256_mul_ps(planeX[p], x), _mm256_mul_ps(planeY[p], y)),
+				_mm256_add_ps(_mm256_mul_ps(planeZ[p], z), planeW[p]));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+		}
+
+		if (detailCulling)
+		{
+			const __m256 dx = _mm256_sub_ps(x, originX);
+			const __m256 dy = _mm256_sub_ps(y, originY);
+			const __m256 dz = _mm256_sub_ps(z, originZ);
+			const __m256 distanceSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+			const __m256 projectedSizeSq = _mm256_mul_ps(_mm256_mul_ps(negRadius, negRadius), screenScaleSq);
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distanceSq, _mm256_loadu_ps(maxDrawDistanceSq + i), _CMP_LE_OQ));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(projectedSizeSq, _mm256_mul_ps(_mm256_loadu_ps(minScreenSizeSq + i), distanceSq), _CMP_GE_OQ));
+		}
+
+		visibleCount = emitVisible(static_cast<uint32_t>(_mm256_movemask_ps(inside)), i, visibleCount);
+	}
+	processedEnd = simdEnd;
+#elif defined(FRUSTUM_CULLER_SSE)
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++)
+	{
+		planeX[p] = _mm_set1_ps(planes[p].x);
+		planeY[p] = _mm_set1_ps(planes[p].y);
+		planeZ[p] = _mm_set1_ps(planes[p].z);
+		planeW[p] = _mm_set1_ps(planes[p].w);
+	}
+	const __m128 originX = _mm_set1_ps(origin.x);
+	const __m128 originY = _mm_set1_ps(origin.y);
+	const __m128 originZ = _mm_set1_ps(origin.z);
+	const __m128 screenScaleSq = _mm_set1_ps(origin.w);
+
+	// Test 4 sphere bắt đầu từ `base`, trả về mask 4 bit.
+	auto testFour = [&](uint32_t base)
+		{
+			const __m128 x = _mm_loadu_ps(centerX + base);
+			const __m128 y = _mm_loadu_ps(centerY + base);
+			const __m128 z = _mm_loadu_ps(centerZ + base);
+			const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + base));
+
+			__m128 inside = _mm_cmpeq_ps(negRadius, negRadius); // Toàn bit 1 (trừ radius NaN).
+			for (int p = 0; p < 6; p++)
+			{
+				const __m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+					_mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+			}
+
+			if (detailCulling)
+			{
+				const __m128 dx = _mm_sub_ps(x, originX);
+				const __m128 dy = _mm_sub_ps(y, originY);
+				const __m128 dz = _mm_sub_ps(z, originZ);
+				const __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+				const __m128 projectedSizeSq = _mm_mul_ps(_mm_mul_ps(negRadius, negRadius), screenScaleSq);
+				inside = _mm_and_ps(inside, _mm_cmple_ps(distanceSq, _mm_loadu_ps(maxDrawDistanceSq + base)));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(projectedSizeSq, _mm_mul_ps(_mm_loadu_ps(minScreenSizeSq + base), distanceSq)));
+			}
+			return static_cast<uint32_t>(_mm_movemask_ps(inside));
+		};
+
+	// Hai nhóm 4 mỗi vòng lặp để hai chuỗi phép tính độc lập chạy xen kẽ.
+	for (uint32_t i = 0; i < simdEnd; i += 8)
+	{
+		const uint32_t mask = testFour(i) | (testFour(i + 4) << 4);
+		visibleCount = emitVisible(mask, i, visibleCount);
+	}
+	processedEnd = simdEnd;
+#else
+	// Không có SIMD: toàn bộ được xử lý bởi đường vô hướng.
+	processedEnd = 0;
+#endif
+
+	return visibleCount;
+}
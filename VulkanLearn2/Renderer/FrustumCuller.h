@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <array>
+
+// Forward declarations
+struct GPULight;
+struct RenderProxyBounds;
+class RenderProxyManager;
+class SceneBVH;
+class OcclusionCuller;
+class OcclusionQueryCuller;
+
+// =================================================================================================
+// Struct: ShadowCasterVolume
+// Mô tả: Vùng chứa các vật có thể đổ bóng vào shadow map của một đèn.
+//        - planes: Frustum của đèn. Với đèn directional mặt gần bị bỏ (kéo dài vô hạn về phía đèn),
+//          vì vật nằm giữa đèn và mặt gần vẫn đổ bóng vào vùng shadow map bao phủ.
+//        - extrusion: Cách bóng của một vật kéo dài ra, dùng để test bóng với frustum camera.
+//          w = 0 (directional): xyz là hướng ánh sáng nhân độ dài bóng.
+//          w > 0 (spot): xyz là vị trí đèn, w là range (bóng kéo dài tới hết range, range <= 0 được kẹp về số dương nhỏ).
+// =================================================================================================
+struct ShadowCasterVolume
+{
+	std::array<glm::vec4, 6> planes;
+	glm::vec4 extrusion;
+};
+
+// =================================================================================================
+// Class: FrustumCuller
+// Mô tả:
+//      Frustum culling trên CPU cho camera chính. Bounding sphere của các proxy được đọc từ bản
+//      structure-of-arrays của RenderProxyManager và test với 6 mặt phẳng frustum theo từng nhóm
+//      8 proxy bằng SIMD:
+//        - AVX (khi biên dịch với /arch:AVX hoặc /arch:AVX2): một thanh ghi 8 float.
+//        - SSE2 (mặc định trên x64): hai thanh ghi 4 float.
+//        - Vô hướng: cho phần dư và nền tảng không có SSE.
+//      Kết quả là danh sách liên tục chỉ số các proxy nhìn thấy được, DrawList dùng để tách
+//      các lệnh vẽ của GeometryPass khỏi các lệnh vẽ chỉ dùng cho shadow.
+//      Với mỗi đèn có shadow map, proxy chỉ được giữ lại làm caster nếu nằm trong ShadowCasterVolume của đèn
+//      (ứng viên lấy từ SceneBVH nếu có, nếu không thì quét toàn bộ bằng đường SIMD) và bóng của nó (bounding sphere quét theo hướng ánh sáng) có thể rơi vào frustum
+//      camera. Kết quả là một mask mỗi proxy (bit = layer shadow map), proxy có mask 0 không cần vẽ vào shadow.
+//      Ngưỡng cull của MeshComponent được test cùng lúc với frustum camera trên cùng dữ liệu SoA:
+//        - Khoảng cách: |tâm - camera|² > maxDrawDistanceSq thì bị loại.
+//        - Kích thước: đường kính chiếu lên màn hình (tỷ lệ chiều cao) xấp xỉ radius * proj[1][1] / khoảng cách,
+//          so sánh dạng bình phương để không cần phép chia và căn: radius² * proj[1][1]² < minScreenSizeSq * khoảng cách².
+//        - Caster xa camera hơn maxShadowDistanceSq không đổ bóng vào shadow map nào.
+// =================================================================================================
+class FrustumCuller
+{
+public:
+	// Tách 6 mặt phẳng frustum (đã chuẩn hóa, pháp tuyến hướng vào trong) từ ma trận view-projection (depth [0, 1]).
+	static std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& viewProj);
+
+	// Dựng ShadowCasterVolume của đèn directional/spot từ lightSpaceMatrix của nó.
+	static ShadowCasterVolume BuildShadowCasterVolume(const GPULight& light);
+
+	// Gốc của cull theo khoảng cách/kích thước: xyz là vị trí camera, w là proj[1][1]² (dùng chung với GPUCullingPass).
+	static glm::vec4 BuildDetailOrigin(const glm::vec3& cameraPosition, const glm::mat4& cameraProj);
+
+	// Cull mọi proxy của `proxyManager` với frustum camera `cameraViewProj` (kèm ngưỡng khoảng cách/kích thước
+	// theo `detailOrigin`, xem BuildDetailOrigin) và với caster volume của mọi đèn có shadow map trong `lights`.
+	// Kết quả hợp lệ tới lần Cull kế tiếp.
+	// `sceneBVH`: Nếu có, ứng viên caster của mỗi đèn được truy vấn từ cây thay vì test mọi proxy
+	// (volume của đèn thường chỉ chứa một phần nhỏ scene). Phải đã được Sync cùng frame với `proxyManager`.
+	void Cull(const RenderProxyManager& proxyManager, const glm::mat4& cameraViewProj, const glm::vec4& detailOrigin, const std::vector<GPULight>& lights, const SceneBVH* sceneBVH = nullptr);
+
+	// Loại khỏi danh sách proxy nhìn thấy các proxy bị occluder che khuất (gọi sau Cull).
+	// Proxy bị loại vẫn giữ shadow view mask: bóng của nó có thể rơi vào phần nhìn thấy được.
+	void CullOccluded(const OcclusionCuller& occlusionCuller, const RenderProxyManager& proxyManager);
+
+	// Như trên, theo kết quả occlusion query phần cứng của các frame trước (đồng thời lên lịch query của frame).
+	void CullOccluded(OcclusionQueryCuller& occlusionQueryCuller, const RenderProxyManager& proxyManager);
+
+	// --- Getters ---
+	const std::vector<uint32_t>& GetVisibleProxies() const { return m_VisibleProxies; }		// Chỉ số proxy tăng dần.
+	const std::vector<uint32_t>& GetShadowViewMasks() const { return m_ShadowViewMasks; }	// Một mask mỗi proxy, bit i: đổ bóng vào layer i.
+
+private:
+	// --- Cấu hình ---
+	static constexpr float MIN_SPOT_EXTRUSION_RANGE = 1e-3f;	// Range nhỏ nhất của spot trong extrusion (w = 0 dành cho directional).
+
+	// --- Dữ liệu nội bộ ---
+	std::vector<uint32_t> m_VisibleProxies;		// Giữ lại dung lượng giữa các frame.
+	std::vector<uint32_t> m_ShadowViewMasks;
+	std::vector<uint32_t> m_CasterCandidates;	// Bộ nhớ tạm: proxy nằm trong caster volume của đèn đang xét.
+	std::vector<entt::entity> m_CasterEntities;	// Bộ nhớ tạm: kết quả truy vấn SceneBVH.
+
+	// --- Hàm helper private ---
+
+	// Helper: Test các sphere [first, end) và ghi chỉ số sphere nhìn thấy vào `output`. Trả về số sphere đã ghi.
+	// `detailOrigin`: Nếu có, sphere cũng phải qua ngưỡng khoảng cách/kích thước của nó (chỉ dùng cho frustum camera).
+	static uint32_t CullSpheresScalar(const std::array<glm::vec4, 6>& planes, const glm::vec4* detailOrigin, const RenderProxyBounds& bounds, uint32_t first, uint32_t end, uint32_t* output);
+
+	// Helper: Như CullSpheresScalar nhưng xử lý 8 sphere mỗi vòng lặp bằng SIMD.
+	// Trả về số sphere đã ghi, `processedEnd` là vị trí đầu tiên chưa được xử lý (phần dư < 8).
+	static uint32_t CullSpheresSimd(const std::array<glm::vec4, 6>& planes, const glm::vec4* detailOrigin, const RenderProxyBounds& bounds, uint32_t count, uint32_t* output, uint32_t& processedEnd);
+
+	// Helper: Cull cả mảng bounds (SIMD + phần dư vô hướng), ghi kết quả vào `output` (được resize theo số sphere nhìn thấy).
+	static void CullSpheres(const std::array<glm::vec4, 6>& planes, const glm::vec4* detailOrigin, const RenderProxyBounds& bounds, uint32_t count, std::vector<uint32_t>& output);
+
+	// Helper: Ghi vào m_CasterCandidates các proxy nằm trong `planes`, lấy ứng viên từ các entity mà SceneBVH trả về.
+	void QueryCasterCandidates(const SceneBVH& sceneBVH, const RenderProxyManager& proxyManager, const std::array<glm::vec4, 6>& planes);
+
+	// Helper: Bóng của sphere (`center`, `radius`) quét theo `extrusion` có thể nằm trong frustum `cameraPlanes` không.
+	static bool IsShadowVisible(const std::array<glm::vec4, 6>& cameraPlanes, const glm::vec3& center, float radius, const glm::vec4& extrusion);
+};
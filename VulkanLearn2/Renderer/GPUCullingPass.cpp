@@ -0,0 +1,268 @@
+#include "pch.h"
+#include "GPUCullingPass.h"
+#include "GPUScene.h"
+#include "Core/VulkanPipeline.h"
+#include "Core/VulkanDescriptor.h"
+#include "Core/VulkanBuffer.h"
+#include "Core/VulkanImage.h"
+#include "Core/VulkanSampler.h"
+
+GPUCullingPass::GPUCullingPass(const GPUCullingPassCreateInfo& cullingInfo) :
+	m_VulkanHandles(cullingInfo.vulkanHandles),
+	m_GPUScene(cullingInfo.gpuScene),
+	m_OcclusionPhase(cullingInfo.occlusionPhase)
+{
+	CreateDescriptor(cullingInfo);
+	CreatePipeline(cullingInfo);
+}
+
+GPUCullingPass::~GPUCullingPass()
+{
+	delete(m_Handles.pipeline);
+}
+
+void GPUCullingPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame)
+{
+	if (m_OcclusionPhase == GPUCullPushConstantData::OCCLUSION_PHASE_LATE)
+	{
+		ExecuteLate(cmdBuffer, currentFrame);
+	}
+	else
+	{
+		ExecuteEarly(cmdBuffer, currentFrame);
+	}
+}
+
+void GPUCullingPass::ExecuteEarly(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame)
+{
+	const VkBuffer drawCommandBuffer = m_GPUScene->GetDrawCommandBuffer()->GetHandles().buffer;
+	const VkBuffer drawCountBuffer = m_GPUScene->GetDrawCountBuffer()->GetHandles().buffer;
+	const VkDeviceSize drawCountOffset = m_GPUScene->GetDrawCountOffset(currentFrame);
+	const VkDeviceSize drawCountSize = sizeof(uint32_t) * GPUScene::DRAW_LIST_COUNT;
+
+	// Lần đọc trước của các vùng buffer này (lệnh vẽ indirect của lần sử dụng trước của frame)
+	// đã hoàn tất nhờ VulkanSyncManager::WaitForFrame, không cần barrier WAR.
+
+	// --- 1. Reset bộ đếm lệnh vẽ của mọi draw list (kể cả draw list của pha sau) ---
+	vkCmdFillBuffer(*cmdBuffer, drawCountBuffer, drawCountOffset, drawCountSize, 0);
+
+	m_BarrierBatch.AddBufferBarrier(drawCountBuffer,
+		VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		drawCountOffset, drawCountSize);
+
+	// Visibility buffer được pha sau của frame trước ghi (cùng queue, submit trước đó).
+	m_BarrierBatch.AddBufferBarrier(m_GPUScene->GetVisibilityBuffer()->GetHandles().buffer,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+	m_BarrierBatch.Flush(*cmdBuffer);
+
+	// --- 2. Cull từng draw list ---
+	const uint32_t instanceCount = m_GPUScene->GetInstanceCount(currentFrame);
+	if (instanceCount > 0)
+	{
+		GPUCullPushConstantData pushConstantData{};
+		pushConstantData.instanceCount = instanceCount;
+		pushConstantData.maxDrawCount = m_GPUScene->GetMaxInstances();
+
+		// Camera: một view. Shadow: mọi shadow view trong một lần dispatch, instance có bóng đổ vào
+		// ít nhất một đèn chỉ sinh một lệnh vẽ, được vẽ vào mọi layer bằng multiview (shadowViewMask
+		// cho vertex shader biết các layer cần bỏ qua). Caster không bị cull theo occlusion của camera.
+		struct DrawListViews
+		{
+			uint32_t drawList;
+			uint32_t firstView;
+			uint32_t viewCount;
+			uint32_t shadowCasterCulling;
+			uint32_t occlusionPhase;
+		};
+		const std::array<DrawListViews, 2> drawLists = { {
+			{ GPUScene::DRAW_LIST_CAMERA, GPUScene::CAMERA_VIEW, 1, 0, GPUCullPushConstantData::OCCLUSION_PHASE_EARLY },
+			{ GPUScene::DRAW_LIST_SHADOW, GPUScene::GetShadowView(0), m_GPUScene->GetShadowViewCount(), 1, GPUCullPushConstantData::OCCLUSION_PHASE_NONE }
+		} };
+
+		for (const DrawListViews& drawList : drawLists)
+		{
+			if (drawList.viewCount == 0) continue;
+
+			pushConstantData.drawListIndex = drawList.drawList;
+			pushConstantData.firstView = drawList.firstView;
+			pushConstantData.viewCount = drawList.viewCount;
+			pushConstantData.shadowCasterCulling = drawList.shadowCasterCulling;
+			pushConstantData.occlusionPhase = drawList.occlusionPhase;
+			Dispatch(cmdBuffer, currentFrame, pushConstantData);
+		}
+	}
+
+	// --- 3. Lệnh vẽ và bộ đếm được đọc ở giai đoạn DRAW_INDIRECT của các pass phía sau, shadowViewMask ở vertex shader ---
+	// Pha sau đọc instance buffer trong compute shader.
+	m_BarrierBatch.AddBufferBarrier(m_GPUScene->GetInstanceBuffer()->GetHandles().buffer,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT,
+		m_GPUScene->GetInstanceOffset(currentFrame), m_GPUScene->GetInstanceRange());
+	m_BarrierBatch.AddBufferBarrier(drawCommandBuffer,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+		m_GPUScene->GetDrawCommandOffset(currentFrame), m_GPUScene->GetDrawCommandRange());
+	m_BarrierBatch.AddBufferBarrier(drawCountBuffer,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+		drawCountOffset, drawCountSize);
+	m_BarrierBatch.Flush(*cmdBuffer);
+}
+
+void GPUCullingPass::ExecuteLate(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame)
+{
+	// Depth pyramid đã được HiZPass chuyển sang trạng thái đọc, instance buffer và bộ đếm đã được pha đầu đồng bộ.
+
+	// --- 1. Visibility buffer: pha đầu vừa đọc, pha này ghi đè (WAR) ---
+	m_BarrierBatch.AddBufferBarrier(m_GPUScene->GetVisibilityBuffer()->GetHandles().buffer,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_NONE,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+	m_BarrierBatch.Flush(*cmdBuffer);
+
+	// --- 2. Cull view camera với Hi-Z ---
+	const uint32_t instanceCount = m_GPUScene->GetInstanceCount(currentFrame);
+	if (instanceCount > 0)
+	{
+		GPUCullPushConstantData pushConstantData{};
+		pushConstantData.instanceCount = instanceCount;
+		pushConstantData.maxDrawCount = m_GPUScene->GetMaxInstances();
+		pushConstantData.drawListIndex = GPUScene::DRAW_LIST_CAMERA_LATE;
+		pushConstantData.firstView = GPUScene::CAMERA_VIEW;
+		pushConstantData.viewCount = 1;
+		pushConstantData.shadowCasterCulling = 0;
+		pushConstantData.occlusionPhase = GPUCullPushConstantData::OCCLUSION_PHASE_LATE;
+		Dispatch(cmdBuffer, currentFrame, pushConstantData);
+	}
+
+	// --- 3. Lệnh vẽ của draw list late được GeometryPass thứ hai đọc ---
+	m_BarrierBatch.AddBufferBarrier(m_GPUScene->GetDrawCommandBuffer()->GetHandles().buffer,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+		m_GPUScene->GetDrawCommandOffset(currentFrame, GPUScene::DRAW_LIST_CAMERA_LATE), sizeof(VkDrawIndexedIndirectCommand) * m_GPUScene->GetMaxInstances());
+	m_BarrierBatch.AddBufferBarrier(m_GPUScene->GetDrawCountBuffer()->GetHandles().buffer,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,
+		m_GPUScene->GetDrawCountOffset(currentFrame, GPUScene::DRAW_LIST_CAMERA_LATE), sizeof(uint32_t));
+	m_BarrierBatch.Flush(*cmdBuffer);
+}
+
+void GPUCullingPass::Dispatch(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame, const GPUCullPushConstantData& pushConstantData)
+{
+	const VkPipelineLayout pipelineLayout = m_Handles.pipeline->getHandles().pipelineLayout;
+	vkCmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Handles.pipeline->getHandles().pipeline);
+
+	// Dynamic offset theo thứ tự binding: instance, draw command, draw count, view, visibility (dùng chung mọi frame).
+	std::array<uint32_t, 5> dynamicOffsets = {
+		m_GPUScene->GetInstanceOffset(currentFrame),
+		m_GPUScene->GetDrawCommandOffset(currentFrame),
+		m_GPUScene->GetDrawCountOffset(currentFrame),
+		m_GPUScene->GetViewOffset(currentFrame),
+		0
+	};
+	vkCmdBindDescriptorSets(
+		*cmdBuffer,
+		VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+		m_BufferDescriptor->getSetIndex(), 1,
+		&m_BufferDescriptor->getHandles().descriptorSet,
+		static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data()
+	);
+	vkCmdBindDescriptorSets(
+		*cmdBuffer,
+		VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+		m_HiZDescriptors[currentFrame]->getSetIndex(), 1,
+		&m_HiZDescriptors[currentFrame]->getHandles().descriptorSet,
+		0, nullptr
+	);
+
+	vkCmdPushConstants(*cmdBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GPUCullPushConstantData), &pushConstantData);
+
+	const uint32_t groupCount = (pushConstantData.instanceCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+	vkCmdDispatch(*cmdBuffer, groupCount, 1, 1);
+}
+
+void GPUCullingPass::CreateDescriptor(const GPUCullingPassCreateInfo& cullingInfo)
+{
+	// --- Set 0: Các binding đều là storage buffer dynamic ---
+	// Descriptor trỏ vào vùng của frame 0, vùng của frame hiện tại được chọn lúc bind bằng dynamic offset.
+	struct BufferBinding
+	{
+		const VulkanBuffer* buffer;
+		VkDeviceSize range;
+	};
+	std::array<BufferBinding, 5> bufferBindings = { {
+		{ m_GPUScene->GetInstanceBuffer(), m_GPUScene->GetInstanceRange() },			// Binding 0: Instance (ghi shadowViewMask).
+		{ m_GPUScene->GetDrawCommandBuffer(), m_GPUScene->GetDrawCommandRange() },	// Binding 1: Lệnh vẽ (ghi).
+		{ m_GPUScene->GetDrawCountBuffer(), m_GPUScene->GetDrawCountRange() },		// Binding 2: Bộ đếm lệnh vẽ (atomic).
+		{ m_GPUScene->GetViewBuffer(), m_GPUScene->GetViewRange() },				// Binding 3: Frustum của các view (chỉ đọc).
+		{ m_GPUScene->GetVisibilityBuffer(), m_GPUScene->GetVisibilityRange() }		// Binding 4: Kết quả occlusion của frame trước (đọc/ghi).
+	} };
+
+	std::array<BufferDescriptorUpdateInfo, 5> bufferUpdates{};
+	std::vector<BindingElementInfo> bindingElements(bufferBindings.size());
+	for (uint32_t binding = 0; binding < bufferBindings.size(); binding++)
+	{
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = bufferBindings[binding].buffer->GetHandles().buffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = bufferBindings[binding].range;
+
+		bufferUpdates[binding].binding = binding;
+		bufferUpdates[binding].firstArrayElement = 0;
+		bufferUpdates[binding].bufferInfos = { bufferInfo };
+
+		BindingElementInfo& element = bindingElements[binding];
+		element.binding = binding;
+		element.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		element.descriptorCount = 1;
+		element.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		element.bufferDescriptorUpdateInfoCount = 1;
+		element.pBufferDescriptorUpdates = &bufferUpdates[binding];
+	}
+
+	m_BufferDescriptor = new VulkanDescriptor(*m_VulkanHandles, bindingElements, 0); // Set 0
+	m_Handles.descriptors.push_back(m_BufferDescriptor);
+
+	// --- Set 1: Depth pyramid của mỗi frame ---
+	// Pha đầu không đọc pyramid nhưng dùng chung shader (và pipeline layout) nên vẫn bind.
+	m_HiZDescriptors.resize(cullingInfo.MAX_FRAMES_IN_FLIGHT);
+	for (uint32_t i = 0; i < cullingInfo.MAX_FRAMES_IN_FLIGHT; i++)
+	{
+		BindingElementInfo hiZBinding{};
+		hiZBinding.binding = 0;
+		hiZBinding.descriptorCount = 1;
+		hiZBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		hiZBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		// Pyramid luôn ở layout GENERAL (HiZPass ghi bằng imageStore), đọc bằng texelFetch.
+		VkDescriptorImageInfo hiZInfo{};
+		hiZInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		hiZInfo.imageView = (*cullingInfo.hiZImages)[i]->GetHandles().imageView;
+		hiZInfo.sampler = cullingInfo.vulkanSampler->getPostProcessSampler();
+
+		ImageDescriptorUpdateInfo hiZUpdateInfo{};
+		hiZUpdateInfo.binding = 0;
+		hiZUpdateInfo.firstArrayElement = 0;
+		hiZUpdateInfo.imageInfos = { hiZInfo };
+
+		hiZBinding.imageDescriptorUpdateInfoCount = 1;
+		hiZBinding.pImageDescriptorUpdates = &hiZUpdateInfo;
+
+		std::vector<BindingElementInfo> hiZBindingElements = { hiZBinding };
+
+		m_HiZDescriptors[i] = new VulkanDescriptor(*m_VulkanHandles, hiZBindingElements, 1); // Set 1
+		m_Handles.descriptors.push_back(m_HiZDescriptors[i]);
+	}
+}
+
+void GPUCullingPass::CreatePipeline(const GPUCullingPassCreateInfo& cullingInfo)
+{
+	VulkanComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.vulkanHandles = cullingInfo.vulkanHandles;
+	pipelineInfo.descriptors = &m_Handles.descriptors;
+	pipelineInfo.computeShaderFilePath = cullingInfo.compShaderFilePath;
+	pipelineInfo.pushConstantDataSize = sizeof(GPUCullPushConstantData);
+
+	m_Handles.pipeline = new VulkanPipeline(&pipelineInfo);
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "IRenderPass.h"
+#include "Core/VulkanBarrierBatch.h"
+
+// Forward declarations
+struct VulkanHandles;
+class VulkanPipeline;
+class VulkanDescriptor;
+class VulkanImage;
+class VulkanSampler;
+class GPUScene;
+
+// =================================================================================================
+// Struct: GPUCullingPassCreateInfo
+// Mô tả: Cấu trúc chứa tất cả thông tin cần thiết để khởi tạo một GPUCullingPass.
+// =================================================================================================
+struct GPUCullingPassCreateInfo
+{
+	const VulkanHandles* vulkanHandles;
+	const GPUScene* gpuScene;
+	uint32_t MAX_FRAMES_IN_FLIGHT;
+
+	// --- Occlusion culling hai pha ---
+	uint32_t occlusionPhase;								// GPUCullPushConstantData::OCCLUSION_PHASE_EARLY hoặc OCCLUSION_PHASE_LATE.
+	const std::vector<VulkanImage*>* hiZImages;				// Depth pyramid mỗi frame của HiZPass (chỉ pha sau đọc).
+	const VulkanSampler* vulkanSampler;
+
+	std::string compShaderFilePath;
+};
+
+// =================================================================================================
+// Struct: GPUCullingPassHandles
+// Mô tả: Chứa các handle nội bộ được quản lý bởi GPUCullingPass.
+// =================================================================================================
+struct GPUCullingPassHandles
+{
+	VulkanPipeline* pipeline;
+	std::vector<VulkanDescriptor*> descriptors;
+};
+
+// =================================================================================================
+// Class: GPUCullingPass
+// Mô tả:
+//      Frustum culling trên GPU. Với mỗi draw list của GPUScene (camera, shadow), compute shader kiểm tra
+//      bounding sphere của mọi instance với 6 mặt phẳng frustum của các view thuộc draw list và ghi
+//      VkDrawIndexedIndirectCommand cho các instance nhìn thấy được vào vùng lệnh vẽ của draw list,
+//      số lệnh vẽ được đếm bằng atomicAdd. Với draw list shadow, instance chỉ được giữ lại cho những đèn mà
+//      bóng của nó có thể rơi vào frustum camera (GPUInstanceData::shadowViewMask). GeometryPass và ShadowMapPass tiêu thụ kết quả bằng
+//      vkCmdDrawIndexedIndirectCount, nên chi phí ghi lệnh trên CPU không phụ thuộc số entity.
+//      View camera được cull theo occlusion hai pha, mỗi pha là một instance của pass:
+//        - Pha đầu (trước GeometryPass): reset bộ đếm, draw list camera chỉ giữ instance nhìn thấy ở frame trước
+//          (visibility buffer của GPUScene), cull draw list shadow.
+//        - Pha sau (sau HiZPass, trước GeometryPass thứ hai): test mọi instance trong frustum với Hi-Z dựng từ depth
+//          của pha đầu, ghi lại visibility buffer cho frame sau và đưa instance vừa lộ ra vào DRAW_LIST_CAMERA_LATE.
+//      Instance bị che hoàn toàn không sinh lệnh vẽ nào, fragment shader của G-buffer chỉ chạy cho đối tượng
+//      thật sự đóng góp pixel.
+//      Pass chỉ ghi buffer (không có image trong RenderGraph) nên tự ghi buffer barrier của mình
+//      và phải được đánh dấu MarkSideEffects để không bị cull.
+// =================================================================================================
+class GPUCullingPass : public IRenderPass
+{
+public:
+	// Constructor: Khởi tạo GPUCullingPass với các thông tin cấu hình.
+	GPUCullingPass(const GPUCullingPassCreateInfo& cullingInfo);
+	~GPUCullingPass();
+
+	// Thực thi pass.
+	void Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame) override;
+
+	// Getter: Lấy các handle nội bộ.
+	const GPUCullingPassHandles& GetHandles() const { return m_Handles; }
+
+private:
+	// Kích thước workgroup, phải khớp với local_size trong Cull_Shader.comp.
+	static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+	GPUCullingPassHandles m_Handles;
+
+	// --- Tham chiếu đến các tài nguyên bên ngoài ---
+	const VulkanHandles* m_VulkanHandles;
+	const GPUScene* m_GPUScene;
+
+	// --- Tài nguyên dành riêng cho pass ---
+	VulkanDescriptor* m_BufferDescriptor;	// Instance, draw command, draw count, view và visibility buffer (Set 0), chọn frame bằng dynamic offset.
+	std::vector<VulkanDescriptor*> m_HiZDescriptors;	// Depth pyramid của mỗi frame (Set 1).
+	uint32_t m_OcclusionPhase;
+	VulkanBarrierBatch m_BarrierBatch;		// Tái sử dụng mỗi frame, tránh cấp phát lại.
+
+	// --- Hàm khởi tạo ---
+
+	// Helper: Tạo descriptor set.
+	void CreateDescriptor(const GPUCullingPassCreateInfo& cullingInfo);
+
+	// Helper: Pha đầu, reset bộ đếm và cull draw list camera (instance nhìn thấy ở frame trước) và shadow.
+	void ExecuteEarly(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame);
+
+	// Helper: Pha sau, cull draw list camera late với Hi-Z.
+	void ExecuteLate(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame);
+
+	// Helper: Bind pipeline, descriptor set và dispatch cho một draw list.
+	void Dispatch(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame, const GPUCullPushConstantData& pushConstantData);
+
+	// Helper: Tạo compute pipeline.
+	void CreatePipeline(const GPUCullingPassCreateInfo& cullingInfo);
+};
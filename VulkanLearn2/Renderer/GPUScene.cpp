@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "GPUScene.h"
+#include "DrawList.h"
+#include "RenderProxyManager.h"
+#include "FrustumCuller.h"
+#include "Core/VulkanBuffer.h"
+#include <limits>
+
+GPUScene::GPUScene(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, uint32_t maxInstances, uint32_t shadowViewCount, uint32_t maxFramesInFlight) :
+	m_VulkanHandles(vulkanHandles),
+	m_MaxInstances(maxInstances),
+	m_ViewCount(1 + shadowViewCount)
+{
+	// Điểm bắt đầu vùng của mỗi frame được dùng làm dynamic offset của storage buffer.
+	VkPhysicalDeviceProperties deviceProperties{};
+	vkGetPhysicalDeviceProperties(m_VulkanHandles.physicalDevice, &deviceProperties);
+	const VkDeviceSize alignment = deviceProperties.limits.minStorageBufferOffsetAlignment;
+
+	m_InstanceRegionSize = AlignUp(sizeof(GPUInstanceData) * m_MaxInstances, alignment);
+	m_ViewRegionSize = AlignUp(sizeof(GPUViewData) * m_ViewCount, alignment);
+	m_DrawCommandRegionSize = AlignUp(sizeof(VkDrawIndexedIndirectCommand) * m_MaxInstances * DRAW_LIST_COUNT, alignment);
+	m_DrawCountRegionSize = AlignUp(sizeof(uint32_t) * DRAW_LIST_COUNT, alignment);
+
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	bufferInfo.queueFamilyIndexCount = 1;
+	bufferInfo.pQueueFamilyIndices = &m_VulkanHandles.queueFamilyIndices.GraphicQueueIndex;
+
+	// Instance buffer: CPU ghi mỗi frame, vertex shader và compute shader đọc.
+	bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+	bufferInfo.size = m_InstanceRegionSize * maxFramesInFlight;
+	m_InstanceBuffer = new VulkanBuffer(m_VulkanHandles, commandManager, bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+	// View buffer: CPU ghi frustum mỗi frame, compute shader đọc.
+	bufferInfo.size = m_ViewRegionSize * maxFramesInFlight;
+	m_ViewBuffer = new VulkanBuffer(m_VulkanHandles, commandManager, bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU);
+
+	// Visibility buffer: chỉ compute shader đọc/ghi. Nội dung ban đầu (hoặc sau khi chỉ số proxy thay đổi)
+	// không ảnh hưởng tới kết quả: instance bị đoán sai chỉ được vẽ ở pha sau thay vì pha đầu, hoặc ngược lại.
+	bufferInfo.size = GetVisibilityRange();
+	m_VisibilityBuffer = new VulkanBuffer(m_VulkanHandles, commandManager, bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY);
+
+	// Draw command / draw count buffer: compute shader ghi, lệnh vẽ indirect đọc.
+	bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+	bufferInfo.size = m_DrawCommandRegionSize * maxFramesInFlight;
+	m_DrawCommandBuffer = new VulkanBuffer(m_VulkanHandles, commandManager, bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY);
+
+	bufferInfo.size = m_DrawCountRegionSize * maxFramesInFlight;
+	m_DrawCountBuffer = new VulkanBuffer(m_VulkanHandles, commandManager, bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY);
+
+	m_InstanceCounts.resize(maxFramesInFlight, 0);
+}
+
+GPUScene::~GPUScene()
+{
+	delete(m_InstanceBuffer);
+	delete(m_ViewBuffer);
+	delete(m_VisibilityBuffer);
+	delete(m_DrawCommandBuffer);
+	delete(m_DrawCountBuffer);
+}
+
+void GPUScene::Upload(uint32_t currentFrame, const DrawList& drawList)
+{
+	const std::vector<const RenderProxy*>& drawItems = drawList.GetItems();
+	const std::vector<uint32_t>& shadowViewMasks = drawList.GetShadowViewMasks();
+	const std::vector<uint32_t>& proxyIndices = drawList.GetProxyIndices();
+	if (drawItems.size() > m_MaxInstances)
+	{
+		throw std::runtime_error("LỖI: GPUScene: Số lệnh vẽ (" + std::to_string(drawItems.size()) + ") vượt quá số instance tối đa (" + std::to_string(m_MaxInstances) + ")!");
+	}
+
+	// Ghi thẳng vào vùng nhớ đã map của frame, không cần buffer trung gian.
+	GPUInstanceData* instances = reinterpret_cast<GPUInstanceData*>(
+		reinterpret_cast<char*>(m_InstanceBuffer->GetHandles().pMappedData) + GetInstanceOffset(currentFrame));
+
+	for (size_t i = 0; i < drawItems.size(); i++)
+	{
+		const RenderProxy& proxy = *drawItems[i];
+
+		GPUInstanceData& instance = instances[i];
+		instance.model = proxy.model;
+		instance.normalMatrix = proxy.normalMatrix;
+		instance.boundingSphere = proxy.worldBoundingSphere;
+		instance.firstIndex = proxy.firstIndex;
+		instance.indexCount = proxy.indexCount;
+		instance.vertexOffset = proxy.vertexOffset;
+		instance.materialIndex = proxy.materialIndex;
+		instance.shadowViewMask = shadowViewMasks[i];
+		instance.visibilityIndex = proxyIndices[i];
+		instance.maxDrawDistanceSq = proxy.maxDrawDistanceSq;
+		instance.minScreenSizeSq = proxy.minScreenSizeSq;
+		instance.maxShadowDistanceSq = proxy.maxShadowDistanceSq;
+	}
+
+	m_InstanceCounts[currentFrame] = static_cast<uint32_t>(drawItems.size());
+
+	// vmaFlushAllocation là no-op nếu bộ nhớ đã là HOST_COHERENT.
+	if (!drawItems.empty())
+	{
+		vmaFlushAllocation(m_VulkanHandles.allocator, m_InstanceBuffer->GetHandles().allocation, GetInstanceOffset(currentFrame), sizeof(GPUInstanceData) * drawItems.size());
+	}
+
+	// Frustum rỗng: mặt phẳng có khoảng cách -max, mọi bounding sphere đều nằm ngoài.
+	GPUViewData emptyView{};
+	for (glm::vec4& plane : emptyView.frustumPlanes)
+	{
+		plane = glm::vec4(0.0f, 0.0f, 0.0f, -std::numeric_limits<float>::max());
+	}
+
+	GPUViewData* views = GetMappedViews(currentFrame);
+	std::fill(views, views + m_ViewCount, emptyView);
+	vmaFlushAllocation(m_VulkanHandles.allocator, m_ViewBuffer->GetHandles().allocation, GetViewOffset(currentFrame), sizeof(GPUViewData) * m_ViewCount);
+}
+
+void GPUScene::SetView(uint32_t currentFrame, uint32_t view, const glm::mat4& viewProj, const glm::vec4& detailOrigin)
+{
+	SetView(currentFrame, view, FrustumCuller::ExtractFrustumPlanes(viewProj), glm::vec4(0.0f));
+
+	GPUViewData& viewData = GetMappedViews(currentFrame)[view];
+	viewData.viewProj = viewProj;
+	viewData.detailOrigin = detailOrigin;
+	const VkDeviceSize viewOffset = GetViewOffset(currentFrame) + sizeof(GPUViewData) * view;
+	vmaFlushAllocation(m_VulkanHandles.allocator, m_ViewBuffer->GetHandles().allocation, viewOffset, sizeof(GPUViewData));
+}
+
+void GPUScene::SetView(uint32_t currentFrame, uint32_t view, const std::array<glm::vec4, 6>& frustumPlanes, const glm::vec4& casterExtrusion)
+{
+	if (view >= m_ViewCount)
+	{
+		throw std::runtime_error("LỖI: GPUScene: View " + std::to_string(view) + " vượt quá số view tối đa!");
+	}
+
+	GPUViewData& viewData = GetMappedViews(currentFrame)[view];
+	std::copy(frustumPlanes.begin(), frustumPlanes.end(), viewData.frustumPlanes);
+	viewData.casterExtrusion = casterExtrusion;
+
+	const VkDeviceSize viewOffset = GetViewOffset(currentFrame) + sizeof(GPUViewData) * view;
+	vmaFlushAllocation(m_VulkanHandles.allocator, m_ViewBuffer->GetHandles().allocation, viewOffset, sizeof(GPUViewData));
+}
+
+VkDeviceSize GPUScene::GetDrawCommandOffset(uint32_t currentFrame, uint32_t drawList) const
+{
+	return GetDrawCommandOffset(currentFrame) + sizeof(VkDrawIndexedIndirectCommand) * m_MaxInstances * drawList;
+}
+
+VkDeviceSize GPUScene::GetDrawCountOffset(uint32_t currentFrame, uint32_t drawList) const
+{
+	return GetDrawCountOffset(currentFrame) + sizeof(uint32_t) * drawList;
+}
+
+GPUViewData* GPUScene::GetMappedViews(uint32_t currentFrame) const
+{
+	return reinterpret_cast<GPUViewData*>(
+		reinterpret_cast<char*>(m_ViewBuffer->GetHandles().pMappedData) + GetViewOffset(currentFrame));
+}
+
+VkDeviceSize GPUScene::AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	if (alignment == 0) return value;
+	return (value + alignment - 1) & ~(alignment - 1);
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "Core/VulkanContext.h"
+#include <vector>
+#include <array>
+
+// Forward declarations
+class VulkanBuffer;
+class VulkanCommandManager;
+class DrawList;
+
+// =================================================================================================
+// Class: GPUScene
+// Mô tả:
+//      Biểu diễn scene trên GPU cho GPU-driven rendering:
+//        - Instance buffer: một GPUInstanceData (ma trận model, bounding sphere, mesh range, material)
+//          cho mỗi item (RenderProxy) của DrawList, cùng thứ tự. CPU ghi trực tiếp (buffer được map).
+//        - View buffer: frustum của mỗi view, CPU ghi trực tiếp. View 0 là camera chính, view 1 + i là
+//          shadow map (layer) thứ i của LightManager (kèm hướng đổ bóng để cull caster theo camera).
+//        - Draw command buffer: mỗi draw list có một vùng VkDrawIndexedIndirectCommand, do compute shader
+//          culling (GPUCullingPass) sinh ra. Draw list camera chứa instance nằm trong frustum camera,
+//          draw list shadow chứa instance nằm trong frustum của ít nhất một shadow view và được vẽ
+//          một lần cho mọi layer bằng multiview. Khi bật occlusion culling hai pha, draw list camera chỉ chứa
+//          instance nhìn thấy ở frame trước, draw list camera late chứa instance vừa mới lộ ra sau khi test Hi-Z.
+//        - Visibility buffer: một uint32_t cho mỗi proxy (GPUInstanceData::visibilityIndex), kết quả occlusion
+//          culling của frame trước. Không chia theo frame: frame sau đọc kết quả của frame trước trên cùng queue.
+//        - Draw count buffer: số lệnh vẽ của mỗi draw list, dùng cho vkCmdDrawIndexedIndirectCount.
+//      Mỗi buffer được chia thành các vùng bằng nhau cho từng frame-in-flight, bind qua dynamic offset
+//      (giống VulkanFrameAllocator). Vertex shader luôn đọc instance qua gl_InstanceIndex, nên cả đường
+//      ghi lệnh vẽ trên CPU lẫn đường GPU-driven dùng chung shader và instance buffer.
+// =================================================================================================
+class GPUScene
+{
+public:
+	static constexpr uint32_t CAMERA_VIEW = 0;
+
+	// Chỉ số view của shadow map thứ `shadowIndex`.
+	static uint32_t GetShadowView(uint32_t shadowIndex) { return CAMERA_VIEW + 1 + shadowIndex; }
+
+	static constexpr uint32_t DRAW_LIST_CAMERA = 0;		// Lệnh vẽ của view camera (GeometryPass).
+	static constexpr uint32_t DRAW_LIST_SHADOW = 1;		// Lệnh vẽ chung của mọi shadow view (ShadowMapPass).
+	static constexpr uint32_t DRAW_LIST_CAMERA_LATE = 2;	// Lệnh vẽ pha sau của occlusion culling (GeometryPass thứ hai).
+	static constexpr uint32_t DRAW_LIST_COUNT = 3;
+
+	// Constructor: Tạo instance buffer, view buffer, visibility buffer, draw command buffer và draw count buffer.
+	// Tham số:
+	//      maxInstances: Số instance tối đa mỗi frame (cũng là số lệnh vẽ tối đa của một draw list).
+	//      shadowViewCount: Số shadow map (mỗi shadow map là một view).
+	//      maxFramesInFlight: Số lượng frame được xử lý song song tối đa.
+	GPUScene(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, uint32_t maxInstances, uint32_t shadowViewCount, uint32_t maxFramesInFlight);
+	~GPUScene();
+
+	// Cấm sao chép.
+	GPUScene(const GPUScene&) = delete;
+	GPUScene& operator=(const GPUScene&) = delete;
+
+	// Ghi dữ liệu instance của frame từ DrawList (instance thứ i ứng với item thứ i) và bỏ mọi view đã khai báo
+	// (view chưa khai báo có frustum rỗng, không giữ lại instance nào).
+	// LƯU Ý: Chỉ gọi sau khi GPU đã thực thi xong lần sử dụng trước của frame này (VulkanSyncManager::WaitForFrame).
+	void Upload(uint32_t currentFrame, const DrawList& drawList);
+
+	// Khai báo view cần cull trong frame (gọi sau Upload). View không được khai báo sẽ không có lệnh vẽ nào.
+	// `viewProj` cũng được giữ lại để chiếu bounding sphere lên Hi-Z, `detailOrigin` dùng cho ngưỡng
+	// khoảng cách/kích thước của instance (view camera, xem FrustumCuller::BuildDetailOrigin).
+	void SetView(uint32_t currentFrame, uint32_t view, const glm::mat4& viewProj, const glm::vec4& detailOrigin);
+
+	// Như trên với mặt phẳng cho sẵn, dùng cho shadow view (ShadowCasterVolume của FrustumCuller).
+	void SetView(uint32_t currentFrame, uint32_t view, const std::array<glm::vec4, 6>& frustumPlanes, const glm::vec4& casterExtrusion);
+
+	// --- Getters ---
+	uint32_t GetInstanceCount(uint32_t currentFrame) const { return m_InstanceCounts[currentFrame]; }
+	uint32_t GetMaxInstances() const { return m_MaxInstances; }
+	uint32_t GetViewCount() const { return m_ViewCount; }
+	uint32_t GetShadowViewCount() const { return m_ViewCount - 1; }
+
+	// Instance buffer: `Range` là kích thước vùng của một frame (range của descriptor), `Offset` là dynamic offset.
+	const VulkanBuffer* GetInstanceBuffer() const { return m_InstanceBuffer; }
+	VkDeviceSize GetInstanceRange() const { return m_InstanceRegionSize; }
+	uint32_t GetInstanceOffset(uint32_t currentFrame) const { return static_cast<uint32_t>(m_InstanceRegionSize * currentFrame); }
+
+	// View buffer: một GPUViewData cho mỗi view.
+	const VulkanBuffer* GetViewBuffer() const { return m_ViewBuffer; }
+	VkDeviceSize GetViewRange() const { return m_ViewRegionSize; }
+	uint32_t GetViewOffset(uint32_t currentFrame) const { return static_cast<uint32_t>(m_ViewRegionSize * currentFrame); }
+
+	// Visibility buffer: một uint32_t cho mỗi proxy, dùng chung cho mọi frame (dynamic offset luôn là 0).
+	const VulkanBuffer* GetVisibilityBuffer() const { return m_VisibilityBuffer; }
+	VkDeviceSize GetVisibilityRange() const { return sizeof(uint32_t) * m_MaxInstances; }
+
+	// Draw command buffer: `GetDrawCommandOffset(frame, drawList)` là vị trí (byte) vùng lệnh vẽ của draw list, dùng cho lệnh vẽ indirect.
+	const VulkanBuffer* GetDrawCommandBuffer() const { return m_DrawCommandBuffer; }
+	VkDeviceSize GetDrawCommandRange() const { return m_DrawCommandRegionSize; }
+	uint32_t GetDrawCommandOffset(uint32_t currentFrame) const { return static_cast<uint32_t>(m_DrawCommandRegionSize * currentFrame); }
+	VkDeviceSize GetDrawCommandOffset(uint32_t currentFrame, uint32_t drawList) const;
+
+	// Draw count buffer: một uint32_t cho mỗi draw list.
+	const VulkanBuffer* GetDrawCountBuffer() const { return m_DrawCountBuffer; }
+	VkDeviceSize GetDrawCountRange() const { return m_DrawCountRegionSize; }
+	uint32_t GetDrawCountOffset(uint32_t currentFrame) const { return static_cast<uint32_t>(m_DrawCountRegionSize * currentFrame); }
+	VkDeviceSize GetDrawCountOffset(uint32_t currentFrame, uint32_t drawList) const;
+
+private:
+	// --- Tham chiếu Vulkan ---
+	const VulkanHandles& m_VulkanHandles;
+
+	// --- Dữ liệu nội bộ ---
+	uint32_t m_MaxInstances;
+	uint32_t m_ViewCount;
+
+	VulkanBuffer* m_InstanceBuffer = nullptr;		// CPU_TO_GPU, map vĩnh viễn.
+	VulkanBuffer* m_ViewBuffer = nullptr;			// CPU_TO_GPU, map vĩnh viễn.
+	VulkanBuffer* m_VisibilityBuffer = nullptr;		// GPU_ONLY, compute shader đọc/ghi (pha sau của occlusion culling).
+	VulkanBuffer* m_DrawCommandBuffer = nullptr;	// GPU_ONLY, compute shader ghi.
+	VulkanBuffer* m_DrawCountBuffer = nullptr;		// GPU_ONLY, reset bằng vkCmdFillBuffer mỗi frame.
+	VkDeviceSize m_InstanceRegionSize = 0;			// Kích thước vùng của một frame (đã căn chỉnh) trong từng buffer.
+	VkDeviceSize m_ViewRegionSize = 0;
+	VkDeviceSize m_DrawCommandRegionSize = 0;
+	VkDeviceSize m_DrawCountRegionSize = 0;
+
+	std::vector<uint32_t> m_InstanceCounts;			// Số instance đã ghi của mỗi frame.
+
+	// --- Hàm helper private ---
+	static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment);
+
+	// Helper: Con trỏ tới dữ liệu view của frame trong vùng nhớ đã map.
+	GPUViewData* GetMappedViews(uint32_t currentFrame) const;
+};
@@ -10,74 +10,68 @@
 #include "Scene/MeshManager.h"
 #include "Core/VulkanImage.h"
 #include "Scene\MaterialManager.h"
-#include "Scene\Scene.h"
-#include "Scene/Component.h"
+#include "Core/VulkanFrameAllocator.h"
+#include "Core/VulkanBuffer.h"
+#include "Core/VulkanCommandManager.h"
+#include "Core/JobSystem.h"
+#include "DrawList.h"
+#include "GPUScene.h"
+#include "OcclusionQueryCuller.h"
 
 
 GeometryPass::GeometryPass(const GeometryPassCreateInfo& geometryInfo) :
 	m_TextureDescriptors(geometryInfo.textureManager->getDescriptor()),
 	m_MeshManager(geometryInfo.meshManager),
 	m_MaterialManager(geometryInfo.materialManager),
+	m_GPUScene(geometryInfo.gpuScene),
+	m_GPUDrivenRendering(geometryInfo.gpuDrivenRendering),
+	m_GPUDrawList(geometryInfo.gpuDrawList),
+	m_LoadAttachments(geometryInfo.loadAttachments),
+	m_StoreDepth(geometryInfo.storeDepth),
+	m_OcclusionQueryCuller(geometryInfo.gpuDrivenRendering ? nullptr : geometryInfo.occlusionQueryCuller),
 	m_DepthStencilImages(geometryInfo.depthStencilImages),
 	m_BackgroundColor(geometryInfo.BackgroundColor),
 	m_SwapchainExtent(geometryInfo.vulkanSwapchainHandles->swapChainExtent),
-	m_Scene(geometryInfo.scene),
+	m_DrawList(geometryInfo.drawList),
 	m_VulkanHandles(geometryInfo.vulkanHandles),
+	m_CommandManager(geometryInfo.commandManager),
+	m_JobSystem(geometryInfo.jobSystem),
+	m_MsaaSamples(geometryInfo.MSAA_SAMPLES),
 	m_AlbedoImages(geometryInfo.albedoImages),
 	m_NormalImages(geometryInfo.normalImages),
-	m_PositionImages(geometryInfo.positionImages)
+	m_PositionImages(geometryInfo.positionImages),
+	m_UniformOffsets(geometryInfo.uniformOffsets)
 {
-	CreateDescriptor(*geometryInfo.uniformBuffers);
+	m_ColorAttachmentFormats = {
+		VK_FORMAT_B8G8R8A8_SRGB,				// Albedo
+		VK_FORMAT_R16G16B16A16_SFLOAT,			// Normal
+		VK_FORMAT_R16G16B16A16_SFLOAT			// Position
+	};
+
+	CreateDescriptor(geometryInfo.frameAllocator);
 	CreatePipeline(geometryInfo);
+	CreateQueryPipeline(geometryInfo);
 }
 
 GeometryPass::~GeometryPass()
 {
 	delete(m_Handles.pipeline);
+	delete(m_Handles.queryPipeline);
 }
 
 void GeometryPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame)
 {
-	// --- 1. Chuyển đổi Layout cho các Attachment ---
-
-
-	// Chuyển layout cho attachment depth/stencil (MSAA) để có thể ghi vào.
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_DepthStencilImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-		0, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-		0, 1);
-
-
-	// G-Buffer
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_AlbedoImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-		0, 1);
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_NormalImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-		0, 1);
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_PositionImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-		0, 1);
-
-	// --- 2. Thiết lập và Bắt đầu Dynamic Rendering ---
+	// Layout của các attachment được RenderGraph chuyển đổi (gộp barrier) trước khi pass được gọi.
+	const VkAttachmentLoadOp loadOp = m_LoadAttachments ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+
+	// --- 1. Thiết lập và Bắt đầu Dynamic Rendering ---
 	// Cấu hình attachment màu, bao gồm cả việc resolve MSAA.
 	VkRenderingAttachmentInfo albedoAttachment{};
 	albedoAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 	albedoAttachment.clearValue.color = m_BackgroundColor;
 	albedoAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 	albedoAttachment.imageView = (*m_AlbedoImages)[currentFrame]->GetHandles().imageView; // Vẽ vào ảnh MSAA.
-	albedoAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	albedoAttachment.loadOp = loadOp;
 	albedoAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 
 	// Normal
@@ -86,7 +80,7 @@ void GeometryPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex
 	normalAttachment.clearValue.color = m_BackgroundColor;
 	normalAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 	normalAttachment.imageView = (*m_NormalImages)[currentFrame]->GetHandles().imageView; 
-	normalAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	normalAttachment.loadOp = loadOp;
 	normalAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 
 	// Position
@@ -95,7 +89,7 @@ void GeometryPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex
 	positionAttachment.clearValue.color = m_BackgroundColor;
 	positionAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 	positionAttachment.imageView = (*m_PositionImages)[currentFrame]->GetHandles().imageView;
-	positionAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	positionAttachment.loadOp = loadOp;
 	positionAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 
 	// Cấu hình attachment depth/stencil.
@@ -104,8 +98,8 @@ void GeometryPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex
 	depthStencilAttachment.clearValue.depthStencil = { 1.0f, 0 };
 	depthStencilAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 	depthStencilAttachment.imageView = (*m_DepthStencilImages)[currentFrame]->GetHandles().imageView;
-	depthStencilAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depthStencilAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthStencilAttachment.loadOp = loadOp;
+	depthStencilAttachment.storeOp = m_StoreDepth ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
 	VkRenderingAttachmentInfo attachments[] = { albedoAttachment, normalAttachment, positionAttachment };
 
@@ -120,86 +114,107 @@ void GeometryPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex
 	renderingInfo.renderArea.extent = m_SwapchainExtent;
 	renderingInfo.renderArea.offset = { 0, 0 };
 
-	vkCmdBeginRendering(*cmdBuffer, &renderingInfo);
+	// --- 2. Thực hiện Vẽ ---
+	if (m_GPUDrivenRendering)
+	{
+		// Danh sách lệnh vẽ và số lượng do GPUCullingPass sinh ra (barrier đã được pass đó ghi),
+		// CPU chỉ ghi một lệnh vẽ bất kể số đối tượng trong scene.
+		vkCmdBeginRendering(*cmdBuffer, &renderingInfo);
+
+		BindPipelineState(*cmdBuffer, currentFrame);
+		vkCmdDrawIndexedIndirectCount(
+			*cmdBuffer,
+			m_GPUScene->GetDrawCommandBuffer()->GetHandles().buffer, m_GPUScene->GetDrawCommandOffset(currentFrame, m_GPUDrawList),
+			m_GPUScene->GetDrawCountBuffer()->GetHandles().buffer, m_GPUScene->GetDrawCountOffset(currentFrame, m_GPUDrawList),
+			m_GPUScene->GetMaxInstances(), sizeof(VkDrawIndexedIndirectCommand)
+		);
+
+		vkCmdEndRendering(*cmdBuffer);
+		return;
+	}
 
-	// --- 3. Thực hiện Vẽ ---
-	// Bind pipeline và các tài nguyên chung.
-	vkCmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipeline);
-	VkDeviceSize offset = 0;
-	vkCmdBindVertexBuffers(*cmdBuffer, 0, 1, &m_MeshManager->getVertexBuffer(), &offset);
-	vkCmdBindIndexBuffer(*cmdBuffer, m_MeshManager->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-	BindDescriptors(cmdBuffer, currentFrame);
+	// Nội dung của vùng rendering được cung cấp hoàn toàn bởi các secondary command buffer.
+	renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
 
-	// Vẽ tất cả các đối tượng trong scene.
-	DrawSceneObject(*cmdBuffer);
+	// Query phải được reset bên ngoài vùng rendering trước khi secondary buffer cuối dùng lại chúng.
+	if (m_OcclusionQueryCuller != nullptr)
+	{
+		m_OcclusionQueryCuller->ResetQueries(*cmdBuffer, currentFrame);
+	}
 
-	vkCmdEndRendering(*cmdBuffer);
+	// Ghi song song các đoạn lệnh vẽ, sau đó thực thi theo thứ tự bên trong vùng rendering.
+	std::vector<VkCommandBuffer> secondaryCmdBuffers = RecordSecondaryCmdBuffers(currentFrame);
 
-	// --- 4. Chuyển đổi Layout sau khi Render ---
-	
-	// G-Buffer
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_AlbedoImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-		0, 1);
-
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_NormalImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-		0, 1);
-
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_PositionImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-		0, 1);
+	vkCmdBeginRendering(*cmdBuffer, &renderingInfo);
+
+	if (!secondaryCmdBuffers.empty())
+	{
+		vkCmdExecuteCommands(*cmdBuffer, static_cast<uint32_t>(secondaryCmdBuffers.size()), secondaryCmdBuffers.data());
+	}
+
+	vkCmdEndRendering(*cmdBuffer);
 }
 
-void GeometryPass::CreateDescriptor(const std::vector<VulkanBuffer*>& uniformBuffers)
+void GeometryPass::CreateDescriptor(const VulkanFrameAllocator* frameAllocator)
 {
 	// Set 0: Texture array descriptor (được tạo và quản lý bởi TextureManager).
 	m_Handles.descriptors.push_back(m_TextureDescriptors);
 
-	// Set 1: UBO descriptor (một cho mỗi frame-in-flight).
-	m_UboDescriptors.resize(uniformBuffers.size());
-	for (size_t i = 0; i < uniformBuffers.size(); i++)
-	{
-		// Cấu hình binding cho UBO.
-		BindingElementInfo uniformElementInfo;
-		uniformElementInfo.binding = 0; // layout(binding = 0) trong set 1.
-		uniformElementInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uniformElementInfo.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // Dùng trong Vertex Shader.
-		uniformElementInfo.descriptorCount = 1;
-
-		// Thông tin về buffer sẽ được bind.
-		VkDescriptorBufferInfo uniformBufferInfo;
-		uniformBufferInfo.buffer = uniformBuffers[i]->GetHandles().buffer;
-		uniformBufferInfo.offset = 0;
-		uniformBufferInfo.range = uniformBuffers[i]->GetHandles().bufferSize;
-
-		std::vector<VkDescriptorBufferInfo> uniformBufferInfos = { uniformBufferInfo };
-
-		BufferDescriptorUpdateInfo uniformBufferUpdate{};
-		uniformBufferUpdate.binding = 0;
-		uniformBufferUpdate.firstArrayElement = 0;
-		uniformBufferUpdate.bufferInfos = uniformBufferInfos;
-
-		uniformElementInfo.bufferDescriptorUpdateInfoCount = 1;
-		uniformElementInfo.pBufferDescriptorUpdates = &uniformBufferUpdate;
-
-		// Tạo đối tượng VulkanDescriptor và thêm vào danh sách quản lý.
-		std::vector<BindingElementInfo> uniformBindings{ uniformElementInfo };
-		m_UboDescriptors[i] = new VulkanDescriptor(*m_VulkanHandles, uniformBindings, 1); // Set 1
-		m_Handles.descriptors.push_back(m_UboDescriptors[i]);
-	}
+	// Set 1: UBO descriptor (dynamic).
+	// Descriptor trỏ vào buffer chung của FrameAllocator, vị trí UBO của từng frame
+	// được chọn lúc bind bằng dynamic offset nên chỉ cần một descriptor set cho mọi frame.
+	BindingElementInfo uniformElementInfo;
+	uniformElementInfo.binding = 0; // layout(binding = 0) trong set 1.
+	uniformElementInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	uniformElementInfo.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // Dùng trong Vertex Shader.
+	uniformElementInfo.descriptorCount = 1;
+
+	// Thông tin về buffer sẽ được bind. Range là kích thước một UBO, offset thực tế là dynamic offset.
+	VkDescriptorBufferInfo uniformBufferInfo;
+	uniformBufferInfo.buffer = frameAllocator->GetBuffer()->GetHandles().buffer;
+	uniformBufferInfo.offset = 0;
+	uniformBufferInfo.range = sizeof(UniformBufferObject);
+
+	std::vector<VkDescriptorBufferInfo> uniformBufferInfos = { uniformBufferInfo };
+
+	BufferDescriptorUpdateInfo uniformBufferUpdate{};
+	uniformBufferUpdate.binding = 0;
+	uniformBufferUpdate.firstArrayElement = 0;
+	uniformBufferUpdate.bufferInfos = uniformBufferInfos;
+
+	uniformElementInfo.bufferDescriptorUpdateInfoCount = 1;
+	uniformElementInfo.pBufferDescriptorUpdates = &uniformBufferUpdate;
+
+	// Tạo đối tượng VulkanDescriptor và thêm vào danh sách quản lý.
+	std::vector<BindingElementInfo> uniformBindings{ uniformElementInfo };
+	m_UboDescriptor = new VulkanDescriptor(*m_VulkanHandles, uniformBindings, 1); // Set 1
+	m_Handles.descriptors.push_back(m_UboDescriptor);
 
 	// Set 2: SBO Chứa thông tin Material
 	m_Handles.descriptors.push_back(m_MaterialManager->GetDescriptor());
+
+	// Set 3: Instance buffer của GPUScene (storage buffer dynamic, vùng của frame chọn bằng dynamic offset).
+	VkDescriptorBufferInfo instanceBufferInfo{};
+	instanceBufferInfo.buffer = m_GPUScene->GetInstanceBuffer()->GetHandles().buffer;
+	instanceBufferInfo.offset = 0;
+	instanceBufferInfo.range = m_GPUScene->GetInstanceRange();
+
+	BufferDescriptorUpdateInfo instanceBufferUpdate{};
+	instanceBufferUpdate.binding = 0;
+	instanceBufferUpdate.firstArrayElement = 0;
+	instanceBufferUpdate.bufferInfos = { instanceBufferInfo };
+
+	BindingElementInfo instanceElementInfo{};
+	instanceElementInfo.binding = 0;
+	instanceElementInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	instanceElementInfo.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	instanceElementInfo.descriptorCount = 1;
+	instanceElementInfo.bufferDescriptorUpdateInfoCount = 1;
+	instanceElementInfo.pBufferDescriptorUpdates = &instanceBufferUpdate;
+
+	std::vector<BindingElementInfo> instanceBindings{ instanceElementInfo };
+	m_InstanceDescriptor = new VulkanDescriptor(*m_VulkanHandles, instanceBindings, 3); // Set 3
+	m_Handles.descriptors.push_back(m_InstanceDescriptor);
 }
 
 void GeometryPass::CreatePipeline(const GeometryPassCreateInfo& geometryInfo)
@@ -212,20 +227,44 @@ void GeometryPass::CreatePipeline(const GeometryPassCreateInfo& geometryInfo)
 	pipelineInfo.swapchainHandles = geometryInfo.vulkanSwapchainHandles;
 	pipelineInfo.fragmentShaderFilePath = geometryInfo.fragShaderFilePath;
 	pipelineInfo.vertexShaderFilePath = geometryInfo.vertShaderFilePath;
-	pipelineInfo.depthFormat = VK_FORMAT_D32_SFLOAT_S8_UINT;
-	pipelineInfo.stencilFormat = VK_FORMAT_D32_SFLOAT_S8_UINT;
+	pipelineInfo.depthFormat = m_DepthStencilFormat;
+	pipelineInfo.stencilFormat = m_DepthStencilFormat;
 	pipelineInfo.cullingMode = VK_CULL_MODE_BACK_BIT;
-
-	std::vector<VkFormat> renderingColorAttachments = { 
-		VK_FORMAT_B8G8R8A8_SRGB,					// Albedo
-		VK_FORMAT_R16G16B16A16_SFLOAT,			// Normal
-		VK_FORMAT_R16G16B16A16_SFLOAT			// Position
-	};
-	pipelineInfo.renderingColorAttachments = &renderingColorAttachments;
+	pipelineInfo.renderingColorAttachments = &m_ColorAttachmentFormats;
+	pipelineInfo.pushConstantDataSize = 0; // Dữ liệu từng đối tượng nằm trong instance buffer.
 
 	m_Handles.pipeline = new VulkanPipeline(&pipelineInfo);
 }
 
+void GeometryPass::CreateQueryPipeline(const GeometryPassCreateInfo& geometryInfo)
+{
+	m_Handles.queryPipeline = nullptr;
+	if (m_OcclusionQueryCuller == nullptr) return;
+
+	// Không dùng descriptor: ma trận camera và hộp bao đều là push constant.
+	std::vector<VulkanDescriptor*> noDescriptors;
+
+	// Cùng định dạng attachment với pipeline chính (chạy trong cùng vùng rendering), nhưng không ghi màu/depth
+	// và không cull mặt sau (hộp bao có thể bị mặt phẳng gần cắt một phần).
+	VulkanPipelineCreateInfo pipelineInfo{};
+	pipelineInfo.descriptors = &noDescriptors;
+	pipelineInfo.msaaSamples = geometryInfo.MSAA_SAMPLES;
+	pipelineInfo.vulkanHandles = geometryInfo.vulkanHandles;
+	pipelineInfo.useVertexInput = false; // Đỉnh của hộp được sinh từ gl_VertexIndex.
+	pipelineInfo.swapchainHandles = geometryInfo.vulkanSwapchainHandles;
+	pipelineInfo.fragmentShaderFilePath = geometryInfo.queryFragShaderFilePath;
+	pipelineInfo.vertexShaderFilePath = geometryInfo.queryVertShaderFilePath;
+	pipelineInfo.depthFormat = m_DepthStencilFormat;
+	pipelineInfo.stencilFormat = m_DepthStencilFormat;
+	pipelineInfo.depthWriteEnable = false;
+	pipelineInfo.colorWriteMask = 0;
+	pipelineInfo.cullingMode = VK_CULL_MODE_NONE;
+	pipelineInfo.renderingColorAttachments = &m_ColorAttachmentFormats;
+	pipelineInfo.pushConstantDataSize = sizeof(OcclusionQueryPushConstantData);
+
+	m_Handles.queryPipeline = new VulkanPipeline(&pipelineInfo);
+}
+
 void GeometryPass::BindDescriptors(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame)
 {
 	// Bind Set 0: Mảng các texture.
@@ -237,13 +276,14 @@ void GeometryPass::BindDescriptors(const VkCommandBuffer* cmdBuffer, uint32_t cu
 		0, nullptr
 	);
 
-	// Bind Set 1: UBO chứa thông tin camera cho frame hiện tại.
+	// Bind Set 1: UBO chứa thông tin camera cho frame hiện tại (chọn bằng dynamic offset).
+	uint32_t uboDynamicOffset = (*m_UniformOffsets)[currentFrame];
 	vkCmdBindDescriptorSets(
 		*cmdBuffer,
 		VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipelineLayout,
-		m_UboDescriptors[currentFrame]->getSetIndex(), 1,
-		&m_UboDescriptors[currentFrame]->getHandles().descriptorSet,
-		0, nullptr
+		m_UboDescriptor->getSetIndex(), 1,
+		&m_UboDescriptor->getHandles().descriptorSet,
+		1, &uboDynamicOffset
 	);
 
 	// Bind Set 2: SBO chứa thông tin Material.
@@ -254,36 +294,85 @@ void GeometryPass::BindDescriptors(const VkCommandBuffer* cmdBuffer, uint32_t cu
 		&m_MaterialManager->GetDescriptor()->getHandles().descriptorSet,
 		0, nullptr
 	);
+
+	// Bind Set 3: Instance buffer của frame hiện tại.
+	uint32_t instanceDynamicOffset = m_GPUScene->GetInstanceOffset(currentFrame);
+	vkCmdBindDescriptorSets(
+		*cmdBuffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipelineLayout,
+		m_InstanceDescriptor->getSetIndex(), 1,
+		&m_InstanceDescriptor->getHandles().descriptorSet,
+		1, &instanceDynamicOffset
+	);
 }
 
-void GeometryPass::DrawSceneObject(VkCommandBuffer cmdBuffer)
+void GeometryPass::BindPipelineState(VkCommandBuffer cmdBuffer, uint32_t currentFrame)
 {
-	// Lấy view chứa tất cả các entity có Transform và Mesh component.
-	// Đây là cách truy vấn hiệu quả của ECS.
-	auto view = m_Scene->GetRegistry().view<TransformComponent, MeshComponent>();
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipeline);
+	VkDeviceSize offset = 0;
+	vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &m_MeshManager->getVertexBuffer(), &offset);
+	vkCmdBindIndexBuffer(cmdBuffer, m_MeshManager->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	BindDescriptors(&cmdBuffer, currentFrame);
+}
 
-	view.each([&](auto e, const TransformComponent& transformComponent, const MeshComponent& meshComponent)
+std::vector<VkCommandBuffer> GeometryPass::RecordSecondaryCmdBuffers(uint32_t currentFrame)
+{
+	// Chỉ các batch nhìn thấy từ camera, phần còn lại của DrawList chỉ dùng cho shadow map.
+	const uint32_t batchCount = m_DrawList->GetVisibleBatchCount();
+	const uint32_t drawJobCount = m_DrawList->GetJobCount(batchCount, m_JobSystem->GetThreadCount());
+
+	// Occlusion query là job cuối: secondary buffer của nó được thực thi sau khi cả scene đã ghi depth.
+	const bool recordQueries = m_OcclusionQueryCuller != nullptr && m_OcclusionQueryCuller->GetQueryCount(currentFrame) > 0;
+	const uint32_t jobCount = drawJobCount + (recordQueries ? 1 : 0);
+	std::vector<VkCommandBuffer> secondaryCmdBuffers(jobCount, VK_NULL_HANDLE);
+
+	// Thông tin kế thừa: phải khớp với các attachment của vkCmdBeginRendering ở primary.
+	VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{};
+	inheritanceRenderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+	inheritanceRenderingInfo.colorAttachmentCount = static_cast<uint32_t>(m_ColorAttachmentFormats.size());
+	inheritanceRenderingInfo.pColorAttachmentFormats = m_ColorAttachmentFormats.data();
+	inheritanceRenderingInfo.depthAttachmentFormat = m_DepthStencilFormat;
+	inheritanceRenderingInfo.stencilAttachmentFormat = m_DepthStencilFormat;
+	inheritanceRenderingInfo.rasterizationSamples = m_MsaaSamples;
+
+	m_JobSystem->ParallelFor(jobCount, [&](uint32_t jobIndex, uint32_t threadIndex)
 		{
-			if (!meshComponent.IsVisible) return;
-
-			std::vector<Mesh*> meshes = meshComponent.Model->getMeshes();
-
-			// Tính toán ma trận model từ TransformComponent.
-			// Lưu ý: Logic này nên được chuyển vào một System riêng biệt để tối ưu hóa.
+			VkCommandBuffer secondaryCmd = m_CommandManager->BeginSecondaryCmdBuffer(currentFrame, threadIndex, inheritanceRenderingInfo);
 
-			for (const auto& mesh : meshes)
+			if (jobIndex == drawJobCount)
 			{
-				// --- Cập nhật Push Constants ---
-				// Gửi dữ liệu cho từng lần vẽ (per-draw data) như ma trận model và ID texture.
-				m_PushConstantData.model = transformComponent.GetTransformMatrix();
-				m_PushConstantData.materialIndex = mesh->materialIndex;
-
-				vkCmdPushConstants(cmdBuffer, m_Handles.pipeline->getHandles().pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstantData), &m_PushConstantData);
+				vkCmdBindPipeline(secondaryCmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.queryPipeline->getHandles().pipeline);
+				m_OcclusionQueryCuller->RecordQueries(secondaryCmd, m_Handles.queryPipeline->getHandles().pipelineLayout, currentFrame);
+			}
+			else
+			{
+				// Secondary buffer không kế thừa state từ primary, phải bind lại toàn bộ.
+				BindPipelineState(secondaryCmd, currentFrame);
 
-				// --- Ghi Lệnh Vẽ ---
-				vkCmdDrawIndexed(cmdBuffer, mesh->meshRange.indexCount, 1, mesh->meshRange.firstIndex, mesh->meshRange.firstVertex, 0);
+				uint32_t firstBatch, endBatch;
+				m_DrawList->GetJobRange(batchCount, drawJobCount, jobIndex, firstBatch, endBatch);
+				DrawSceneObject(secondaryCmd, firstBatch, endBatch);
 			}
+
+			VK_CHECK(vkEndCommandBuffer(secondaryCmd), "LỖI: Kết thúc ghi secondary command buffer thất bại!");
+			secondaryCmdBuffers[jobIndex] = secondaryCmd;
 		}
 	);
 
+	return secondaryCmdBuffers;
+}
+
+void GeometryPass::DrawSceneObject(VkCommandBuffer cmdBuffer, uint32_t firstBatch, uint32_t endBatch)
+{
+	const std::vector<DrawBatch>& drawBatches = m_DrawList->GetBatches();
+
+	for (uint32_t i = firstBatch; i < endBatch; i++)
+	{
+		const DrawBatch& batch = drawBatches[i];
+
+		// --- Ghi Lệnh Vẽ ---
+		// Một lệnh vẽ cho mọi instance của mesh: vertex shader đọc ma trận model và material
+		// của item thứ gl_InstanceIndex (bắt đầu từ firstInstance) trong instance buffer.
+		vkCmdDrawIndexed(cmdBuffer, batch.mesh->meshRange.indexCount, batch.instanceCount, batch.mesh->meshRange.firstIndex, batch.mesh->meshRange.firstVertex, batch.firstInstance);
+	}
 }
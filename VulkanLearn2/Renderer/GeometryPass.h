@@ -9,10 +9,15 @@ class VulkanPipeline;
 class VulkanImage;
 class VulkanDescriptor;
 class VulkanBuffer;
+class VulkanFrameAllocator;
+class VulkanCommandManager;
+class JobSystem;
+class DrawList;
 class TextureManager;
 class MeshManager;
 class MaterialManager;
-class Scene;
+class GPUScene;
+class OcclusionQueryCuller;
 
 // =================================================================================================
 // Struct: GeometryPassCreateInfo
@@ -27,15 +32,28 @@ struct GeometryPassCreateInfo
 	uint32_t MAX_FRAMES_IN_FLIGHT;
 
 	// --- Dữ liệu Scene ---
-	Scene* scene;
+	const DrawList* drawList;						// Danh sách lệnh vẽ của frame, được xây dựng trước khi ghi lệnh.
 	const TextureManager* textureManager;
 	const MeshManager* meshManager;
 	MaterialManager* materialManager;
-	const std::vector<VulkanBuffer*>* uniformBuffers; // UBO chứa ma trận camera.
+	const VulkanFrameAllocator* frameAllocator;		// Buffer chung chứa UBO camera (bind qua dynamic offset).
+	const std::vector<uint32_t>* uniformOffsets;	// Dynamic offset của UBO camera cho mỗi frame.
+	const GPUScene* gpuScene;						// Instance buffer (Set 3) và lệnh vẽ indirect của GPUCullingPass.
+	bool gpuDrivenRendering;						// true: vẽ bằng vkCmdDrawIndexedIndirectCount, false: ghi lệnh vẽ từ DrawList trên CPU.
+	uint32_t gpuDrawList;							// GPU-driven: draw list của GPUScene được vẽ (DRAW_LIST_CAMERA hoặc DRAW_LIST_CAMERA_LATE).
+	bool loadAttachments;							// true: vẽ tiếp lên G-buffer và depth của pass trước (pha sau của occlusion culling).
+	bool storeDepth;								// true: giữ depth sau pass (HiZPass đọc).
+	OcclusionQueryCuller* occlusionQueryCuller;		// Ghi lệnh trên CPU: vẽ hộp bao của các occlusion query sau scene (nullptr: không dùng).
+
+	// --- Ghi lệnh đa luồng ---
+	VulkanCommandManager* commandManager;			// Cung cấp secondary command buffer cho từng luồng.
+	JobSystem* jobSystem;
 
 	// --- Shaders ---
 	std::string fragShaderFilePath;
 	std::string vertShaderFilePath;
+	std::string queryFragShaderFilePath;			// Shader vẽ hộp bao của occlusion query (chỉ cần khi có occlusionQueryCuller).
+	std::string queryVertShaderFilePath;
 
 	// --- Attachments & Đầu ra ---
 	VkClearColorValue BackgroundColor;
@@ -52,6 +70,7 @@ struct GeometryPassCreateInfo
 struct GeometryPassHandles
 {
 	VulkanPipeline* pipeline;
+	VulkanPipeline* queryPipeline;		// Vẽ hộp bao của occlusion query, nullptr nếu không dùng.
 	std::vector<VulkanDescriptor*> descriptors;
 };
 
@@ -63,6 +82,15 @@ struct GeometryPassHandles
 //      Nó sử dụng MSAA để khử răng cưa, vẽ vào một cặp attachment màu và depth (MSAA),
 //      sau đó resolve kết quả vào một ảnh không-MSAA. Ảnh này sẽ trở thành đầu vào
 //      cho chuỗi post-processing.
+//      Dữ liệu từng đối tượng (ma trận model, material) được vertex shader đọc từ instance buffer
+//      của GPUScene qua gl_InstanceIndex. Có hai cách ghi lệnh vẽ:
+//        - GPU-driven: một lệnh vkCmdDrawIndexedIndirectCount duy nhất tiêu thụ kết quả của GPUCullingPass.
+//          Occlusion culling hai pha dùng hai instance của pass: pha đầu xóa attachment và vẽ draw list camera,
+//          pha sau giữ nội dung (loadOp LOAD) và vẽ thêm các instance vừa lộ ra (DRAW_LIST_CAMERA_LATE).
+//        - CPU: các lệnh vẽ được chia thành nhiều đoạn và ghi song song vào secondary command buffer
+//          (mỗi luồng một command pool), sau đó primary buffer thực thi chúng theo đúng thứ tự.
+//          Nếu có OcclusionQueryCuller, một secondary buffer cuối cùng vẽ hộp bao (không ghi màu/depth) của
+//          các occlusion query trên depth của cả scene.
 // =================================================================================================
 class GeometryPass : public IRenderPass
 {
@@ -85,36 +113,58 @@ private:
 	GeometryPassHandles m_Handles;
 
 	// --- Tham chiếu đến các tài nguyên bên ngoài ---
-	Scene* m_Scene;
+	const DrawList* m_DrawList;
 	const MeshManager* m_MeshManager;
 	MaterialManager* m_MaterialManager;
+	const GPUScene* m_GPUScene;
+	bool m_GPUDrivenRendering;
+	uint32_t m_GPUDrawList;
+	bool m_LoadAttachments;
+	bool m_StoreDepth;
+	OcclusionQueryCuller* m_OcclusionQueryCuller;
 	const VulkanHandles* m_VulkanHandles;
-	PushConstantData m_PushConstantData; // Changed from pointer to instance.
+	VulkanCommandManager* m_CommandManager;
+	JobSystem* m_JobSystem;
 	VkExtent2D m_SwapchainExtent;
 	VkClearColorValue m_BackgroundColor;
 
 	// --- Tài nguyên dành riêng cho pass ---
 	VulkanDescriptor* m_TextureDescriptors;				// Descriptor cho mảng texture (Set 0).
-	std::vector<VulkanDescriptor*> m_UboDescriptors;	// Descriptors cho UBO camera (Set 1), một cho mỗi frame.
+	VulkanDescriptor* m_UboDescriptor;					// Descriptor cho UBO camera (Set 1), dùng chung cho mọi frame nhờ dynamic offset.
+	VulkanDescriptor* m_InstanceDescriptor;				// Descriptor cho instance buffer của GPUScene (Set 3), chọn frame bằng dynamic offset.
+	const std::vector<uint32_t>* m_UniformOffsets;		// Dynamic offset của UBO camera cho mỗi frame.
 	const std::vector<VulkanImage*>* m_DepthStencilImages;
 	const std::vector<VulkanImage*>* m_AlbedoImages;
 	const std::vector<VulkanImage*>* m_NormalImages;
 	const std::vector<VulkanImage*>* m_PositionImages;
 
+	// Định dạng các attachment, dùng chung cho pipeline và inheritance info của secondary buffer.
+	std::vector<VkFormat> m_ColorAttachmentFormats;
+	VkFormat m_DepthStencilFormat = VK_FORMAT_D32_SFLOAT_S8_UINT;
+	VkSampleCountFlagBits m_MsaaSamples;
 
 	// --- Hàm khởi tạo ---
 	
 	// Helper: Tạo descriptor sets.
-	void CreateDescriptor(const std::vector<VulkanBuffer*>& uniformBuffers);
+	void CreateDescriptor(const VulkanFrameAllocator* frameAllocator);
 	
 	// Helper: Tạo pipeline đồ họa.
 	void CreatePipeline(const GeometryPassCreateInfo& geometryInfo);
 
+	// Helper: Tạo pipeline vẽ hộp bao của occlusion query (chỉ test depth, không ghi gì).
+	void CreateQueryPipeline(const GeometryPassCreateInfo& geometryInfo);
+
 	// --- Hàm thực thi ---
 	
 	// Helper: Bind các descriptor set trước khi vẽ.
 	void BindDescriptors(const VkCommandBuffer* cmdBuffer, uint32_t currentFrame);
 	
-	// Helper: Ghi lệnh vẽ cho các đối tượng trong scene.
-	void DrawSceneObject(VkCommandBuffer cmdBuffer);
+	// Helper: Bind pipeline, vertex/index buffer và descriptor set.
+	void BindPipelineState(VkCommandBuffer cmdBuffer, uint32_t currentFrame);
+
+	// Helper: Ghi song song các đoạn lệnh vẽ (và occlusion query nếu có) vào secondary buffer, trả về theo đúng thứ tự.
+	std::vector<VkCommandBuffer> RecordSecondaryCmdBuffers(uint32_t currentFrame);
+
+	// Helper: Ghi lệnh vẽ instanced cho các DrawBatch trong khoảng [firstBatch, endBatch).
+	void DrawSceneObject(VkCommandBuffer cmdBuffer, uint32_t firstBatch, uint32_t endBatch);
 };
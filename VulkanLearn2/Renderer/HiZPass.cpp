@@ -0,0 +1,207 @@
+#include "pch.h"
+#include "HiZPass.h"
+#include "Core/VulkanSampler.h"
+#include "Core/VulkanImage.h"
+#include "Core/VulkanSwapchain.h"
+#include "Core/VulkanPipeline.h"
+#include "Core/VulkanDescriptor.h"
+
+HiZPass::HiZPass(const HiZPassCreateInfo& hiZInfo) :
+	m_VulkanHandles(hiZInfo.vulkanHandles),
+	m_SwapchainExtent(hiZInfo.vulkanSwapchainHandles->swapChainExtent)
+{
+	CreatePyramids(*hiZInfo.depthStencilImages, hiZInfo.MAX_FRAMES_IN_FLIGHT);
+	CreateDescriptor(hiZInfo.vulkanSampler);
+	CreatePipeline(hiZInfo);
+}
+
+HiZPass::~HiZPass()
+{
+	delete(m_Handles.pipeline);
+
+	for (VkImageView view : m_DepthViews)
+	{
+		vkDestroyImageView(m_VulkanHandles->device, view, nullptr);
+	}
+	for (const auto& frameViews : m_MipViews)
+	{
+		for (VkImageView view : frameViews)
+		{
+			vkDestroyImageView(m_VulkanHandles->device, view, nullptr);
+		}
+	}
+	for (VulkanImage* image : m_PyramidImages)
+	{
+		delete(image);
+	}
+}
+
+void HiZPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame)
+{
+	// Depth buffer đã được RenderGraph chuyển sang SHADER_READ_ONLY sau GeometryPass (pha đầu).
+	VulkanImage* pyramid = m_PyramidImages[currentFrame];
+
+	// Mọi cấp bị ghi đè, chỉ cần đợi lần đọc trước (GPUCullingPass pha sau của lần sử dụng trước của frame).
+	m_BarrierBatch.TransitionImage(pyramid, VK_IMAGE_LAYOUT_GENERAL,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, true);
+	m_BarrierBatch.Flush(*cmdBuffer);
+
+	vkCmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Handles.pipeline->getHandles().pipeline);
+
+	for (uint32_t level = 0; level < m_MipLevels; level++)
+	{
+		const VulkanDescriptor* descriptor = m_LevelDescriptors[currentFrame][level];
+		vkCmdBindDescriptorSets(
+			*cmdBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE, m_Handles.pipeline->getHandles().pipelineLayout,
+			descriptor->getSetIndex(), 1,
+			&descriptor->getHandles().descriptorSet,
+			0, nullptr
+		);
+
+		const uint32_t groupCountX = (GetLevelWidth(level) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+		const uint32_t groupCountY = (GetLevelHeight(level) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+		vkCmdDispatch(*cmdBuffer, groupCountX, groupCountY, 1);
+
+		// Cấp vừa ghi là nguồn của cấp kế tiếp.
+		if (level + 1 < m_MipLevels)
+		{
+			m_BarrierBatch.AddImageBarrier(pyramid->GetHandles().image, VK_IMAGE_ASPECT_COLOR_BIT,
+				VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+				VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+				VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+				level, 1);
+			m_BarrierBatch.Flush(*cmdBuffer);
+		}
+	}
+
+	// GPUCullingPass pha sau đọc mọi cấp qua sampler.
+	m_BarrierBatch.TransitionImage(pyramid, VK_IMAGE_LAYOUT_GENERAL,
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+	m_BarrierBatch.Flush(*cmdBuffer);
+}
+
+void HiZPass::CreatePyramids(const std::vector<VulkanImage*>& depthStencilImages, uint32_t frameCount)
+{
+	// Số cấp cho tới khi còn 1x1 texel.
+	m_MipLevels = 1;
+	while (GetLevelWidth(m_MipLevels - 1) > 1 || GetLevelHeight(m_MipLevels - 1) > 1)
+	{
+		m_MipLevels++;
+	}
+
+	VulkanImageCreateInfo pyramidCI{};
+	pyramidCI.width = m_SwapchainExtent.width;
+	pyramidCI.height = m_SwapchainExtent.height;
+	pyramidCI.mipLevels = m_MipLevels;
+	pyramidCI.samples = VK_SAMPLE_COUNT_1_BIT;
+	pyramidCI.format = PYRAMID_FORMAT;
+	pyramidCI.imageUsageFlags = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	pyramidCI.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+	VulkanImageViewCreateInfo pyramidCVI{};
+	pyramidCVI.format = PYRAMID_FORMAT;
+	pyramidCVI.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+	pyramidCVI.mipLevels = m_MipLevels;
+
+	m_PyramidImages.resize(frameCount);
+	m_DepthViews.resize(frameCount);
+	m_MipViews.resize(frameCount);
+	for (uint32_t frame = 0; frame < frameCount; frame++)
+	{
+		m_PyramidImages[frame] = new VulkanImage(*m_VulkanHandles, pyramidCI, pyramidCVI);
+
+		m_DepthViews[frame] = CreateImageView(depthStencilImages[frame]->GetHandles().image, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1);
+
+		m_MipViews[frame].resize(m_MipLevels);
+		for (uint32_t level = 0; level < m_MipLevels; level++)
+		{
+			m_MipViews[frame][level] = CreateImageView(m_PyramidImages[frame]->GetHandles().image, PYRAMID_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, level, 1);
+		}
+	}
+}
+
+VkImageView HiZPass::CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t levelCount) const
+{
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.subresourceRange.aspectMask = aspectFlags;
+	viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
+	viewInfo.subresourceRange.levelCount = levelCount;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	VkImageView view = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateImageView(m_VulkanHandles->device, &viewInfo, nullptr, &view), "LỖI: HiZPass: Tạo image view thất bại!");
+	return view;
+}
+
+void HiZPass::CreateDescriptor(const VulkanSampler* vulkanSampler)
+{
+	m_LevelDescriptors.resize(m_PyramidImages.size());
+	for (size_t frame = 0; frame < m_PyramidImages.size(); frame++)
+	{
+		m_LevelDescriptors[frame].resize(m_MipLevels);
+		for (uint32_t level = 0; level < m_MipLevels; level++)
+		{
+			// --- Binding 0: Nguồn (depth buffer cho cấp 0, cấp trước cho các cấp còn lại) ---
+			// Chỉ đọc bằng texelFetch, sampler không ảnh hưởng tới kết quả.
+			BindingElementInfo sourceBinding{};
+			sourceBinding.binding = 0;
+			sourceBinding.descriptorCount = 1;
+			sourceBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			sourceBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+			VkDescriptorImageInfo sourceInfo{};
+			sourceInfo.imageLayout = level == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+			sourceInfo.imageView = level == 0 ? m_DepthViews[frame] : m_MipViews[frame][level - 1];
+			sourceInfo.sampler = vulkanSampler->getPostProcessSampler();
+
+			ImageDescriptorUpdateInfo sourceUpdateInfo{};
+			sourceUpdateInfo.binding = 0;
+			sourceUpdateInfo.firstArrayElement = 0;
+			sourceUpdateInfo.imageInfos = { sourceInfo };
+
+			sourceBinding.imageDescriptorUpdateInfoCount = 1;
+			sourceBinding.pImageDescriptorUpdates = &sourceUpdateInfo;
+
+			// --- Binding 1: Cấp đang ghi (storage image) ---
+			BindingElementInfo outputBinding{};
+			outputBinding.binding = 1;
+			outputBinding.descriptorCount = 1;
+			outputBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			outputBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+			VkDescriptorImageInfo outputInfo{};
+			outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			outputInfo.imageView = m_MipViews[frame][level];
+			outputInfo.sampler = VK_NULL_HANDLE;
+
+			ImageDescriptorUpdateInfo outputUpdateInfo{};
+			outputUpdateInfo.binding = 1;
+			outputUpdateInfo.firstArrayElement = 0;
+			outputUpdateInfo.imageInfos = { outputInfo };
+
+			outputBinding.imageDescriptorUpdateInfoCount = 1;
+			outputBinding.pImageDescriptorUpdates = &outputUpdateInfo;
+
+			std::vector<BindingElementInfo> bindingElements = { sourceBinding, outputBinding };
+
+			m_LevelDescriptors[frame][level] = new VulkanDescriptor(*m_VulkanHandles, bindingElements, 0); // Set 0
+			m_Handles.descriptors.push_back(m_LevelDescriptors[frame][level]);
+		}
+	}
+}
+
+void HiZPass::CreatePipeline(const HiZPassCreateInfo& hiZInfo)
+{
+	VulkanComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.vulkanHandles = hiZInfo.vulkanHandles;
+	pipelineInfo.descriptors = &m_Handles.descriptors;
+	pipelineInfo.computeShaderFilePath = hiZInfo.compShaderFilePath;
+
+	m_Handles.pipeline = new VulkanPipeline(&pipelineInfo);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "IRenderPass.h"
+#include "Core/VulkanBarrierBatch.h"
+
+// Forward declarations
+struct VulkanHandles;
+struct SwapchainHandles;
+class VulkanPipeline;
+class VulkanImage;
+class VulkanDescriptor;
+class VulkanSampler;
+
+// =================================================================================================
+// Struct: HiZPassCreateInfo
+// Mô tả: Cấu trúc chứa tất cả thông tin cần thiết để khởi tạo một HiZPass.
+// =================================================================================================
+struct HiZPassCreateInfo
+{
+	const VulkanHandles* vulkanHandles;
+	const SwapchainHandles* vulkanSwapchainHandles;
+	const VulkanSampler* vulkanSampler;
+	uint32_t MAX_FRAMES_IN_FLIGHT;
+
+	const std::vector<VulkanImage*>* depthStencilImages;	// Depth của GeometryPass (pha đầu), D32_SFLOAT_S8_UINT không-MSAA.
+
+	std::string compShaderFilePath;
+};
+
+// =================================================================================================
+// Struct: HiZPassHandles
+// Mô tả: Chứa các handle nội bộ được quản lý bởi HiZPass.
+// =================================================================================================
+struct HiZPassHandles
+{
+	VulkanPipeline* pipeline;
+	std::vector<VulkanDescriptor*> descriptors;
+};
+
+// =================================================================================================
+// Class: HiZPass
+// Mô tả:
+//      Dựng depth pyramid (Hi-Z) từ depth buffer của GeometryPass cho occlusion culling trên GPU.
+//      Cấp 0 có cùng kích thước với depth buffer, mỗi cấp sau lấy depth xa nhất (max, depth [0, 1] không đảo)
+//      của 2x2 texel cấp trước, kích thước làm tròn lên để texel cuối của hàng/cột lẻ không bị bỏ sót.
+//      Mỗi cấp là một lần dispatch: đọc cấp trước qua sampler (texelFetch), ghi cấp hiện tại bằng imageStore.
+//      Pyramid do pass sở hữu (một image cho mỗi frame-in-flight, luôn ở layout GENERAL) và không nằm trong
+//      RenderGraph (đồ thị chưa hỗ trợ view theo từng mip), nên pass tự ghi barrier giữa các cấp và barrier
+//      cho GPUCullingPass pha sau, và phải được đánh dấu MarkSideEffects.
+//      Depth buffer có stencil nên được đọc qua một view riêng chỉ có aspect DEPTH.
+// =================================================================================================
+class HiZPass : public IRenderPass
+{
+public:
+	// Constructor: Khởi tạo HiZPass với các thông tin cấu hình.
+	HiZPass(const HiZPassCreateInfo& hiZInfo);
+	~HiZPass();
+
+	// Thực thi pass.
+	void Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame) override;
+
+	// --- Getters ---
+	const HiZPassHandles& GetHandles() const { return m_Handles; }
+	const std::vector<VulkanImage*>& GetPyramidImages() const { return m_PyramidImages; } // R32_SFLOAT, view chứa mọi cấp.
+	uint32_t GetMipLevels() const { return m_MipLevels; }
+
+private:
+	// Kích thước workgroup, phải khớp với local_size trong HiZ_Shader.comp.
+	static constexpr uint32_t WORKGROUP_SIZE = 8;
+	static constexpr VkFormat PYRAMID_FORMAT = VK_FORMAT_R32_SFLOAT;
+
+	HiZPassHandles m_Handles;
+
+	// --- Tham chiếu đến các tài nguyên bên ngoài ---
+	const VulkanHandles* m_VulkanHandles;
+	VkExtent2D m_SwapchainExtent;
+
+	// --- Tài nguyên dành riêng cho pass ---
+	uint32_t m_MipLevels = 1;
+	std::vector<VulkanImage*> m_PyramidImages;						// Một pyramid cho mỗi frame.
+	std::vector<VkImageView> m_DepthViews;							// View chỉ có aspect DEPTH của depth buffer mỗi frame.
+	std::vector<std::vector<VkImageView>> m_MipViews;				// [frame][cấp]: View một mip để ghi bằng imageStore và đọc ở cấp sau.
+	std::vector<std::vector<VulkanDescriptor*>> m_LevelDescriptors;	// [frame][cấp]: Nguồn (sampler) và đích (storage image).
+	VulkanBarrierBatch m_BarrierBatch;								// Tái sử dụng mỗi frame, tránh cấp phát lại.
+
+	// --- Hàm khởi tạo ---
+
+	// Helper: Tạo các pyramid và view của chúng.
+	void CreatePyramids(const std::vector<VulkanImage*>& depthStencilImages, uint32_t frameCount);
+
+	// Helper: Tạo một VkImageView 2D cho khoảng mip [baseMipLevel, baseMipLevel + levelCount).
+	VkImageView CreateImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t levelCount) const;
+
+	// Helper: Tạo descriptor sets.
+	void CreateDescriptor(const VulkanSampler* vulkanSampler);
+
+	// Helper: Tạo compute pipeline.
+	void CreatePipeline(const HiZPassCreateInfo& hiZInfo);
+
+	// Kích thước của cấp `level` (làm tròn lên).
+	uint32_t GetLevelWidth(uint32_t level) const { return std::max((m_SwapchainExtent.width + (1u << level) - 1) >> level, 1u); }
+	uint32_t GetLevelHeight(uint32_t level) const { return std::max((m_SwapchainExtent.height + (1u << level) - 1) >> level, 1u); }
+};
@@ -6,20 +6,23 @@
 #include "Core/VulkanPipeline.h"
 #include "Core/VulkanDescriptor.h"
 #include "Core/VulkanBuffer.h"
+#include "Core/VulkanFrameAllocator.h"
 
 LightingPass::LightingPass(const LightingPassCreateInfo& lightingInfo) :
 	m_VulkanHandles(lightingInfo.vulkanHandles),
 	m_SwapchainExtent(lightingInfo.vulkanSwapchainHandles->swapChainExtent),
 	m_BackgroundColor(lightingInfo.BackgroundColor),
 	m_OutputImages(lightingInfo.outputImages), 
-	m_SceneLightDescriptors(*lightingInfo.sceneLightDescriptors)
+	m_SceneLightDescriptors(*lightingInfo.sceneLightDescriptors),
+	m_SceneLightOffsets(lightingInfo.sceneLightOffsets),
+	m_UniformOffsets(lightingInfo.uniformOffsets)
 {
 	CreateDescriptor(
 		*lightingInfo.gAlbedoTextures,
 		*lightingInfo.gNormalTextures,
 		*lightingInfo.gPositionTextures,
 		lightingInfo.vulkanSampler,
-		*lightingInfo.uniformBuffers);
+		lightingInfo.frameAllocator);
 	CreatePipeline(lightingInfo);
 }
 
@@ -30,15 +33,9 @@ LightingPass::~LightingPass()
 
 void LightingPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame)
 {
-	// --- 1. Chuyển đổi Layout cho Ảnh Đầu Ra ---
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_OutputImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-		0, 1);
-
-	// --- 2. Thiết lập và Bắt đầu Dynamic Rendering ---
+	// Layout của ảnh đầu ra được RenderGraph chuyển đổi (gộp barrier) trước khi pass được gọi.
+
+	// --- 1. Thiết lập và Bắt đầu Dynamic Rendering ---
 	VkRenderingAttachmentInfo colorAttachment{};
 	colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
 	colorAttachment.clearValue.color = m_BackgroundColor;
@@ -59,20 +56,12 @@ void LightingPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex
 
 	vkCmdBeginRendering(*cmdBuffer, &renderingInfo);
 
-	// --- 3. Thực hiện Vẽ ---
+	// --- 2. Thực hiện Vẽ ---
 	vkCmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipeline);
 	BindDescriptors(cmdBuffer, currentFrame);
 	DrawQuad(*cmdBuffer);
 
 	vkCmdEndRendering(*cmdBuffer);
-
-	// --- 4. Chuyển đổi Layout sau khi Render ---
-	VulkanImage::TransitionLayout(
-		*cmdBuffer, (*m_OutputImages)[currentFrame]->GetHandles().image, 1,
-		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-		0, 1);
 }
 
 
@@ -81,7 +70,7 @@ void LightingPass::CreateDescriptor(
 	const std::vector<VulkanImage*>& gNormalTextures,
 	const std::vector<VulkanImage*>& gPositionTextures,
  	const VulkanSampler* vulkanSampler,
-	const std::vector<VulkanBuffer*>& uniformBuffers)
+	const VulkanFrameAllocator* frameAllocator)
 {
 	// =================================================================================================
 	// DESCRIPTOR SET 0: G-BUFFER INPUTS
@@ -158,37 +147,34 @@ void LightingPass::CreateDescriptor(
 	// =================================================================================================
 	// DESCRIPTOR SET 2: CAMERA UBO
 	// =================================================================================================
-	m_UboDescriptors.resize(uniformBuffers.size());
-	for (size_t i = 0; i < uniformBuffers.size(); i++)
-	{
-		// Cấu hình binding cho UBO.
-		BindingElementInfo uniformElementInfo;
-		uniformElementInfo.binding = 0; // layout(binding = 0) trong set 2.
-		uniformElementInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		uniformElementInfo.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // SỬA LỖI: Phải là FRAGMENT_BIT vì viewPos dùng trong fragment shader.
-		uniformElementInfo.descriptorCount = 1;
-
-		// Thông tin về buffer sẽ được bind.
-		VkDescriptorBufferInfo uniformBufferInfo;
-		uniformBufferInfo.buffer = uniformBuffers[i]->GetHandles().buffer;
-		uniformBufferInfo.offset = 0;
-		uniformBufferInfo.range = uniformBuffers[i]->GetHandles().bufferSize;
-
-		std::vector<VkDescriptorBufferInfo> uniformBufferInfos = { uniformBufferInfo };
-
-		BufferDescriptorUpdateInfo uniformBufferUpdate{};
-		uniformBufferUpdate.binding = 0;
-		uniformBufferUpdate.firstArrayElement = 0;
-		uniformBufferUpdate.bufferInfos = uniformBufferInfos;
-
-		uniformElementInfo.bufferDescriptorUpdateInfoCount = 1;
-		uniformElementInfo.pBufferDescriptorUpdates = &uniformBufferUpdate;
-
-		// Tạo đối tượng VulkanDescriptor và thêm vào danh sách quản lý.
-		std::vector<BindingElementInfo> uniformBindings{ uniformElementInfo };
-		m_UboDescriptors[i] = new VulkanDescriptor(*m_VulkanHandles, uniformBindings, 2); // Set 2
-		m_Handles.descriptors.push_back(m_UboDescriptors[i]);
-	}
+	// Descriptor dynamic trỏ vào buffer chung của FrameAllocator, UBO của từng frame
+	// được chọn bằng dynamic offset lúc bind.
+	BindingElementInfo uniformElementInfo;
+	uniformElementInfo.binding = 0; // layout(binding = 0) trong set 2.
+	uniformElementInfo.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	uniformElementInfo.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; // SỬA LỖI: Phải là FRAGMENT_BIT vì viewPos dùng trong fragment shader.
+	uniformElementInfo.descriptorCount = 1;
+
+	// Thông tin về buffer sẽ được bind.
+	VkDescriptorBufferInfo uniformBufferInfo;
+	uniformBufferInfo.buffer = frameAllocator->GetBuffer()->GetHandles().buffer;
+	uniformBufferInfo.offset = 0;
+	uniformBufferInfo.range = sizeof(UniformBufferObject);
+
+	std::vector<VkDescriptorBufferInfo> uniformBufferInfos = { uniformBufferInfo };
+
+	BufferDescriptorUpdateInfo uniformBufferUpdate{};
+	uniformBufferUpdate.binding = 0;
+	uniformBufferUpdate.firstArrayElement = 0;
+	uniformBufferUpdate.bufferInfos = uniformBufferInfos;
+
+	uniformElementInfo.bufferDescriptorUpdateInfoCount = 1;
+	uniformElementInfo.pBufferDescriptorUpdates = &uniformBufferUpdate;
+
+	// Tạo đối tượng VulkanDescriptor và thêm vào danh sách quản lý.
+	std::vector<BindingElementInfo> uniformBindings{ uniformElementInfo };
+	m_UboDescriptor = new VulkanDescriptor(*m_VulkanHandles, uniformBindings, 2); // Set 2
+	m_Handles.descriptors.push_back(m_UboDescriptor);
 }
 
 void LightingPass::CreatePipeline(const LightingPassCreateInfo& lightingInfo)
@@ -223,24 +209,26 @@ void LightingPass::BindDescriptors(const VkCommandBuffer* cmdBuffer, uint32_t cu
 		0, nullptr
 	);
 
-	// Bind Set 1: Scene Light SSBO
+	// Bind Set 1: Scene Light SSBO (dynamic offset trỏ tới dữ liệu đèn của frame hiện tại)
+	uint32_t lightDynamicOffset = (*m_SceneLightOffsets)[currentFrame];
 	vkCmdBindDescriptorSets(
 		*cmdBuffer,
 		VK_PIPELINE_BIND_POINT_GRAPHICS,
 		m_Handles.pipeline->getHandles().pipelineLayout,
 		m_SceneLightDescriptors[currentFrame]->getSetIndex(), 1,
 		&m_SceneLightDescriptors[currentFrame]->getHandles().descriptorSet,
-		0, nullptr
+		1, &lightDynamicOffset
 	);
 
 	// SỬA LỖI: Bind Set 2: Camera UBO
+	uint32_t uboDynamicOffset = (*m_UniformOffsets)[currentFrame];
 	vkCmdBindDescriptorSets(
 		*cmdBuffer,
 		VK_PIPELINE_BIND_POINT_GRAPHICS,
 		m_Handles.pipeline->getHandles().pipelineLayout,
-		m_UboDescriptors[currentFrame]->getSetIndex(), 1,
-		&m_UboDescriptors[currentFrame]->getHandles().descriptorSet,
-		0, nullptr
+		m_UboDescriptor->getSetIndex(), 1,
+		&m_UboDescriptor->getHandles().descriptorSet,
+		1, &uboDynamicOffset
 	);
 }
 
@@ -9,6 +9,7 @@ class VulkanImage;
 class VulkanDescriptor;
 class VulkanSampler;
 class VulkanBuffer;
+class VulkanFrameAllocator;
 
 // =================================================================================================
 // Struct: LightingPassCreateInfo
@@ -29,7 +30,9 @@ struct LightingPassCreateInfo
 
 	// --- Lighting Inputs ---
 	const std::vector<VulkanDescriptor*>* sceneLightDescriptors;
-	const std::vector<VulkanBuffer*>* uniformBuffers; // Camera UBO for viewPos
+	const std::vector<uint32_t>* sceneLightOffsets;		// Dynamic offset của light SSBO cho mỗi frame.
+	const VulkanFrameAllocator* frameAllocator;			// Buffer chung chứa Camera UBO (viewPos).
+	const std::vector<uint32_t>* uniformOffsets;		// Dynamic offset của Camera UBO cho mỗi frame.
 
 	// --- Shaders ---
 	std::string fragShaderFilePath;
@@ -82,7 +85,9 @@ private:
 	// --- Tài nguyên dành riêng cho pass ---
 	std::vector<VulkanDescriptor*> m_TextureDescriptors; // Descriptors cho G-Buffer đầu vào.
 	std::vector<VulkanDescriptor*> m_SceneLightDescriptors; // Descriptors cho Lighting đầu vào.
-	std::vector<VulkanDescriptor*> m_UboDescriptors;      // Descriptors cho Camera UBO.
+	const std::vector<uint32_t>* m_SceneLightOffsets;     // Dynamic offset của light SSBO cho mỗi frame.
+	VulkanDescriptor* m_UboDescriptor;                    // Descriptor cho Camera UBO (dynamic, dùng chung mọi frame).
+	const std::vector<uint32_t>* m_UniformOffsets;        // Dynamic offset của Camera UBO cho mỗi frame.
 	const std::vector<VulkanImage*>* m_OutputImages;      // Ảnh đầu ra.
 
 	// --- Hàm khởi tạo ---
@@ -93,7 +98,7 @@ private:
 		const std::vector<VulkanImage*>& gNormalTextures,
 		const std::vector<VulkanImage*>& gPositionTextures,
 		const VulkanSampler* vulkanSampler,
-		const std::vector<VulkanBuffer*>& uniformBuffers
+		const VulkanFrameAllocator* frameAllocator
 	);
 	
 	// Helper: Tạo pipeline đồ họa.
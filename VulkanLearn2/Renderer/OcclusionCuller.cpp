@@ -0,0 +1,315 @@
+#include "pch.h"
+#include "OcclusionCuller.h"
+#include "RenderProxyManager.h"
+#include "Core/JobSystem.h"
+#include "Scene/Scene.h"
+#include "Scene/Component.h"
+#include <limits>
+
+// SSE2 có sẵn trên mọi CPU x64 (MSVC không định nghĩa __SSE2__ cho x64).
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_CULLER_SSE
+#endif
+
+OcclusionCuller::OcclusionCuller(Scene* scene, JobSystem* jobSystem) :
+	m_Scene(scene),
+	m_JobSystem(jobSystem)
+{
+	// Cấp 0 là depth buffer, các cấp sau giảm một nửa mỗi chiều cho tới 1x1.
+	uint32_t levelCount = 1;
+	while (GetLevelWidth(levelCount - 1) > 1 || GetLevelHeight(levelCount - 1) > 1)
+	{
+		levelCount++;
+	}
+
+	m_DepthLevels.resize(levelCount);
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		m_DepthLevels[level].resize(GetLevelWidth(level) * GetLevelHeight(level), 1.0f);
+	}
+}
+
+void OcclusionCuller::Sync()
+{
+	m_Occluders.clear();
+
+	auto view = m_Scene->GetRegistry().view<TransformComponent, OccluderComponent>();
+	view.each([&](const TransformComponent& transform, const OccluderComponent& occluder)
+		{
+			const glm::mat4 model = transform.GetTransformMatrix();
+
+			OccluderBox& box = m_Occluders.emplace_back();
+			for (int i = 0; i < 8; i++)
+			{
+				const glm::vec3 sign((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+				box.corners[i] = glm::vec3(model * glm::vec4(occluder.Center + occluder.HalfExtents * sign, 1.0f));
+			}
+		}
+	);
+}
+
+void OcclusionCuller::RasterizeOccluders(const glm::mat4& viewProj)
+{
+	m_ViewProj = viewProj;
+	m_Triangles.clear();
+
+	// --- 1. Chiếu hộp occluder của các entity (thường chỉ có ít occluder lớn) ---
+	for (const OccluderBox& box : m_Occluders)
+	{
+		AddOccluderBox(box.corners);
+	}
+
+	// Không có occluder: CullOccluded không loại gì, không cần raster.
+	if (m_Triangles.empty()) return;
+
+	// --- 2. Raster song song, mỗi job sở hữu một dải hàng của depth buffer ---
+	m_JobSystem->ParallelFor(BAND_COUNT, [&](uint32_t jobIndex, uint32_t threadIndex)
+		{
+			RasterizeBand(jobIndex * BAND_HEIGHT, (jobIndex + 1) * BAND_HEIGHT);
+		}
+	);
+
+	// --- 3. Chuỗi mip depth xa nhất ---
+	BuildHierarchy();
+}
+
+void OcclusionCuller::CullOccluded(const RenderProxyBounds& bounds, std::vector<uint32_t>& proxyIndices) const
+{
+	if (m_Triangles.empty()) return;
+
+	auto occluded = [&](uint32_t proxyIndex)
+		{
+			const glm::vec3 center(bounds.centerX[proxyIndex], bounds.centerY[proxyIndex], bounds.centerZ[proxyIndex]);
+			return IsSphereOccluded(center, bounds.radius[proxyIndex]);
+		};
+	proxyIndices.erase(std::remove_if(proxyIndices.begin(), proxyIndices.end(), occluded), proxyIndices.end());
+}
+
+void OcclusionCuller::AddOccluderBox(const glm::vec3 (&corners)[8])
+{
+	// Hai tam giác cho mỗi mặt. Không cull mặt sau: depth nhỏ nhất vẫn là của các mặt trước,
+	// và không phụ thuộc vào chiều của trục Y sau phép chiếu.
+	static constexpr uint8_t BOX_INDICES[36] = {
+		0, 2, 1,	1, 2, 3,	// -Z
+		4, 5, 6,	5, 7, 6,	// +Z
+		0, 1, 4,	1, 5, 4,	// -Y
+		2, 6, 3,	3, 6, 7,	// +Y
+		0, 4, 2,	2, 4, 6,	// -X
+		1, 3, 5,	3, 7, 5		// +X
+	};
+
+	glm::vec3 screen[8];
+	for (int i = 0; i < 8; i++)
+	{
+		const glm::vec4 clip = m_ViewProj * glm::vec4(corners[i], 1.0f);
+
+		// Cắt mặt phẳng gần: bỏ cả occluder thay vì clip (bỏ occluder không bao giờ loại sai).
+		if (clip.w < NEAR_CLIP_W) return;
+
+		const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		screen[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * DEPTH_WIDTH, (ndc.y * 0.5f + 0.5f) * DEPTH_HEIGHT, ndc.z);
+	}
+
+	for (int i = 0; i < 36; i += 3)
+	{
+		ScreenTriangle triangle{};
+		triangle.vertices[0] = screen[BOX_INDICES[i]];
+		triangle.vertices[1] = screen[BOX_INDICES[i + 1]];
+		triangle.vertices[2] = screen[BOX_INDICES[i + 2]];
+
+		const glm::vec3& v0 = triangle.vertices[0];
+		const glm::vec3& v1 = triangle.vertices[1];
+		const glm::vec3& v2 = triangle.vertices[2];
+
+		// Mặt nhìn từ cạnh (diện tích 0) không phủ pixel nào.
+		const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+		if (std::abs(area) < 1e-6f) continue;
+
+		const float minX = std::min({ v0.x, v1.x, v2.x });
+		const float maxX = std::max({ v0.x, v1.x, v2.x });
+		const float minY = std::min({ v0.y, v1.y, v2.y });
+		const float maxY = std::max({ v0.y, v1.y, v2.y });
+		if (maxX < 0.0f || maxY < 0.0f || minX >= DEPTH_WIDTH || minY >= DEPTH_HEIGHT) continue;
+
+		triangle.minY = std::max(static_cast<int32_t>(std::floor(minY)), 0);
+		triangle.maxY = std::min(static_cast<int32_t>(std::floor(maxY)), static_cast<int32_t>(DEPTH_HEIGHT) - 1);
+		m_Triangles.push_back(triangle);
+	}
+}
+
+void OcclusionCuller::RasterizeBand(uint32_t firstRow, uint32_t endRow)
+{
+	float* depth = m_DepthLevels[0].data();
+	std::fill(depth + firstRow * DEPTH_WIDTH, depth + endRow * DEPTH_WIDTH, 1.0f);
+
+	for (const ScreenTriangle& triangle : m_Triangles)
+	{
+		if (triangle.maxY < static_cast<int32_t>(firstRow) || triangle.minY >= static_cast<int32_t>(endRow)) continue;
+
+		RasterizeTriangle(triangle,
+			std::max(triangle.minY, static_cast<int32_t>(firstRow)),
+			std::min(triangle.maxY + 1, static_cast<int32_t>(endRow)));
+	}
+}
+
+void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& triangle, int32_t firstRow, int32_t endRow)
+{
+	const glm::vec3& v0 = triangle.vertices[0];
+	const glm::vec3& v1 = triangle.vertices[1];
+	const glm::vec3& v2 = triangle.vertices[2];
+
+	// Tọa độ barycentric là hàm affine của (x, y): b = A * x + B * y + C. Chia cho diện tích nên
+	// điểm nằm trong tam giác có cả ba giá trị >= 0 với mọi chiều quay của tam giác.
+	const float inverseArea = 1.0f / ((v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x));
+	auto edge = [&](const glm::vec3& a, const glm::vec3& b)
+		{
+			return glm::vec3(
+				-(b.y - a.y) * inverseArea,
+				(b.x - a.x) * inverseArea,
+				((b.y - a.y) * a.x - (b.x - a.x) * a.y) * inverseArea);
+		};
+	const glm::vec3 e0 = edge(v1, v2);	// Trọng số của v0.
+	const glm::vec3 e1 = edge(v2, v0);	// Trọng số của v1.
+	const glm::vec3 e2 = edge(v0, v1);	// Trọng số của v2.
+
+	// Depth sau phép chia phối cảnh là affine trong không gian màn hình.
+	const glm::vec3 ez = e0 * v0.z + e1 * v1.z + e2 * v2.z;
+
+	// Lấy mẫu tại tâm pixel. Cột bắt đầu được làm tròn xuống bội số của 4 cho SSE (các pixel thừa bị loại bởi phép thử cạnh).
+	const int32_t minX = std::max(static_cast<int32_t>(std::floor(std::min({ v0.x, v1.x, v2.x }))), 0) & ~3;
+	const int32_t maxX = std::min(static_cast<int32_t>(std::floor(std::max({ v0.x, v1.x, v2.x }))), static_cast<int32_t>(DEPTH_WIDTH) - 1);
+
+	float* depth = m_DepthLevels[0].data();
+
+#if defined(OCCLUSION_CULLER_SSE)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 a0 = _mm_set1_ps(e0.x);
+	const __m128 a1 = _mm_set1_ps(e1.x);
+	const __m128 a2 = _mm_set1_ps(e2.x);
+	const __m128 az = _mm_set1_ps(ez.x);
+
+	for (int32_t y = firstRow; y < endRow; y++)
+	{
+		// Giá trị tại x = 0 của hàng, mỗi nhóm 4 pixel chỉ cần thêm A * x.
+		const float py = static_cast<float>(y) + 0.5f;
+		const __m128 row0 = _mm_set1_ps(e0.y * py + e0.z);
+		const __m128 row1 = _mm_set1_ps(e1.y * py + e1.z);
+		const __m128 row2 = _mm_set1_ps(e2.y * py + e2.z);
+		const __m128 rowZ = _mm_set1_ps(ez.y * py + ez.z);
+		float* depthRow = depth + y * DEPTH_WIDTH;
+
+		for (int32_t x = minX; x <= maxX; x += 4)
+		{
+			const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), pixelOffsets);
+			const __m128 b0 = _mm_add_ps(_mm_mul_ps(a0, px), row0);
+			const __m128 b1 = _mm_add_ps(_mm_mul_ps(a1, px), row1);
+			const __m128 b2 = _mm_add_ps(_mm_mul_ps(a2, px), row2);
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(b0, zero), _mm_cmpge_ps(b1, zero)), _mm_cmpge_ps(b2, zero));
+			if (_mm_movemask_ps(inside) == 0) continue;
+
+			const __m128 z = _mm_add_ps(_mm_mul_ps(az, px), rowZ);
+			const __m128 oldDepth = _mm_loadu_ps(depthRow + x);
+			const __m128 newDepth = _mm_min_ps(oldDepth, z);
+			_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, newDepth), _mm_andnot_ps(inside, oldDepth)));
+		}
+	}
+#else
+	for (int32_t y = firstRow; y < endRow; y++)
+	{
+		const float py = static_cast<float>(y) + 0.5f;
+		float* depthRow = depth + y * DEPTH_WIDTH;
+
+		for (int32_t x = minX; x <= maxX; x++)
+		{
+			const float px = static_cast<float>(x) + 0.5f;
+			if (e0.x * px + e0.y * py + e0.z < 0.0f) continue;
+			if (e1.x * px + e1.y * py + e1.z < 0.0f) continue;
+			if (e2.x * px + e2.y * py + e2.z < 0.0f) continue;
+
+			depthRow[x] = std::min(depthRow[x], ez.x * px + ez.y * py + ez.z);
+		}
+	}
+#endif
+}
+
+void OcclusionCuller::BuildHierarchy()
+{
+	for (uint32_t level = 1; level < m_DepthLevels.size(); level++)
+	{
+		const std::vector<float>& source = m_DepthLevels[level - 1];
+		std::vector<float>& destination = m_DepthLevels[level];
+		const uint32_t sourceWidth = GetLevelWidth(level - 1);
+		const uint32_t sourceHeight = GetLevelHeight(level - 1);
+		const uint32_t width = GetLevelWidth(level);
+		const uint32_t height = GetLevelHeight(level);
+
+		for (uint32_t y = 0; y < height; y++)
+		{
+			// Chiều đã bằng 1 thì không giảm nữa, hai hàng (cột) nguồn trùng nhau.
+			const uint32_t sourceY0 = std::min(y * 2, sourceHeight - 1);
+			const uint32_t sourceY1 = std::min(y * 2 + 1, sourceHeight - 1);
+			for (uint32_t x = 0; x < width; x++)
+			{
+				const uint32_t sourceX0 = std::min(x * 2, sourceWidth - 1);
+				const uint32_t sourceX1 = std::min(x * 2 + 1, sourceWidth - 1);
+				destination[y * width + x] = std::max({
+					source[sourceY0 * sourceWidth + sourceX0], source[sourceY0 * sourceWidth + sourceX1],
+					source[sourceY1 * sourceWidth + sourceX0], source[sourceY1 * sourceWidth + sourceX1] });
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::IsSphereOccluded(const glm::vec3& center, float radius) const
+{
+	// Chiếu 8 góc của hộp bao sphere: hình chữ nhật bao trên màn hình và depth gần nhất
+	// (depth tuyến tính theo khoảng cách nên điểm gần nhất của hộp là một góc).
+	glm::vec2 minScreen(std::numeric_limits<float>::max());
+	glm::vec2 maxScreen(-std::numeric_limits<float>::max());
+	float nearestDepth = 1.0f;
+	for (int i = 0; i < 8; i++)
+	{
+		const glm::vec3 sign((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f);
+		const glm::vec4 clip = m_ViewProj * glm::vec4(center + radius * sign, 1.0f);
+
+		// Sphere cắt mặt phẳng gần: luôn coi là nhìn thấy.
+		if (clip.w < NEAR_CLIP_W) return false;
+
+		const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		const glm::vec2 screen((ndc.x * 0.5f + 0.5f) * DEPTH_WIDTH, (ndc.y * 0.5f + 0.5f) * DEPTH_HEIGHT);
+		minScreen = glm::min(minScreen, screen);
+		maxScreen = glm::max(maxScreen, screen);
+		nearestDepth = std::min(nearestDepth, ndc.z);
+	}
+
+	// Nằm ngoài depth buffer: không có occluder nào ở đó.
+	if (maxScreen.x < 0.0f || maxScreen.y < 0.0f || minScreen.x >= DEPTH_WIDTH || minScreen.y >= DEPTH_HEIGHT) return false;
+
+	const int32_t x0 = std::clamp(static_cast<int32_t>(std::floor(minScreen.x)), 0, static_cast<int32_t>(DEPTH_WIDTH) - 1);
+	const int32_t x1 = std::clamp(static_cast<int32_t>(std::floor(maxScreen.x)), 0, static_cast<int32_t>(DEPTH_WIDTH) - 1);
+	const int32_t y0 = std::clamp(static_cast<int32_t>(std::floor(minScreen.y)), 0, static_cast<int32_t>(DEPTH_HEIGHT) - 1);
+	const int32_t y1 = std::clamp(static_cast<int32_t>(std::floor(maxScreen.y)), 0, static_cast<int32_t>(DEPTH_HEIGHT) - 1);
+
+	// Cấp mip đầu tiên mà hình chữ nhật chỉ phủ tối đa MAX_TEST_TEXELS texel mỗi chiều.
+	uint32_t level = 0;
+	while (level + 1 < m_DepthLevels.size() &&
+		((x1 >> level) - (x0 >> level) + 1 > static_cast<int32_t>(MAX_TEST_TEXELS) ||
+		 (y1 >> level) - (y0 >> level) + 1 > static_cast<int32_t>(MAX_TEST_TEXELS)))
+	{
+		level++;
+	}
+
+	// Bị che khi điểm gần nhất vẫn xa hơn occluder xa nhất trong vùng.
+	const std::vector<float>& depth = m_DepthLevels[level];
+	const uint32_t width = GetLevelWidth(level);
+	for (int32_t y = y0 >> level; y <= (y1 >> level); y++)
+	{
+		for (int32_t x = x0 >> level; x <= (x1 >> level); x++)
+		{
+			if (depth[y * width + x] >= nearestDepth) return false;
+		}
+	}
+	return true;
+}
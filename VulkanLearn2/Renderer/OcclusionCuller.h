@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+
+// Forward declarations
+struct RenderProxyBounds;
+class Scene;
+class JobSystem;
+
+// =================================================================================================
+// Class: OcclusionCuller
+// Mô tả:
+//      Occlusion culling phần mềm trên CPU, không cần đọc ngược dữ liệu từ GPU:
+//        1. Hộp occluder của các entity có OccluderComponent được chiếu bằng ma trận camera và raster
+//           vào một depth buffer nhỏ (DEPTH_WIDTH x DEPTH_HEIGHT). Buffer được chia thành các dải hàng,
+//           mỗi job của JobSystem raster mọi tam giác vào dải của mình (không cần khóa), mỗi lần tính
+//           4 pixel bằng SSE2.
+//        2. Từ depth buffer dựng một chuỗi mip (mỗi texel giữ depth xa nhất của 2x2 texel cấp dưới).
+//        3. Mỗi bounding sphere được chiếu thành hình chữ nhật trên màn hình kèm depth gần nhất, so với
+//           cấp mip mà hình chữ nhật chỉ phủ vài texel: bị che nếu gần nhất của sphere vẫn xa hơn
+//           depth xa nhất của occluder trong vùng đó.
+//      Depth [0, 1] không đảo (gần = nhỏ) nên chuỗi mip giữ giá trị lớn nhất, tương đương min-depth
+//      hierarchy của reversed-Z. Occluder hoặc sphere cắt mặt phẳng gần được bỏ qua (luôn an toàn).
+// =================================================================================================
+class OcclusionCuller
+{
+public:
+	static constexpr uint32_t DEPTH_WIDTH = 256;
+	static constexpr uint32_t DEPTH_HEIGHT = 128;
+
+	// Constructor: `scene` cung cấp các occluder, `jobSystem` dùng để raster song song.
+	OcclusionCuller(Scene* scene, JobSystem* jobSystem);
+
+	// Chép hộp occluder (world space) của các entity có OccluderComponent. Gọi mỗi frame khi registry không bị sửa
+	// (trong SimulationThread::Extract), trước RasterizeOccluders.
+	void Sync();
+
+	// Raster mọi occluder đã chép theo `viewProj` và dựng chuỗi mip. Gọi mỗi frame trước CullOccluded.
+	void RasterizeOccluders(const glm::mat4& viewProj);
+
+	// Loại khỏi `proxyIndices` (giữ nguyên thứ tự) các proxy có bounding sphere bị occluder che khuất hoàn toàn.
+	void CullOccluded(const RenderProxyBounds& bounds, std::vector<uint32_t>& proxyIndices) const;
+
+	// --- Getters ---
+	uint32_t GetOccluderTriangleCount() const { return static_cast<uint32_t>(m_Triangles.size()); }
+
+private:
+	// --- Cấu hình ---
+	static constexpr uint32_t BAND_HEIGHT = 16;							// Số hàng của mỗi dải (một job).
+	static constexpr uint32_t BAND_COUNT = DEPTH_HEIGHT / BAND_HEIGHT;
+	static constexpr uint32_t MAX_TEST_TEXELS = 4;						// Kích thước tối đa (texel) của hình chữ nhật khi test.
+	static constexpr float NEAR_CLIP_W = 1e-3f;							// Đỉnh có w nhỏ hơn được coi là cắt mặt phẳng gần.
+
+	static_assert(DEPTH_WIDTH % 4 == 0, "Mỗi hàng phải chia hết cho 4 pixel (SSE).");
+	static_assert(DEPTH_HEIGHT % BAND_HEIGHT == 0, "Depth buffer phải chia đều thành các dải.");
+
+	// 8 góc (world space) của hộp occluder, góc i: bit 0 chọn dấu của x, bit 1 của y, bit 2 của z.
+	struct OccluderBox
+	{
+		glm::vec3 corners[8];
+	};
+
+	// Tam giác đã chiếu: x, y theo pixel của depth buffer, z là depth [0, 1].
+	struct ScreenTriangle
+	{
+		glm::vec3 vertices[3];
+		int32_t minY;
+		int32_t maxY;
+	};
+
+	// --- Tham chiếu đến các tài nguyên bên ngoài ---
+	Scene* m_Scene;
+	JobSystem* m_JobSystem;
+
+	// --- Dữ liệu nội bộ ---
+	glm::mat4 m_ViewProj{ 1.0f };
+	std::vector<OccluderBox> m_Occluders;				// Bản chép của Sync, không đọc registry khi raster.
+	std::vector<ScreenTriangle> m_Triangles;			// Tam giác occluder của frame, giữ lại dung lượng giữa các frame.
+	std::vector<std::vector<float>> m_DepthLevels;		// Cấp 0 là depth buffer, cấp i + 1 là max của 2x2 texel cấp i.
+
+	// --- Hàm helper private ---
+
+	// Helper: Chiếu 12 tam giác của hộp occluder (8 góc đã biến đổi về world space) vào m_Triangles.
+	void AddOccluderBox(const glm::vec3 (&corners)[8]);
+
+	// Helper: Xóa và raster mọi tam giác vào các hàng [firstRow, endRow) của depth buffer.
+	void RasterizeBand(uint32_t firstRow, uint32_t endRow);
+
+	// Helper: Raster một tam giác vào các hàng [firstRow, endRow).
+	void RasterizeTriangle(const ScreenTriangle& triangle, int32_t firstRow, int32_t endRow);
+
+	// Helper: Dựng các cấp mip từ depth buffer.
+	void BuildHierarchy();
+
+	// Helper: Sphere (`center`, `radius`) có bị che khuất hoàn toàn không.
+	bool IsSphereOccluded(const glm::vec3& center, float radius) const;
+
+	static uint32_t GetLevelWidth(uint32_t level) { return std::max(DEPTH_WIDTH >> level, 1u); }
+	static uint32_t GetLevelHeight(uint32_t level) { return std::max(DEPTH_HEIGHT >> level, 1u); }
+};
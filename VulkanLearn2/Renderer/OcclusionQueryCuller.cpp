@@ -0,0 +1,181 @@
+#include "pch.h"
+#include "OcclusionQueryCuller.h"
+#include "RenderProxyManager.h"
+
+OcclusionQueryCuller::OcclusionQueryCuller(const VulkanHandles& vulkanHandles, uint32_t maxQueries, uint32_t maxFramesInFlight) :
+	m_VulkanHandles(vulkanHandles),
+	m_MaxQueries(maxQueries)
+{
+	VkQueryPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+	poolInfo.queryCount = m_MaxQueries;
+
+	m_Frames.resize(maxFramesInFlight);
+	for (FrameQueries& frame : m_Frames)
+	{
+		VK_CHECK(vkCreateQueryPool(m_VulkanHandles.device, &poolInfo, nullptr, &frame.queryPool), "LỖI: OcclusionQueryCuller: Tạo query pool thất bại!");
+		frame.queriedProxies.reserve(m_MaxQueries);
+		frame.boundingSpheres.reserve(m_MaxQueries);
+	}
+}
+
+OcclusionQueryCuller::~OcclusionQueryCuller()
+{
+	for (FrameQueries& frame : m_Frames)
+	{
+		vkDestroyQueryPool(m_VulkanHandles.device, frame.queryPool, nullptr);
+	}
+}
+
+void OcclusionQueryCuller::BeginFrame(uint32_t currentFrame, const RenderProxyManager& proxyManager, const glm::mat4& viewProj, const glm::vec3& cameraPosition)
+{
+	m_FrameNumber++;
+	m_CurrentFrame = currentFrame;
+	m_CameraPosition = cameraPosition;
+
+	// Mảng proxy vừa được dựng lại: chỉ số cũ trỏ tới proxy khác, bắt đầu lại từ trạng thái "nhìn thấy".
+	if (proxyManager.GetStructureVersion() != m_StructureVersion || m_States.size() != proxyManager.GetProxyCount())
+	{
+		m_StructureVersion = proxyManager.GetStructureVersion();
+		m_States.assign(proxyManager.GetProxyCount(), ProxyState{});
+	}
+
+	// GPU đã thực thi xong lần sử dụng trước của frame này, vùng query của nó được dùng lại.
+	FrameQueries& frame = m_Frames[currentFrame];
+	ReadResults(frame);
+
+	frame.queriedProxies.clear();
+	frame.boundingSpheres.clear();
+	frame.viewProj = viewProj;
+	frame.structureVersion = m_StructureVersion;
+	frame.recorded = false;
+}
+
+void OcclusionQueryCuller::CullOccluded(const RenderProxyManager& proxyManager, std::vector<uint32_t>& proxyIndices)
+{
+	const std::vector<RenderProxy>& proxies = proxyManager.GetProxies();
+	const RenderProxyBounds& bounds = proxyManager.GetBounds();
+	FrameQueries& frame = m_Frames[m_CurrentFrame];
+
+	size_t keptCount = 0;
+	for (uint32_t proxyIndex : proxyIndices)
+	{
+		ProxyState& state = m_States[proxyIndex];
+		const bool enteredFrustum = state.lastFrustumFrame + 1 != m_FrameNumber;
+		state.lastFrustumFrame = m_FrameNumber;
+
+		const glm::vec3 center(bounds.centerX[proxyIndex], bounds.centerY[proxyIndex], bounds.centerZ[proxyIndex]);
+		const float radius = bounds.radius[proxyIndex];
+
+		// Không đáng (hoặc không thể) query: luôn vẽ.
+		if (proxies[proxyIndex].indexCount < MIN_QUERY_INDEX_COUNT || IsCameraInside(center, radius))
+		{
+			state.visible = true;
+			proxyIndices[keptCount++] = proxyIndex;
+			continue;
+		}
+
+		// Kết quả cũ có thể đã lỗi thời khi proxy quay lại frustum: vẽ cho tới khi có kết quả mới.
+		if (enteredFrustum)
+		{
+			state.visible = true;
+			state.occludedStreak = 0;
+			if (state.nextQueryFrame != PENDING_QUERY)
+			{
+				state.nextQueryFrame = m_FrameNumber + proxyIndex % VISIBLE_QUERY_INTERVAL;
+			}
+		}
+
+		// Query đầy pool được dời sang các frame sau.
+		if (state.nextQueryFrame != PENDING_QUERY && m_FrameNumber >= state.nextQueryFrame && frame.queriedProxies.size() < m_MaxQueries)
+		{
+			frame.queriedProxies.push_back(proxyIndex);
+			frame.boundingSpheres.push_back(glm::vec4(center, radius));
+			state.nextQueryFrame = PENDING_QUERY;
+		}
+
+		if (state.visible)
+		{
+			proxyIndices[keptCount++] = proxyIndex;
+		}
+	}
+	proxyIndices.resize(keptCount);
+}
+
+void OcclusionQueryCuller::ResetQueries(VkCommandBuffer cmdBuffer, uint32_t currentFrame)
+{
+	FrameQueries& frame = m_Frames[currentFrame];
+	if (!frame.queriedProxies.empty())
+	{
+		vkCmdResetQueryPool(cmdBuffer, frame.queryPool, 0, static_cast<uint32_t>(frame.queriedProxies.size()));
+	}
+	frame.recorded = true;
+}
+
+void OcclusionQueryCuller::RecordQueries(VkCommandBuffer cmdBuffer, VkPipelineLayout pipelineLayout, uint32_t currentFrame) const
+{
+	const FrameQueries& frame = m_Frames[currentFrame];
+
+	vkCmdPushConstants(cmdBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+		offsetof(OcclusionQueryPushConstantData, viewProj), sizeof(glm::mat4), &frame.viewProj);
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(frame.queriedProxies.size()); i++)
+	{
+		vkCmdPushConstants(cmdBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+			offsetof(OcclusionQueryPushConstantData, boundingSphere), sizeof(glm::vec4), &frame.boundingSpheres[i]);
+
+		// Chỉ cần biết có sample nào qua depth test hay không, không cần số chính xác.
+		vkCmdBeginQuery(cmdBuffer, frame.queryPool, i, 0);
+		vkCmdDraw(cmdBuffer, BOX_VERTEX_COUNT, 1, 0, 0);
+		vkCmdEndQuery(cmdBuffer, frame.queryPool, i);
+	}
+}
+
+void OcclusionQueryCuller::ReadResults(FrameQueries& frame)
+{
+	const uint32_t queryCount = static_cast<uint32_t>(frame.queriedProxies.size());
+	if (queryCount == 0 || frame.structureVersion != m_StructureVersion) return;
+
+	// Không dùng VK_QUERY_RESULT_WAIT_BIT: query chưa có kết quả (hoặc chưa được ghi) không bao giờ làm CPU đợi.
+	if (frame.recorded)
+	{
+		m_Results.resize(queryCount * 2);
+		const VkResult result = vkGetQueryPoolResults(m_VulkanHandles.device, frame.queryPool, 0, queryCount,
+			m_Results.size() * sizeof(uint32_t), m_Results.data(), 2 * sizeof(uint32_t), VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		if (result != VK_SUCCESS && result != VK_NOT_READY)
+		{
+			throw std::runtime_error("LỖI: OcclusionQueryCuller: Đọc kết quả query thất bại (VkResult: " + std::to_string(result) + ")!");
+		}
+	}
+
+	for (uint32_t i = 0; i < queryCount; i++)
+	{
+		ProxyState& state = m_States[frame.queriedProxies[i]];
+
+		if (!frame.recorded || m_Results[i * 2 + 1] == 0)
+		{
+			// Không có kết quả: giữ trạng thái, query lại ngay.
+			state.nextQueryFrame = m_FrameNumber;
+		}
+		else if (m_Results[i * 2] > 0)
+		{
+			state.visible = true;
+			state.occludedStreak = 0;
+			state.nextQueryFrame = m_FrameNumber + VISIBLE_QUERY_INTERVAL;
+		}
+		else
+		{
+			state.visible = false;
+			state.occludedStreak = std::min(state.occludedStreak + 1, 8u);
+			state.nextQueryFrame = m_FrameNumber + std::min(1u << (state.occludedStreak - 1), MAX_OCCLUDED_QUERY_INTERVAL);
+		}
+	}
+}
+
+bool OcclusionQueryCuller::IsCameraInside(const glm::vec3& center, float radius) const
+{
+	const glm::vec3 offset = glm::abs(m_CameraPosition - center);
+	const float halfExtent = radius + CAMERA_MARGIN;
+	return offset.x <= halfExtent && offset.y <= halfExtent && offset.z <= halfExtent;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "Core/VulkanContext.h"
+#include <vector>
+
+// Forward declarations
+class RenderProxyManager;
+
+// =================================================================================================
+// Class: OcclusionQueryCuller
+// Mô tả:
+//      Occlusion culling bằng occlusion query phần cứng (đường ghi lệnh vẽ trên CPU), thay cho
+//      OcclusionCuller khi scene không có OccluderComponent: mọi vật lớn tự làm occluder cho nhau.
+//        - GeometryPass vẽ hộp bao (khối lập phương bao bounding sphere, không ghi màu/depth) của các proxy
+//          được lên lịch sau khi vẽ xong scene, mỗi hộp nằm trong một query của query pool của frame.
+//        - Kết quả được đọc ở lần sử dụng kế tiếp của frame đó (sau VulkanSyncManager::WaitForFrame), không
+//          đợi GPU: query chưa có kết quả chỉ được lên lịch lại. Mỗi frame-in-flight có một query pool riêng.
+//      Chính sách theo CHC++ (tận dụng tính liên tục giữa các frame):
+//        - Proxy nhìn thấy được vẽ và chỉ được query lại sau VISIBLE_QUERY_INTERVAL frame (lệch theo chỉ số proxy
+//          để số query chia đều giữa các frame).
+//        - Proxy bị che không được vẽ. Nó được query lại sau 1, 2, 4... frame (tối đa MAX_OCCLUDED_QUERY_INTERVAL),
+//          càng bị che lâu càng ít được test.
+//        - Proxy vừa vào frustum, nhỏ (ít index, vẽ rẻ hơn query) hoặc có hộp bao chứa camera (mặt gần bị cắt,
+//          query không đáng tin) luôn được coi là nhìn thấy.
+//      Đổi lại, proxy vừa lộ ra xuất hiện trễ vài frame (độ trễ của query cộng khoảng lịch).
+//      Trạng thái gắn với chỉ số proxy, được xóa khi RenderProxyManager dựng lại mảng proxy.
+// =================================================================================================
+class OcclusionQueryCuller
+{
+public:
+	// Constructor: Tạo một query pool `maxQueries` query cho mỗi frame-in-flight.
+	OcclusionQueryCuller(const VulkanHandles& vulkanHandles, uint32_t maxQueries, uint32_t maxFramesInFlight);
+	~OcclusionQueryCuller();
+
+	// Cấm sao chép.
+	OcclusionQueryCuller(const OcclusionQueryCuller&) = delete;
+	OcclusionQueryCuller& operator=(const OcclusionQueryCuller&) = delete;
+
+	// Đọc kết quả query của lần sử dụng trước của frame và cập nhật trạng thái các proxy.
+	// Gọi mỗi frame sau WaitForFrame và RenderProxyManager::Sync, trước CullOccluded.
+	void BeginFrame(uint32_t currentFrame, const RenderProxyManager& proxyManager, const glm::mat4& viewProj, const glm::vec3& cameraPosition);
+
+	// Loại khỏi `proxyIndices` (danh sách proxy trong frustum camera, giữ nguyên thứ tự) các proxy đang bị che,
+	// và lên lịch query của frame.
+	void CullOccluded(const RenderProxyManager& proxyManager, std::vector<uint32_t>& proxyIndices);
+
+	// Reset các query sẽ dùng trong frame. Ghi vào primary command buffer, bên ngoài vùng rendering.
+	void ResetQueries(VkCommandBuffer cmdBuffer, uint32_t currentFrame);
+
+	// Ghi lệnh vẽ hộp bao cho mọi query đã lên lịch, bên trong vùng rendering sau khi vẽ scene.
+	// Pipeline vẽ hộp bao phải đã được bind, `pipelineLayout` có push constant OcclusionQueryPushConstantData.
+	void RecordQueries(VkCommandBuffer cmdBuffer, VkPipelineLayout pipelineLayout, uint32_t currentFrame) const;
+
+	// --- Getters ---
+	uint32_t GetQueryCount(uint32_t currentFrame) const { return static_cast<uint32_t>(m_Frames[currentFrame].queriedProxies.size()); }
+
+private:
+	// --- Cấu hình ---
+	static constexpr uint32_t VISIBLE_QUERY_INTERVAL = 8;		// Số frame giữa hai lần query proxy nhìn thấy.
+	static constexpr uint32_t MAX_OCCLUDED_QUERY_INTERVAL = 4;	// Khoảng lịch tối đa của proxy bị che liên tục.
+	static constexpr uint32_t MIN_QUERY_INDEX_COUNT = 1536;		// Proxy ít index hơn luôn được vẽ (512 tam giác).
+	static constexpr float CAMERA_MARGIN = 0.1f;				// Nới hộp bao khi test camera nằm trong (lớn hơn near plane).
+	static constexpr uint32_t BOX_VERTEX_COUNT = 36;			// 12 tam giác, sinh trong OcclusionQuery_Shader.vert.
+
+	// Trạng thái temporal của một proxy.
+	struct ProxyState
+	{
+		uint32_t lastFrustumFrame = 0;		// Frame gần nhất proxy nằm trong frustum camera.
+		uint32_t nextQueryFrame = 0;		// Query lại từ frame này. PENDING_QUERY: đang đợi kết quả.
+		uint32_t occludedStreak = 0;		// Số kết quả "bị che" liên tiếp.
+		bool visible = true;
+	};
+	static constexpr uint32_t PENDING_QUERY = UINT32_MAX;
+
+	// Các query đã ghi trong một frame-in-flight.
+	struct FrameQueries
+	{
+		VkQueryPool queryPool = VK_NULL_HANDLE;
+		std::vector<uint32_t> queriedProxies;		// Query i test proxy queriedProxies[i].
+		std::vector<glm::vec4> boundingSpheres;		// Hộp bao của query i.
+		glm::mat4 viewProj{ 1.0f };
+		uint32_t structureVersion = 0;				// RenderProxyManager::GetStructureVersion lúc lên lịch.
+		bool recorded = false;						// GeometryPass đã reset và ghi các query (kết quả đọc được).
+	};
+
+	// --- Tham chiếu đến các tài nguyên bên ngoài ---
+	const VulkanHandles& m_VulkanHandles;
+
+	// --- Dữ liệu nội bộ ---
+	uint32_t m_MaxQueries;
+	uint32_t m_FrameNumber = 0;				// Tăng mỗi BeginFrame, dùng cho lịch query.
+	uint32_t m_CurrentFrame = 0;
+	uint32_t m_StructureVersion = 0;
+	glm::vec3 m_CameraPosition{ 0.0f };
+	std::vector<ProxyState> m_States;		// Một phần tử cho mỗi proxy.
+	std::vector<FrameQueries> m_Frames;		// Một phần tử cho mỗi frame-in-flight.
+	std::vector<uint32_t> m_Results;		// Bộ nhớ tạm: cặp (số sample, availability) của mỗi query.
+
+	// --- Hàm helper private ---
+
+	// Helper: Áp dụng kết quả các query đã ghi của `frame` vào trạng thái proxy.
+	void ReadResults(FrameQueries& frame);
+
+	// Helper: Camera có nằm trong hộp bao (đã nới) của sphere không.
+	bool IsCameraInside(const glm::vec3& center, float radius) const;
+};
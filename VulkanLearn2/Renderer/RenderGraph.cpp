@@ -0,0 +1,571 @@
+#include "pch.h"
+#include "RenderGraph.h"
+#include "IRenderPass.h"
+
+// Bộ (layout, stage, access) tương ứng với mỗi cách sử dụng image.
+struct RenderGraphUsageInfo
+{
+	VkImageLayout layout;
+	VkPipelineStageFlags2 stageMask;
+	VkAccessFlags2 accessMask;
+};
+
+static RenderGraphUsageInfo GetUsageInfo(RenderGraphUsage usage)
+{
+	switch (usage)
+	{
+	case RenderGraphUsage::ColorAttachment:
+		return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT };
+	case RenderGraphUsage::ColorAttachmentLoad:
+		return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT };
+	case RenderGraphUsage::DepthStencilAttachment:
+	case RenderGraphUsage::DepthStencilAttachmentLoad:
+		return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+	case RenderGraphUsage::DepthAttachment:
+		return { VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT };
+	case RenderGraphUsage::SampledFragment:
+		return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+	case RenderGraphUsage::StorageWriteCompute:
+		return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT };
+	case RenderGraphUsage::SampledCompute:
+		return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+	case RenderGraphUsage::Present:
+		// Việc trình chiếu được đồng bộ bằng semaphore, barrier chỉ cần chuyển layout.
+		return { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
+	}
+
+	throw std::runtime_error("LỖI: RenderGraphUsage không hợp lệ!");
+}
+
+// Usage ghi nhưng giữ nội dung cũ (loadOp LOAD): với việc cull pass, đây cũng là một lần đọc.
+static bool PreservesContents(RenderGraphUsage usage)
+{
+	return usage == RenderGraphUsage::ColorAttachmentLoad || usage == RenderGraphUsage::DepthStencilAttachmentLoad;
+}
+
+// Usage có thể thực hiện trên compute queue (không cần graphics pipeline).
+static bool IsComputeUsage(RenderGraphUsage usage)
+{
+	return usage == RenderGraphUsage::StorageWriteCompute || usage == RenderGraphUsage::SampledCompute;
+}
+
+RenderGraph::RenderGraph(const VulkanHandles& vulkanHandles, uint32_t frameCount) :
+	m_VulkanHandles(vulkanHandles),
+	m_FrameCount(frameCount)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	// Hủy các image trước, sau đó mới giải phóng vùng nhớ mà chúng alias.
+	for (auto& resource : m_Resources)
+	{
+		for (VulkanImage* image : resource.images)
+		{
+			delete(image);
+		}
+	}
+
+	for (auto& slot : m_MemorySlots)
+	{
+		for (VmaAllocation allocation : slot.allocations)
+		{
+			vmaFreeMemory(m_VulkanHandles.allocator, allocation);
+		}
+	}
+}
+
+RenderGraphResource RenderGraph::CreateImage(const std::string& name, const VulkanImageCreateInfo& imageCI, const VulkanImageViewCreateInfo& imageViewCI)
+{
+	CheckNotCompiled();
+
+	ResourceNode resource{};
+	resource.name = name;
+	resource.type = ResourceType::Transient;
+	resource.aspectFlags = imageViewCI.aspectFlags;
+	resource.imageCI = imageCI;
+	resource.imageViewCI = imageViewCI;
+
+	m_Resources.push_back(std::move(resource));
+	return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::ImportImageList(const std::string& name, ImageListGetter getter, VkImageAspectFlags aspectFlags)
+{
+	CheckNotCompiled();
+
+	ResourceNode resource{};
+	resource.name = name;
+	resource.type = ResourceType::ImportedList;
+	resource.aspectFlags = aspectFlags;
+	resource.getter = std::move(getter);
+
+	m_Resources.push_back(std::move(resource));
+	return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+RenderGraphResource RenderGraph::ImportSwapchain(const std::string& name, const std::vector<VkImage>* swapchainImages)
+{
+	CheckNotCompiled();
+
+	ResourceNode resource{};
+	resource.name = name;
+	resource.type = ResourceType::Swapchain;
+	resource.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+	resource.swapchainImages = swapchainImages;
+
+	m_Resources.push_back(std::move(resource));
+	return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+}
+
+void RenderGraph::MarkOutput(RenderGraphResource resource, RenderGraphUsage finalUsage)
+{
+	CheckNotCompiled();
+
+	m_Resources[resource].isOutput = true;
+	m_Resources[resource].finalUsage = finalUsage;
+}
+
+void RenderGraph::MarkSideEffects(RenderGraphPass pass)
+{
+	CheckNotCompiled();
+
+	m_Passes[pass].hasSideEffects = true;
+}
+
+RenderGraphPass RenderGraph::AddPass(const std::string& name, QueueType queue)
+{
+	CheckNotCompiled();
+
+	PassNode pass{};
+	pass.name = name;
+	pass.queue = queue;
+
+	m_Passes.push_back(std::move(pass));
+	return static_cast<RenderGraphPass>(m_Passes.size() - 1);
+}
+
+void RenderGraph::Read(RenderGraphPass pass, RenderGraphResource resource, RenderGraphUsage usage)
+{
+	AddAccess(pass, resource, usage, false);
+}
+
+void RenderGraph::Write(RenderGraphPass pass, RenderGraphResource resource, RenderGraphUsage usage)
+{
+	AddAccess(pass, resource, usage, true);
+}
+
+void RenderGraph::AddAccess(RenderGraphPass pass, RenderGraphResource resource, RenderGraphUsage usage, bool isWrite)
+{
+	CheckNotCompiled();
+
+	if (usage == RenderGraphUsage::Present)
+	{
+		throw std::runtime_error("LỖI: RenderGraph: Present chỉ được dùng làm trạng thái cuối qua MarkOutput!");
+	}
+
+	if (m_Passes[pass].queue == QueueType::Compute && !IsComputeUsage(usage))
+	{
+		throw std::runtime_error("LỖI: RenderGraph: Pass compute '" + m_Passes[pass].name + "' chỉ được dùng các usage của compute shader!");
+	}
+
+	m_Passes[pass].accesses.push_back({ resource, usage, isWrite });
+}
+
+void RenderGraph::Compile()
+{
+	CheckNotCompiled();
+
+	CullPasses();
+	BuildSubmissions();
+	AllocateTransientImages();
+	BuildBarriers();
+
+	m_Compiled = true;
+}
+
+void RenderGraph::SetPassExecutor(RenderGraphPass pass, IRenderPass* executor)
+{
+	m_Passes[pass].executor = executor;
+}
+
+const std::vector<VulkanImage*>& RenderGraph::GetImages(RenderGraphResource resource) const
+{
+	const ResourceNode& node = m_Resources[resource];
+	if (node.type != ResourceType::Transient || node.images.empty())
+	{
+		throw std::runtime_error("LỖI: RenderGraph: Tài nguyên '" + node.name + "' không phải image tạm đã được tạo (chưa Compile hoặc không được pass nào sử dụng)!");
+	}
+	return node.images;
+}
+
+void RenderGraph::ExecuteSubmission(uint32_t submission, const VkCommandBuffer& cmdBuffer, uint32_t imageIndex, uint32_t currentFrame)
+{
+	for (int passIndex = m_Submissions[submission].firstPass; passIndex < m_Submissions[submission].endPass; passIndex++)
+	{
+		const PassNode& pass = m_Passes[passIndex];
+		if (!pass.active) continue;
+
+		if (pass.executor == nullptr)
+		{
+			throw std::runtime_error("LỖI: RenderGraph: Pass '" + pass.name + "' chưa được gắn executor!");
+		}
+
+		RecordBarriers(cmdBuffer, pass.barriers, imageIndex, currentFrame);
+		pass.executor->Execute(&cmdBuffer, imageIndex, currentFrame);
+	}
+
+	// Chuyển các output sang trạng thái cuối (ví dụ: PRESENT_SRC cho swapchain).
+	if (submission + 1 == m_Submissions.size())
+	{
+		RecordBarriers(cmdBuffer, m_FinalBarriers, imageIndex, currentFrame);
+	}
+}
+
+void RenderGraph::CullPasses()
+{
+	// Duyệt ngược: một pass chỉ cần thiết nếu nó ghi vào tài nguyên mà một pass cần thiết phía sau
+	// (hoặc output của frame) sẽ đọc. Lệnh ghi xóa nội dung cũ, nên các pass ghi trước đó
+	// chỉ cần thiết nếu có pass đọc nằm giữa.
+	std::vector<bool> needed(m_Resources.size(), false);
+	for (size_t i = 0; i < m_Resources.size(); i++)
+	{
+		needed[i] = m_Resources[i].isOutput;
+	}
+
+	for (int passIndex = static_cast<int>(m_Passes.size()) - 1; passIndex >= 0; passIndex--)
+	{
+		PassNode& pass = m_Passes[passIndex];
+
+		pass.active = pass.hasSideEffects;
+		for (const auto& access : pass.accesses)
+		{
+			if (access.isWrite && needed[access.resource])
+			{
+				pass.active = true;
+			}
+		}
+
+		if (!pass.active)
+		{
+			Log::Info("RenderGraph: Loại bỏ pass '" + pass.name + "' vì đầu ra không được sử dụng.");
+			continue;
+		}
+
+		for (const auto& access : pass.accesses)
+		{
+			if (access.isWrite) needed[access.resource] = false;
+		}
+		for (const auto& access : pass.accesses)
+		{
+			if (!access.isWrite || PreservesContents(access.usage)) needed[access.resource] = true;
+		}
+	}
+}
+
+void RenderGraph::BuildSubmissions()
+{
+	// Không có compute queue riêng: mọi pass chạy trên graphics queue, đồ thị chỉ còn một submission.
+	const bool asyncCompute = m_VulkanHandles.HasAsyncCompute();
+
+	std::vector<bool> usedOnGraphics(m_Resources.size(), false);
+	std::vector<bool> usedOnCompute(m_Resources.size(), false);
+	bool foundSwapchain = false;
+
+	for (int passIndex = 0; passIndex < static_cast<int>(m_Passes.size()); passIndex++)
+	{
+		PassNode& pass = m_Passes[passIndex];
+		if (!pass.active) continue;
+
+		if (!asyncCompute) pass.queue = QueueType::Graphics;
+
+		if (m_Submissions.empty() || m_Submissions.back().queue != pass.queue)
+		{
+			m_Submissions.push_back({ pass.queue, passIndex, passIndex + 1 });
+		}
+		else
+		{
+			m_Submissions.back().endPass = passIndex + 1;
+		}
+
+		for (const auto& access : pass.accesses)
+		{
+			const ResourceNode& resource = m_Resources[access.resource];
+			if (pass.queue == QueueType::Compute) usedOnCompute[access.resource] = true;
+			else usedOnGraphics[access.resource] = true;
+
+			if (resource.type == ResourceType::Swapchain && !foundSwapchain)
+			{
+				foundSwapchain = true;
+				m_PresentSubmission = static_cast<uint32_t>(m_Submissions.size()) - 1;
+			}
+		}
+	}
+
+	for (RenderGraphResource i = 0; i < m_Resources.size(); i++)
+	{
+		ResourceNode& resource = m_Resources[i];
+		if (!usedOnCompute[i]) continue;
+
+		// Image import được tạo với VK_SHARING_MODE_EXCLUSIVE cho graphics queue family.
+		if (resource.type != ResourceType::Transient)
+		{
+			throw std::runtime_error("LỖI: RenderGraph: Tài nguyên import '" + resource.name + "' không thể được dùng trên compute queue!");
+		}
+
+		// Image dùng trên cả hai queue được tạo ở chế độ CONCURRENT, không cần chuyển quyền sở hữu queue family.
+		if (usedOnGraphics[i])
+		{
+			resource.imageCI.shareWithComputeQueue = true;
+		}
+	}
+
+	// Barrier chuyển output sang trạng thái cuối (PRESENT_SRC) được ghi ở cuối submission cuối cùng.
+	if (!m_Submissions.empty() && m_Submissions.back().queue == QueueType::Compute)
+	{
+		throw std::runtime_error("LỖI: RenderGraph: Pass cuối cùng của đồ thị phải chạy trên graphics queue!");
+	}
+
+	size_t computeSubmissionCount = std::count_if(m_Submissions.begin(), m_Submissions.end(),
+		[](const Submission& submission) { return submission.queue == QueueType::Compute; });
+	Log::Info("RenderGraph: " + std::to_string(m_Submissions.size()) + " lần submit mỗi frame (" + std::to_string(computeSubmissionCount) + " trên compute queue).");
+}
+
+void RenderGraph::AllocateTransientImages()
+{
+	// --- 1. Tính thời gian sống (theo chỉ số pass) của mỗi tài nguyên ---
+	for (int passIndex = 0; passIndex < static_cast<int>(m_Passes.size()); passIndex++)
+	{
+		if (!m_Passes[passIndex].active) continue;
+
+		for (const auto& access : m_Passes[passIndex].accesses)
+		{
+			ResourceNode& resource = m_Resources[access.resource];
+			if (resource.firstPass == -1) resource.firstPass = passIndex;
+			resource.lastPass = passIndex;
+		}
+	}
+
+	// --- 2. Gán vùng nhớ: xếp các image tạm theo thời điểm bắt đầu sống ---
+	std::vector<RenderGraphResource> transientResources;
+	for (RenderGraphResource i = 0; i < m_Resources.size(); i++)
+	{
+		if (m_Resources[i].type == ResourceType::Transient && m_Resources[i].firstPass != -1)
+		{
+			transientResources.push_back(i);
+		}
+	}
+	std::stable_sort(transientResources.begin(), transientResources.end(),
+		[this](RenderGraphResource a, RenderGraphResource b) { return m_Resources[a].firstPass < m_Resources[b].firstPass; });
+
+	VkDeviceSize requestedSize = 0;
+	for (RenderGraphResource resourceIndex : transientResources)
+	{
+		ResourceNode& resource = m_Resources[resourceIndex];
+		VkMemoryRequirements requirements = VulkanImage::GetMemoryRequirements(m_VulkanHandles, resource.imageCI);
+		requestedSize += requirements.size;
+
+		// Chọn vùng nhớ đã rảnh (image trước đó đã hết thời gian sống) có kích thước gần nhất.
+		int bestSlot = -1;
+		VkDeviceSize bestDifference = 0;
+		for (int slotIndex = 0; slotIndex < static_cast<int>(m_MemorySlots.size()); slotIndex++)
+		{
+			const MemorySlot& slot = m_MemorySlots[slotIndex];
+			if (m_Resources[slot.lastResource].lastPass >= resource.firstPass) continue;
+			if ((slot.requirements.memoryTypeBits & requirements.memoryTypeBits) == 0) continue;
+
+			VkDeviceSize difference = slot.requirements.size > requirements.size
+				? slot.requirements.size - requirements.size
+				: requirements.size - slot.requirements.size;
+			if (bestSlot == -1 || difference < bestDifference)
+			{
+				bestSlot = slotIndex;
+				bestDifference = difference;
+			}
+		}
+
+		if (bestSlot == -1)
+		{
+			MemorySlot slot{};
+			slot.requirements = requirements;
+			m_MemorySlots.push_back(slot);
+			bestSlot = static_cast<int>(m_MemorySlots.size()) - 1;
+		}
+		else
+		{
+			MemorySlot& slot = m_MemorySlots[bestSlot];
+			slot.requirements.size = std::max(slot.requirements.size, requirements.size);
+			slot.requirements.alignment = std::max(slot.requirements.alignment, requirements.alignment);
+			slot.requirements.memoryTypeBits &= requirements.memoryTypeBits;
+			resource.aliasPredecessor = static_cast<int>(slot.lastResource);
+		}
+
+		resource.memorySlot = bestSlot;
+		m_MemorySlots[bestSlot].lastResource = resourceIndex;
+	}
+
+	// --- 3. Cấp phát vùng nhớ cho mỗi frame-in-flight ---
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+	VkDeviceSize allocatedSize = 0;
+	for (auto& slot : m_MemorySlots)
+	{
+		allocatedSize += slot.requirements.size;
+		slot.allocations.resize(m_FrameCount);
+		for (uint32_t frame = 0; frame < m_FrameCount; frame++)
+		{
+			VK_CHECK(vmaAllocateMemory(m_VulkanHandles.allocator, &slot.requirements, &allocInfo, &slot.allocations[frame], nullptr),
+				"LỖI: RenderGraph: Cấp phát bộ nhớ cho image tạm thất bại!");
+		}
+	}
+
+	// --- 4. Tạo image tạm trên vùng nhớ đã gán ---
+	for (RenderGraphResource resourceIndex : transientResources)
+	{
+		ResourceNode& resource = m_Resources[resourceIndex];
+		resource.images.resize(m_FrameCount);
+		for (uint32_t frame = 0; frame < m_FrameCount; frame++)
+		{
+			resource.images[frame] = new VulkanImage(m_VulkanHandles, resource.imageCI, resource.imageViewCI,
+				m_MemorySlots[resource.memorySlot].allocations[frame]);
+		}
+	}
+
+	Log::Info("RenderGraph: " + std::to_string(transientResources.size()) + " image tạm dùng chung " + std::to_string(m_MemorySlots.size())
+		+ " vùng nhớ (" + std::to_string(allocatedSize / (1024 * 1024)) + "MB thay vì " + std::to_string(requestedSize / (1024 * 1024)) + "MB mỗi frame).");
+}
+
+void RenderGraph::BuildBarriers()
+{
+	std::vector<VulkanImageState> states(m_Resources.size());
+
+	for (size_t submissionIndex = 0; submissionIndex < m_Submissions.size(); submissionIndex++)
+	{
+		const Submission& submission = m_Submissions[submissionIndex];
+
+		// Submission này chờ (semaphore, stage ALL_COMMANDS) submission trước, vốn đã chờ các submission trước nữa:
+		// mọi truy cập trước đó đã hoàn thành và hiển thị. Lệnh ghi hoặc chuyển layout chỉ cần nối tiếp
+		// lần chờ semaphore, các lần đọc không đổi layout không cần barrier.
+		if (submissionIndex > 0)
+		{
+			for (RenderGraphResource i = 0; i < m_Resources.size(); i++)
+			{
+				if (m_Resources[i].firstPass == -1 || m_Resources[i].firstPass >= submission.firstPass) continue;
+
+				states[i].writeStageMask = VK_PIPELINE_STAGE_2_NONE;
+				states[i].writeAccessMask = VK_ACCESS_2_NONE;
+				states[i].readStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			}
+		}
+
+		for (int passIndex = submission.firstPass; passIndex < submission.endPass; passIndex++)
+		{
+			PassNode& pass = m_Passes[passIndex];
+			if (!pass.active) continue;
+
+			for (const auto& access : pass.accesses)
+			{
+				const ResourceNode& resource = m_Resources[access.resource];
+				VulkanImageState& state = states[access.resource];
+
+				if (resource.firstPass == passIndex)
+				{
+					if (!access.isWrite || PreservesContents(access.usage))
+					{
+						throw std::runtime_error("LỖI: RenderGraph: Tài nguyên '" + resource.name + "' được pass '" + pass.name + "' đọc trước khi được ghi!");
+					}
+
+					// Swapchain image chỉ sẵn sàng khi semaphore acquire (đợi ở COLOR_ATTACHMENT_OUTPUT) được báo hiệu,
+					// barrier chuyển layout phải nối tiếp stage đó thay vì TOP_OF_PIPE.
+					if (resource.type == ResourceType::Swapchain)
+					{
+						state.writeStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+					}
+
+					// Image dùng lại vùng nhớ của image trước: phải đợi mọi truy cập của image đó kết thúc.
+					if (resource.aliasPredecessor != -1)
+					{
+						const VulkanImageState& predecessorState = states[resource.aliasPredecessor];
+						state.writeStageMask = predecessorState.writeStageMask | predecessorState.readStageMask;
+						state.writeAccessMask = predecessorState.writeAccessMask;
+					}
+				}
+
+				AppendBarrier(pass.barriers, access.resource, state, access.usage, access.isWrite && !PreservesContents(access.usage));
+			}
+		}
+	}
+
+	// Chuyển các output sang trạng thái cuối sau pass cuối cùng.
+	for (RenderGraphResource i = 0; i < m_Resources.size(); i++)
+	{
+		if (m_Resources[i].isOutput && m_Resources[i].firstPass != -1)
+		{
+			AppendBarrier(m_FinalBarriers, i, states[i], m_Resources[i].finalUsage, false);
+		}
+	}
+}
+
+void RenderGraph::AppendBarrier(std::vector<ImageBarrierInfo>& barriers, RenderGraphResource resource, VulkanImageState& state, RenderGraphUsage usage, bool discardContents)
+{
+	const RenderGraphUsageInfo usageInfo = GetUsageInfo(usage);
+
+	ImageBarrierInfo info{};
+	info.resource = resource;
+
+	// Lệnh ghi xóa toàn bộ nội dung (loadOp CLEAR, imageStore toàn bộ): oldLayout UNDEFINED.
+	if (VulkanBarrierBatch::ResolveTransition(state, usageInfo.layout, usageInfo.stageMask, usageInfo.accessMask, discardContents, info.barrier))
+	{
+		barriers.push_back(info);
+	}
+}
+
+void RenderGraph::RecordBarriers(const VkCommandBuffer& cmdBuffer, const std::vector<ImageBarrierInfo>& barriers, uint32_t imageIndex, uint32_t currentFrame)
+{
+	for (const auto& info : barriers)
+	{
+		const ResourceNode& resource = m_Resources[info.resource];
+		const VkImageMemoryBarrier2& barrier = info.barrier;
+
+		// Xác định image thật của frame hiện tại.
+		switch (resource.type)
+		{
+		case ResourceType::Transient:
+			AddResolvedBarrier(barrier, resource.images[currentFrame]->GetHandles().image, resource.aspectFlags);
+			break;
+		case ResourceType::ImportedList:
+			for (const VulkanImage* image : resource.getter(currentFrame))
+			{
+				AddResolvedBarrier(barrier, image->GetHandles().image, resource.aspectFlags);
+			}
+			break;
+		case ResourceType::Swapchain:
+			AddResolvedBarrier(barrier, (*resource.swapchainImages)[imageIndex], resource.aspectFlags);
+			break;
+		}
+	}
+
+	m_BarrierBatch.Flush(cmdBuffer);
+}
+
+void RenderGraph::AddResolvedBarrier(const VkImageMemoryBarrier2& barrier, VkImage image, VkImageAspectFlags aspectFlags)
+{
+	m_BarrierBatch.AddImageBarrier(image, aspectFlags,
+		barrier.oldLayout, barrier.newLayout,
+		barrier.srcStageMask, barrier.srcAccessMask,
+		barrier.dstStageMask, barrier.dstAccessMask);
+}
+
+void RenderGraph::CheckNotCompiled() const
+{
+	if (m_Compiled)
+	{
+		throw std::runtime_error("LỖI: RenderGraph: Không thể thay đổi đồ thị sau khi đã Compile!");
+	}
+}
@@ -0,0 +1,247 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include "Core/VulkanBarrierBatch.h"
+
+// Forward declarations
+class IRenderPass;
+
+// Handle của một tài nguyên / một pass trong RenderGraph (chỉ số trong danh sách khai báo).
+using RenderGraphResource = uint32_t;
+using RenderGraphPass = uint32_t;
+
+// =================================================================================================
+// Enum: RenderGraphUsage
+// Mô tả: Cách một pass sử dụng một image. Mỗi usage tương ứng với một bộ (layout, stage, access)
+//        cố định, RenderGraph dựa vào đó để tự tính barrier giữa các pass.
+// =================================================================================================
+enum class RenderGraphUsage
+{
+	ColorAttachment,		// Ghi làm color attachment (loadOp CLEAR, nội dung cũ bị bỏ).
+	DepthStencilAttachment,	// Ghi làm depth/stencil attachment (loadOp CLEAR).
+	DepthAttachment,		// Ghi làm depth attachment không có stencil (loadOp CLEAR).
+	ColorAttachmentLoad,	// Vẽ tiếp vào color attachment (loadOp LOAD, giữ nội dung của pass trước).
+	DepthStencilAttachmentLoad,	// Vẽ tiếp vào depth/stencil attachment (loadOp LOAD).
+	SampledFragment,		// Đọc qua sampler trong fragment shader.
+	StorageWriteCompute,	// Ghi toàn bộ image bằng imageStore trong compute shader (layout GENERAL, nội dung cũ bị bỏ).
+	SampledCompute,			// Đọc qua sampler trong compute shader.
+	Present					// Trạng thái cuối để trình chiếu (chỉ dùng với MarkOutput).
+};
+
+// =================================================================================================
+// Class: RenderGraph
+// Mô tả:
+//      Đồ thị render tĩnh của một frame. Các pass khai báo image mà chúng đọc/ghi, sau đó Compile():
+//        1. Loại bỏ (cull) các pass có đầu ra không được pass nào dùng tới và không phải output.
+//        2. Tính thời gian sống của các image tạm (transient) và cho các image không chồng lấn
+//           thời gian sống dùng chung vùng nhớ (aliasing) để tiết kiệm bộ nhớ attachment.
+//        3. Tính trước toàn bộ barrier: mỗi pass chỉ phát một vkCmdPipelineBarrier2 đã gộp,
+//           mỗi image barrier mang stage mask riêng (synchronization2) thay vì OR chung cả lệnh,
+//           bỏ qua các barrier thừa (ví dụ: hai pass liên tiếp cùng đọc một image).
+//        4. Chia các pass thành các lần submit (submission): mỗi dãy pass liên tiếp cùng queue là một
+//           submission. Pass khai báo QueueType::Compute chạy trên compute queue (async compute),
+//           các submission nối tiếp nhau bằng timeline semaphore (submission i chờ submission i - 1).
+//      Đồ thị được compile một lần khi khởi tạo, ExecuteSubmission() mỗi frame chỉ ghi barrier và gọi pass.
+//      Image tạm được tạo cho mỗi frame-in-flight, aliasing chỉ diễn ra giữa các image cùng frame.
+//      LƯU Ý: Lần truy cập đầu tiên của mỗi image trong frame phải là lệnh ghi xóa toàn bộ nội dung
+//             (nội dung từ frame trước không được giữ lại). Usage *Load vừa đọc vừa ghi nên không thể là lần đầu.
+//             Mọi lần chờ semaphore giữa các submission phải dùng stage ALL_COMMANDS: barrier đầu tiên
+//             của một image trong submission mới nối tiếp stage đó.
+// =================================================================================================
+class RenderGraph
+{
+public:
+	// Hàm trả về danh sách image của một tài nguyên import cho frame `currentFrame`.
+	using ImageListGetter = std::function<const std::vector<VulkanImage*>& (uint32_t currentFrame)>;
+
+	// Constructor: Khởi tạo đồ thị rỗng.
+	// Tham số:
+	//      frameCount: Số frame-in-flight (số bản sao của mỗi image tạm).
+	RenderGraph(const VulkanHandles& vulkanHandles, uint32_t frameCount);
+
+	// Destructor: Giải phóng các image tạm và vùng nhớ aliasing.
+	~RenderGraph();
+
+	// Cấm sao chép.
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	// --- Khai báo tài nguyên (trước Compile) ---
+
+	// Khai báo một image tạm do RenderGraph sở hữu, được tạo trong Compile().
+	RenderGraphResource CreateImage(const std::string& name, const VulkanImageCreateInfo& imageCI, const VulkanImageViewCreateInfo& imageViewCI);
+
+	// Import một danh sách image do hệ thống khác sở hữu (ví dụ: shadow map của LightManager).
+	// Mọi image trong danh sách được chuyển layout cùng nhau.
+	RenderGraphResource ImportImageList(const std::string& name, ImageListGetter getter, VkImageAspectFlags aspectFlags);
+
+	// Import các image của swapchain, image được chọn theo imageIndex khi Execute.
+	RenderGraphResource ImportSwapchain(const std::string& name, const std::vector<VkImage>* swapchainImages);
+
+	// Đánh dấu tài nguyên là đầu ra của frame: các pass ghi vào nó không bị cull,
+	// và sau pass cuối cùng image được chuyển sang trạng thái `finalUsage`.
+	void MarkOutput(RenderGraphResource resource, RenderGraphUsage finalUsage);
+
+	// --- Khai báo pass (trước Compile, theo đúng thứ tự thực thi) ---
+
+	// `queue`: QueueType::Compute cho pass chỉ dùng compute shader, muốn chạy trên compute queue riêng.
+	// Nếu GPU không có compute queue riêng, pass được chạy trên graphics queue như bình thường.
+	RenderGraphPass AddPass(const std::string& name, QueueType queue = QueueType::Graphics);
+	void Read(RenderGraphPass pass, RenderGraphResource resource, RenderGraphUsage usage);
+	void Write(RenderGraphPass pass, RenderGraphResource resource, RenderGraphUsage usage);
+
+	// Đánh dấu pass có tác dụng phụ ngoài các image của đồ thị (ví dụ: ghi buffer lệnh vẽ indirect):
+	// pass luôn được giữ lại khi cull. Pass tự chịu trách nhiệm đồng bộ các tài nguyên đó.
+	void MarkSideEffects(RenderGraphPass pass);
+
+	// Cull pass, tạo image tạm (có aliasing) và tính trước barrier cho từng pass.
+	void Compile();
+
+	// --- Sau Compile ---
+
+	// Gắn đối tượng thực thi cho pass. Pass bị cull không cần executor.
+	void SetPassExecutor(RenderGraphPass pass, IRenderPass* executor);
+
+	// Lấy các image tạm (một image cho mỗi frame-in-flight). Địa chỉ vector ổn định sau Compile.
+	const std::vector<VulkanImage*>& GetImages(RenderGraphResource resource) const;
+
+	// Pass có được giữ lại sau khi cull hay không.
+	bool IsPassActive(RenderGraphPass pass) const { return m_Passes[pass].active; }
+
+	// --- Submission ---
+
+	// Số lần submit mỗi frame. Hai submission liên tiếp luôn ở hai queue khác nhau.
+	uint32_t GetSubmissionCount() const { return static_cast<uint32_t>(m_Submissions.size()); }
+
+	// Queue mà submission `submission` phải được submit lên.
+	QueueType GetSubmissionQueue(uint32_t submission) const { return m_Submissions[submission].queue; }
+
+	// Chỉ số submission đầu tiên dùng swapchain image (0 nếu đồ thị không dùng swapchain).
+	// Các submission trước nó không cần imageIndex, có thể được submit trước khi acquire swapchain image.
+	uint32_t GetPresentSubmission() const { return m_PresentSubmission; }
+
+	// Ghi barrier và lệnh của mọi pass trong submission `submission` vào command buffer.
+	// Submission cuối cùng ghi thêm barrier chuyển các output sang trạng thái cuối.
+	void ExecuteSubmission(uint32_t submission, const VkCommandBuffer& cmdBuffer, uint32_t imageIndex, uint32_t currentFrame);
+
+private:
+	enum class ResourceType
+	{
+		Transient,		// Do RenderGraph tạo và sở hữu.
+		ImportedList,	// Danh sách image do hệ thống khác sở hữu.
+		Swapchain		// Image swapchain, chọn theo imageIndex.
+	};
+
+	struct ResourceNode
+	{
+		std::string name;
+		ResourceType type = ResourceType::Transient;
+		VkImageAspectFlags aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
+
+		// Transient
+		VulkanImageCreateInfo imageCI{};
+		VulkanImageViewCreateInfo imageViewCI{};
+		std::vector<VulkanImage*> images;				// Một image cho mỗi frame-in-flight.
+
+		// Imported
+		ImageListGetter getter;
+		const std::vector<VkImage>* swapchainImages = nullptr;
+
+		// Output
+		bool isOutput = false;
+		RenderGraphUsage finalUsage = RenderGraphUsage::Present;
+
+		// Kết quả Compile: khoảng pass [firstPass, lastPass] sử dụng tài nguyên, vùng nhớ aliasing.
+		int firstPass = -1;
+		int lastPass = -1;
+		int memorySlot = -1;
+		int aliasPredecessor = -1;					// Image tạm dùng vùng nhớ này ngay trước (-1 nếu không có).
+	};
+
+	struct ResourceAccess
+	{
+		RenderGraphResource resource;
+		RenderGraphUsage usage;
+		bool isWrite;
+	};
+
+	// Một image barrier đã tính trước (layout, stage, access), image thật được xác định khi Execute.
+	struct ImageBarrierInfo
+	{
+		RenderGraphResource resource;
+		VkImageMemoryBarrier2 barrier;
+	};
+
+	struct PassNode
+	{
+		std::string name;
+		std::vector<ResourceAccess> accesses;
+		IRenderPass* executor = nullptr;
+		QueueType queue = QueueType::Graphics;			// Queue khai báo, thành Graphics nếu GPU không có compute queue riêng.
+		bool hasSideEffects = false;					// Không bao giờ bị cull (MarkSideEffects).
+		bool active = true;
+		std::vector<ImageBarrierInfo> barriers;		// Barrier ghi ngay trước pass (gộp thành một lệnh).
+	};
+
+	// Một lần submit: dãy pass liên tiếp [firstPass, endPass) (theo chỉ số khai báo) chạy trên cùng một queue.
+	struct Submission
+	{
+		QueueType queue = QueueType::Graphics;
+		int firstPass = 0;
+		int endPass = 0;
+	};
+
+	// Vùng nhớ dùng chung của một nhóm image tạm có thời gian sống không chồng lấn.
+	struct MemorySlot
+	{
+		VkMemoryRequirements requirements{};
+		RenderGraphResource lastResource = 0;		// Image tạm được gán vào vùng nhớ gần nhất.
+		std::vector<VmaAllocation> allocations;		// Một vùng nhớ cho mỗi frame-in-flight.
+	};
+
+	// --- Tham chiếu Vulkan ---
+	const VulkanHandles& m_VulkanHandles;
+	uint32_t m_FrameCount;
+
+	// --- Dữ liệu nội bộ ---
+	std::vector<ResourceNode> m_Resources;
+	std::vector<PassNode> m_Passes;
+	std::vector<MemorySlot> m_MemorySlots;
+	std::vector<Submission> m_Submissions;
+	uint32_t m_PresentSubmission = 0;
+	std::vector<ImageBarrierInfo> m_FinalBarriers;	// Barrier ghi sau pass cuối (chuyển sang trạng thái output).
+	bool m_Compiled = false;
+
+	VulkanBarrierBatch m_BarrierBatch;				// Tái sử dụng mỗi frame, tránh cấp phát lại.
+
+	// --- Hàm helper private ---
+
+	// Helper: Thêm một lần truy cập vào pass.
+	void AddAccess(RenderGraphPass pass, RenderGraphResource resource, RenderGraphUsage usage, bool isWrite);
+
+	// Helper: Đánh dấu pass hoạt động, duyệt ngược từ các output.
+	void CullPasses();
+
+	// Helper: Chia các pass còn hoạt động thành các submission theo queue.
+	void BuildSubmissions();
+
+	// Helper: Tính thời gian sống, gán vùng nhớ aliasing và tạo image tạm.
+	void AllocateTransientImages();
+
+	// Helper: Mô phỏng trạng thái tài nguyên qua các pass để tính barrier.
+	void BuildBarriers();
+
+	// Helper: Thêm barrier cần thiết để chuyển `state` sang `usage` vào `barriers`, cập nhật `state`.
+	// `discardContents`: Lệnh ghi xóa toàn bộ nội dung, không cần giữ dữ liệu cũ khi chuyển layout.
+	void AppendBarrier(std::vector<ImageBarrierInfo>& barriers, RenderGraphResource resource, VulkanImageState& state, RenderGraphUsage usage, bool discardContents);
+
+	// Helper: Ghi các barrier đã tính trước vào command buffer bằng một lệnh vkCmdPipelineBarrier2.
+	void RecordBarriers(const VkCommandBuffer& cmdBuffer, const std::vector<ImageBarrierInfo>& barriers, uint32_t imageIndex, uint32_t currentFrame);
+
+	// Helper: Thêm barrier đã tính trước cho một image cụ thể vào m_BarrierBatch.
+	void AddResolvedBarrier(const VkImageMemoryBarrier2& barrier, VkImage image, VkImageAspectFlags aspectFlags);
+
+	// Helper: Ném lỗi nếu đồ thị đã được Compile.
+	void CheckNotCompiled() const;
+};
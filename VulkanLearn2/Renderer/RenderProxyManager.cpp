@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "RenderProxyManager.h"
+#include "Scene/Scene.h"
+#include "Scene/Component.h"
+#include "Scene/Model.h"
+#include <limits>
+
+RenderProxyManager::RenderProxyManager(Scene* scene) :
+	m_Scene(scene),
+	m_ProxyRanges(&scene->GetRegistry().storage<RenderProxyComponent>())
+{
+	entt::registry& registry = m_Scene->GetRegistry();
+	registry.on_construct<MeshComponent>().connect<&RenderProxyManager::OnMeshComponentChanged>(this);
+	registry.on_update<MeshComponent>().connect<&RenderProxyManager::OnMeshComponentChanged>(this);
+	registry.on_destroy<MeshComponent>().connect<&RenderProxyManager::OnMeshComponentChanged>(this);
+}
+
+RenderProxyManager::~RenderProxyManager()
+{
+	entt::registry& registry = m_Scene->GetRegistry();
+	registry.on_construct<MeshComponent>().disconnect(this);
+	registry.on_update<MeshComponent>().disconnect(this);
+	registry.on_destroy<MeshComponent>().disconnect(this);
+}
+
+void RenderProxyManager::Sync()
+{
+	// Dựng lại đã đọc transform mới nhất, không cần cập nhật riêng.
+	if (m_StructureDirty)
+	{
+		Rebuild();
+		m_StructureDirty = false;
+		m_StructureVersion++;
+	}
+	else
+	{
+		UpdateTransforms();
+	}
+
+	// Mọi thay đổi transform của frame đã được tiêu thụ.
+	m_Scene->GetRegistry().clear<TransformChangedTag>();
+}
+
+const RenderProxyComponent* RenderProxyManager::GetProxyRange(entt::entity entity) const
+{
+	return m_ProxyRanges->contains(entity) ? &m_ProxyRanges->get(entity) : nullptr;
+}
+
+void RenderProxyManager::OnMeshComponentChanged(entt::registry& registry, entt::entity entity)
+{
+	m_StructureDirty = true;
+}
+
+void RenderProxyManager::Rebuild()
+{
+	entt::registry& registry = m_Scene->GetRegistry();
+
+	// Giữ lại dung lượng đã cấp phát.
+	m_Proxies.clear();
+	registry.clear<RenderProxyComponent>();
+
+	// Bounds SoA được cấp phát lại theo số proxy sau khi dựng xong.
+	m_Bounds.centerX.clear();
+	m_Bounds.centerY.clear();
+	m_Bounds.centerZ.clear();
+	m_Bounds.radius.clear();
+	m_Bounds.maxDrawDistanceSq.clear();
+	m_Bounds.minScreenSizeSq.clear();
+	m_Bounds.maxShadowDistanceSq.clear();
+
+	// 0 trong MeshComponent là không giới hạn: khoảng cách lớn nhất và kích thước 0 không loại bỏ proxy nào.
+	auto distanceSq = [](float distance) { return distance > 0.0f ? distance * distance : std::numeric_limits<float>::max(); };
+
+	auto view = registry.view<TransformComponent, MeshComponent>();
+	for (auto entity : view)
+	{
+		const MeshComponent& meshComponent = view.get<MeshComponent>(entity);
+		if (!meshComponent.IsVisible || meshComponent.Model == nullptr) continue;
+
+		const glm::mat4 model = view.get<TransformComponent>(entity).GetTransformMatrix();
+		const std::vector<Mesh*>& meshes = meshComponent.Model->getMeshes();
+		const float maxDrawDistanceSq = distanceSq(meshComponent.MaxDrawDistance);
+		const float minScreenSizeSq = meshComponent.MinScreenSize * meshComponent.MinScreenSize;
+		const float maxShadowDistanceSq = distanceSq(meshComponent.MaxShadowDistance);
+
+		RenderProxyComponent proxyRange{};
+		proxyRange.firstProxy = static_cast<uint32_t>(m_Proxies.size());
+		proxyRange.proxyCount = static_cast<uint32_t>(meshes.size());
+
+		for (const Mesh* mesh : meshes)
+		{
+			RenderProxy proxy{};
+			proxy.mesh = mesh;
+			proxy.firstIndex = mesh->meshRange.firstIndex;
+			proxy.indexCount = mesh->meshRange.indexCount;
+			proxy.vertexOffset = static_cast<int32_t>(mesh->meshRange.firstVertex);
+			proxy.materialIndex = mesh->materialIndex;
+			proxy.meshId = mesh->meshId;
+			proxy.maxDrawDistanceSq = maxDrawDistanceSq;
+			proxy.minScreenSizeSq = minScreenSizeSq;
+			proxy.maxShadowDistanceSq = maxShadowDistanceSq;
+
+			m_Proxies.push_back(proxy);
+			m_Bounds.centerX.push_back(0.0f);
+			m_Bounds.centerY.push_back(0.0f);
+			m_Bounds.centerZ.push_back(0.0f);
+			m_Bounds.radius.push_back(0.0f);
+			m_Bounds.maxDrawDistanceSq.push_back(maxDrawDistanceSq);
+			m_Bounds.minScreenSizeSq.push_back(minScreenSizeSq);
+			m_Bounds.maxShadowDistanceSq.push_back(maxShadowDistanceSq);
+			UpdateProxyTransform(static_cast<uint32_t>(m_Proxies.size() - 1), model);
+		}
+
+		// Không thay đổi storage đang được duyệt (TransformComponent, MeshComponent).
+		registry.emplace<RenderProxyComponent>(entity, proxyRange);
+	}
+}
+
+void RenderProxyManager::UpdateTransforms()
+{
+	auto view = m_Scene->GetRegistry().view<TransformChangedTag, RenderProxyComponent, TransformComponent>();
+
+	view.each([&](auto entity, const RenderProxyComponent& proxyRange, const TransformComponent& transform)
+		{
+			const glm::mat4 model = transform.GetTransformMatrix();
+			for (uint32_t i = 0; i < proxyRange.proxyCount; i++)
+			{
+				UpdateProxyTransform(proxyRange.firstProxy + i, model);
+			}
+		}
+	);
+}
+
+void RenderProxyManager::UpdateProxyTransform(uint32_t proxyIndex, const glm::mat4& model)
+{
+	RenderProxy& proxy = m_Proxies[proxyIndex];
+	proxy.model = model;
+
+	// Tính một lần khi transform thay đổi thay vì cho từng vertex trong shader.
+	proxy.normalMatrix = glm::mat3x4(glm::transpose(glm::inverse(glm::mat3(model))));
+
+	// Bán kính nhân với scale lớn nhất để hình cầu vẫn bao mesh khi scale không đều.
+	const glm::vec4& localSphere = proxy.mesh->boundingSphere;
+	const float maxScale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+	proxy.worldBoundingSphere = glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(localSphere), 1.0f)), localSphere.w * maxScale);
+
+	m_Bounds.centerX[proxyIndex] = proxy.worldBoundingSphere.x;
+	m_Bounds.centerY[proxyIndex] = proxy.worldBoundingSphere.y;
+	m_Bounds.centerZ[proxyIndex] = proxy.worldBoundingSphere.z;
+	m_Bounds.radius[proxyIndex] = proxy.worldBoundingSphere.w;
+}
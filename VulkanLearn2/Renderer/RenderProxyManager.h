@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+
+// Forward declarations
+struct Mesh;
+struct RenderProxyComponent;
+class Scene;
+
+// =================================================================================================
+// Struct: RenderProxy
+// Mô tả: Bản sao phẳng của một mesh của một entity, chứa mọi dữ liệu renderer cần khi vẽ:
+//        transform, mesh range, material và bounding sphere trong world space.
+//        Các pass chỉ duyệt mảng RenderProxy liên tục thay vì registry và Model.
+// =================================================================================================
+struct RenderProxy
+{
+	glm::mat4 model;
+	glm::mat3x4 normalMatrix;		// transpose(inverse(mat3(model))), theo layout mat3 của std430 (3 cột vec4).
+	glm::vec4 worldBoundingSphere;	// xyz: Tâm (world space), w: Bán kính (đã nhân scale lớn nhất).
+	const Mesh* mesh;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t vertexOffset;
+	uint32_t materialIndex;
+	uint32_t meshId;
+
+	// Ngưỡng cull của MeshComponent đã bình phương (so sánh trực tiếp với bình phương khoảng cách).
+	// Không giới hạn: khoảng cách là FLT_MAX, kích thước là 0.
+	float maxDrawDistanceSq;
+	float minScreenSizeSq;
+	float maxShadowDistanceSq;
+};
+
+// =================================================================================================
+// Struct: RenderProxyBounds
+// Mô tả: Bounding sphere world space và ngưỡng cull của mọi proxy theo dạng structure-of-arrays (phần tử
+//        thứ i ứng với proxy thứ i), để culling đọc liên tục và test nhiều proxy cùng lúc bằng SIMD.
+// =================================================================================================
+struct RenderProxyBounds
+{
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+
+	// Bản sao của RenderProxy::maxDrawDistanceSq, minScreenSizeSq, maxShadowDistanceSq (chỉ đổi khi dựng lại).
+	std::vector<float> maxDrawDistanceSq;
+	std::vector<float> minScreenSizeSq;
+	std::vector<float> maxShadowDistanceSq;
+};
+
+// =================================================================================================
+// Class: RenderProxyManager
+// Mô tả:
+//      Giữ mảng RenderProxy của scene và cập nhật nó theo thay đổi thay vì trích xuất lại mỗi frame:
+//        - Thay đổi cấu trúc (MeshComponent được thêm, xóa hoặc patch/replace): mảng được dựng lại
+//          toàn bộ ở lần Sync kế tiếp. Việc này hiếm xảy ra và dùng lại dung lượng đã cấp phát.
+//        - Thay đổi transform: TransformSystem gắn TransformChangedTag cho entity có ma trận vừa được
+//          tính lại, Sync chỉ cập nhật ma trận và bounding sphere các proxy của những entity đó.
+//      Mỗi entity có proxy được gắn RenderProxyComponent (khoảng proxy liên tiếp của nó).
+//      LƯU Ý: Thay đổi MeshComponent (ví dụ IsVisible) phải đi qua registry.patch/replace để được phát hiện.
+// =================================================================================================
+class RenderProxyManager
+{
+public:
+	// Constructor: Đăng ký lắng nghe thay đổi của MeshComponent trong registry của `scene`.
+	RenderProxyManager(Scene* scene);
+	~RenderProxyManager();
+
+	// Cấm sao chép.
+	RenderProxyManager(const RenderProxyManager&) = delete;
+	RenderProxyManager& operator=(const RenderProxyManager&) = delete;
+
+	// Áp dụng các thay đổi từ lần Sync trước. Gọi mỗi frame sau TransformSystem, trước khi xây dựng DrawList.
+	void Sync();
+
+	// --- Getters ---
+	const std::vector<RenderProxy>& GetProxies() const { return m_Proxies; }
+	uint32_t GetProxyCount() const { return static_cast<uint32_t>(m_Proxies.size()); }
+	const RenderProxyBounds& GetBounds() const { return m_Bounds; }
+	uint32_t GetStructureVersion() const { return m_StructureVersion; }	// Tăng mỗi lần dựng lại: chỉ số proxy cũ không còn hợp lệ.
+
+	// Khoảng proxy của `entity`, nullptr nếu entity không có proxy nào.
+	// Chỉ đọc storage RenderProxyComponent (không tra registry), gọi được trong lúc simulation sửa registry.
+	const RenderProxyComponent* GetProxyRange(entt::entity entity) const;
+
+private:
+	// --- Tham chiếu đến các tài nguyên bên ngoài ---
+	Scene* m_Scene;
+	const entt::storage_for_t<RenderProxyComponent>* m_ProxyRanges;	// Storage chỉ RenderProxyManager sửa (trong Sync).
+
+	// --- Dữ liệu nội bộ ---
+	std::vector<RenderProxy> m_Proxies;
+	RenderProxyBounds m_Bounds;			// Bản sao SoA của worldBoundingSphere và ngưỡng cull, luôn cùng kích thước với m_Proxies.
+	bool m_StructureDirty = true;		// Dựng lại toàn bộ ở lần Sync kế tiếp (ban đầu luôn cần dựng).
+	uint32_t m_StructureVersion = 0;
+
+	// --- Hàm helper private ---
+
+	// Callback của registry khi MeshComponent được thêm, xóa hoặc patch/replace.
+	void OnMeshComponentChanged(entt::registry& registry, entt::entity entity);
+
+	// Helper: Dựng lại toàn bộ mảng proxy từ các entity có Transform và Mesh component.
+	void Rebuild();
+
+	// Helper: Cập nhật proxy các entity có TransformChangedTag.
+	void UpdateTransforms();
+
+	// Helper: Ghi ma trận model, normal matrix và bounding sphere world space (cả bản SoA) của proxy thứ `proxyIndex`.
+	void UpdateProxyTransform(uint32_t proxyIndex, const glm::mat4& model);
+};
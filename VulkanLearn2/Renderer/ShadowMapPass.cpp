@@ -4,16 +4,30 @@
 #include "Core\VulkanImage.h"
 #include "Scene/MeshManager.h"
 #include "Scene\Model.h"
-#include "Scene/Scene.h"
-#include "Scene\Component.h"
+#include "Core/VulkanCommandManager.h"
+#include "Core/JobSystem.h"
+#include "DrawList.h"
+#include "GPUScene.h"
+#include "Core/VulkanDescriptor.h"
+#include "Core/VulkanBuffer.h"
 
 ShadowMapPass::ShadowMapPass(const ShadowMapPassCreateInfo& shadowInfo):
 	m_VulkanHandles(shadowInfo.vulkanHandles),
 	m_MeshManager(shadowInfo.meshManager),
-	m_Scene(shadowInfo.scene),
+	m_DrawList(shadowInfo.drawList),
+	m_GPUScene(shadowInfo.gpuScene),
+	m_GPUDrivenRendering(shadowInfo.gpuDrivenRendering),
+	m_CommandManager(shadowInfo.commandManager),
+	m_JobSystem(shadowInfo.jobSystem),
+	m_MsaaSamples(shadowInfo.MSAA_SAMPLES),
 	m_BackgroundColor(shadowInfo.BackgroundColor),
 	m_LightManager(shadowInfo.lightManager)
 {
+	// Mỗi đèn có bóng đổ là một view (layer) của multiview.
+	const uint32_t shadowMapCount = m_LightManager->GetShadowMapCount();
+	m_ViewMask = shadowMapCount >= 32 ? ~0u : (1u << shadowMapCount) - 1;
+
+	CreateDescriptor();
 	CreatePipeline(shadowInfo);
 }
 
@@ -24,67 +38,110 @@ ShadowMapPass::~ShadowMapPass()
 
 void ShadowMapPass::Execute(const VkCommandBuffer* cmdBuffer, uint32_t imageIndex, uint32_t currentFrame)
 {
-	for (const auto& light : m_LightManager->GetAllGpuLights(currentFrame))
+	if (m_LightManager->GetShadowMapCount() == 0) return;
+
+	// Ghi song song toàn bộ lệnh vẽ trước khi ghi vào primary.
+	// GPU-driven: chỉ có một lệnh vẽ indirect, ghi thẳng vào primary.
+	// Toàn bộ batch: vật nằm ngoài frustum camera vẫn có thể đổ bóng vào vùng nhìn thấy.
+	const uint32_t jobCount = m_GPUDrivenRendering ? 0 : m_DrawList->GetJobCount(m_DrawList->GetBatchCount(), m_JobSystem->GetThreadCount());
+	std::vector<VkCommandBuffer> secondaryCmdBuffers;
+	if (!m_GPUDrivenRendering)
 	{
-		if (light.params.z != -1)
-		{
-			// --- 1. Chuyển đổi Layout cho Shadow Map ---
-			// Chuyển layout của shadow map sang DEPTH_ATTACHMENT_OPTIMAL để có thể ghi vào.
-			VulkanImage::TransitionLayout(
-				*cmdBuffer, m_LightManager->GetShadowMappingImage(currentFrame)[light.params.z]->GetHandles().image, 1,
-				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
-				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-				0, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-				0, 1);
-
-			// --- 2. Thiết lập và Bắt đầu Dynamic Rendering ---
-			VkRenderingAttachmentInfo depthAttachment{};
-			depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-			depthAttachment.clearValue.depthStencil = { 1.0f, 0 };
-			depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
-			depthAttachment.imageView = m_LightManager->GetShadowMappingImage(currentFrame)[light.params.z]->GetHandles().imageView;
-			depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-			depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-
-			VkRenderingInfo renderingInfo{};
-			renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-			renderingInfo.colorAttachmentCount = 0;
-			renderingInfo.pColorAttachments = nullptr;
-			renderingInfo.pDepthAttachment = &depthAttachment;
-			renderingInfo.pStencilAttachment = nullptr;
-			renderingInfo.layerCount = 1;
-			renderingInfo.renderArea.extent = { m_LightManager->GetShadowSize(), m_LightManager->GetShadowSize() };
-			renderingInfo.renderArea.offset = { 0, 0 };
-
-			vkCmdBeginRendering(*cmdBuffer, &renderingInfo);
-			
-			// --- 3. Thực hiện Vẽ ---
-			vkCmdBindPipeline(*cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipeline);
-			VkDeviceSize offset = 0;
-			vkCmdBindVertexBuffers(*cmdBuffer, 0, 1, &m_MeshManager->getVertexBuffer(), &offset);
-			vkCmdBindIndexBuffer(*cmdBuffer, m_MeshManager->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-			DrawSceneObject(*cmdBuffer, light);
-
-			vkCmdEndRendering(*cmdBuffer);
-
-			// --- 4. Chuyển đổi Layout sau khi Render ---
-			// Chuyển layout của shadow map sang SHADER_READ_ONLY_OPTIMAL để có thể đọc từ shader (trong LightingPass).
-			VulkanImage::TransitionLayout(
-				*cmdBuffer, m_LightManager->GetShadowMappingImage(currentFrame)[light.params.z]->GetHandles().image, 1,
-				VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
-				0, 1);
-		}
+		secondaryCmdBuffers = RecordSecondaryCmdBuffers(currentFrame, jobCount);
+	}
+
+	// Layout của shadow map array được RenderGraph chuyển đổi bằng một barrier duy nhất trước pass.
+
+	// --- 1. Thiết lập và Bắt đầu Dynamic Rendering ---
+	// Một vùng rendering cho mọi đèn: loadOp CLEAR xóa mọi layer thuộc viewMask.
+	VkRenderingAttachmentInfo depthAttachment{};
+	depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	depthAttachment.clearValue.depthStencil = { 1.0f, 0 };
+	depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+	depthAttachment.imageView = m_LightManager->GetShadowMapArray(currentFrame)->GetHandles().imageView;
+	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+	VkRenderingInfo renderingInfo{};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+	renderingInfo.flags = m_GPUDrivenRendering ? 0 : VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+	renderingInfo.colorAttachmentCount = 0;
+	renderingInfo.pColorAttachments = nullptr;
+	renderingInfo.pDepthAttachment = &depthAttachment;
+	renderingInfo.pStencilAttachment = nullptr;
+	renderingInfo.layerCount = 1; // Bị bỏ qua khi dùng multiview, layer được chọn theo viewMask.
+	renderingInfo.viewMask = m_ViewMask;
+	renderingInfo.renderArea.extent = { m_LightManager->GetShadowSize(), m_LightManager->GetShadowSize() };
+	renderingInfo.renderArea.offset = { 0, 0 };
+
+	vkCmdBeginRendering(*cmdBuffer, &renderingInfo);
+
+	// --- 2. Thực hiện Vẽ ---
+	if (m_GPUDrivenRendering)
+	{
+		// Lệnh vẽ do GPUCullingPass sinh ra từ frustum của mọi đèn.
+		BindPipelineState(*cmdBuffer, currentFrame);
+		vkCmdDrawIndexedIndirectCount(
+			*cmdBuffer,
+			m_GPUScene->GetDrawCommandBuffer()->GetHandles().buffer, m_GPUScene->GetDrawCommandOffset(currentFrame, GPUScene::DRAW_LIST_SHADOW),
+			m_GPUScene->GetDrawCountBuffer()->GetHandles().buffer, m_GPUScene->GetDrawCountOffset(currentFrame, GPUScene::DRAW_LIST_SHADOW),
+			m_GPUScene->GetMaxInstances(), sizeof(VkDrawIndexedIndirectCommand)
+		);
 	}
+	// Thực thi các đoạn lệnh vẽ theo đúng thứ tự.
+	else if (jobCount > 0)
+	{
+		vkCmdExecuteCommands(*cmdBuffer, jobCount, secondaryCmdBuffers.data());
+	}
+
+	vkCmdEndRendering(*cmdBuffer);
+}
+
+void ShadowMapPass::CreateDescriptor()
+{
+	// Set 0, Binding 0: Instance buffer của GPUScene (storage buffer dynamic, vùng của frame chọn bằng dynamic offset).
+	VkDescriptorBufferInfo instanceBufferInfo{};
+	instanceBufferInfo.buffer = m_GPUScene->GetInstanceBuffer()->GetHandles().buffer;
+	instanceBufferInfo.offset = 0;
+	instanceBufferInfo.range = m_GPUScene->GetInstanceRange();
+
+	BufferDescriptorUpdateInfo instanceBufferUpdate{};
+	instanceBufferUpdate.binding = 0;
+	instanceBufferUpdate.firstArrayElement = 0;
+	instanceBufferUpdate.bufferInfos = { instanceBufferInfo };
+
+	BindingElementInfo instanceElementInfo{};
+	instanceElementInfo.binding = 0;
+	instanceElementInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	instanceElementInfo.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	instanceElementInfo.descriptorCount = 1;
+	instanceElementInfo.bufferDescriptorUpdateInfoCount = 1;
+	instanceElementInfo.pBufferDescriptorUpdates = &instanceBufferUpdate;
+
+	// Set 0, Binding 1: Ma trận của các đèn xếp theo layer, nằm trong buffer của FrameAllocator.
+	BufferDescriptorUpdateInfo shadowMatrixUpdate{};
+	shadowMatrixUpdate.binding = 1;
+	shadowMatrixUpdate.firstArrayElement = 0;
+	shadowMatrixUpdate.bufferInfos = { m_LightManager->GetShadowMatrixBufferInfo() };
+
+	BindingElementInfo shadowMatrixElementInfo{};
+	shadowMatrixElementInfo.binding = 1;
+	shadowMatrixElementInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+	shadowMatrixElementInfo.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	shadowMatrixElementInfo.descriptorCount = 1;
+	shadowMatrixElementInfo.bufferDescriptorUpdateInfoCount = 1;
+	shadowMatrixElementInfo.pBufferDescriptorUpdates = &shadowMatrixUpdate;
+
+	std::vector<BindingElementInfo> instanceBindings{ instanceElementInfo, shadowMatrixElementInfo };
+	m_InstanceDescriptor = new VulkanDescriptor(*m_VulkanHandles, instanceBindings, 0); // Set 0
+	m_Handles.descriptors.push_back(m_InstanceDescriptor);
 }
 
 void ShadowMapPass::CreatePipeline(const ShadowMapPassCreateInfo& shadowMapInfo)
 {
 	VulkanPipelineCreateInfo pipelineInfo{};
 	pipelineInfo.cullingMode = VK_CULL_MODE_FRONT_BIT; // Cull front face để tránh peter panning
-	pipelineInfo.depthFormat = VK_FORMAT_D32_SFLOAT;
+	pipelineInfo.depthFormat = m_DepthFormat;
 	pipelineInfo.stencilFormat = VK_FORMAT_UNDEFINED;
 	pipelineInfo.descriptors = &m_Handles.descriptors;
 	pipelineInfo.enableDepthBias = true;
@@ -99,37 +156,74 @@ void ShadowMapPass::CreatePipeline(const ShadowMapPassCreateInfo& shadowMapInfo)
 	pipelineInfo.vulkanHandles = shadowMapInfo.vulkanHandles;
 	pipelineInfo.viewportExtent = { m_LightManager->GetShadowSize(), m_LightManager->GetShadowSize() };
 
-	pipelineInfo.pushConstantDataSize = sizeof(ShadowMapPushConstantData);
+	pipelineInfo.pushConstantDataSize = 0; // Ma trận của đèn được đọc từ storage buffer theo gl_ViewIndex.
+	pipelineInfo.viewMask = m_ViewMask;
 
 	m_Handles.pipeline = new VulkanPipeline(&pipelineInfo);
 }
 
-void ShadowMapPass::DrawSceneObject(VkCommandBuffer cmdBuffer, const GPULight& currentLight)
+std::vector<VkCommandBuffer> ShadowMapPass::RecordSecondaryCmdBuffers(uint32_t currentFrame, uint32_t jobCount)
 {
-	auto view = m_Scene->GetRegistry().view<TransformComponent, MeshComponent>();
-
-	view.each([&](auto e, const TransformComponent& transformComponent, const MeshComponent& meshComponent)
+	std::vector<VkCommandBuffer> secondaryCmdBuffers(jobCount, VK_NULL_HANDLE);
+
+	// Thông tin kế thừa: chỉ có depth attachment, cùng viewMask với vùng rendering.
+	VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{};
+	inheritanceRenderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+	inheritanceRenderingInfo.viewMask = m_ViewMask;
+	inheritanceRenderingInfo.colorAttachmentCount = 0;
+	inheritanceRenderingInfo.depthAttachmentFormat = m_DepthFormat;
+	inheritanceRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+	inheritanceRenderingInfo.rasterizationSamples = m_MsaaSamples;
+
+	m_JobSystem->ParallelFor(jobCount, [&](uint32_t jobIndex, uint32_t threadIndex)
 		{
-			if (!meshComponent.IsVisible) return;
+			VkCommandBuffer secondaryCmd = m_CommandManager->BeginSecondaryCmdBuffer(currentFrame, threadIndex, inheritanceRenderingInfo);
 
-			std::vector<Mesh*> meshes = meshComponent.Model->getMeshes();
+			BindPipelineState(secondaryCmd, currentFrame);
 
-			// Tính toán ma trận model từ TransformComponent.
-			// Lưu ý: Logic này nên được chuyển vào một System riêng biệt để tối ưu hóa.
+			uint32_t firstBatch, endBatch;
+			m_DrawList->GetJobRange(m_DrawList->GetBatchCount(), jobCount, jobIndex, firstBatch, endBatch);
+			DrawSceneObject(secondaryCmd, firstBatch, endBatch);
 
-			for (const auto& mesh : meshes)
-			{
-				// --- Cập nhật Push Constants ---
-				// Gửi dữ liệu cho từng lần vẽ (per-draw data) như ma trận model và ID texture.
-				m_PushConstantData.model = transformComponent.GetTransformMatrix();
-				m_PushConstantData.lightMatrix = currentLight.lightSpaceMatrix;
+			VK_CHECK(vkEndCommandBuffer(secondaryCmd), "LỖI: Kết thúc ghi secondary command buffer thất bại!");
+			secondaryCmdBuffers[jobIndex] = secondaryCmd;
+		}
+	);
 
-				vkCmdPushConstants(cmdBuffer, m_Handles.pipeline->getHandles().pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ShadowMapPushConstantData), &m_PushConstantData);
+	return secondaryCmdBuffers;
+}
 
-				// --- Ghi Lệnh Vẽ ---
-				vkCmdDrawIndexed(cmdBuffer, mesh->meshRange.indexCount, 1, mesh->meshRange.firstIndex, mesh->meshRange.firstVertex, 0);
-			}
-		}
+void ShadowMapPass::BindPipelineState(VkCommandBuffer cmdBuffer, uint32_t currentFrame)
+{
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipeline);
+	VkDeviceSize offset = 0;
+	vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &m_MeshManager->getVertexBuffer(), &offset);
+	vkCmdBindIndexBuffer(cmdBuffer, m_MeshManager->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+	// Bind Set 0: Instance buffer và ma trận của các đèn của frame hiện tại (theo thứ tự binding).
+	std::array<uint32_t, 2> dynamicOffsets = {
+		m_GPUScene->GetInstanceOffset(currentFrame),
+		m_LightManager->GetShadowMatrixOffsets()[currentFrame]
+	};
+	vkCmdBindDescriptorSets(
+		cmdBuffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS, m_Handles.pipeline->getHandles().pipelineLayout,
+		m_InstanceDescriptor->getSetIndex(), 1,
+		&m_InstanceDescriptor->getHandles().descriptorSet,
+		static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data()
 	);
+}
+
+void ShadowMapPass::DrawSceneObject(VkCommandBuffer cmdBuffer, uint32_t firstBatch, uint32_t endBatch)
+{
+	const std::vector<DrawBatch>& drawBatches = m_DrawList->GetBatches();
 
+	for (uint32_t i = firstBatch; i < endBatch; i++)
+	{
+		const DrawBatch& batch = drawBatches[i];
+
+		// --- Ghi Lệnh Vẽ ---
+		// Một lệnh vẽ cho mọi instance của mesh, ma trận model được đọc theo gl_InstanceIndex.
+		vkCmdDrawIndexed(cmdBuffer, batch.mesh->meshRange.indexCount, batch.instanceCount, batch.mesh->meshRange.firstIndex, batch.mesh->meshRange.firstVertex, batch.firstInstance);
+	}
 }
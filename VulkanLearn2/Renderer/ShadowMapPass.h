@@ -10,10 +10,13 @@ class VulkanPipeline;
 class VulkanImage;
 class VulkanDescriptor;
 class VulkanBuffer;
+class VulkanCommandManager;
+class JobSystem;
+class DrawList;
 class TextureManager;
 class MeshManager;
 class MaterialManager;
-class Scene;
+class GPUScene;
 
 // =================================================================================================
 // Struct: ShadowMapPassCreateInfo
@@ -29,7 +32,13 @@ struct ShadowMapPassCreateInfo
 	// --- Dữ liệu Scene ---
 	const MeshManager* meshManager;
 	const LightManager* lightManager;
-	Scene* scene;
+	const DrawList* drawList;					// Danh sách lệnh vẽ của frame, dùng chung với GeometryPass.
+	const GPUScene* gpuScene;					// Instance buffer (Set 0) và draw list shadow (lệnh vẽ indirect chung của mọi shadow view).
+	bool gpuDrivenRendering;					// true: vẽ bằng vkCmdDrawIndexedIndirectCount, false: ghi lệnh vẽ từ DrawList trên CPU.
+
+	// --- Ghi lệnh đa luồng ---
+	VulkanCommandManager* commandManager;		// Cung cấp secondary command buffer cho từng luồng.
+	JobSystem* jobSystem;
 
 	// --- Shaders ---
 	std::string fragShaderFilePath;
@@ -52,8 +61,15 @@ struct ShadowMapHandles
 // Class: ShadowMapPass
 // Mô tả: 
 //      Thực hiện render scene từ góc nhìn của đèn để tạo shadow map.
-//      Pass này sẽ render độ sâu của scene vào một depth texture (shadow map).
+//      Pass này sẽ render độ sâu của scene vào các layer của shadow map array của LightManager.
 //      Dữ liệu này sau đó được dùng trong LightingPass để tính toán bóng đổ.
+//      Mọi shadow map được vẽ trong một vùng dynamic rendering duy nhất bằng multiview: mỗi view là
+//      một layer (một đèn), mỗi lệnh vẽ được phát một lần cho mọi đèn, vertex shader chọn ma trận
+//      của đèn theo gl_ViewIndex. Chi phí ghi lệnh vì vậy tỉ lệ với số đối tượng thay vì số đèn × số đối tượng.
+//      Instance không đổ bóng vào một đèn (GPUInstanceData::shadowViewMask) bị vertex shader loại khỏi view đó.
+//      Ma trận model được vertex shader đọc từ instance buffer của GPUScene qua gl_InstanceIndex.
+//      GPU-driven: một lệnh vkCmdDrawIndexedIndirectCount với draw list shadow (kết quả của GPUCullingPass).
+//      CPU: các đoạn DrawList được ghi song song vào secondary command buffer.
 // =================================================================================================
 class ShadowMapPass : public IRenderPass
 {
@@ -71,22 +87,41 @@ public:
 private:
 	ShadowMapHandles m_Handles;
 
-	ShadowMapPushConstantData m_PushConstantData;
-
 	// --- Tham chiếu đến các tài nguyên bên ngoài ---
 	const MeshManager* m_MeshManager;
 	const VulkanHandles* m_VulkanHandles;
 	const LightManager* m_LightManager;
-	Scene* m_Scene;
+	const DrawList* m_DrawList;
+	const GPUScene* m_GPUScene;
+	bool m_GPUDrivenRendering;
+	VulkanCommandManager* m_CommandManager;
+	JobSystem* m_JobSystem;
 	VkClearColorValue m_BackgroundColor;
 
+	// --- Cấu hình attachment (dùng chung cho pipeline, rendering info và inheritance info) ---
+	const VkFormat m_DepthFormat = VK_FORMAT_D32_SFLOAT;
+	VkSampleCountFlagBits m_MsaaSamples;
+	uint32_t m_ViewMask = 0;					// Một bit cho mỗi layer của shadow map array.
+
+	// --- Tài nguyên dành riêng cho pass ---
+	VulkanDescriptor* m_InstanceDescriptor;		// Instance buffer của GPUScene và ma trận của các đèn (Set 0), chọn frame bằng dynamic offset.
+
 	// --- Hàm khởi tạo ---
+
+	// Helper: Tạo descriptor set.
+	void CreateDescriptor();
 	
 	// Helper: Tạo pipeline đồ họa.
 	void CreatePipeline(const ShadowMapPassCreateInfo& shadowMapInfo);
 	
 	// --- Hàm thực thi ---
+
+	// Helper: Bind pipeline, vertex/index buffer, instance buffer và ma trận của các đèn.
+	void BindPipelineState(VkCommandBuffer cmdBuffer, uint32_t currentFrame);
 	
-	// Helper: Vẽ các đối tượng trong scene.
-	void DrawSceneObject(VkCommandBuffer cmdBuffer, const GPULight& currentLight);
+	// Helper: Ghi song song lệnh vẽ của các đoạn DrawList, mỗi đoạn một secondary command buffer.
+	std::vector<VkCommandBuffer> RecordSecondaryCmdBuffers(uint32_t currentFrame, uint32_t jobCount);
+
+	// Helper: Vẽ instanced các DrawBatch trong khoảng [firstBatch, endBatch) (state đã được bind).
+	void DrawSceneObject(VkCommandBuffer cmdBuffer, uint32_t firstBatch, uint32_t endBatch);
 };
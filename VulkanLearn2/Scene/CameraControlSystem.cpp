@@ -4,15 +4,15 @@
 #include "GLFW/glfw3.h"
 #include "glm/gtx/norm.hpp"
 #include "glm/glm.hpp"
-#include "Core/GameTime.h"
 
-void CameraControlSystem::CameraTransformUpdate(Scene* scene)
+void CameraControlSystem::CameraTransformUpdate(Scene* scene, float deltaTime)
 {
 	float MoveSpeed = 2.0f;
 	glm::vec3 UP{ 0, 1, 0 };
 	
-	auto view = scene->GetRegistry().view<TransformComponent, CameraComponent>();
-	view.each([&](auto e, TransformComponent& transform, const CameraComponent& camera)
+	entt::registry& registry = scene->GetRegistry();
+	auto view = registry.view<TransformComponent, CameraComponent>();
+	view.each([&](auto e, const TransformComponent& transform, const CameraComponent& camera)
 		{
 			if (!camera.IsPrimary()) return;
 
@@ -46,7 +46,8 @@ void CameraControlSystem::CameraTransformUpdate(Scene* scene)
 
 			velocity = glm::normalize(velocity);
 
-			transform.Translate(velocity * MoveSpeed * Core::Time::GetDeltaTime());
+			// patch để TransformSystem biết entity vừa thay đổi.
+			registry.patch<TransformComponent>(e, [&](TransformComponent& t) { t.Translate(velocity * MoveSpeed * deltaTime); });
 		});
 }
 
@@ -58,15 +59,18 @@ void CameraControlSystem::CameraRotateUpdate(Scene* scene)
 		glm::vec2 deltaMousePosition = Input::GetDeltaMousePosition();
 		if (glm::length(deltaMousePosition) != 0)
 		{
-			auto view = scene->GetRegistry().view<TransformComponent, CameraComponent>();
+			entt::registry& registry = scene->GetRegistry();
+			auto view = registry.view<TransformComponent, CameraComponent>();
 			for (auto [entity, transform, camera] : view.each())
 			{	
 				if (!camera.IsPrimary()) continue;
-				transform.Rotate({ deltaMousePosition.y * s_RotateSpeed, deltaMousePosition.x * s_RotateSpeed, 0 });
-
-				glm::vec3 currentRotation = transform.GetRotation();
-				currentRotation.x = std::clamp(currentRotation.x, -89.0f, 89.0f);
-				transform.SetRotation(currentRotation);
+				registry.patch<TransformComponent>(entity, [&](TransformComponent& t)
+					{
+						// Yaw dương quay ngược chiều kim đồng hồ nhìn từ trên xuống: chuột sang phải là yaw âm.
+						glm::vec3 currentRotation = t.GetRotation() + glm::vec3(deltaMousePosition.y * s_RotateSpeed, -deltaMousePosition.x * s_RotateSpeed, 0.0f);
+						currentRotation.x = std::clamp(currentRotation.x, -89.0f, 89.0f);
+						t.SetRotation(currentRotation);
+					});
 			};
 		}
 	}
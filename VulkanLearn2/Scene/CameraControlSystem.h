@@ -7,7 +7,8 @@
 class CameraControlSystem
 {
 public:
-	static void CameraTransformUpdate(Scene* scene);
+	// Gọi trong bước simulation (sau Input::BeginStep), deltaTime: độ dài bước.
+	static void CameraTransformUpdate(Scene* scene, float deltaTime);
 	
 	static void CameraRotateUpdate(Scene* scene);
 private:
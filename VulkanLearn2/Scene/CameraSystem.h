@@ -6,10 +6,14 @@
 class CameraSystem
 {
 public:
+	// Gọi sau TransformSystem::UpdateTransformMatrix: view matrix chỉ được tính lại khi transform của camera
+	// vừa thay đổi (TransformChangedTag), projection khi tham số thay đổi.
 	static void UpdateCameraMatrix(Scene* scene)
 	{
-		auto view = scene->GetRegistry().view<TransformComponent, CameraComponent>();
-		view.each([](auto e, const TransformComponent& transform, const CameraComponent& camera) 
+		entt::registry& registry = scene->GetRegistry();
+
+		auto view = registry.view<TransformComponent, CameraComponent>();
+		view.each([&](auto e, const TransformComponent& transform, const CameraComponent& camera) 
 			{
 				if (camera.m_IsProjDirty)
 				{
@@ -17,7 +21,11 @@ public:
 					camera.m_IsProjDirty = false;
 				}
 
-				UpdateViewMatrix(transform, camera);
+				if (camera.m_IsViewDirty || registry.all_of<TransformChangedTag>(e))
+				{
+					UpdateViewMatrix(transform, camera);
+					camera.m_IsViewDirty = false;
+				}
 			});
 	}
 private:
@@ -36,7 +44,7 @@ private:
 
 		// 2. Tính View Matrix bằng glm::lookAt
 		// Tham số 2 (Target) chính là: Vị trí Camera + Hướng nhìn
-		glm::mat4 viewMatrix = glm::lookAt(transform.GetPosition(), transform.GetPosition() + transform.GetForward(), worldUp);
+		glm::mat4 viewMatrix = glm::lookAt(transform.GetWorldPosition(), transform.GetWorldPosition() + transform.GetForward(), worldUp);
 
 		camera.m_ViewMatrix = viewMatrix;
 	}
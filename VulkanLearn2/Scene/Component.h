@@ -2,45 +2,128 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include "LightData.h"
 
 class Model;
 
+// Position/Orientation/Scale là giá trị local (tương đối so với entity cha, hoặc world nếu không có cha).
+// Ma trận world, vector hướng và vị trí world chỉ đúng sau TransformSystem::UpdateTransformMatrix.
+// Entity cha được gán qua Scene::SetParent.
+// Góc xoay được lưu bằng quaternion. Góc Euler (độ, thứ tự áp dụng X rồi Y rồi Z: R = Rz * Ry * Rx) chỉ là
+// tiện ích cho editor/điều khiển: SetRotation chuyển sang quaternion ngay, GetRotation tính lại khi cần.
+// Hướng mặc định: forward là -Z, right là +X (local).
+// LƯU Ý: Thay đổi sau khi gắn phải đi qua registry.patch/replace (như MeshComponent), TransformSystem chỉ
+// duyệt các entity được báo thay đổi. Thiết lập ngay sau CreateEntity không cần patch (component mới đã được báo).
 struct TransformComponent 
 {
 	friend class TransformSystem;
+	friend class Scene;
+	friend class SceneSerializer;
 public:
 
 	glm::vec3 GetPosition()			const	{ return m_Position; }
-	glm::vec3 GetRotation()			const	{ return m_Rotation; }
+	glm::vec3 GetRotation()			const	{ if (m_IsEulerStale) UpdateEulerFromOrientation(); return m_Rotation; }
+	glm::quat GetOrientation()		const	{ return m_Orientation; }
 	glm::vec3 GetScale()			const	{ return m_Scale; }
-	glm::mat4 GetTransformMatrix()	const	{ return m_TransformMatrix; }
-	glm::vec3 GetForward()			const	{ return m_Foward; }
+	glm::mat4 GetLocalMatrix()		const	{ return m_LocalMatrix; }
+	glm::mat4 GetTransformMatrix()	const	{ return m_TransformMatrix; }	// Ma trận world.
+	glm::vec3 GetWorldPosition()	const	{ return glm::vec3(m_TransformMatrix[3]); }
+	glm::vec3 GetForward()			const	{ return m_Foward; }				// Hướng world.
 	glm::vec3 GetRight()			const	{ return m_Right; }
+	entt::entity GetParent()		const	{ return m_Parent; }
 
 	void SetPosition(glm::vec3 pos)			{ m_Position = pos;		m_IsDirty = true; }
-	void SetRotation(glm::vec3 rotation)	{ m_Rotation = rotation;	m_IsDirty = true; }
+	void SetRotation(glm::vec3 rotation)	{ m_Rotation = rotation;	m_Orientation = EulerToOrientation(rotation);	m_IsEulerStale = false;	m_IsDirty = true; }
+	void SetOrientation(glm::quat rotation)	{ m_Orientation = glm::normalize(rotation);	m_IsEulerStale = true;	m_IsDirty = true; }
 	void SetScale(glm::vec3 scale)			{ m_Scale = scale;		m_IsDirty = true; }
 
 	void Translate(glm::vec3 positionDelta) { m_Position += positionDelta;	m_IsDirty = true; }
-	void Rotate(glm::vec3 rotateDelta)		{ m_Rotation += rotateDelta;		m_IsDirty = true; }
+	void Rotate(glm::vec3 rotateDelta)		{ SetRotation(GetRotation() + rotateDelta); }
+	void Rotate(glm::quat rotateDelta)		{ SetOrientation(rotateDelta * m_Orientation); }	// Quanh trục của không gian cha.
 
 private:
 	glm::vec3 m_Position{ 0.0f };
-	glm::vec3 m_Rotation{ 0.0f };
+	glm::quat m_Orientation{ 1.0f, 0.0f, 0.0f, 0.0f };
 	glm::vec3 m_Scale{ 1.0f };
 
-	mutable	bool m_IsDirty = true;
+	mutable glm::vec3 m_Rotation{ 0.0f };	// Góc Euler (độ) của m_Orientation.
+	mutable bool m_IsEulerStale = false;
+
+	// Cây cha-con, do Scene duy trì: danh sách liên kết đôi các con của cùng một cha.
+	entt::entity m_Parent = entt::null;
+	entt::entity m_FirstChild = entt::null;
+	entt::entity m_PrevSibling = entt::null;
+	entt::entity m_NextSibling = entt::null;
+	uint32_t m_Depth = 0;					// Độ sâu trong cây (gốc: 0).
+
+	mutable	bool m_IsDirty = true;			// Giá trị local thay đổi.
+	mutable bool m_WorldChanged = false;	// Ma trận world vừa được tính lại (chỉ dùng trong lượt cập nhật theo cấp).
+	mutable glm::mat4 m_LocalMatrix = glm::mat4(1.0f);
 	mutable glm::mat4 m_TransformMatrix = glm::mat4(1.0f);
 
-	mutable glm::vec3 m_Foward{ 0.0f };
-	mutable glm::vec3 m_Right{ 0.0f };
+	mutable glm::quat m_WorldOrientation{ 1.0f, 0.0f, 0.0f, 0.0f };	// Tích quaternion từ gốc xuống (bỏ qua tỷ lệ của cha).
+	mutable glm::vec3 m_Foward{ 0.0f, 0.0f, -1.0f };
+	mutable glm::vec3 m_Right{ 1.0f, 0.0f, 0.0f };
+
+	static glm::quat EulerToOrientation(glm::vec3 rotation)
+	{
+		const glm::vec3 radians = glm::radians(rotation);
+		return glm::angleAxis(radians.z, glm::vec3(0, 0, 1)) * glm::angleAxis(radians.y, glm::vec3(0, 1, 0)) * glm::angleAxis(radians.x, glm::vec3(1, 0, 0));
+	}
+
+	// Tách góc Euler từ ma trận xoay R = Rz * Ry * Rx (ma trận lưu theo cột: m[cột][hàng]).
+	void UpdateEulerFromOrientation() const
+	{
+		const glm::mat3 m = glm::mat3_cast(m_Orientation);
+		const float y = glm::asin(glm::clamp(-m[0][2], -1.0f, 1.0f));
+		const float x = glm::atan(m[1][2], m[2][2]);
+		const float z = glm::atan(m[0][1], m[0][0]);
+		m_Rotation = glm::degrees(glm::vec3(x, y, z));
+		m_IsEulerStale = false;
+	}
 };
 
+// Thay đổi MeshComponent sau khi gắn phải dùng registry.patch/replace để RenderProxyManager phát hiện.
 struct MeshComponent
 {
 	Model* Model = nullptr;
 	bool IsVisible = true;
+
+	// Cull theo khoảng cách và kích thước trên màn hình (xem FrustumCuller), 0: không giới hạn.
+	// Khoảng cách đo từ camera tới tâm bounding sphere của từng mesh.
+	float MaxDrawDistance = 0.0f;	// Xa hơn thì không vẽ.
+	float MinScreenSize = 0.0f;		// Đường kính chiếu lên màn hình nhỏ hơn (tỷ lệ so với chiều cao màn hình) thì không vẽ.
+	float MaxShadowDistance = 0.0f;	// Xa hơn thì không đổ bóng.
+};
+
+// Tag: TransformComponent vừa được thêm, patch/replace hoặc đổi cha, chờ TransformSystem (do Scene gắn).
+// TransformSystem chỉ duyệt các entity có tag này (và cây con của chúng), rồi xóa toàn bộ tag.
+struct TransformDirtyTag {};
+
+// Tag: ma trận của TransformComponent vừa được TransformSystem tính lại trong frame này.
+// RenderProxyManager::Sync tiêu thụ và xóa toàn bộ tag mỗi frame.
+struct TransformChangedTag {};
+
+// Khoảng proxy liên tiếp của entity trong mảng của RenderProxyManager (do RenderProxyManager quản lý).
+struct RenderProxyComponent
+{
+	uint32_t firstProxy = 0;
+	uint32_t proxyCount = 0;
+};
+
+// Hộp occluder (local space) của entity cho OcclusionCuller.
+// Hộp phải nằm trọn trong phần đặc của mesh, nếu không vật phía sau có thể bị loại sai.
+struct OccluderComponent
+{
+	glm::vec3 Center{ 0.0f };
+	glm::vec3 HalfExtents{ 0.5f };
+};
+
+// Lá của entity trong cây AABB của SceneBVH (do SceneBVH quản lý).
+struct SpatialNodeComponent
+{
+	int32_t leaf = -1;
 };
 
 struct NameComponent
@@ -57,6 +140,7 @@ struct LightComponent
 struct CameraComponent
 {
 	friend class CameraSystem;
+	friend class SceneSerializer;
 public:
 	glm::mat4 GetProjMatrix() const { return m_ProjMatrix; }
 	glm::mat4 GetViewMatrix() const { return m_ViewMatrix; }
@@ -67,6 +151,7 @@ public:
 
 private:
 	mutable bool m_IsProjDirty = true;
+	mutable bool m_IsViewDirty = true;	// Camera mới: tính view lần đầu. Sau đó theo TransformChangedTag.
 
 	float m_Fov = 45.0f;
 	float m_Near = 0.01f;
@@ -1,15 +1,17 @@
 ﻿#include "pch.h"
 #include "LightManager.h"
 #include "Core/VulkanBuffer.h"
+#include "Core/VulkanFrameAllocator.h"
 #include "Core/VulkanDescriptor.h"
 #include "Core/VulkanCommandManager.h"
 #include "Core/VulkanImage.h"
 #include "Scene/Scene.h"
 #include "Component.h"
 
-LightManager::LightManager(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, Scene* scene, const VulkanSampler* sampler, uint32_t maxFramesInFlight):
+LightManager::LightManager(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, VulkanFrameAllocator* frameAllocator, Scene* scene, const VulkanSampler* sampler, uint32_t maxFramesInFlight):
 	m_VulkanHandles(vulkanHandles),
 	m_CommandManager(commandManager),
+	m_FrameAllocator(frameAllocator),
 	m_Scene(scene),
 	m_VulkanSampler(sampler),
 	m_MaxFramesInFlight(maxFramesInFlight)
@@ -22,26 +24,20 @@ LightManager::LightManager(const VulkanHandles& vulkanHandles, VulkanCommandMana
 			m_AllSceneGpuLights.push_back(lightComponent.Data.ToGPU(transformComponent.GetPosition()));
 		});
 
-	CreateDummyShadowMap();
+	AssignShadowLayers();
 	CreateShadowMappingTexture(maxFramesInFlight);
-	CreateLightBuffers(maxFramesInFlight);
 	CreateDescriptors(maxFramesInFlight);
 
+	// Dữ liệu đèn được cấp phát lại từ FrameAllocator mỗi frame (xem UploadLightData).
+	m_LightBufferOffsets.resize(maxFramesInFlight, 0);
+	m_ShadowMatrixOffsets.resize(maxFramesInFlight, 0);
+
 	// Cập nhật dữ liệu lần đầu.
 	UpdateLightSpaceMatrices();
-	for (size_t i = 0; i < maxFramesInFlight; i++)
-	{
-		UploadLightData(i);
-	}
 }
 
 LightManager::~LightManager()
 {
-	for (const auto& buffer : m_SceneLightBuffers)
-	{
-		delete(buffer);
-	}
-
 	for (size_t i = 0; i < m_ShadowMappingImages.size(); i++)
 	{
 		for (const auto& image : m_ShadowMappingImages[i])
@@ -49,35 +45,29 @@ LightManager::~LightManager()
 			delete(image);
 		}
 	}
-
-	delete(m_DummyShadowMap); // Giải phóng dummy shadow map
 }
 
-void LightManager::CreateLightBuffers(uint32_t maxFramesInFlight)
+VkDeviceSize LightManager::GetLightBufferRange() const
 {
-	// Nếu không có đèn nào, không cần tạo buffer.
-	if (m_AllSceneGpuLights.empty())
-	{
-		m_SceneLightBuffers.resize(maxFramesInFlight, nullptr); // Đảm bảo vector có kích thước đúng nhưng chứa null
-		return;
-	}
-
-	m_SceneLightBuffers.resize(maxFramesInFlight);
-
-	VkDeviceSize bufferSize = sizeof(GPULight) * m_AllSceneGpuLights.size();
+	// Range của descriptor dynamic là cố định, luôn giữ ít nhất một phần tử
+	// để descriptor hợp lệ ngay cả khi scene không có đèn nào.
+	size_t lightCount = std::max<size_t>(m_AllSceneGpuLights.size(), 1);
+	return sizeof(GPULight) * lightCount;
+}
 
-	VkBufferCreateInfo bufferInfo{};
-	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	bufferInfo.queueFamilyIndexCount = 1;
-	bufferInfo.pQueueFamilyIndices = &m_VulkanHandles.queueFamilyIndices.GraphicQueueIndex;
-	bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
-	bufferInfo.size = bufferSize;
+VkDeviceSize LightManager::GetShadowMatrixRange() const
+{
+	// Giống light buffer: luôn giữ ít nhất một phần tử để descriptor hợp lệ.
+	return sizeof(glm::mat4) * std::max<uint32_t>(m_ShadowMapCount, 1);
+}
 
-	for (size_t i = 0; i < maxFramesInFlight; i++)
-	{
-		m_SceneLightBuffers[i] = new VulkanBuffer(m_VulkanHandles, m_CommandManager, bufferInfo, VMA_MEMORY_USAGE_GPU_ONLY);
-	}
+VkDescriptorBufferInfo LightManager::GetShadowMatrixBufferInfo() const
+{
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = m_FrameAllocator->GetBuffer()->GetHandles().buffer;
+	bufferInfo.offset = 0;
+	bufferInfo.range = GetShadowMatrixRange();
+	return bufferInfo;
 }
 
 void LightManager::CreateDescriptors(uint32_t maxFramesInFlight)
@@ -87,24 +77,11 @@ void LightManager::CreateDescriptors(uint32_t maxFramesInFlight)
 	for (size_t i = 0; i < maxFramesInFlight; i++)
 	{
 		// Binding 0 cho Light Buffer chưa dữ liệu ánh sáng.
-		// Nếu không có đèn, sử dụng một buffer rỗng hoặc một buffer dummy để tránh crash.
+		// Dữ liệu nằm trong buffer chung của FrameAllocator, vị trí thực tế được chọn bằng dynamic offset.
 		VkDescriptorBufferInfo bufferInfo{};
-		if (m_SceneLightBuffers[i]) // Chỉ truy cập nếu buffer tồn tại
-		{
-			bufferInfo.buffer = m_SceneLightBuffers[i]->GetHandles().buffer;
-			bufferInfo.offset = 0;
-			bufferInfo.range = m_SceneLightBuffers[i]->GetHandles().bufferSize;
-		}
-		else
-		{
-			// Xử lý trường hợp không có đèn: có thể tạo một buffer dummy nhỏ hoặc
-			// đảm bảo shader xử lý mảng đèn rỗng. Hiện tại, để đơn giản, giả định
-			// shader sẽ không access nếu m_AllSceneGpuLights rỗng.
-			// Nếu không có đèn, range = 0, điều này hợp lệ cho shader SSBO.
-			bufferInfo.buffer = VK_NULL_HANDLE; // Hoặc một buffer dummy hợp lệ 
-			bufferInfo.offset = 0;
-			bufferInfo.range = 0; 
-		}
+		bufferInfo.buffer = m_FrameAllocator->GetBuffer()->GetHandles().buffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = GetLightBufferRange();
 
 		BufferDescriptorUpdateInfo bufferUpdateInfo{};
 		bufferUpdateInfo.binding = 0;
@@ -114,46 +91,29 @@ void LightManager::CreateDescriptors(uint32_t maxFramesInFlight)
 		BindingElementInfo elementInfo{};
 		elementInfo.binding = 0;
 		elementInfo.descriptorCount = 1;
-		elementInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		elementInfo.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
 		elementInfo.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 		elementInfo.bufferDescriptorUpdateInfoCount = 1;
 		elementInfo.pBufferDescriptorUpdates = &bufferUpdateInfo;
 
-		// Binding 1 Cho Shadow Image chứa dữ liệu bóng của từng nguồn sáng.
-		std::vector<VkDescriptorImageInfo> imageInfos{};
-		
-		// Lấp đầy imageInfos với shadow maps thực tế
-		for (size_t j = 0; j < m_ShadowMappingImages[i].size(); j++)
-		{
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = m_ShadowMappingImages[i][j]->GetHandles().imageView;
-			imageInfo.sampler = m_VulkanSampler->getShadowSampler();
-			imageInfos.push_back(imageInfo);
-		}
-
-		if (imageInfos.empty())
-		{
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = m_DummyShadowMap->GetHandles().imageView;
-			imageInfo.sampler = m_VulkanSampler->getShadowSampler();
-			imageInfos.push_back(imageInfo);
-		}
+		// Binding 1 Cho Shadow Map Array: mỗi layer chứa dữ liệu bóng của một nguồn sáng (layer = params.z).
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = GetShadowMapArray(static_cast<uint32_t>(i))->GetHandles().imageView;
+		imageInfo.sampler = m_VulkanSampler->getShadowSampler();
 
 		ImageDescriptorUpdateInfo imageUpdateInfo{};
 		imageUpdateInfo.binding = 1;
 		imageUpdateInfo.firstArrayElement = 0;
-		imageUpdateInfo.imageInfos = imageInfos;
+		imageUpdateInfo.imageInfos = { imageInfo };
 
 		BindingElementInfo elementInfo2{};
 		elementInfo2.binding = 1;
-		elementInfo2.descriptorCount = MAX_SHADOW_DESCRIPTOR;
+		elementInfo2.descriptorCount = 1;
 		elementInfo2.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		elementInfo2.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 		elementInfo2.imageDescriptorUpdateInfoCount = 1;
 		elementInfo2.pImageDescriptorUpdates = &imageUpdateInfo;
-		elementInfo2.useBindless = true; // Bật cờ bindless cho mảng shadow map
 
 		m_LightBufferDescriptors[i] = new VulkanDescriptor(m_VulkanHandles, {elementInfo, elementInfo2}, 1);
 	}
@@ -161,59 +121,84 @@ void LightManager::CreateDescriptors(uint32_t maxFramesInFlight)
 
 void LightManager::UploadLightData(uint32_t currentFrame)
 {
-	VkDeviceSize bufferSize = sizeof(GPULight) * m_AllSceneGpuLights.size();
-	m_SceneLightBuffers[currentFrame]->UploadData(m_AllSceneGpuLights.data(), bufferSize, 0);
+	// Ma trận shadow xếp theo layer, vertex shader của ShadowMapPass chọn bằng gl_ViewIndex.
+	FrameAllocation matrixAllocation = m_FrameAllocator->Allocate(currentFrame, GetShadowMatrixRange());
+	m_ShadowMatrixOffsets[currentFrame] = matrixAllocation.offset;
+
+	glm::mat4* shadowMatrices = reinterpret_cast<glm::mat4*>(matrixAllocation.pMappedData);
+	for (const auto& light : m_AllSceneGpuLights)
+	{
+		if (light.params.z >= 0)
+		{
+			shadowMatrices[static_cast<uint32_t>(light.params.z)] = light.lightSpaceMatrix;
+		}
+	}
+
+	FrameAllocation allocation = m_FrameAllocator->Allocate(currentFrame, GetLightBufferRange());
+	m_LightBufferOffsets[currentFrame] = allocation.offset;
+
+	if (m_AllSceneGpuLights.empty())
+	{
+		// Đèn rỗng: cường độ 0 và không có shadow map, không đóng góp vào kết quả chiếu sáng.
+		GPULight emptyLight{};
+		emptyLight.params.z = -1;
+		memcpy(allocation.pMappedData, &emptyLight, sizeof(GPULight));
+		return;
+	}
+
+	memcpy(allocation.pMappedData, m_AllSceneGpuLights.data(), sizeof(GPULight) * m_AllSceneGpuLights.size());
 }
 
-void LightManager::CreateShadowMappingTexture(uint32_t maxFramesInFlight)
+void LightManager::AssignShadowLayers()
 {
-	m_ShadowMappingImages.resize(maxFramesInFlight);
-	for (size_t i = 0; i < maxFramesInFlight; i++)
+	// Mọi shadow map được vẽ trong một lần render multiview, số layer bị giới hạn bởi số view tối đa của GPU.
+	const uint32_t maxShadowLayers = std::min(MAX_SHADOW_LAYERS, m_VulkanHandles.maxMultiviewViewCount);
+
+	m_ShadowMapCount = 0;
+	for (auto& light : m_AllSceneGpuLights)
 	{
-		for (auto& light : m_AllSceneGpuLights)
+		if (light.params.z == -1) continue; // Đèn không có bóng đổ
+
+		if (m_ShadowMapCount >= maxShadowLayers)
 		{
-			if (light.params.z != -1) // Chỉ tạo shadow map cho những đèn có shadow map index hợp lệ
-			{
-				VulkanImageCreateInfo imageInfo{};
-				imageInfo.format = VK_FORMAT_D32_SFLOAT;
-				imageInfo.width = SHADOW_SIZE;
-				imageInfo.height = SHADOW_SIZE;
-				imageInfo.imageUsageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-				imageInfo.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-				imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-				imageInfo.mipLevels = 1;
-
-				VulkanImageViewCreateInfo imageViewInfo{};
-				imageViewInfo.aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
-				imageViewInfo.format = VK_FORMAT_D32_SFLOAT;
-				imageViewInfo.mipLevels = 1;
-
-				VulkanImage* shadowImage = new VulkanImage(m_VulkanHandles, imageInfo, imageViewInfo);
-
-				light.params.z = static_cast<float>(m_ShadowMappingImages[i].size());
-				m_ShadowMappingImages[i].push_back(shadowImage);
-			}
+			Log::Warning("Số đèn có bóng đổ vượt quá giới hạn " + std::to_string(maxShadowLayers) + " shadow map, các đèn còn lại sẽ không có bóng đổ.");
+			light.params.z = -1;
+			continue;
 		}
+
+		light.params.z = static_cast<float>(m_ShadowMapCount++);
 	}
 }
 
-void LightManager::CreateDummyShadowMap()
+void LightManager::CreateShadowMappingTexture(uint32_t maxFramesInFlight)
 {
+	// Texture array luôn có ít nhất một layer để descriptor hợp lệ khi không có đèn nào có bóng đổ
+	// (layer đó không bao giờ được đọc vì mọi đèn đều có params.z = -1).
+	const uint32_t layerCount = std::max(m_ShadowMapCount, 1u);
+
 	VulkanImageCreateInfo imageInfo{};
 	imageInfo.format = VK_FORMAT_D32_SFLOAT;
-	imageInfo.width = 1;
-	imageInfo.height = 1;
+	imageInfo.width = SHADOW_SIZE;
+	imageInfo.height = SHADOW_SIZE;
+	imageInfo.arrayLayers = layerCount;
 	imageInfo.imageUsageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
 	imageInfo.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 	imageInfo.mipLevels = 1;
 
+	// Một view 2D array cho cả hai mục đích: attachment multiview (mỗi view một layer) và sampler2DArrayShadow.
 	VulkanImageViewCreateInfo imageViewInfo{};
 	imageViewInfo.aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
 	imageViewInfo.format = VK_FORMAT_D32_SFLOAT;
 	imageViewInfo.mipLevels = 1;
+	imageViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	imageViewInfo.layerCount = layerCount;
 
-	m_DummyShadowMap = new VulkanImage(m_VulkanHandles, imageInfo, imageViewInfo);
+	m_ShadowMappingImages.resize(maxFramesInFlight);
+	for (size_t i = 0; i < maxFramesInFlight; i++)
+	{
+		m_ShadowMappingImages[i].push_back(new VulkanImage(m_VulkanHandles, imageInfo, imageViewInfo));
+	}
 }
 
 void LightManager::UpdateLightSpaceMatrices()
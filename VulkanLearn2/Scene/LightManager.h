@@ -3,7 +3,7 @@
 #include "Core\VulkanContext.h"
 #include "Core\VulkanSampler.h"
 
-class VulkanBuffer;
+class VulkanFrameAllocator;
 class VulkanDescriptor;
 class VulkanCommandManager;
 class VulkanImage;
@@ -14,24 +14,41 @@ class Scene;
 // Mô tả: 
 //      Quản lý tất cả các nguồn sáng trong scene.
 //      Chịu trách nhiệm tạo buffer ánh sáng (SSBO), shadow maps, và descriptor sets liên quan.
+//      Shadow map của mọi đèn là các layer của một depth texture array duy nhất mỗi frame
+//      (layer = params.z của đèn), để ShadowMapPass vẽ tất cả trong một lần bằng multiview.
 // =================================================================================================
 class LightManager
 {
 public:
 	// Constructor: Khởi tạo LightManager với danh sách đèn ban đầu.
-	LightManager(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, Scene* scene, const VulkanSampler* sampler, uint32_t maxFramesInFlight);
+	// Đèn chỉ được đọc từ scene ở đây (kích thước light buffer, số layer shadow map và descriptor cố định từ đó):
+	// LightComponent thêm sau khi tạo, kể cả qua SceneSerializer::Load, không được đưa lên GPU.
+	LightManager(const VulkanHandles& vulkanHandles, VulkanCommandManager* commandManager, VulkanFrameAllocator* frameAllocator, Scene* scene, const VulkanSampler* sampler, uint32_t maxFramesInFlight);
 	~LightManager();
 
+	// Cấp phát dữ liệu đèn và ma trận shadow của frame hiện tại từ FrameAllocator và ghi dữ liệu vào đó.
+	// Phải được gọi mỗi frame, sau khi FrameAllocator đã Reset vùng của frame này.
+	void UploadLightData(uint32_t currentFrame);
+
 	// --- Getters ---
 	const std::vector<VulkanDescriptor*>& GetDescriptors() const { return m_LightBufferDescriptors; }
+	const std::vector<uint32_t>& GetLightBufferOffsets() const { return m_LightBufferOffsets; } // Dynamic offset của light SSBO cho mỗi frame.
 	const std::vector<GPULight>& GetAllGpuLights(uint32_t currentFrame) const { return m_AllSceneGpuLights; }
-	const std::vector<VulkanImage*>& GetShadowMappingImage(uint32_t currentFrame) const { return m_ShadowMappingImages[currentFrame]; }
+	const std::vector<VulkanImage*>& GetShadowMappingImage(uint32_t currentFrame) const { return m_ShadowMappingImages[currentFrame]; } // Danh sách chỉ gồm texture array của frame (để import vào RenderGraph).
+	VulkanImage* GetShadowMapArray(uint32_t currentFrame) const { return m_ShadowMappingImages[currentFrame][0]; }
+	uint32_t GetShadowMapCount() const { return m_ShadowMapCount; } // Số layer thực sự được dùng (số đèn có bóng đổ).
 	const uint32_t GetShadowSize() const { return SHADOW_SIZE; }
 
+	// Ma trận lightSpaceMatrix của mọi shadow map, xếp theo layer (mat4[GetShadowMapCount()]).
+	// Nằm trong buffer chung của FrameAllocator, chọn frame bằng dynamic offset.
+	VkDescriptorBufferInfo GetShadowMatrixBufferInfo() const;
+	const std::vector<uint32_t>& GetShadowMatrixOffsets() const { return m_ShadowMatrixOffsets; }
+
 private:
 	// --- Tham chiếu Vulkan ---
 	const VulkanHandles& m_VulkanHandles;
 	VulkanCommandManager* m_CommandManager;
+	VulkanFrameAllocator* m_FrameAllocator;
 	Scene* m_Scene;
 	const VulkanSampler* m_VulkanSampler;
 
@@ -39,24 +56,25 @@ private:
 
 	// --- Cấu hình Shadow Map ---
 	const uint32_t SHADOW_SIZE = 2048;
-	const uint32_t MAX_SHADOW_DESCRIPTOR = 256;
+	const uint32_t MAX_SHADOW_LAYERS = 32; // Giới hạn bởi số bit của viewMask (multiview), có thể nhỏ hơn tùy GPU.
 
 	// --- Dữ liệu nội bộ ---
 	std::vector<GPULight> m_AllSceneGpuLights;
-	std::vector<VulkanBuffer*> m_SceneLightBuffers;
+	std::vector<uint32_t> m_LightBufferOffsets;
 	std::vector<VulkanDescriptor*> m_LightBufferDescriptors;
+	std::vector<uint32_t> m_ShadowMatrixOffsets;
 
-	std::vector<std::vector<VulkanImage*>> m_ShadowMappingImages;
-	VulkanImage* m_DummyShadowMap = nullptr; // Placeholder khi không có shadow map nào được tạo hoặc có ít hơn MAX_SHADOW_DESCRIPTOR
+	std::vector<std::vector<VulkanImage*>> m_ShadowMappingImages; // [frame] -> { texture array }
+	uint32_t m_ShadowMapCount = 0;
 
 
 	// --- Hàm helper private ---
-	void CreateLightBuffers(uint32_t maxFramesInFlight);
+	VkDeviceSize GetLightBufferRange() const;
+	VkDeviceSize GetShadowMatrixRange() const;
+	void AssignShadowLayers(); // Gán layer (params.z) cho các đèn có bóng đổ, tối đa theo giới hạn multiview.
 	void CreateShadowMappingTexture(uint32_t maxFramesInFlight);
-	void CreateDummyShadowMap(); // Tạo một ảnh depth 1x1 làm placeholder
 	void CreateDescriptors(uint32_t maxFramesInFlight);
 
 	void UpdateLightSpaceMatrices();
-	void UploadLightData(uint32_t currentFrame);
 
 };
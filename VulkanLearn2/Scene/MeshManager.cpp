@@ -61,6 +61,8 @@ std::vector<Mesh*> MeshManager::createMeshFromMeshData(const MeshData* meshData,
 
 		Mesh* mesh = new Mesh();
 		mesh->meshRange = meshRange;
+		mesh->meshId = m_MeshCount++;
+		mesh->boundingSphere = ComputeBoundingSphere(meshData[i]);
 
 		outMeshes.push_back(mesh);
 	}
@@ -68,6 +70,31 @@ std::vector<Mesh*> MeshManager::createMeshFromMeshData(const MeshData* meshData,
 	return outMeshes;
 }
 
+glm::vec4 MeshManager::ComputeBoundingSphere(const MeshData& meshData)
+{
+	if (meshData.vertices.empty()) return glm::vec4(0.0f);
+
+	// Tâm là tâm của AABB, bán kính là khoảng cách xa nhất từ tâm tới một vertex.
+	// Không phải hình cầu nhỏ nhất nhưng đủ chặt cho culling và chỉ cần hai lần duyệt.
+	glm::vec3 minPos = meshData.vertices[0].pos;
+	glm::vec3 maxPos = meshData.vertices[0].pos;
+	for (const Vertex& vertex : meshData.vertices)
+	{
+		minPos = glm::min(minPos, vertex.pos);
+		maxPos = glm::max(maxPos, vertex.pos);
+	}
+
+	glm::vec3 center = (minPos + maxPos) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (const Vertex& vertex : meshData.vertices)
+	{
+		glm::vec3 offset = vertex.pos - center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+
+	return glm::vec4(center, std::sqrt(radiusSquared));
+}
+
 void MeshManager::CreateBuffers()
 {
 	// Chỉ tạo buffer nếu có dữ liệu.
@@ -55,9 +55,13 @@ private:
 
 	// --- Dữ liệu nội bộ ---
 	MeshManagerHandles m_Handles;
+	uint32_t m_MeshCount = 0;	// Số mesh đã tạo, cũng là meshId của mesh kế tiếp.
 	
 	// --- Hàm helper private ---
 	void CreateVertexBuffer();
 	void CreateIndexBuffer();
 
+	// Helper: Tính bounding sphere (local space) bao toàn bộ vertex của mesh.
+	static glm::vec4 ComputeBoundingSphere(const MeshData& meshData);
+
 };
\ No newline at end of file
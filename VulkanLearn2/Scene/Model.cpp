@@ -9,6 +9,18 @@ Model::Model(const std::string& modelFilePath, MeshManager* meshManager, Materia
 	// ModelLoader giờ đây sẽ nhận các manager và trực tiếp xử lý việc tạo Mesh và Material.
 	ModelLoader modelLoader(meshManager, materialManager);
 	m_Handles.meshes = modelLoader.LoadModelFromFile(modelFilePath);
+	m_AssetId = HashAssetPath(modelFilePath);
+}
+
+uint64_t Model::HashAssetPath(const std::string& filePath)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : filePath)
+	{
+		hash ^= static_cast<uint8_t>(c == '\\' ? '/' : c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
 }
 
 Model::~Model()
@@ -32,6 +32,8 @@ struct Mesh
 {
 	MeshRange meshRange;
 	uint32_t materialIndex;
+	uint32_t meshId;			// Số thứ tự duy nhất do MeshManager cấp, dùng trong sort key của DrawList.
+	glm::vec4 boundingSphere;	// xyz: Tâm (local space), w: Bán kính. Dùng cho frustum culling.
 };
 
 // =================================================================================================
@@ -60,9 +62,16 @@ public:
 	~Model();
 
 	// Getter: Lấy danh sách các mesh con của model.
-	const std::vector<Mesh*> getMeshes() const { return m_Handles.meshes; }
+	const std::vector<Mesh*>& getMeshes() const { return m_Handles.meshes; }
+
+	// Getter: ID của asset (hash đường dẫn file), dùng để tham chiếu model trong file scene (SceneSerializer).
+	uint64_t getAssetId() const { return m_AssetId; }
+
+	// Hash FNV-1a 64 bit của đường dẫn, dấu '\' được coi như '/' để ID không phụ thuộc cách viết đường dẫn.
+	static uint64_t HashAssetPath(const std::string& filePath);
 	
 private:
 	ModelHandles m_Handles;
+	uint64_t m_AssetId = 0;
 	
 };
\ No newline at end of file
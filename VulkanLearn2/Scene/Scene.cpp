@@ -4,8 +4,13 @@
 
 Scene::Scene()
 {
-	// Hàm khởi tạo Scene, hiện tại để trống.
-	// Có thể được dùng để thiết lập các hệ thống (system) mặc định trong tương lai.
+	// Tạo trước storage của tag: các callback gắn tag trong lúc registry đang duyệt các storage
+	// (ví dụ khi hủy entity), tạo storage mới lúc đó sẽ làm hỏng vòng duyệt.
+	m_Registry.storage<TransformDirtyTag>();
+
+	m_Registry.on_construct<TransformComponent>().connect<&Scene::OnTransformConstructed>(*this);
+	m_Registry.on_update<TransformComponent>().connect<&Scene::OnTransformUpdated>(*this);
+	m_Registry.on_destroy<TransformComponent>().connect<&Scene::OnTransformDestroyed>(*this);
 }
 
 Scene::~Scene()
@@ -32,7 +37,151 @@ entt::entity Scene::CreateEntity(const std::string& name)
 
 void Scene::DestroyEntity(entt::entity entity)
 {
-	// Hủy entity được chỉ định khỏi registry.
-	// Thao tác này cũng sẽ tự động xóa tất cả các component đã được gắn vào entity đó.
-	m_Registry.destroy(entity);
+	m_PendingDestroys.push_back(entity);
+}
+
+void Scene::FlushDestroyedEntities()
+{
+	// Hủy entity khỏi registry, thao tác này cũng sẽ tự động xóa tất cả các component đã được gắn vào entity đó.
+	// Một entity có thể được yêu cầu hủy nhiều lần.
+	for (entt::entity entity : m_PendingDestroys)
+	{
+		if (m_Registry.valid(entity))
+		{
+			m_Registry.destroy(entity);
+		}
+	}
+	m_PendingDestroys.clear();
+}
+
+void Scene::SetParent(entt::entity child, entt::entity parent)
+{
+	TransformComponent& childTransform = m_Registry.get<TransformComponent>(child);
+
+	if (parent != entt::null)
+	{
+		if (!m_Registry.all_of<TransformComponent>(parent))
+		{
+			throw std::runtime_error("LỖI: Scene::SetParent: Entity cha không có TransformComponent!");
+		}
+
+		// Đi ngược lên gốc từ parent: gặp child nghĩa là phép gắn tạo thành vòng.
+		for (entt::entity ancestor = parent; ancestor != entt::null; )
+		{
+			if (ancestor == child)
+			{
+				throw std::runtime_error("LỖI: Scene::SetParent: Không thể gắn entity vào chính nó hoặc con cháu của nó!");
+			}
+			const TransformComponent* ancestorTransform = m_Registry.try_get<TransformComponent>(ancestor);
+			ancestor = ancestorTransform ? ancestorTransform->m_Parent : entt::null;
+		}
+	}
+
+	if (childTransform.m_Parent == parent) return;
+
+	UnlinkFromParent(child);
+	childTransform.m_Parent = parent;
+
+	uint32_t depth = 0;
+	if (parent != entt::null)
+	{
+		// Thêm vào đầu danh sách con của cha mới.
+		TransformComponent& parentTransform = m_Registry.get<TransformComponent>(parent);
+		childTransform.m_NextSibling = parentTransform.m_FirstChild;
+		if (parentTransform.m_FirstChild != entt::null)
+		{
+			m_Registry.get<TransformComponent>(parentTransform.m_FirstChild).m_PrevSibling = child;
+		}
+		parentTransform.m_FirstChild = child;
+		depth = parentTransform.m_Depth + 1;
+	}
+
+	UpdateSubtreeDepth(child, depth);
+	MarkTransformDirty(child);
+	m_TransformHierarchy.orderDirty = true;
+}
+
+void Scene::OnTransformConstructed(entt::registry& registry, entt::entity entity)
+{
+	// Entity mới được thêm vào cuối storage: phá thứ tự theo cấp của TransformSystem.
+	MarkTransformDirty(entity);
+	m_TransformHierarchy.orderDirty = true;
+}
+
+void Scene::OnTransformUpdated(entt::registry& registry, entt::entity entity)
+{
+	MarkTransformDirty(entity);
+}
+
+void Scene::OnTransformDestroyed(entt::registry& registry, entt::entity entity)
+{
+	// Entity bị xóa được thay bằng phần tử cuối của storage: phá thứ tự theo cấp của TransformSystem.
+	m_TransformHierarchy.orderDirty = true;
+
+	UnlinkFromParent(entity);
+
+	// Các con trở thành gốc, ma trận world của chúng phải được tính lại.
+	auto& storage = m_Registry.storage<TransformComponent>();
+	entt::entity child = storage.get(entity).m_FirstChild;
+	while (child != entt::null && storage.contains(child))
+	{
+		TransformComponent& childTransform = storage.get(child);
+		const entt::entity next = childTransform.m_NextSibling;
+
+		childTransform.m_Parent = entt::null;
+		childTransform.m_PrevSibling = entt::null;
+		childTransform.m_NextSibling = entt::null;
+		UpdateSubtreeDepth(child, 0);
+		MarkTransformDirty(child);
+
+		child = next;
+	}
+}
+
+void Scene::MarkTransformDirty(entt::entity entity)
+{
+	// m_IsDirty cũng được bật để lượt cập nhật theo cấp (khi có nhiều thay đổi) thấy được entity này.
+	m_Registry.get<TransformComponent>(entity).m_IsDirty = true;
+	m_Registry.emplace_or_replace<TransformDirtyTag>(entity);
+}
+
+void Scene::UnlinkFromParent(entt::entity entity)
+{
+	auto& storage = m_Registry.storage<TransformComponent>();
+	TransformComponent& transform = storage.get(entity);
+
+	if (transform.m_PrevSibling != entt::null && storage.contains(transform.m_PrevSibling))
+	{
+		storage.get(transform.m_PrevSibling).m_NextSibling = transform.m_NextSibling;
+	}
+	else if (transform.m_Parent != entt::null && storage.contains(transform.m_Parent))
+	{
+		storage.get(transform.m_Parent).m_FirstChild = transform.m_NextSibling;
+	}
+	if (transform.m_NextSibling != entt::null && storage.contains(transform.m_NextSibling))
+	{
+		storage.get(transform.m_NextSibling).m_PrevSibling = transform.m_PrevSibling;
+	}
+
+	transform.m_PrevSibling = entt::null;
+	transform.m_NextSibling = entt::null;
+}
+
+void Scene::UpdateSubtreeDepth(entt::entity root, uint32_t depth)
+{
+	auto& storage = m_Registry.storage<TransformComponent>();
+	storage.get(root).m_Depth = depth;
+
+	std::vector<entt::entity> pending{ root };
+	while (!pending.empty())
+	{
+		const TransformComponent& transform = storage.get(pending.back());
+		pending.pop_back();
+
+		for (entt::entity child = transform.m_FirstChild; child != entt::null; child = storage.get(child).m_NextSibling)
+		{
+			storage.get(child).m_Depth = transform.m_Depth + 1;
+			pending.push_back(child);
+		}
+	}
 }
@@ -2,6 +2,25 @@
 
 // entt.hpp được kỳ vọng đã được include trong pch.h
 #include <string>
+#include <vector>
+
+/**
+ * @brief Thứ tự cập nhật của storage TransformComponent (do TransformSystem quản lý).
+ *
+ * Storage được sắp xếp theo độ sâu trong cây (theo chiều rộng): mọi entity cùng độ sâu nằm liên tục,
+ * cha luôn thuộc một cấp trước con, nên ma trận world được tính bằng một lượt duyệt tuyến tính.
+ */
+struct TransformHierarchy
+{
+	struct Level
+	{
+		uint32_t first;	//!< Chỉ số đầu tiên trong storage.
+		uint32_t end;	//!< Chỉ số sau phần tử cuối.
+	};
+
+	bool orderDirty = true;		//!< Cây hoặc storage thay đổi (thêm/bớt component): phải sắp xếp lại.
+	std::vector<Level> levels;	//!< Các cấp, theo độ sâu tăng dần.
+};
 
 /**
  * @class Scene
@@ -29,9 +48,30 @@ public:
 	/**
 	 * @brief Hủy một entity và tất cả các component của nó.
 	 * @param entity Handle của entity cần hủy.
+	 *
+	 * Entity chỉ bị hủy ở lần FlushDestroyedEntities kế tiếp: luồng render vẫn đọc component của nó
+	 * (RenderProxyComponent) trong lúc simulation chạy (xem SimulationThread).
 	 */
 	void DestroyEntity(entt::entity entity);
 
+	/**
+	 * @brief Hủy các entity đã được DestroyEntity đưa vào hàng đợi.
+	 *
+	 * Gọi khi không luồng nào khác đọc registry (trong SimulationThread::Extract, trước các hàm Sync của renderer).
+	 */
+	void FlushDestroyedEntities();
+
+	/**
+	 * @brief Gắn entity vào một entity cha trong cây transform.
+	 * @param child Entity con (phải có TransformComponent).
+	 * @param parent Entity cha (phải có TransformComponent), entt::null để tách khỏi cha.
+	 *
+	 * Giá trị local của con được giữ nguyên, tức là vị trí world thay đổi theo cha.
+	 * Ném std::runtime_error nếu parent là chính child hoặc con cháu của nó.
+	 * Khi entity cha bị hủy, các con trở thành gốc.
+	 */
+	void SetParent(entt::entity child, entt::entity parent);
+
 	/**
 	 * @brief Cung cấp quyền truy cập trực tiếp vào registry bên dưới.
 	 * @return Một tham chiếu đến đối tượng entt::registry.
@@ -40,7 +80,44 @@ public:
 	 */
 	entt::registry& GetRegistry() { return m_Registry; }
 
+	/**
+	 * @brief Thứ tự cập nhật transform, dùng bởi TransformSystem.
+	 */
+	TransformHierarchy& GetTransformHierarchy() { return m_TransformHierarchy; }
+
 private:
+	TransformHierarchy m_TransformHierarchy; //!< Khai báo trước registry để còn sống khi registry bị hủy.
 	entt::registry m_Registry; //!< Registry ECS cốt lõi, sở hữu tất cả các entity và component.
+	std::vector<entt::entity> m_PendingDestroys; //!< Entity chờ hủy ở FlushDestroyedEntities.
+
+	/**
+	 * @brief Callback khi TransformComponent được thêm: gốc mới, chờ cập nhật.
+	 */
+	void OnTransformConstructed(entt::registry& registry, entt::entity entity);
+
+	/**
+	 * @brief Callback khi TransformComponent được patch/replace: chờ cập nhật.
+	 */
+	void OnTransformUpdated(entt::registry& registry, entt::entity entity);
+
+	/**
+	 * @brief Callback khi TransformComponent bị xóa: tách khỏi cha, các con trở thành gốc.
+	 */
+	void OnTransformDestroyed(entt::registry& registry, entt::entity entity);
+
+	/**
+	 * @brief Đánh dấu transform của entity cần được TransformSystem tính lại (gắn TransformDirtyTag).
+	 */
+	void MarkTransformDirty(entt::entity entity);
+
+	/**
+	 * @brief Gỡ entity khỏi danh sách con của cha nó (không đổi m_Parent).
+	 */
+	void UnlinkFromParent(entt::entity entity);
+
+	/**
+	 * @brief Gán độ sâu cho entity và cả cây con của nó (không đệ quy).
+	 */
+	void UpdateSubtreeDepth(entt::entity root, uint32_t depth);
 };
 
@@ -0,0 +1,463 @@
+#include "pch.h"
+#include "SceneBVH.h"
+#include "Scene.h"
+#include "Component.h"
+#include "Model.h"
+#include <limits>
+
+bool BVHBox::Contains(const BVHBox& other) const
+{
+	return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+}
+
+bool BVHBox::Overlaps(const BVHBox& other) const
+{
+	return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+}
+
+float BVHBox::GetSurfaceArea() const
+{
+	const glm::vec3 extent = max - min;
+	return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+BVHBox BVHBox::Union(const BVHBox& a, const BVHBox& b)
+{
+	return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+SceneBVH::SceneBVH(Scene* scene) :
+	m_Scene(scene)
+{
+	entt::registry& registry = m_Scene->GetRegistry();
+	registry.on_construct<MeshComponent>().connect<&SceneBVH::OnStructureChanged>(this);
+	registry.on_update<MeshComponent>().connect<&SceneBVH::OnStructureChanged>(this);
+	registry.on_destroy<MeshComponent>().connect<&SceneBVH::OnStructureChanged>(this);
+	registry.on_construct<LightComponent>().connect<&SceneBVH::OnStructureChanged>(this);
+	registry.on_update<LightComponent>().connect<&SceneBVH::OnStructureChanged>(this);
+	registry.on_destroy<LightComponent>().connect<&SceneBVH::OnStructureChanged>(this);
+}
+
+SceneBVH::~SceneBVH()
+{
+	entt::registry& registry = m_Scene->GetRegistry();
+	registry.on_construct<MeshComponent>().disconnect(this);
+	registry.on_update<MeshComponent>().disconnect(this);
+	registry.on_destroy<MeshComponent>().disconnect(this);
+	registry.on_construct<LightComponent>().disconnect(this);
+	registry.on_update<LightComponent>().disconnect(this);
+	registry.on_destroy<LightComponent>().disconnect(this);
+}
+
+void SceneBVH::Sync()
+{
+	// Dựng lại đã đọc transform mới nhất, không cần cập nhật riêng.
+	if (m_StructureDirty)
+	{
+		Rebuild();
+		m_StructureDirty = false;
+	}
+	else
+	{
+		UpdateTransforms();
+	}
+}
+
+void SceneBVH::OnStructureChanged(entt::registry& registry, entt::entity entity)
+{
+	m_StructureDirty = true;
+}
+
+void SceneBVH::Rebuild()
+{
+	entt::registry& registry = m_Scene->GetRegistry();
+
+	// Giữ lại dung lượng đã cấp phát.
+	m_Nodes.clear();
+	m_Root = NULL_NODE;
+	m_FreeList = NULL_NODE;
+	m_LeafCount = 0;
+	registry.clear<SpatialNodeComponent>();
+
+	// Một entity có thể vừa có mesh vừa là đèn, duyệt theo TransformComponent để chỉ chèn một lá.
+	auto view = registry.view<TransformComponent>();
+	for (auto entity : view)
+	{
+		BVHBox box{};
+		uint32_t category = 0;
+		if (!ComputeEntityBounds(registry, entity, box, category)) continue;
+
+		const int32_t leaf = AllocateNode();
+		Node& node = m_Nodes[leaf];
+		node.box = { box.min - AABB_MARGIN, box.max + AABB_MARGIN };
+		node.entity = entity;
+		node.category = category;
+		node.height = 0;
+		InsertLeaf(leaf);
+		m_LeafCount++;
+
+		// Không thay đổi storage đang được duyệt (TransformComponent).
+		registry.emplace<SpatialNodeComponent>(entity, leaf);
+	}
+}
+
+void SceneBVH::UpdateTransforms()
+{
+	entt::registry& registry = m_Scene->GetRegistry();
+	auto view = registry.view<TransformChangedTag, SpatialNodeComponent>();
+
+	view.each([&](auto entity, const SpatialNodeComponent& spatialNode)
+		{
+			BVHBox box{};
+			uint32_t category = 0;
+			if (!ComputeEntityBounds(registry, entity, box, category)) return;
+
+			// AABB nới rộng vẫn bao được AABB mới: cây không đổi.
+			if (m_Nodes[spatialNode.leaf].box.Contains(box)) return;
+
+			RemoveLeaf(spatialNode.leaf);
+			m_Nodes[spatialNode.leaf].box = { box.min - AABB_MARGIN, box.max + AABB_MARGIN };
+			InsertLeaf(spatialNode.leaf);
+		}
+	);
+}
+
+bool SceneBVH::ComputeEntityBounds(const entt::registry& registry, entt::entity entity, BVHBox& box, uint32_t& category) const
+{
+	const TransformComponent& transform = registry.get<TransformComponent>(entity);
+
+	box = { glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()) };
+	category = 0;
+
+	auto addSphere = [&](const glm::vec3& center, float radius)
+		{
+			box.min = glm::min(box.min, center - radius);
+			box.max = glm::max(box.max, center + radius);
+		};
+
+	// Bounding sphere của từng mesh, tính giống RenderProxyManager.
+	const MeshComponent* meshComponent = registry.try_get<MeshComponent>(entity);
+	if (meshComponent != nullptr && meshComponent->IsVisible && meshComponent->Model != nullptr && !meshComponent->Model->getMeshes().empty())
+	{
+		const glm::mat4 model = transform.GetTransformMatrix();
+		const float maxScale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+		for (const Mesh* mesh : meshComponent->Model->getMeshes())
+		{
+			addSphere(glm::vec3(model * glm::vec4(glm::vec3(mesh->boundingSphere), 1.0f)), mesh->boundingSphere.w * maxScale);
+		}
+		category |= CATEGORY_RENDERABLE;
+	}
+
+	// Point/spot: hình cầu bán kính range quanh vị trí đèn (spot lấy cả hình cầu cho đơn giản).
+	const LightComponent* lightComponent = registry.try_get<LightComponent>(entity);
+	if (lightComponent != nullptr && lightComponent->IsEnable && lightComponent->Data.type != LightType::Directional)
+	{
+		addSphere(transform.GetWorldPosition(), lightComponent->Data.range);
+		category |= CATEGORY_LIGHT;
+	}
+
+	return category != 0;
+}
+
+int32_t SceneBVH::AllocateNode()
+{
+	if (m_FreeList == NULL_NODE)
+	{
+		m_Nodes.emplace_back();
+		return static_cast<int32_t>(m_Nodes.size() - 1);
+	}
+
+	const int32_t node = m_FreeList;
+	m_FreeList = m_Nodes[node].parent;
+	m_Nodes[node] = Node{};
+	return node;
+}
+
+void SceneBVH::FreeNode(int32_t node)
+{
+	m_Nodes[node] = Node{};
+	m_Nodes[node].parent = m_FreeList;
+	m_FreeList = node;
+}
+
+void SceneBVH::InsertLeaf(int32_t leaf)
+{
+	if (m_Root == NULL_NODE)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].parent = NULL_NODE;
+		return;
+	}
+
+	// --- 1. Tìm sibling: đi xuống theo chi phí diện tích bề mặt ---
+	const BVHBox leafBox = m_Nodes[leaf].box;
+	int32_t index = m_Root;
+	while (!m_Nodes[index].IsLeaf())
+	{
+		const Node& node = m_Nodes[index];
+		const float area = node.box.GetSurfaceArea();
+		const float combinedArea = BVHBox::Union(node.box, leafBox).GetSurfaceArea();
+
+		// Chi phí tạo node cha mới cho `index` và lá.
+		const float cost = 2.0f * combinedArea;
+
+		// Chi phí tối thiểu khi đẩy lá xuống sâu hơn: mọi tổ tiên đều bị nới rộng.
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+
+		auto descendCost = [&](int32_t child)
+			{
+				const Node& childNode = m_Nodes[child];
+				const float unionArea = BVHBox::Union(leafBox, childNode.box).GetSurfaceArea();
+				return (childNode.IsLeaf() ? unionArea : unionArea - childNode.box.GetSurfaceArea()) + inheritanceCost;
+			};
+		const float cost1 = descendCost(node.child1);
+		const float cost2 = descendCost(node.child2);
+
+		if (cost < cost1 && cost < cost2) break;
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+	const int32_t sibling = index;
+
+	// --- 2. Tạo node cha mới thay vị trí của sibling ---
+	const int32_t oldParent = m_Nodes[sibling].parent;
+	const int32_t newParent = AllocateNode(); // Có thể cấp phát lại m_Nodes, không giữ tham chiếu qua lệnh này.
+
+	m_Nodes[newParent].parent = oldParent;
+	m_Nodes[newParent].child1 = sibling;
+	m_Nodes[newParent].child2 = leaf;
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf].parent = newParent;
+	UpdateNode(newParent);
+
+	if (oldParent == NULL_NODE)
+	{
+		m_Root = newParent;
+	}
+	else if (m_Nodes[oldParent].child1 == sibling)
+	{
+		m_Nodes[oldParent].child1 = newParent;
+	}
+	else
+	{
+		m_Nodes[oldParent].child2 = newParent;
+	}
+
+	// --- 3. Sửa và cân bằng các tổ tiên ---
+	RefitAncestors(oldParent);
+}
+
+void SceneBVH::RemoveLeaf(int32_t leaf)
+{
+	if (leaf == m_Root)
+	{
+		m_Root = NULL_NODE;
+		return;
+	}
+
+	// Node cha bị xóa, sibling thế chỗ của nó.
+	const int32_t parent = m_Nodes[leaf].parent;
+	const int32_t grandParent = m_Nodes[parent].parent;
+	const int32_t sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+	m_Nodes[sibling].parent = grandParent;
+	if (grandParent == NULL_NODE)
+	{
+		m_Root = sibling;
+	}
+	else if (m_Nodes[grandParent].child1 == parent)
+	{
+		m_Nodes[grandParent].child1 = sibling;
+	}
+	else
+	{
+		m_Nodes[grandParent].child2 = sibling;
+	}
+
+	FreeNode(parent);
+	m_Nodes[leaf].parent = NULL_NODE;
+	RefitAncestors(grandParent);
+}
+
+void SceneBVH::RefitAncestors(int32_t node)
+{
+	while (node != NULL_NODE)
+	{
+		node = Balance(node);
+		UpdateNode(node);
+		node = m_Nodes[node].parent;
+	}
+}
+
+void SceneBVH::UpdateNode(int32_t node)
+{
+	Node& parent = m_Nodes[node];
+	const Node& child1 = m_Nodes[parent.child1];
+	const Node& child2 = m_Nodes[parent.child2];
+
+	parent.box = BVHBox::Union(child1.box, child2.box);
+	parent.height = 1 + std::max(child1.height, child2.height);
+	parent.category = child1.category | child2.category;
+}
+
+int32_t SceneBVH::Balance(int32_t nodeA)
+{
+	//        A                C (hoặc B)
+	//      /   \            /   \
+	//     B     C    =>    A     F/G
+	//          / \        / \
+	//         F   G      B   G/F
+	// Đưa con cao hơn (C hoặc B) lên thay A, cháu thấp hơn của nó xuống làm con của A.
+	Node& a = m_Nodes[nodeA];
+	if (a.IsLeaf() || a.height < 2) return nodeA;
+
+	const int32_t nodeB = a.child1;
+	const int32_t nodeC = a.child2;
+	const int32_t balance = m_Nodes[nodeC].height - m_Nodes[nodeB].height;
+	if (balance >= -1 && balance <= 1) return nodeA;
+
+	// Con cao hơn (được đưa lên) và con còn lại của A.
+	const bool rotateC = balance > 1;
+	const int32_t nodeUp = rotateC ? nodeC : nodeB;
+	Node& up = m_Nodes[nodeUp];
+	const int32_t grandChild1 = up.child1;
+	const int32_t grandChild2 = up.child2;
+
+	// `up` thế chỗ của A dưới node cha của A.
+	up.parent = a.parent;
+	a.parent = nodeUp;
+	if (up.parent == NULL_NODE)
+	{
+		m_Root = nodeUp;
+	}
+	else if (m_Nodes[up.parent].child1 == nodeA)
+	{
+		m_Nodes[up.parent].child1 = nodeUp;
+	}
+	else
+	{
+		m_Nodes[up.parent].child2 = nodeUp;
+	}
+
+	// Cháu cao hơn ở lại dưới `up`, cháu thấp hơn thay chỗ của `up` dưới A.
+	const bool keepFirst = m_Nodes[grandChild1].height > m_Nodes[grandChild2].height;
+	const int32_t kept = keepFirst ? grandChild1 : grandChild2;
+	const int32_t moved = keepFirst ? grandChild2 : grandChild1;
+
+	up.child1 = nodeA;
+	up.child2 = kept;
+	if (rotateC)
+	{
+		a.child2 = moved;
+	}
+	else
+	{
+		a.child1 = moved;
+	}
+	m_Nodes[moved].parent = nodeA;
+
+	UpdateNode(nodeA);
+	UpdateNode(nodeUp);
+	return nodeUp;
+}
+
+template<typename TestNode>
+void SceneBVH::Traverse(uint32_t categoryMask, std::vector<entt::entity>& output, TestNode&& testNode) const
+{
+	if (m_Root == NULL_NODE) return;
+
+	// `inside`: node cha đã nằm trọn trong vùng truy vấn, không cần test lại.
+	struct StackEntry
+	{
+		int32_t node;
+		bool inside;
+	};
+
+	// Cây được giữ cân bằng nên stack hiếm khi vượt quá vài chục phần tử.
+	std::vector<StackEntry> stack;
+	stack.reserve(64);
+	stack.push_back({ m_Root, false });
+
+	while (!stack.empty())
+	{
+		const StackEntry entry = stack.back();
+		stack.pop_back();
+
+		const Node& node = m_Nodes[entry.node];
+		if ((node.category & categoryMask) == 0) continue;
+
+		bool inside = entry.inside;
+		if (!inside)
+		{
+			const int result = testNode(node.box);
+			if (result < 0) continue;
+			inside = result > 0;
+		}
+
+		if (node.IsLeaf())
+		{
+			output.push_back(node.entity);
+		}
+		else
+		{
+			stack.push_back({ node.child1, inside });
+			stack.push_back({ node.child2, inside });
+		}
+	}
+}
+
+void SceneBVH::QueryFrustum(const std::array<glm::vec4, 6>& planes, uint32_t categoryMask, std::vector<entt::entity>& output) const
+{
+	Traverse(categoryMask, output, [&](const BVHBox& box)
+		{
+			int result = 1;
+			for (const glm::vec4& plane : planes)
+			{
+				const glm::vec3 normal(plane);
+
+				// Đỉnh xa nhất theo hướng pháp tuyến (p-vertex) và đỉnh đối diện (n-vertex).
+				const glm::vec3 positive = glm::mix(box.min, box.max, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+				const glm::vec3 negative = glm::mix(box.max, box.min, glm::greaterThanEqual(normal, glm::vec3(0.0f)));
+
+				if (glm::dot(normal, positive) + plane.w < 0.0f) return -1;
+				if (glm::dot(normal, negative) + plane.w < 0.0f) result = 0;
+			}
+			return result;
+		});
+}
+
+void SceneBVH::QuerySphere(const glm::vec3& center, float radius, uint32_t categoryMask, std::vector<entt::entity>& output) const
+{
+	Traverse(categoryMask, output, [&](const BVHBox& box)
+		{
+			const glm::vec3 closest = glm::clamp(center, box.min, box.max);
+			const glm::vec3 offset = closest - center;
+			return glm::dot(offset, offset) <= radius * radius ? 0 : -1;
+		});
+}
+
+void SceneBVH::QueryBox(const BVHBox& queryBox, uint32_t categoryMask, std::vector<entt::entity>& output) const
+{
+	Traverse(categoryMask, output, [&](const BVHBox& box)
+		{
+			if (!queryBox.Overlaps(box)) return -1;
+			return queryBox.Contains(box) ? 1 : 0;
+		});
+}
+
+void SceneBVH::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t categoryMask, std::vector<entt::entity>& output) const
+{
+	// Phép thử slab, thành phần hướng bằng 0 cho nghịch đảo vô cực (IEEE 754).
+	const glm::vec3 inverseDirection = 1.0f / direction;
+
+	Traverse(categoryMask, output, [&](const BVHBox& box)
+		{
+			const glm::vec3 t1 = (box.min - origin) * inverseDirection;
+			const glm::vec3 t2 = (box.max - origin) * inverseDirection;
+			const glm::vec3 tNear = glm::min(t1, t2);
+			const glm::vec3 tFar = glm::max(t1, t2);
+
+			const float enter = std::max({ tNear.x, tNear.y, tNear.z, 0.0f });
+			const float exit = std::min({ tFar.x, tFar.y, tFar.z, maxDistance });
+			return enter <= exit ? 0 : -1;
+		});
+}
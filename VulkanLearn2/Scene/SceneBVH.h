@@ -0,0 +1,134 @@
+#pragma once
+#include <vector>
+#include <array>
+
+// Forward declarations
+class Scene;
+
+// =================================================================================================
+// Struct: BVHBox
+// Mô tả: Axis-aligned bounding box trong world space.
+// =================================================================================================
+struct BVHBox
+{
+	glm::vec3 min;
+	glm::vec3 max;
+
+	bool Contains(const BVHBox& other) const;
+	bool Overlaps(const BVHBox& other) const;
+	float GetSurfaceArea() const;
+	static BVHBox Union(const BVHBox& a, const BVHBox& b);
+};
+
+// =================================================================================================
+// Class: SceneBVH
+// Mô tả:
+//      Chỉ mục không gian của scene: cây AABB động (dynamic AABB tree) chứa các entity có thể render
+//      (Transform + Mesh) và các nguồn sáng có phạm vi (point, spot), đặt cạnh registry để trả lời các
+//      truy vấn frustum, sphere, box và ray mà không phải duyệt toàn bộ view của registry.
+//        - Mỗi entity là một lá với AABB được nới rộng (AABB_MARGIN), nên chuyển động nhỏ không làm
+//          thay đổi cây. Khi AABB chặt vượt ra ngoài, lá được gỡ và chèn lại (chọn vị trí theo chi phí
+//          diện tích bề mặt), đường đi lên gốc được cân bằng bằng phép xoay để chiều cao cây luôn ~log(n).
+//        - Thay đổi transform: lấy theo TransformChangedTag của TransformSystem, chỉ các lá đó được cập nhật.
+//        - Thay đổi cấu trúc (MeshComponent, LightComponent được thêm, xóa hoặc patch/replace):
+//          cây được dựng lại ở lần Sync kế tiếp (giống RenderProxyManager).
+//      Đèn directional ảnh hưởng toàn bộ scene nên không nằm trong cây.
+//      Mỗi entity trong cây được gắn SpatialNodeComponent (chỉ số lá của nó).
+// =================================================================================================
+class SceneBVH
+{
+public:
+	// Loại entity của một lá, dùng làm mask khi truy vấn.
+	static constexpr uint32_t CATEGORY_RENDERABLE = 1u << 0;
+	static constexpr uint32_t CATEGORY_LIGHT = 1u << 1;
+	static constexpr uint32_t CATEGORY_ALL = ~0u;
+
+	// Constructor: Đăng ký lắng nghe thay đổi của MeshComponent và LightComponent trong registry của `scene`.
+	SceneBVH(Scene* scene);
+	~SceneBVH();
+
+	// Cấm sao chép.
+	SceneBVH(const SceneBVH&) = delete;
+	SceneBVH& operator=(const SceneBVH&) = delete;
+
+	// Áp dụng các thay đổi từ lần Sync trước.
+	// LƯU Ý: Gọi mỗi frame sau TransformSystem và trước RenderProxyManager::Sync (hàm này xóa TransformChangedTag).
+	void Sync();
+
+	// --- Truy vấn ---
+	// Thêm vào `output` các entity có loại thuộc `categoryMask` và AABB (đã nới rộng) giao với vùng truy vấn.
+	// Kết quả là tập ứng viên (broad phase), người gọi tự test chính xác nếu cần.
+
+	// `planes`: Mặt phẳng đã chuẩn hóa, pháp tuyến hướng vào trong (FrustumCuller::ExtractFrustumPlanes).
+	void QueryFrustum(const std::array<glm::vec4, 6>& planes, uint32_t categoryMask, std::vector<entt::entity>& output) const;
+	void QuerySphere(const glm::vec3& center, float radius, uint32_t categoryMask, std::vector<entt::entity>& output) const;
+	void QueryBox(const BVHBox& box, uint32_t categoryMask, std::vector<entt::entity>& output) const;
+	// Tia từ `origin` theo `direction` (không cần chuẩn hóa), dài tối đa `maxDistance` lần `direction`.
+	void QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, uint32_t categoryMask, std::vector<entt::entity>& output) const;
+
+	// --- Getters ---
+	uint32_t GetLeafCount() const { return m_LeafCount; }
+	int32_t GetHeight() const { return m_Root == NULL_NODE ? 0 : m_Nodes[m_Root].height; }
+
+private:
+	// --- Cấu hình ---
+	static constexpr int32_t NULL_NODE = -1;
+	static constexpr float AABB_MARGIN = 0.1f;	// Độ nới rộng AABB của lá (mét) mỗi phía.
+
+	// Node của cây. Lá có child1 == NULL_NODE. Node trong free list dùng `parent` làm con trỏ next.
+	struct Node
+	{
+		BVHBox box;
+		entt::entity entity = entt::null;
+		uint32_t category = 0;		// Lá: loại của entity. Node trong: OR của các con (bỏ qua nhánh không khớp mask).
+		int32_t parent = NULL_NODE;
+		int32_t child1 = NULL_NODE;
+		int32_t child2 = NULL_NODE;
+		int32_t height = -1;		// Lá: 0, node tự do: -1.
+
+		bool IsLeaf() const { return child1 == NULL_NODE; }
+	};
+
+	// --- Tham chiếu đến các tài nguyên bên ngoài ---
+	Scene* m_Scene;
+
+	// --- Dữ liệu nội bộ ---
+	std::vector<Node> m_Nodes;
+	int32_t m_Root = NULL_NODE;
+	int32_t m_FreeList = NULL_NODE;
+	uint32_t m_LeafCount = 0;
+	bool m_StructureDirty = true;		// Dựng lại toàn bộ ở lần Sync kế tiếp (ban đầu luôn cần dựng).
+
+	// --- Hàm helper private ---
+
+	// Callback của registry khi MeshComponent hoặc LightComponent được thêm, xóa hoặc patch/replace.
+	void OnStructureChanged(entt::registry& registry, entt::entity entity);
+
+	// Helper: Xóa cây và chèn lại mọi entity có mesh hoặc đèn có phạm vi.
+	void Rebuild();
+
+	// Helper: Cập nhật lá của các entity có TransformChangedTag.
+	void UpdateTransforms();
+
+	// Helper: AABB chặt và loại của entity. Trả về false nếu entity không có gì cần đưa vào cây.
+	bool ComputeEntityBounds(const entt::registry& registry, entt::entity entity, BVHBox& box, uint32_t& category) const;
+
+	// Helper: Quản lý node (free list).
+	int32_t AllocateNode();
+	void FreeNode(int32_t node);
+
+	// Helper: Chèn/gỡ lá và sửa AABB, chiều cao, category dọc đường đi lên gốc.
+	void InsertLeaf(int32_t leaf);
+	void RemoveLeaf(int32_t leaf);
+	void RefitAncestors(int32_t node);
+
+	// Helper: Tính lại AABB, chiều cao và category của node trong từ hai con.
+	void UpdateNode(int32_t node);
+
+	// Helper: Xoay để cân bằng cây con gốc `nodeA` (AVL), trả về gốc mới của cây con.
+	int32_t Balance(int32_t nodeA);
+
+	// Helper: Duyệt cây từ gốc bằng stack, `testNode(box)` trả về -1 (bỏ cả nhánh), 0 (giao), 1 (nằm trọn trong vùng truy vấn).
+	template<typename TestNode>
+	void Traverse(uint32_t categoryMask, std::vector<entt::entity>& output, TestNode&& testNode) const;
+};
@@ -0,0 +1,470 @@
+#include "pch.h"
+#include "SceneSerializer.h"
+#include "Scene.h"
+#include "Component.h"
+#include "Model.h"
+#include <cstring>
+
+namespace
+{
+	// Gom component của các entity được lưu thành hai mảng song song: chỉ số entity trong file và bản ghi.
+	template<typename Component, typename Record, typename Convert>
+	void CollectComponents(entt::registry& registry, const std::unordered_map<entt::entity, uint32_t>& fileIndices,
+		Convert convert, std::vector<uint32_t>& indices, std::vector<Record>& records)
+	{
+		auto& storage = registry.storage<Component>();
+		indices.reserve(storage.size());
+		records.reserve(storage.size());
+		for (auto [entity, component] : storage.each())
+		{
+			// Entity không có TransformComponent không được lưu.
+			const auto it = fileIndices.find(entity);
+			if (it == fileIndices.end()) continue;
+
+			indices.push_back(it->second);
+			records.push_back(convert(component));
+		}
+	}
+
+	// Đọc tuần tự từ bộ nhớ của file, kiểm tra tràn trước mỗi lần đọc.
+	class BinaryReader
+	{
+	public:
+		explicit BinaryReader(const std::vector<char>& data) : m_Data(data) {}
+
+		void Read(void* destination, size_t size)
+		{
+			if (size > m_Data.size() - m_Offset)
+			{
+				throw std::runtime_error("LỖI: SceneSerializer: File scene bị cắt cụt!");
+			}
+			std::memcpy(destination, m_Data.data() + m_Offset, size);
+			m_Offset += size;
+		}
+
+		template<typename T>
+		std::vector<T> ReadArray(uint32_t count)
+		{
+			std::vector<T> values(count);
+			Read(values.data(), sizeof(T) * count);
+			return values;
+		}
+
+		size_t GetOffset() const { return m_Offset; }
+		size_t GetSize() const { return m_Data.size(); }
+		void Seek(size_t offset) { m_Offset = offset; }
+
+	private:
+		const std::vector<char>& m_Data;
+		size_t m_Offset = 0;
+	};
+
+	void AppendBytes(std::vector<char>& buffer, const void* data, size_t size)
+	{
+		const char* bytes = static_cast<const char*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	}
+}
+
+void SceneSerializer::Save(Scene* scene, const std::string& filePath)
+{
+	entt::registry& registry = scene->GetRegistry();
+	auto& transforms = registry.storage<TransformComponent>();
+
+	// Thứ tự trong file: theo độ sâu, cha luôn đứng trước con, nên khi tải cây được dựng bằng một lượt.
+	std::vector<entt::entity> entities(transforms.data(), transforms.data() + transforms.size());
+	std::stable_sort(entities.begin(), entities.end(), [&](entt::entity lhs, entt::entity rhs)
+		{
+			return transforms.get(lhs).m_Depth < transforms.get(rhs).m_Depth;
+		});
+
+	const uint32_t entityCount = static_cast<uint32_t>(entities.size());
+	std::unordered_map<entt::entity, uint32_t> fileIndices;
+	fileIndices.reserve(entityCount);
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		fileIndices.emplace(entities[i], i);
+	}
+
+	std::vector<char> buffer(sizeof(FileHeader));
+	uint32_t blockCount = 0;
+
+	// --- TransformComponent: mọi entity, theo thứ tự trong file ---
+	{
+		std::vector<uint32_t> indices(entityCount);
+		std::vector<TransformRecord> records(entityCount);
+		for (uint32_t i = 0; i < entityCount; i++)
+		{
+			const TransformComponent& transform = transforms.get(entities[i]);
+			TransformRecord& record = records[i];
+			record = {
+				{ transform.m_Position.x, transform.m_Position.y, transform.m_Position.z },
+				{ transform.m_Orientation.x, transform.m_Orientation.y, transform.m_Orientation.z, transform.m_Orientation.w },
+				{ transform.m_Scale.x, transform.m_Scale.y, transform.m_Scale.z },
+				transform.m_Parent != entt::null ? fileIndices.at(transform.m_Parent) : NO_PARENT
+			};
+			indices[i] = i;
+		}
+		AppendBlock(buffer, BLOCK_TRANSFORM, indices, records.data(), records.size() * sizeof(TransformRecord), blockCount);
+	}
+
+	// --- NameComponent: mảng độ dài, rồi toàn bộ ký tự liền nhau ---
+	{
+		std::vector<uint32_t> indices;
+		std::vector<uint32_t> lengths;
+		CollectComponents<NameComponent>(registry, fileIndices,
+			[](const NameComponent& name) { return static_cast<uint32_t>(name.Name.size()); }, indices, lengths);
+
+		std::vector<char> data;
+		AppendBytes(data, lengths.data(), lengths.size() * sizeof(uint32_t));
+		for (uint32_t index : indices)
+		{
+			const std::string& name = registry.get<NameComponent>(entities[index]).Name;
+			AppendBytes(data, name.data(), name.size());
+		}
+		AppendBlock(buffer, BLOCK_NAME, indices, data.data(), data.size(), blockCount);
+	}
+
+	// --- MeshComponent ---
+	{
+		std::vector<uint32_t> indices;
+		std::vector<MeshRecord> records;
+		CollectComponents<MeshComponent>(registry, fileIndices, [](const MeshComponent& mesh)
+			{
+				return MeshRecord{ mesh.Model ? mesh.Model->getAssetId() : 0, mesh.MaxDrawDistance, mesh.MinScreenSize, mesh.MaxShadowDistance, mesh.IsVisible ? 1u : 0u };
+			}, indices, records);
+		AppendBlock(buffer, BLOCK_MESH, indices, records.data(), records.size() * sizeof(MeshRecord), blockCount);
+	}
+
+	// --- LightComponent ---
+	{
+		std::vector<uint32_t> indices;
+		std::vector<LightRecord> records;
+		CollectComponents<LightComponent>(registry, fileIndices, [](const LightComponent& light)
+			{
+				const Light& data = light.Data;
+				return LightRecord{
+					static_cast<int32_t>(data.type),
+					{ data.direction.x, data.direction.y, data.direction.z },
+					{ data.color.r, data.color.g, data.color.b },
+					data.intensity, data.range, data.innerCutoff, data.outerCutoff, data.sourceRadius,
+					data.shadowMapIndex >= 0 ? 0 : -1,	// Chỉ lưu có/không có bóng đổ, layer do LightManager gán trong constructor.
+					light.IsEnable ? 1u : 0u
+				};
+			}, indices, records);
+		AppendBlock(buffer, BLOCK_LIGHT, indices, records.data(), records.size() * sizeof(LightRecord), blockCount);
+	}
+
+	// --- CameraComponent ---
+	{
+		std::vector<uint32_t> indices;
+		std::vector<CameraRecord> records;
+		CollectComponents<CameraComponent>(registry, fileIndices, [](const CameraComponent& camera)
+			{
+				return CameraRecord{ camera.m_Fov, camera.m_Near, camera.m_Far, camera.m_AspectRatio, camera.m_IsPrimary ? 1u : 0u };
+			}, indices, records);
+		AppendBlock(buffer, BLOCK_CAMERA, indices, records.data(), records.size() * sizeof(CameraRecord), blockCount);
+	}
+
+	// --- OccluderComponent ---
+	{
+		std::vector<uint32_t> indices;
+		std::vector<OccluderRecord> records;
+		CollectComponents<OccluderComponent>(registry, fileIndices, [](const OccluderComponent& occluder)
+			{
+				return OccluderRecord{
+					{ occluder.Center.x, occluder.Center.y, occluder.Center.z },
+					{ occluder.HalfExtents.x, occluder.HalfExtents.y, occluder.HalfExtents.z }
+				};
+			}, indices, records);
+		AppendBlock(buffer, BLOCK_OCCLUDER, indices, records.data(), records.size() * sizeof(OccluderRecord), blockCount);
+	}
+
+	const FileHeader header{ FILE_MAGIC, FORMAT_VERSION, entityCount, blockCount };
+	std::memcpy(buffer.data(), &header, sizeof(header));
+
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	if (!file)
+	{
+		throw std::runtime_error("LỖI: SceneSerializer: Ghi file scene thất bại: " + filePath);
+	}
+}
+
+std::vector<entt::entity> SceneSerializer::Load(Scene* scene, const std::string& filePath, const std::unordered_map<uint64_t, Model*>& models)
+{
+	const std::vector<char> data = ReadFile(filePath);
+	BinaryReader reader(data);
+
+	FileHeader header{};
+	reader.Read(&header, sizeof(header));
+	if (header.magic != FILE_MAGIC)
+	{
+		throw std::runtime_error("LỖI: SceneSerializer: Không phải file scene: " + filePath);
+	}
+	if (header.version != FORMAT_VERSION)
+	{
+		throw std::runtime_error("LỖI: SceneSerializer: Version file scene không được hỗ trợ (" + std::to_string(header.version) + "): " + filePath);
+	}
+
+	// Mỗi entity có ít nhất một bản ghi TransformComponent: số entity không thể vượt quá số byte còn lại,
+	// kiểm tra trước khi tạo entity để file hỏng không cấp phát theo một số tùy ý.
+	if (static_cast<uint64_t>(header.entityCount) * (sizeof(uint32_t) + sizeof(TransformRecord)) > reader.GetSize() - reader.GetOffset())
+	{
+		throw std::runtime_error("LỖI: SceneSerializer: File scene bị cắt cụt!");
+	}
+
+	entt::registry& registry = scene->GetRegistry();
+	std::vector<entt::entity> entities(header.entityCount);
+	registry.create(entities.begin(), entities.end());
+
+	// Một block hỏng giữa chừng: hủy mọi entity đã tạo, scene giữ nguyên như trước khi tải.
+	try
+	{
+		// Mỗi loại block và mỗi entity trong một block chỉ được xuất hiện một lần (registry.insert trên entity
+		// đã có component làm hỏng storage của entt).
+		std::vector<uint32_t> loadedBlockTypes;
+
+		for (uint32_t block = 0; block < header.blockCount; block++)
+		{
+			BlockHeader blockHeader{};
+			reader.Read(&blockHeader, sizeof(blockHeader));
+			if (blockHeader.payloadSize > reader.GetSize() - reader.GetOffset())
+			{
+				throw std::runtime_error("LỖI: SceneSerializer: File scene bị cắt cụt!");
+			}
+			const size_t blockEnd = reader.GetOffset() + blockHeader.payloadSize;
+			const uint32_t count = blockHeader.count;
+
+			// Block loại không biết (ví dụ do version mới hơn thêm vào): bỏ qua.
+			const size_t recordSize = GetRecordSize(blockHeader.type);
+			if (recordSize == 0)
+			{
+				reader.Seek(blockEnd);
+				continue;
+			}
+
+			// Kích thước block phải khớp với số bản ghi, kiểm tra trước mọi cấp phát theo `count`
+			// (NameComponent có độ dài thay đổi: chỉ biết cận dưới là chỉ số và độ dài của mỗi tên).
+			const uint64_t expectedSize = static_cast<uint64_t>(count) * (sizeof(uint32_t) + recordSize);
+			if (blockHeader.type == BLOCK_NAME ? blockHeader.payloadSize < expectedSize : blockHeader.payloadSize != expectedSize)
+			{
+				throw std::runtime_error("LỖI: SceneSerializer: Kích thước block không hợp lệ!");
+			}
+
+			if (std::find(loadedBlockTypes.begin(), loadedBlockTypes.end(), blockHeader.type) != loadedBlockTypes.end())
+			{
+				throw std::runtime_error("LỖI: SceneSerializer: Block bị lặp lại!");
+			}
+			loadedBlockTypes.push_back(blockHeader.type);
+
+			std::vector<entt::entity> blockEntities(count);
+			{
+				const std::vector<uint32_t> indices = reader.ReadArray<uint32_t>(count);
+				std::vector<bool> seen(header.entityCount, false);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					if (indices[i] >= header.entityCount)
+					{
+						throw std::runtime_error("LỖI: SceneSerializer: Chỉ số entity không hợp lệ!");
+					}
+					if (seen[indices[i]])
+					{
+						throw std::runtime_error("LỖI: SceneSerializer: Entity bị lặp lại trong block!");
+					}
+					seen[indices[i]] = true;
+					blockEntities[i] = entities[indices[i]];
+				}
+			}
+
+			switch (blockHeader.type)
+			{
+			case BLOCK_TRANSFORM:
+			{
+				const std::vector<TransformRecord> records = reader.ReadArray<TransformRecord>(count);
+
+				std::vector<TransformComponent> components(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					const TransformRecord& record = records[i];
+					TransformComponent& transform = components[i];
+					transform.m_Position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+					transform.m_Orientation = glm::normalize(glm::quat(record.orientation[3], record.orientation[0], record.orientation[1], record.orientation[2]));
+					transform.m_Scale = glm::vec3(record.scale[0], record.scale[1], record.scale[2]);
+					transform.m_IsEulerStale = true;
+				}
+				registry.insert<TransformComponent>(blockEntities.begin(), blockEntities.end(), components.begin());
+
+				// Cha đứng trước con trong file, nên mỗi lần gắn chỉ thêm một lá vào cây.
+				for (uint32_t i = 0; i < count; i++)
+				{
+					if (records[i].parent == NO_PARENT) continue;
+					if (records[i].parent >= header.entityCount)
+					{
+						throw std::runtime_error("LỖI: SceneSerializer: Chỉ số entity cha không hợp lệ!");
+					}
+					scene->SetParent(blockEntities[i], entities[records[i].parent]);
+				}
+				break;
+			}
+			case BLOCK_NAME:
+			{
+				const std::vector<uint32_t> lengths = reader.ReadArray<uint32_t>(count);
+
+				std::vector<NameComponent> components(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					if (lengths[i] > blockEnd - reader.GetOffset())
+					{
+						throw std::runtime_error("LỖI: SceneSerializer: Kích thước block không hợp lệ!");
+					}
+					components[i].Name.resize(lengths[i]);
+					reader.Read(components[i].Name.data(), lengths[i]);
+				}
+				registry.insert<NameComponent>(blockEntities.begin(), blockEntities.end(), components.begin());
+				break;
+			}
+			case BLOCK_MESH:
+			{
+				const std::vector<MeshRecord> records = reader.ReadArray<MeshRecord>(count);
+
+				std::vector<MeshComponent> components(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					const MeshRecord& record = records[i];
+					MeshComponent& mesh = components[i];
+					if (record.modelId != 0)
+					{
+						const auto it = models.find(record.modelId);
+						if (it == models.end())
+						{
+							throw std::runtime_error("LỖI: SceneSerializer: File scene tham chiếu model chưa được tải (ID: " + std::to_string(record.modelId) + ")!");
+						}
+						mesh.Model = it->second;
+					}
+					mesh.IsVisible = record.isVisible != 0;
+					mesh.MaxDrawDistance = record.maxDrawDistance;
+					mesh.MinScreenSize = record.minScreenSize;
+					mesh.MaxShadowDistance = record.maxShadowDistance;
+				}
+				registry.insert<MeshComponent>(blockEntities.begin(), blockEntities.end(), components.begin());
+				break;
+			}
+			case BLOCK_LIGHT:
+			{
+				const std::vector<LightRecord> records = reader.ReadArray<LightRecord>(count);
+
+				std::vector<LightComponent> components(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					const LightRecord& record = records[i];
+					Light& light = components[i].Data;
+					if (record.type < static_cast<int32_t>(LightType::Directional) || record.type > static_cast<int32_t>(LightType::Spot))
+					{
+						throw std::runtime_error("LỖI: SceneSerializer: Loại đèn không hợp lệ!");
+					}
+					light.type = static_cast<LightType>(record.type);
+					light.direction = glm::vec3(record.direction[0], record.direction[1], record.direction[2]);
+					light.color = glm::vec3(record.color[0], record.color[1], record.color[2]);
+					light.intensity = record.intensity;
+					light.range = record.range;
+					light.innerCutoff = record.innerCutoff;
+					light.outerCutoff = record.outerCutoff;
+					light.sourceRadius = record.sourceRadius;
+					light.shadowMapIndex = record.shadowMapIndex >= 0 ? 0 : -1;
+					components[i].IsEnable = record.isEnable != 0;
+				}
+				registry.insert<LightComponent>(blockEntities.begin(), blockEntities.end(), components.begin());
+				break;
+			}
+			case BLOCK_CAMERA:
+			{
+				const std::vector<CameraRecord> records = reader.ReadArray<CameraRecord>(count);
+
+				std::vector<CameraComponent> components(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					const CameraRecord& record = records[i];
+					CameraComponent& camera = components[i];
+					camera.m_Fov = record.fov;
+					camera.m_Near = record.nearPlane;
+					camera.m_Far = record.farPlane;
+					camera.m_AspectRatio = record.aspectRatio;
+					camera.m_IsPrimary = record.isPrimary != 0;
+				}
+				registry.insert<CameraComponent>(blockEntities.begin(), blockEntities.end(), components.begin());
+				break;
+			}
+			case BLOCK_OCCLUDER:
+			{
+				const std::vector<OccluderRecord> records = reader.ReadArray<OccluderRecord>(count);
+
+				std::vector<OccluderComponent> components(count);
+				for (uint32_t i = 0; i < count; i++)
+				{
+					components[i].Center = glm::vec3(records[i].center[0], records[i].center[1], records[i].center[2]);
+					components[i].HalfExtents = glm::vec3(records[i].halfExtents[0], records[i].halfExtents[1], records[i].halfExtents[2]);
+				}
+				registry.insert<OccluderComponent>(blockEntities.begin(), blockEntities.end(), components.begin());
+				break;
+			}
+			}
+
+			if (reader.GetOffset() != blockEnd)
+			{
+				throw std::runtime_error("LỖI: SceneSerializer: Kích thước block không hợp lệ!");
+			}
+		}
+
+	}
+	catch (...)
+	{
+		registry.destroy(entities.begin(), entities.end());
+		throw;
+	}
+
+	return entities;
+}
+
+void SceneSerializer::AppendBlock(std::vector<char>& buffer, uint32_t type, const std::vector<uint32_t>& indices, const void* data, size_t dataSize, uint32_t& blockCount)
+{
+	if (indices.empty()) return;
+
+	const BlockHeader header{ type, static_cast<uint32_t>(indices.size()), indices.size() * sizeof(uint32_t) + dataSize };
+	AppendBytes(buffer, &header, sizeof(header));
+	AppendBytes(buffer, indices.data(), indices.size() * sizeof(uint32_t));
+	AppendBytes(buffer, data, dataSize);
+	blockCount++;
+}
+
+size_t SceneSerializer::GetRecordSize(uint32_t type)
+{
+	switch (type)
+	{
+	case BLOCK_TRANSFORM: return sizeof(TransformRecord);
+	case BLOCK_NAME: return sizeof(uint32_t);
+	case BLOCK_MESH: return sizeof(MeshRecord);
+	case BLOCK_LIGHT: return sizeof(LightRecord);
+	case BLOCK_CAMERA: return sizeof(CameraRecord);
+	case BLOCK_OCCLUDER: return sizeof(OccluderRecord);
+	default: return 0;
+	}
+}
+
+std::vector<char> SceneSerializer::ReadFile(const std::string& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		throw std::runtime_error("LỖI: SceneSerializer: Không thể mở file scene: " + filePath);
+	}
+
+	std::vector<char> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(data.data(), static_cast<std::streamsize>(data.size()));
+	if (!file)
+	{
+		throw std::runtime_error("LỖI: SceneSerializer: Đọc file scene thất bại: " + filePath);
+	}
+	return data;
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Forward declarations
+class Scene;
+class Model;
+
+// =================================================================================================
+// Class: SceneSerializer
+// Mô tả:
+//      Lưu/tải entity và component của Scene ở định dạng nhị phân có version.
+//      Mỗi loại component là một block liên tục: mảng chỉ số entity rồi mảng bản ghi kích thước cố định
+//      (NameComponent: mảng độ dài rồi toàn bộ ký tự), nên khi tải cả block được đọc một lần và chèn hàng
+//      loạt vào registry (registry.create/insert theo khoảng), không phân tích từng entity.
+//        - Chỉ entity có TransformComponent được lưu, theo thứ tự độ sâu trong cây (cha luôn đứng trước con).
+//        - Model được tham chiếu bằng Model::getAssetId (hash đường dẫn), được phân giải bằng bảng do
+//          người gọi cung cấp khi tải.
+//        - Component runtime (RenderProxyComponent, SpatialNodeComponent, các tag) không được lưu.
+//      Block có loại không biết được bỏ qua (dựa vào kích thước trong header của block).
+//      Số được ghi theo thứ tự byte của máy (little-endian trên mọi nền tảng đang hỗ trợ).
+// =================================================================================================
+class SceneSerializer
+{
+public:
+	// Ghi toàn bộ scene ra file. Ném std::runtime_error nếu không ghi được.
+	static void Save(Scene* scene, const std::string& filePath);
+
+	// Tạo các entity trong file vào scene (không xóa entity đang có), trả về danh sách entity mới theo thứ tự
+	// trong file. Ném std::runtime_error nếu file hỏng, sai version hoặc tham chiếu model không có trong `models`;
+	// khi đó mọi entity đã tạo bị hủy, scene giữ nguyên.
+	// LightManager chỉ đọc đèn và gán layer shadow một lần trong constructor: scene có đèn phải được tải trước khi
+	// tạo LightManager (giống Application::CreateSceneLights), đèn tải sau đó không được chiếu sáng.
+	static std::vector<entt::entity> Load(Scene* scene, const std::string& filePath, const std::unordered_map<uint64_t, Model*>& models);
+
+	static constexpr uint32_t FORMAT_VERSION = 1;
+
+private:
+	// Mã loại block (FourCC).
+	static constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+	{
+		return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+	}
+	static constexpr uint32_t FILE_MAGIC = MakeFourCC('V', 'L', 'S', 'C');
+	static constexpr uint32_t BLOCK_TRANSFORM = MakeFourCC('T', 'R', 'N', 'S');
+	static constexpr uint32_t BLOCK_NAME = MakeFourCC('N', 'A', 'M', 'E');
+	static constexpr uint32_t BLOCK_MESH = MakeFourCC('M', 'E', 'S', 'H');
+	static constexpr uint32_t BLOCK_LIGHT = MakeFourCC('L', 'G', 'H', 'T');
+	static constexpr uint32_t BLOCK_CAMERA = MakeFourCC('C', 'A', 'M', 'R');
+	static constexpr uint32_t BLOCK_OCCLUDER = MakeFourCC('O', 'C', 'C', 'L');
+	static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+	// --- Bố cục trong file ---
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entityCount;
+		uint32_t blockCount;
+	};
+
+	struct BlockHeader
+	{
+		uint32_t type;
+		uint32_t count;			// Số component trong block.
+		uint64_t payloadSize;	// Số byte sau header (chỉ số entity + dữ liệu).
+	};
+
+	struct TransformRecord
+	{
+		float position[3];
+		float orientation[4];	// x, y, z, w
+		float scale[3];
+		uint32_t parent;		// Chỉ số entity cha trong file, NO_PARENT: gốc.
+	};
+
+	struct MeshRecord
+	{
+		uint64_t modelId;		// Model::getAssetId, 0: không có model.
+		float maxDrawDistance;
+		float minScreenSize;
+		float maxShadowDistance;
+		uint32_t isVisible;
+	};
+
+	struct LightRecord
+	{
+		int32_t type;
+		float direction[3];
+		float color[3];
+		float intensity;
+		float range;
+		float innerCutoff;
+		float outerCutoff;
+		float sourceRadius;
+		int32_t shadowMapIndex;	// -1: không có bóng đổ, 0: có (layer thật do LightManager gán).
+		uint32_t isEnable;
+	};
+
+	struct CameraRecord
+	{
+		float fov;
+		float nearPlane;
+		float farPlane;
+		float aspectRatio;
+		uint32_t isPrimary;
+	};
+
+	struct OccluderRecord
+	{
+		float center[3];
+		float halfExtents[3];
+	};
+
+	// --- Hàm helper private ---
+
+	// Helper: Ghi một block gồm `indices` và `dataSize` byte dữ liệu vào cuối `buffer` (bỏ qua nếu rỗng).
+	static void AppendBlock(std::vector<char>& buffer, uint32_t type, const std::vector<uint32_t>& indices, const void* data, size_t dataSize, uint32_t& blockCount);
+
+	// Helper: Kích thước bản ghi của mỗi component trong block loại `type` (NameComponent: phần độ dài),
+	// 0 nếu loại block không biết.
+	static size_t GetRecordSize(uint32_t type);
+
+	// Helper: Đọc toàn bộ file vào bộ nhớ.
+	static std::vector<char> ReadFile(const std::string& filePath);
+};
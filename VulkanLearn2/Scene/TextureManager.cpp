@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "TextureManager.h"
 #include "Core/VulkanCommandManager.h"
+#include "Core/VulkanSyncManager.h"
 #include "Core/VulkanImage.h"
 #include "Core/VulkanDescriptor.h"
 #include "Core/VulkanBuffer.h"
@@ -66,14 +67,17 @@ void TextureManager::UploadDataToTextureImage()
 		stagingBuffers.push_back(textureImage->textureImage->UploadTextureData(m_CommandManager, singleTimeCmd));
 	}
 
-	// Kết thúc và submit command buffer, đợi cho đến khi GPU thực thi xong.
-	m_CommandManager->EndSingleTimeCmdBuffer(singleTimeCmd);
+	// Kết thúc và submit command buffer mà không block CPU.
+	m_CommandManager->SubmitSingleTimeCmdBuffer(singleTimeCmd);
 
-	// Sau khi GPU đã copy xong, các staging buffer không còn cần thiết và cần được giải phóng.
-	for (auto& stagingBuffer : stagingBuffers)
+	// Các staging buffer chỉ được giải phóng khi GPU đã copy xong.
+	m_CommandManager->GetSyncManager()->DeferDestroy([stagingBuffers]()
 	{
-		delete(stagingBuffer);
-	}
+		for (auto& stagingBuffer : stagingBuffers)
+		{
+			delete(stagingBuffer);
+		}
+	});
 }
 
 void TextureManager::CreateTextureImageDescriptor()
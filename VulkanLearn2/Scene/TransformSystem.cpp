@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "TransformSystem.h"
+
+// Chọn tập lệnh SIMD theo cờ biên dịch (MSVC định nghĩa __AVX__ với /arch:AVX và /arch:AVX2).
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRANSFORM_SYSTEM_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_SYSTEM_SSE
+#endif
+
+namespace
+{
+	// Phép toán trên LANE_COUNT float cùng lúc, để công thức dựng ma trận chỉ viết một lần cho mọi tập lệnh.
+#if defined(TRANSFORM_SYSTEM_AVX)
+	using FloatLanes = __m256;
+	constexpr uint32_t LANE_COUNT = 8;
+	inline FloatLanes Load(const float* p)				{ return _mm256_load_ps(p); }
+	inline void Store(float* p, FloatLanes v)			{ _mm256_store_ps(p, v); }
+	inline FloatLanes Broadcast(float v)				{ return _mm256_set1_ps(v); }
+	inline FloatLanes Add(FloatLanes a, FloatLanes b)	{ return _mm256_add_ps(a, b); }
+	inline FloatLanes Sub(FloatLanes a, FloatLanes b)	{ return _mm256_sub_ps(a, b); }
+	inline FloatLanes Mul(FloatLanes a, FloatLanes b)	{ return _mm256_mul_ps(a, b); }
+#elif defined(TRANSFORM_SYSTEM_SSE)
+	using FloatLanes = __m128;
+	constexpr uint32_t LANE_COUNT = 4;
+	inline FloatLanes Load(const float* p)				{ return _mm_load_ps(p); }
+	inline void Store(float* p, FloatLanes v)			{ _mm_store_ps(p, v); }
+	inline FloatLanes Broadcast(float v)				{ return _mm_set1_ps(v); }
+	inline FloatLanes Add(FloatLanes a, FloatLanes b)	{ return _mm_add_ps(a, b); }
+	inline FloatLanes Sub(FloatLanes a, FloatLanes b)	{ return _mm_sub_ps(a, b); }
+	inline FloatLanes Mul(FloatLanes a, FloatLanes b)	{ return _mm_mul_ps(a, b); }
+#else
+	using FloatLanes = float;
+	constexpr uint32_t LANE_COUNT = 1;
+	inline FloatLanes Load(const float* p)				{ return *p; }
+	inline void Store(float* p, FloatLanes v)			{ *p = v; }
+	inline FloatLanes Broadcast(float v)				{ return v; }
+	inline FloatLanes Add(FloatLanes a, FloatLanes b)	{ return a + b; }
+	inline FloatLanes Sub(FloatLanes a, FloatLanes b)	{ return a - b; }
+	inline FloatLanes Mul(FloatLanes a, FloatLanes b)	{ return a * b; }
+#endif
+}
+
+void TransformSystem::ComposeLocalMatrices(const TransformComponent* const* transforms, uint32_t count)
+{
+	if (count == 0) return;
+	static_assert(SIMD_BATCH_SIZE % LANE_COUNT == 0, "SIMD_BATCH_SIZE phải là bội của số làn SIMD.");
+
+	// Chép quaternion và tỷ lệ sang dạng SoA. Làn thừa của lô chưa đầy bằng 0 (kết quả bị bỏ qua).
+	alignas(32) float rotation[4][SIMD_BATCH_SIZE] = {};	// x, y, z, w
+	alignas(32) float scale[3][SIMD_BATCH_SIZE] = {};
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const TransformComponent& transform = *transforms[i];
+		rotation[0][i] = transform.m_Orientation.x;
+		rotation[1][i] = transform.m_Orientation.y;
+		rotation[2][i] = transform.m_Orientation.z;
+		rotation[3][i] = transform.m_Orientation.w;
+		scale[0][i] = transform.m_Scale.x;
+		scale[1][i] = transform.m_Scale.y;
+		scale[2][i] = transform.m_Scale.z;
+	}
+
+	// Phần 3x3 của R * S, theo cột: basis[cột * 3 + hàng]. Cột tịnh tiến chính là position, không cần tính.
+	alignas(32) float basis[9][SIMD_BATCH_SIZE];
+	const FloatLanes one = Broadcast(1.0f);
+	const FloatLanes two = Broadcast(2.0f);
+	for (uint32_t base = 0; base < SIMD_BATCH_SIZE; base += LANE_COUNT)
+	{
+		const FloatLanes x = Load(rotation[0] + base);
+		const FloatLanes y = Load(rotation[1] + base);
+		const FloatLanes z = Load(rotation[2] + base);
+		const FloatLanes w = Load(rotation[3] + base);
+
+		// Ma trận xoay của quaternion đơn vị (giống glm::mat3_cast).
+		const FloatLanes x2 = Mul(x, two);
+		const FloatLanes y2 = Mul(y, two);
+		const FloatLanes z2 = Mul(z, two);
+		const FloatLanes xx = Mul(x, x2);
+		const FloatLanes yy = Mul(y, y2);
+		const FloatLanes zz = Mul(z, z2);
+		const FloatLanes xy = Mul(x, y2);
+		const FloatLanes xz = Mul(x, z2);
+		const FloatLanes yz = Mul(y, z2);
+		const FloatLanes wx = Mul(w, x2);
+		const FloatLanes wy = Mul(w, y2);
+		const FloatLanes wz = Mul(w, z2);
+
+		const FloatLanes sx = Load(scale[0] + base);
+		const FloatLanes sy = Load(scale[1] + base);
+		const FloatLanes sz = Load(scale[2] + base);
+
+		Store(basis[0] + base, Mul(Sub(one, Add(yy, zz)), sx));
+		Store(basis[1] + base, Mul(Add(xy, wz), sx));
+		Store(basis[2] + base, Mul(Sub(xz, wy), sx));
+
+		Store(basis[3] + base, Mul(Sub(xy, wz), sy));
+		Store(basis[4] + base, Mul(Sub(one, Add(xx, zz)), sy));
+		Store(basis[5] + base, Mul(Add(yz, wx), sy));
+
+		Store(basis[6] + base, Mul(Add(xz, wy), sz));
+		Store(basis[7] + base, Mul(Sub(yz, wx), sz));
+		Store(basis[8] + base, Mul(Sub(one, Add(xx, yy)), sz));
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const TransformComponent& transform = *transforms[i];
+		glm::mat4& local = transform.m_LocalMatrix;
+		local[0] = glm::vec4(basis[0][i], basis[1][i], basis[2][i], 0.0f);
+		local[1] = glm::vec4(basis[3][i], basis[4][i], basis[5][i], 0.0f);
+		local[2] = glm::vec4(basis[6][i], basis[7][i], basis[8][i], 0.0f);
+		local[3] = glm::vec4(transform.m_Position, 1.0f);
+		transform.m_IsDirty = false;
+	}
+}
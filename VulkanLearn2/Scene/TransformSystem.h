@@ -1,55 +1,277 @@
 ﻿#pragma once
 #include "Scene.h"
 #include "Component.h"
+#include "Core/JobSystem.h"
 
+// =================================================================================================
+// Class: TransformSystem
+// Mô tả:
+//      Tính lại ma trận local/world và vector hướng của các TransformComponent, theo cây cha-con
+//      (Scene::SetParent).
+//      Chỉ các entity có TransformDirtyTag (Scene gắn khi TransformComponent được thêm, patch/replace hoặc
+//      đổi cha) và cây con của chúng được duyệt, nên entity tĩnh không tốn gì mỗi frame. Tùy số lượng:
+//        - Ít thay đổi: mỗi entity dirty không có tổ tiên dirty là gốc của một cây con cần tính lại. Các cây con
+//          rời nhau, được chia cho các job và duyệt theo danh sách con (cha luôn được tính trước con).
+//        - Nhiều thay đổi (ví dụ lúc load scene): duyệt tuyến tính toàn bộ storage, đã được sắp xếp theo độ sâu
+//          (xem TransformHierarchy) khi cây hoặc storage thay đổi. Các cấp được xử lý lần lượt từ gốc, mỗi cấp
+//          chia thành các đoạn CHUNK_SIZE phần tử cho các job. Phần tử được tính lại khi giá trị local của nó đổi
+//          hoặc world của cha (ở cấp trước) vừa được tính lại.
+//      Ma trận local được dựng từ position/quaternion/scale theo lô SIMD_BATCH_SIZE phần tử: dữ liệu của lô
+//      được chép sang dạng SoA rồi tính bằng SIMD (ComposeLocalMatrices), không có hàm lượng giác nào.
+//      Forward/right lấy trực tiếp từ cột của ma trận world.
+//      Job chỉ ghi vào component thuộc phần của mình và danh sách entity thay đổi riêng của nó (chỉ đọc cha đã
+//      xong), không có vùng ghi chung nên không cần khóa. Registry chỉ được sửa (gắn TransformChangedTag, xóa
+//      TransformDirtyTag) trên luồng chính sau khi mọi job xong.
+// =================================================================================================
 class TransformSystem
 {
 public:
-	static void UpdateTransformMatrix(Scene* scene)
+	static void UpdateTransformMatrix(Scene* scene, JobSystem* jobSystem)
 	{
-		auto view = scene->GetRegistry().view<TransformComponent>();
+		entt::registry& registry = scene->GetRegistry();
+		const size_t dirtyCount = registry.storage<TransformDirtyTag>().size();
 
-		view.each([](auto e, const TransformComponent& transform)
+		// Không có gì thay đổi: không duyệt entity nào.
+		if (dirtyCount == 0) return;
+
+		std::vector<ChangedEntities> changedEntities;
+		if (dirtyCount * FULL_UPDATE_RATIO >= registry.storage<TransformComponent>().size())
+		{
+			UpdateByLevel(scene, jobSystem, changedEntities);
+		}
+		else
+		{
+			UpdateDirtySubtrees(registry, jobSystem, changedEntities);
+		}
+
+		registry.clear<TransformDirtyTag>();
+
+		// Báo cho RenderProxyManager (và SceneBVH, CameraSystem) cập nhật các entity vừa thay đổi.
+		for (const ChangedEntities& chunkEntities : changedEntities)
+		{
+			for (entt::entity e : chunkEntities.entities)
+			{
+				registry.emplace_or_replace<TransformChangedTag>(e);
+			}
+		}
+	}
+
+private:
+	// Số TransformComponent (hoặc số cây con) mỗi job (bằng kích thước page của storage entt).
+	static constexpr uint32_t CHUNK_SIZE = 1024;
+
+	// Số ma trận local dựng cùng lúc (một thanh ghi AVX, hai thanh ghi SSE).
+	static constexpr uint32_t SIMD_BATCH_SIZE = 8;
+
+	// Từ 1/FULL_UPDATE_RATIO số transform bị dirty trở lên thì duyệt tuyến tính toàn bộ storage.
+	static constexpr size_t FULL_UPDATE_RATIO = 4;
+
+	// Entity thay đổi của một job. Căn theo cache line để các job không ghi chung một dòng cache (false sharing).
+	struct alignas(64) ChangedEntities
+	{
+		std::vector<entt::entity> entities;
+	};
+
+	// Gọi `updateChunk` cho `chunkCount` job: trực tiếp trên luồng chính nếu chỉ có một, không đáng đánh thức worker.
+	template<typename Function>
+	static void DispatchChunks(JobSystem* jobSystem, uint32_t chunkCount, Function&& updateChunk)
+	{
+		if (chunkCount == 1)
+		{
+			updateChunk(0, jobSystem->GetMainThreadIndex());
+		}
+		else if (chunkCount > 1)
+		{
+			jobSystem->ParallelFor(chunkCount, updateChunk);
+		}
+	}
+
+	// Lượt ít thay đổi: chỉ duyệt cây con của các entity dirty.
+	static void UpdateDirtySubtrees(entt::registry& registry, JobSystem* jobSystem, std::vector<ChangedEntities>& changedEntities)
+	{
+		auto& storage = registry.storage<TransformComponent>();
+		const auto& dirtyStorage = registry.storage<TransformDirtyTag>();
+
+		// Entity có tổ tiên cũng dirty đã nằm trong cây con của tổ tiên đó.
+		std::vector<entt::entity> roots;
+		for (entt::entity e : registry.view<TransformDirtyTag>())
+		{
+			if (!storage.contains(e)) continue;
+
+			bool ancestorDirty = false;
+			for (entt::entity parent = storage.get(e).m_Parent; parent != entt::null; parent = storage.get(parent).m_Parent)
 			{
-				if (transform.m_IsDirty)
+				if (dirtyStorage.contains(parent))
 				{
-					UpdateTransformMatrix(transform);
-					UpdateTransformVector(transform);
-					transform.m_IsDirty = false;
+					ancestorDirty = true;
+					break;
+				}
+			}
+			if (!ancestorDirty)
+			{
+				roots.push_back(e);
+			}
+		}
+
+		const uint32_t rootCount = static_cast<uint32_t>(roots.size());
+		const uint32_t chunkCount = (rootCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		changedEntities.resize(chunkCount);
+
+		DispatchChunks(jobSystem, chunkCount, [&](uint32_t chunkIndex, uint32_t threadIndex)
+			{
+				const uint32_t first = chunkIndex * CHUNK_SIZE;
+				const uint32_t end = std::min(first + CHUNK_SIZE, rootCount);
+				std::vector<entt::entity>& changed = changedEntities[chunkIndex].entities;
+
+				// Duyệt theo chiều sâu bằng stack: entity được ghi trước khi các con của nó được đẩy vào.
+				std::vector<entt::entity> pending;
+				for (uint32_t i = first; i < end; i++)
+				{
+					pending.push_back(roots[i]);
+					while (!pending.empty())
+					{
+						const entt::entity e = pending.back();
+						pending.pop_back();
+						changed.push_back(e);
+
+						for (entt::entity child = storage.get(e).m_FirstChild; child != entt::null; child = storage.get(child).m_NextSibling)
+						{
+							pending.push_back(child);
+						}
+					}
 				}
+
+				UpdateMatrices(storage, changed);
 			});
 	}
 
-private:
-	static void UpdateTransformMatrix(const TransformComponent& transform)
+	// Lượt nhiều thay đổi: duyệt tuyến tính toàn bộ storage theo cấp.
+	static void UpdateByLevel(Scene* scene, JobSystem* jobSystem, std::vector<ChangedEntities>& changedEntities)
 	{
-		glm::mat4 mat = glm::mat4(1.0f);
-		mat = glm::translate(mat, transform.m_Position);
-		mat = glm::rotate(mat, glm::radians(transform.m_Rotation.z), { 0,0,1 });
-		mat = glm::rotate(mat, glm::radians(transform.m_Rotation.y), { 0,1,0 });
-		mat = glm::rotate(mat, glm::radians(transform.m_Rotation.x), { 1,0,0 });
-		mat = glm::scale(mat, transform.m_Scale);
+		entt::registry& registry = scene->GetRegistry();
+		auto& storage = registry.storage<TransformComponent>();
+
+		TransformHierarchy& hierarchy = scene->GetTransformHierarchy();
+		if (hierarchy.orderDirty)
+		{
+			SortByDepth(registry, hierarchy);
+			hierarchy.orderDirty = false;
+		}
+
+		// Mảng entity của storage cùng thứ tự với mảng component, nên mỗi đoạn đọc component liên tục.
+		const entt::entity* entities = storage.data();
+
+		for (const TransformHierarchy::Level& level : hierarchy.levels)
+		{
+			const uint32_t chunkCount = (level.end - level.first + CHUNK_SIZE - 1) / CHUNK_SIZE;
+			const size_t firstChunk = changedEntities.size();
+			changedEntities.resize(firstChunk + chunkCount);
+
+			DispatchChunks(jobSystem, chunkCount, [&](uint32_t chunkIndex, uint32_t threadIndex)
+				{
+					const uint32_t first = level.first + chunkIndex * CHUNK_SIZE;
+					const uint32_t end = std::min(first + CHUNK_SIZE, level.end);
+					std::vector<entt::entity>& changed = changedEntities[firstChunk + chunkIndex].entities;
 
-		transform.m_TransformMatrix = mat;
+					for (uint32_t i = first; i < end; i++)
+					{
+						const TransformComponent& transform = storage.get(entities[i]);
+						const TransformComponent* parent = GetParent(storage, transform);
+
+						transform.m_WorldChanged = transform.m_IsDirty || (parent && parent->m_WorldChanged);
+						if (transform.m_WorldChanged)
+						{
+							changed.push_back(entities[i]);
+						}
+					}
+
+					UpdateMatrices(storage, changed);
+				});
+		}
 	}
 
-	static void UpdateTransformVector(const TransformComponent& transform)
+	// Tính lại các entity trong `entities` (cha luôn đứng trước con, hoặc đã xong từ trước):
+	// dựng ma trận local của các entity đổi giá trị local theo lô, rồi tính world theo thứ tự.
+	template<typename Storage>
+	static void UpdateMatrices(const Storage& storage, const std::vector<entt::entity>& entities)
 	{
-		float yawRad = glm::radians(transform.m_Rotation.y);
-		float pitchRad = glm::radians(transform.m_Rotation.x);
+		std::array<const TransformComponent*, SIMD_BATCH_SIZE> batch;
+		uint32_t batchCount = 0;
+		for (entt::entity e : entities)
+		{
+			const TransformComponent& transform = storage.get(e);
+			if (transform.m_IsDirty)
+			{
+				batch[batchCount++] = &transform;
+				if (batchCount == SIMD_BATCH_SIZE)
+				{
+					ComposeLocalMatrices(batch.data(), batchCount);
+					batchCount = 0;
+				}
+			}
+		}
+		ComposeLocalMatrices(batch.data(), batchCount);
 
-		glm::vec3 forward;
-		forward.x = glm::cos(yawRad) * glm::cos(pitchRad);
-		forward.y = glm::sin(pitchRad);
-		forward.z = glm::sin(yawRad) * glm::cos(pitchRad);
+		for (entt::entity e : entities)
+		{
+			UpdateWorldMatrix(storage, storage.get(e));
+		}
+	}
 
-		forward = glm::normalize(forward);
+	template<typename Storage>
+	static const TransformComponent* GetParent(const Storage& storage, const TransformComponent& transform)
+	{
+		return transform.m_Parent != entt::null ? &storage.get(transform.m_Parent) : nullptr;
+	}
+
+	// Tính ma trận world (cha đã được cập nhật) và vector hướng từ quaternion world.
+	template<typename Storage>
+	static void UpdateWorldMatrix(const Storage& storage, const TransformComponent& transform)
+	{
+		const TransformComponent* parent = GetParent(storage, transform);
+		transform.m_TransformMatrix = parent ? parent->m_TransformMatrix * transform.m_LocalMatrix : transform.m_LocalMatrix;
+
+		// Không lấy từ các cột của ma trận world: cột có tỷ lệ 0 (hợp lệ trong editor/file scene) chuẩn hóa ra NaN.
+		transform.m_WorldOrientation = parent ? parent->m_WorldOrientation * transform.m_Orientation : transform.m_Orientation;
+		transform.m_Foward = transform.m_WorldOrientation * glm::vec3(0.0f, 0.0f, -1.0f);
+		transform.m_Right = transform.m_WorldOrientation * glm::vec3(1.0f, 0.0f, 0.0f);
+	}
 
-		glm::vec3 up{ 0, 1, 0 };
+	// Sắp xếp storage theo độ sâu (do Scene duy trì) và ghi lại khoảng của từng cấp.
+	// Chi phí O(n log n), chỉ chạy khi cây hoặc storage thay đổi.
+	static void SortByDepth(entt::registry& registry, TransformHierarchy& hierarchy)
+	{
+		auto& storage = registry.storage<TransformComponent>();
+		const uint32_t transformCount = static_cast<uint32_t>(storage.size());
+
+		registry.sort<TransformComponent>([](const TransformComponent& lhs, const TransformComponent& rhs)
+			{
+				return lhs.m_Depth < rhs.m_Depth;
+			});
 
-		glm::vec3 right = glm::normalize(glm::cross(forward, up));
+		// Sau khi sắp xếp, các phần tử cùng độ sâu nằm liên tục (chiều của mảng packed do entt quyết định,
+		// nên các cấp được sắp lại theo độ sâu).
+		const entt::entity* entities = storage.data();
+		std::vector<std::pair<uint32_t, TransformHierarchy::Level>> levels;
+		for (uint32_t i = 0; i < transformCount; i++)
+		{
+			const uint32_t depth = storage.get(entities[i]).m_Depth;
+			if (levels.empty() || levels.back().first != depth)
+			{
+				levels.push_back({ depth, { i, i } });
+			}
+			levels.back().second.end = i + 1;
+		}
+		std::sort(levels.begin(), levels.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
 
-		transform.m_Foward = forward;
-		transform.m_Right = right;
+		hierarchy.levels.clear();
+		for (const auto& level : levels)
+		{
+			hierarchy.levels.push_back(level.second);
+		}
 	}
+
+	// Dựng ma trận local T * R * S của `count` (<= SIMD_BATCH_SIZE) phần tử và xóa cờ dirty của chúng.
+	// Định nghĩa trong TransformSystem.cpp (chọn tập lệnh SIMD theo cờ biên dịch).
+	static void ComposeLocalMatrices(const TransformComponent* const* transforms, uint32_t count);
 };
\ No newline at end of file
@@ -16,19 +16,38 @@ layout(set = 1, binding = 0) uniform UniformBufferObject {
     mat4 proj;
 } ubo;
 
-layout(push_constant) uniform PushConstantData {
+// Matches struct GPUInstanceData in VulkanTypes.h (std430)
+struct InstanceData {
     mat4 model;
-    uint materialId;
-} pc;
+    mat3 normalMatrix; // transpose(inverse(mat3(model))), precomputed on the CPU
+    vec4 boundingSphere;
+    uint firstIndex;
+    uint indexCount;
+    int vertexOffset;
+    uint materialIndex;
+    uint shadowViewMask; // Bit i: casts a shadow into shadow map layer i
+    uint visibilityIndex; // Used by GPU occlusion culling only
+    float maxDrawDistanceSq; // Cull thresholds, used by GPU culling only
+    float minScreenSizeSq;
+    float maxShadowDistanceSq;
+};
+
+// Per-instance data, indexed by firstInstance of the draw (CPU path and GPU culling path alike)
+layout(std430, set = 3, binding = 0) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * pc.model * vec4(inPosition, 1.0);
+    mat4 model = instances[gl_InstanceIndex].model;
+    mat3 normalMatrix = instances[gl_InstanceIndex].normalMatrix;
+
+    vec4 worldPos = model * vec4(inPosition, 1.0);
+    gl_Position = ubo.proj * ubo.view * worldPos;
     fragTexCoord = inTexCoord;
-    fragMaterialId = pc.materialId;
+    fragMaterialId = instances[gl_InstanceIndex].materialIndex;
 
-    // Calculate and pass world position, normal, and tangent
-    fragWorldPos = (pc.model * vec4(inPosition, 1.0)).xyz;
-    mat3 normalMatrix = transpose(inverse(mat3(pc.model)));
+    // Pass world position, normal, and tangent
+    fragWorldPos = worldPos.xyz;
     fragWorldNormal = normalize(normalMatrix * inNormal);
     fragTangent = normalize(normalMatrix * inTangent);
 }
\ No newline at end of file
@@ -25,9 +25,9 @@ layout(std430, set = 1, binding = 0) readonly buffer LightBuffer {
     Light lights[];
 } lightBuffer;
 
-// Bindless Shadow Maps array
-// Using sampler2DShadow for hardware PCF/comparison
-layout(set = 1, binding = 1) uniform sampler2DShadow shadowMaps[256]; 
+// Shadow maps of all lights as layers of one depth texture array (layer = light.params.z)
+// Using sampler2DArrayShadow for hardware PCF/comparison
+layout(set = 1, binding = 1) uniform sampler2DArrayShadow shadowMaps;
 
 // =========================================================================
 // SET 2: CAMERA DATA (UBO)
@@ -118,11 +118,11 @@ float CalculateShadow(vec4 fragPosLightSpace, int shadowIdx, vec3 normal, vec3 l
     float bias = max(0.005 * (1.0 - dot(normal, lightDir)), 0.0005);
     
     // 5. Sample Shadow Map
-    // 'texture' on a sampler2DShadow automatically performs the depth comparison.
-    // It takes a vec3(u, v, d) where 'd' is the reference value to compare against.
+    // 'texture' on a sampler2DArrayShadow automatically performs the depth comparison.
+    // It takes a vec4(u, v, layer, d) where 'd' is the reference value to compare against.
     // Returns 1.0 if (d < storedDepth), 0.0 otherwise (or interpolated if filtering is on).
     // We subtract bias from our depth to fix acne.
-    float shadow = texture(shadowMaps[shadowIdx], vec3(projCoords.xy, projCoords.z - bias));
+    float shadow = texture(shadowMaps, vec4(projCoords.xy, float(shadowIdx), projCoords.z - bias));
 
     return shadow;
 }
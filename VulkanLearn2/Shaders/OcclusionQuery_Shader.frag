@@ -0,0 +1,6 @@
+#version 450
+
+void main() {
+    // Empty fragment shader
+    // Color and depth writes are disabled: only the samples passing the depth test are counted by the query
+}
@@ -0,0 +1,27 @@
+#version 450
+
+// Matches struct OcclusionQueryPushConstantData in VulkanTypes.h
+layout(push_constant) uniform PushConstants {
+    mat4 viewProj;
+    vec4 boundingSphere; // xyz: world center, w: world radius
+} pc;
+
+// 12 triangles of the unit cube [-1, 1]^3, indexed by gl_VertexIndex (vkCmdDraw with 36 vertices, no vertex buffer).
+// Back faces are not culled, so the winding does not matter
+const int CUBE_INDICES[36] = int[](
+    0, 1, 3, 0, 3, 2,   // -X
+    4, 6, 7, 4, 7, 5,   // +X
+    0, 4, 5, 0, 5, 1,   // -Y
+    2, 3, 7, 2, 7, 6,   // +Y
+    0, 2, 6, 0, 6, 4,   // -Z
+    1, 5, 7, 1, 7, 3    // +Z
+);
+
+void main() {
+    // Corner bits: 1 = +Z, 2 = +Y, 4 = +X
+    int corner = CUBE_INDICES[gl_VertexIndex];
+    vec3 position = vec3((corner & 4) != 0 ? 1.0 : -1.0, (corner & 2) != 0 ? 1.0 : -1.0, (corner & 1) != 0 ? 1.0 : -1.0);
+
+    // The cube encloses the bounding sphere, so it also encloses the mesh
+    gl_Position = pc.viewProj * vec4(pc.boundingSphere.xyz + position * pc.boundingSphere.w, 1.0);
+}
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_multiview : require
 
 // Input attributes matching Vertex::GetAttributeDesc()
 layout(location = 0) in vec3 inPosition;
@@ -6,13 +7,40 @@ layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inTangent;
 
-// Push constants matching struct ShadowMapPushConstantData in VulkanTypes.h
-layout(push_constant) uniform PushConstants {
+// Matches struct GPUInstanceData in VulkanTypes.h (std430)
+struct InstanceData {
     mat4 model;
-    mat4 lightSpaceMatrix;
-} pc;
+    mat3 normalMatrix; // transpose(inverse(mat3(model))), precomputed on the CPU
+    vec4 boundingSphere;
+    uint firstIndex;
+    uint indexCount;
+    int vertexOffset;
+    uint materialIndex;
+    uint shadowViewMask; // Bit i: casts a shadow into shadow map layer i
+    uint visibilityIndex; // Used by GPU occlusion culling only
+    float maxDrawDistanceSq; // Cull thresholds, used by GPU culling only
+    float minScreenSizeSq;
+    float maxShadowDistanceSq;
+};
+
+// Per-instance data, indexed by firstInstance of the draw
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBuffer {
+    InstanceData instances[];
+};
+
+// Light space matrix of every shadow map, indexed by layer (LightManager::UploadLightData)
+layout(std430, set = 0, binding = 1) readonly buffer ShadowMatrixBuffer {
+    mat4 lightSpaceMatrices[];
+};
 
 void main() {
-    // Transform vertex position to light clip space
-    gl_Position = pc.lightSpaceMatrix * pc.model * vec4(inPosition, 1.0);
+    // Multiview draws every instance into every view: reject instances whose shadow is culled for this light
+    // by moving the vertex outside the clip volume (depth clamp is disabled), so the triangle is clipped away
+    if ((instances[gl_InstanceIndex].shadowViewMask & (1u << gl_ViewIndex)) == 0u) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+
+    // Multiview: each view renders one layer of the shadow map array, gl_ViewIndex is the layer
+    gl_Position = lightSpaceMatrices[gl_ViewIndex] * instances[gl_InstanceIndex].model * vec4(inPosition, 1.0);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Scene/MeshManager.h"
 #include "Scene/Model.h"
 #include <stdexcept>
+#include <queue>
 
 ModelLoader::ModelLoader(MeshManager* meshManager, MaterialManager* materialManager)
 	: m_MeshManager(meshManager), m_MaterialManager(materialManager)
@@ -34,24 +35,32 @@ std::vector<Mesh*> ModelLoader::LoadModelFromFile(const std::string& filePath)
 		throw std::runtime_error("LỖI ASSIMP: " + std::string(importer.GetErrorString()));
 	}
 
-	ProcessNode(scene->mRootNode, scene, meshes);
+	ProcessNodes(scene, meshes);
 
 	return meshes;
 }
 
-void ModelLoader::ProcessNode(aiNode* node, const aiScene* scene, std::vector<Mesh*>& outMeshes)
+void ModelLoader::ProcessNodes(const aiScene* scene, std::vector<Mesh*>& outMeshes)
 {
-	// Xử lý tất cả các mesh trong node hiện tại.
-	for (unsigned int i = 0; i < node->mNumMeshes; i++)
-	{
-		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		outMeshes.push_back(ProcessMesh(mesh, scene));
-	}
+	std::queue<const aiNode*> pending;
+	pending.push(scene->mRootNode);
 
-	// Duyệt đệ quy qua tất cả các node con.
-	for (unsigned int i = 0; i < node->mNumChildren; i++)
+	while (!pending.empty())
 	{
-		ProcessNode(node->mChildren[i], scene, outMeshes);
+		const aiNode* node = pending.front();
+		pending.pop();
+
+		// Xử lý tất cả các mesh trong node hiện tại.
+		for (unsigned int i = 0; i < node->mNumMeshes; i++)
+		{
+			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+			outMeshes.push_back(ProcessMesh(mesh, scene));
+		}
+
+		for (unsigned int i = 0; i < node->mNumChildren; i++)
+		{
+			pending.push(node->mChildren[i]);
+		}
 	}
 }
 
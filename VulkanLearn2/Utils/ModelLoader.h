@@ -43,8 +43,8 @@ private:
 	MeshManager* m_MeshManager;
 	MaterialManager* m_MaterialManager;
 
-	// Duyệt qua cây node của scene Assimp một cách đệ quy.
-	void ProcessNode(aiNode* node, const aiScene* scene, std::vector<Mesh*>& outMeshes);
+	// Duyệt cây node của scene Assimp theo chiều rộng (không đệ quy, cây sâu không làm tràn stack).
+	void ProcessNodes(const aiScene* scene, std::vector<Mesh*>& outMeshes);
 	
 	// Xử lý một mesh đơn lẻ trong scene Assimp để trích xuất dữ liệu,
 	// tạo Mesh và Material, và trả về con trỏ tới Mesh đã tạo.
@@ -12,11 +12,22 @@
 #include "Core/VulkanDescriptorManager.h"
 #include "Core/VulkanSampler.h"
 #include "Core/VulkanDescriptor.h"
+#include "Core/VulkanFrameAllocator.h"
+#include "Core/JobSystem.h"
+#include "Core/SimulationThread.h"
 #include "Renderer/GeometryPass.h"
 #include "Renderer/BrightFilterPass.h"
 #include "Renderer/CompositePass.h"
 #include "Renderer/BlurPass.h"
 #include "Renderer/LightingPass.h"
+#include "Renderer/DrawList.h"
+#include "Renderer/RenderProxyManager.h"
+#include "Renderer/FrustumCuller.h"
+#include "Renderer/OcclusionCuller.h"
+#include "Renderer/OcclusionQueryCuller.h"
+#include "Renderer/GPUScene.h"
+#include "Renderer/GPUCullingPass.h"
+#include "Renderer/HiZPass.h"
 #include "Utils/DebugTimer.h"
 #include "Utils/ModelLoader.h"
 #include "Scene/MeshManager.h"
@@ -24,6 +35,7 @@
 #include "Scene/TextureManager.h"
 #include "Scene/MaterialManager.h"
 #include "Scene\LightManager.h"
+#include "Scene/SceneBVH.h"
 #include "Renderer/ShadowMapPass.h"
 #include "Scene/Scene.h"
 #include "Scene/Component.h"
@@ -58,12 +70,13 @@ int main()
  * @brief Constructor: Khởi tạo toàn bộ ứng dụng Vulkan.
  * Tuần tự thực hiện các bước thiết lập cốt lõi:
  * 1. Tạo cửa sổ và các thành phần Vulkan cơ bản (Context, Swapchain, Sampler...).
- * 2. Tạo các tài nguyên framebuffer (ảnh attachments) cho các render pass.
- * 3. Tạo uniform buffers cho dữ liệu shader (ví dụ: camera).
+ * 2. Khai báo Render Graph, tạo các attachment tạm cho các render pass.
+ * 3. Tạo bộ cấp phát dữ liệu theo frame cho shader (ví dụ: camera, đèn).
  * 4. Tải dữ liệu scene (model, texture).
  * 5. Tạo các render pass (Geometry, Post-processing).
- * 6. Hoàn tất việc thiết lập descriptors và các đối tượng đồng bộ hóa.
+ * 6. Hoàn tất việc thiết lập descriptors.
  * 7. Tải dữ liệu hình học (mesh) lên GPU.
+ * 8. Khởi động simulation.
  */
 Application::Application()
 {
@@ -71,28 +84,50 @@ Application::Application()
 	m_Window = new Window(WINDOW_WIDTH, WINDOW_HEIGHT, "ZOLCOL VULKAN");
 	m_VulkanContext = new VulkanContext(m_Window->getGLFWWindow(), m_Window->getInstanceExtensionsRequired());
 	m_VulkanSwapchain = new VulkanSwapchain(m_VulkanContext->getVulkanHandles(), m_Window->getGLFWWindow(), VSyncOn);
-	m_VulkanCommandManager = new VulkanCommandManager(m_VulkanContext->getVulkanHandles(), MAX_FRAMES_IN_FLIGHT);
+	// GPU-driven rendering cần vkCmdDrawIndexedIndirectCount, nếu không được hỗ trợ thì ghi lệnh vẽ trên CPU.
+	m_GPUDrivenRendering = GPU_DRIVEN_RENDERING && m_VulkanContext->getVulkanHandles().drawIndirectCountSupported;
+	Log::Info(m_GPUDrivenRendering ? "Render: GPU-driven (frustum và occlusion culling Hi-Z trên GPU, vẽ indirect)." : "Render: Ghi lệnh vẽ trên CPU.");
+	// Tạo các đối tượng đồng bộ (semaphores, timeline) trước CommandManager vì mọi lần submit đều dùng timeline chung.
+	m_VulkanSyncManager = new VulkanSyncManager(m_VulkanContext->getVulkanHandles(), MAX_FRAMES_IN_FLIGHT, m_VulkanSwapchain->getHandles().swapchainImageCount);
+	// JobSystem được tạo trước CommandManager để biết số luồng cần command pool riêng.
+	m_JobSystem = new JobSystem();
+	// JobSystem chỉ nhận ParallelFor từ một luồng: luồng simulation có pool riêng, nhỏ hơn (phần lớn nhân dành cho ghi lệnh).
+	m_SimulationJobSystem = SIMULATION_THREAD ? new JobSystem(std::max(1u, std::thread::hardware_concurrency() / 4)) : m_JobSystem;
+	m_VulkanCommandManager = new VulkanCommandManager(m_VulkanContext->getVulkanHandles(), m_VulkanSyncManager, MAX_FRAMES_IN_FLIGHT, m_JobSystem->GetThreadCount());
+	m_DrawList = new DrawList();
+	m_FrustumCuller = new FrustumCuller();
 	m_VulkanSampler = new VulkanSampler(m_VulkanContext->getVulkanHandles());
 	m_Scene = new Scene();
+	// Đăng ký lắng nghe MeshComponent (và LightComponent) trước khi tạo entity nào.
+	m_RenderProxyManager = new RenderProxyManager(m_Scene);
+	m_SceneBVH = new SceneBVH(m_Scene);
+	m_OcclusionCuller = new OcclusionCuller(m_Scene, m_JobSystem);
+	if (!m_GPUDrivenRendering && HARDWARE_OCCLUSION_QUERIES)
+	{
+		m_OcclusionQueryCuller = new OcclusionQueryCuller(m_VulkanContext->getVulkanHandles(), MAX_OCCLUSION_QUERIES, MAX_FRAMES_IN_FLIGHT);
+	}
 	Core::Time::Init();
 	Input::Init(m_Window->getGLFWWindow());	
 
 	CreateSceneLights();
 
-	// --- 2. TẠO TÀI NGUYÊN FRAMEBUFFER (ATTACHMENTS) ---
-	// Tạo các ảnh (VulkanImage) sẽ được dùng làm đầu ra cho các render pass.
-	CreateFrameBufferImages();
+	// --- 2. KHAI BÁO RENDER GRAPH ---
+	// Khai báo các attachment và thứ tự pass, Compile để tạo attachment (có aliasing) và tính barrier.
+	CreateRenderGraph();
 
 	// --- 3. TẠO TÀI NGUYÊN CHO SHADER ---
-	// Tạo uniform buffers để chứa dữ liệu camera (view, projection).
-	CreateUniformBuffers();
+	// Tạo bộ cấp phát tuyến tính chứa dữ liệu thay đổi mỗi frame (camera, đèn).
+	CreateFrameAllocator();
 
 	// --- 4. TẢI DỮ LIỆU SCENE ---
 	// Khởi tạo các manager và tải các model, texture từ file.
 	m_MeshManager = new MeshManager(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager);
 	m_TextureManager = new TextureManager(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager, m_VulkanSampler->getSampler());
 	m_MaterialManager = new MaterialManager(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager, m_TextureManager);
-	m_LightManager = new LightManager(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager, m_Scene, m_VulkanSampler, MAX_FRAMES_IN_FLIGHT);
+	m_LightManager = new LightManager(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager, m_FrameAllocator, m_Scene, m_VulkanSampler, MAX_FRAMES_IN_FLIGHT);
+	// Mỗi shadow map (layer của shadow map array) là một view của GPUScene.
+	m_GPUScene = new GPUScene(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager, MAX_GPU_INSTANCES,
+		m_LightManager->GetShadowMapCount(), MAX_FRAMES_IN_FLIGHT);
 
 	// --- Khởi tạo Scene & Entities ---
 
@@ -102,7 +137,7 @@ Application::Application()
 	
 	auto& cameraTransform = m_Scene->GetRegistry().get<TransformComponent>(m_MainCamera);
 	cameraTransform.SetPosition({ 0.0f, 3.0f, 5.0f });
-	cameraTransform.SetRotation({ -11.0f, -90, 0 });
+	cameraTransform.SetRotation({ -11.0f, 0.0f, 0.0f }); // Nhìn theo -Z, hơi chúc xuống.
 	
 	// 1. Tải tài nguyên Model (chỉ tải một lần)
 	m_AnimeGirlModel = new Model("Resources/AnimeGirl.assbin", m_MeshManager, m_MaterialManager);
@@ -137,10 +172,18 @@ Application::Application()
 	// Khởi tạo các đối tượng cho từng bước trong chuỗi render (Geometry, Bright, Blur, Composite).
 	CreateRenderPasses();
 
-	// --- 6. HOÀN TẤT DESCRIPTORS VÀ ĐỒNG BỘ HÓA ---
+	// --- 6. HOÀN TẤT DESCRIPTORS ---
 	// Tổng hợp tất cả các descriptor từ các pass và tạo descriptor pool.
 	m_VulkanDescriptorManager = new VulkanDescriptorManager(m_VulkanContext->getVulkanHandles());
+	if (m_GPUCullingPass != nullptr)
+	{
+		m_VulkanDescriptorManager->AddDescriptors(m_GPUCullingPass->GetHandles().descriptors);
+		m_VulkanDescriptorManager->AddDescriptors(m_HiZPass->GetHandles().descriptors);
+		m_VulkanDescriptorManager->AddDescriptors(m_GPUCullingLatePass->GetHandles().descriptors);
+		m_VulkanDescriptorManager->AddDescriptors(m_GeometryLatePass->GetHandles().descriptors);
+	}
 	m_VulkanDescriptorManager->AddDescriptors(m_GeometryPass->GetHandles().descriptors);
+	m_VulkanDescriptorManager->AddDescriptors(m_ShadowMapPass->GetHandles().descriptors);
 	m_VulkanDescriptorManager->AddDescriptors(m_LightingPass->GetHandles().descriptors);
 	m_VulkanDescriptorManager->AddDescriptors(m_BrightFilterPass->GetHandles().descriptors);
 	m_VulkanDescriptorManager->AddDescriptors(m_BlurHPass->GetHandles().descriptors);
@@ -148,14 +191,14 @@ Application::Application()
 	m_VulkanDescriptorManager->AddDescriptors(m_CompositePass->GetHandles().descriptors);
 	m_VulkanDescriptorManager->Finalize(); // Tạo pool và cấp phát các set.
 
-	// Tạo các đối tượng đồng bộ (semaphores, fences) để điều phối vòng lặp render.
-	m_VulkanSyncManager = new VulkanSyncManager(m_VulkanContext->getVulkanHandles(), MAX_FRAMES_IN_FLIGHT, m_VulkanSwapchain->getHandles().swapchainImageCount);
-
 	// --- 7. TẢI DỮ LIỆU LÊN GPU ---
 	// Sau khi tất cả các mesh đã được xử lý, tạo và tải dữ liệu vào vertex/index buffer trên GPU.
 	m_MeshManager->CreateBuffers();
 
-	
+	// --- 8. KHỞI ĐỘNG SIMULATION ---
+	// Bước đầu tiên chạy ngay tại đây (frame đầu tiên đã có transform và camera), các bước sau chạy
+	// trên luồng riêng nếu SIMULATION_THREAD.
+	m_Simulation = new SimulationThread(SIMULATION_STEP_TIME, SIMULATION_THREAD, [this](float deltaTime) { Update(deltaTime); });
 }
 
 /**
@@ -165,11 +208,21 @@ Application::Application()
  */
 Application::~Application()
 {
+	// Dừng simulation trước khi hủy scene và các hệ thống mà nó dùng.
+	delete(m_Simulation);
+
 	// Đảm bảo GPU đã thực thi xong tất cả các lệnh trước khi bắt đầu hủy tài nguyên.
 	vkDeviceWaitIdle(m_VulkanContext->getVulkanHandles().device);
 
+	// Thực thi các tác vụ hủy còn chờ (staging buffer, command buffer dùng một lần) khi các manager còn sống.
+	m_VulkanSyncManager->FlushDeferredDestroys();
+
 	// 1. Giải phóng các Render Pass.
+	delete(m_GPUCullingPass);
 	delete(m_GeometryPass);
+	delete(m_HiZPass);
+	delete(m_GPUCullingLatePass);
+	delete(m_GeometryLatePass);
 	delete(m_ShadowMapPass);
 	delete(m_LightingPass);
 	delete(m_BrightFilterPass);
@@ -180,49 +233,30 @@ Application::~Application()
 	// 2. Giải phóng các Manager.
 	// DescriptorManager phải được hủy trước các tài nguyên mà nó quản lý (như uniform buffers, images).
 	delete(m_VulkanDescriptorManager);
-	delete(m_VulkanSyncManager);
 	delete(m_VulkanCommandManager);
+	delete(m_VulkanSyncManager);
+	if (m_SimulationJobSystem != m_JobSystem)
+	{
+		delete(m_SimulationJobSystem);
+	}
+	delete(m_JobSystem);
+	delete(m_DrawList);
+	delete(m_FrustumCuller);
+	delete(m_OcclusionCuller);
+	delete(m_OcclusionQueryCuller);
+	delete(m_SceneBVH);
+	delete(m_RenderProxyManager);
+	delete(m_GPUScene);
 	delete(m_MeshManager);
 	delete(m_TextureManager);
 	delete(m_MaterialManager);
 	delete(m_LightManager);
 
-	// 3. Giải phóng Buffers (ví dụ: uniform buffers).
-	for (auto& uniformBuffer : m_Geometry_UniformBuffers)
-	{
-		delete(uniformBuffer);
-	}
+	// 3. Giải phóng Buffers (bộ cấp phát dữ liệu theo frame).
+	delete(m_FrameAllocator);
 
-	// 4. Giải phóng Images (các attachment của framebuffer).
-	for (auto& image : m_LitSceneImages)
-	{
-		delete(image);
-	}
-	for (auto& image : m_TempBlurImages)
-	{
-		delete(image);
-	}
-	for (auto& image : m_BrightImages)
-	{
-		delete(image);
-	}
-	for (auto& image : m_Geometry_DepthStencilImage)
-	{
-		delete(image);
-	}
-	for (auto& image : m_Geometry_AlbedoImages)
-	{
-		delete(image);
-	}
-	for (auto& image : m_Geometry_NormalImages)
-	{
-		delete(image);
-	}
-	for (auto& image : m_Geometry_PositionImages)
-	{
-		delete(image);
-	}
-	delete(m_Composite_ColorImage);
+	// 4. Giải phóng Render Graph (các attachment của framebuffer và vùng nhớ aliasing).
+	delete(m_RenderGraph);
 
 	// 5. Giải phóng các đối tượng trong Scene.
 	delete(m_AnimeGirlModel);
@@ -239,6 +273,8 @@ Application::~Application()
 /**
  * @brief Vòng lặp chính của ứng dụng.
  * Liên tục xử lý sự kiện cửa sổ và gọi hàm DrawFrame cho đến khi cửa sổ nhận được yêu cầu đóng.
+ * Simulation (Update) không chạy ở đây mà theo bước cố định trong SimulationThread: trên luồng riêng thì
+ * thời gian mỗi frame gần với max(simulation, render) thay vì tổng của hai phần.
  */
 void Application::Loop()
 {
@@ -249,11 +285,18 @@ void Application::Loop()
 		
 		ShowFps();
 
+		// Chụp trạng thái phím/chuột cho các bước simulation (GLFW chỉ được gọi trên luồng chính).
 		Input::Update();
-		Update();
 		DrawFrame();
 	}
 
+	// Submit nốt phần present của frame cuối cùng, không để lại frame dở dang khi thoát.
+	if (m_PendingPresentFrame != -1)
+	{
+		PresentFrame(m_PendingPresentFrame);
+		m_PendingPresentFrame = -1;
+	}
+
 	// Đợi device rảnh rỗi trước khi thoát chương trình.
 	vkDeviceWaitIdle(m_VulkanContext->getVulkanHandles().device);
 }
@@ -266,26 +309,125 @@ void Application::Loop()
  * @brief Thực hiện tất cả các hoạt động cần thiết để vẽ một frame.
  * Đây là trái tim của vòng lặp render, điều phối việc đồng bộ CPU-GPU,
  * cập nhật dữ liệu, ghi command buffer và trình chiếu kết quả lên màn hình.
+ * Render Graph chia frame thành nhiều submission (graphics / async compute):
+ *      - Phần scene (các submission trước submission dùng swapchain) được submit ngay.
+ *      - Phần present (từ submission dùng swapchain trở đi) được trì hoãn tới lần gọi DrawFrame kế tiếp,
+ *        sau phần scene của frame sau. Nhờ vậy bloom (compute queue) của frame này chạy song song với
+ *        Geometry/ShadowMap (graphics queue) của frame sau, đổi lại độ trễ tăng thêm một frame.
+ *      - Nếu GPU không có compute queue riêng, cả frame là một submission và được present ngay.
  */
 void Application::DrawFrame()
 {
 	// --- 1. ĐỒNG BỘ CPU-GPU: ĐỢI FRAME TRƯỚC HOÀN THÀNH ---
-	// Chờ fence của frame hiện tại, đảm bảo rằng command buffer từ lần lặp trước của frame này đã thực thi xong.
-	vkWaitForFences(m_VulkanContext->getVulkanHandles().device, 1, &m_VulkanSyncManager->getCurrentFence(m_CurrentFrame), VK_TRUE, UINT64_MAX);
+	// Chờ timeline đạt tới giá trị mà submission cuối của lần sử dụng trước của frame này đã báo hiệu.
+	// Các submission trong frame nối tiếp nhau nên mọi command buffer của frame này đều đã thực thi xong.
+	m_VulkanSyncManager->WaitForFrame(m_CurrentFrame);
+
+	// Hủy các tài nguyên mà GPU không còn sử dụng (staging buffer, command buffer dùng một lần...).
+	m_VulkanSyncManager->CollectGarbage();
+
+	// Các secondary command buffer của lần sử dụng trước của frame này có thể được ghi lại.
+	m_VulkanCommandManager->ResetSecondaryCmdBuffers(m_CurrentFrame);
+
+	// GPU đã đọc xong dữ liệu tạm của lần sử dụng trước của frame này, thu hồi toàn bộ vùng nhớ.
+	m_FrameAllocator->Reset(m_CurrentFrame);
+
+	// --- 2. CẬP NHẬT DỮ LIỆU ĐỘNG ---
+	// Lấy dữ liệu scene của bước simulation gần nhất (camera, RenderProxy, SceneBVH, occluder). Sau đó frame chỉ
+	// đọc các bản chép, simulation chạy bước kế tiếp song song với phần còn lại của hàm.
+	m_Simulation->Extract([this](float alpha) { ExtractSceneData(alpha); });
+	m_LightManager->UploadLightData(m_CurrentFrame);
 
-	// --- 2. LẤY ẢNH TIẾP THEO TỪ SWAPCHAIN ---
-	// Yêu cầu một ảnh từ swapchain để chuẩn bị vẽ lên.
+	// Đảm bảo dữ liệu CPU vừa ghi vào FrameAllocator hiển thị với GPU trước khi submit.
+	m_FrameAllocator->Flush(m_CurrentFrame);
+
+	// Xây dựng danh sách lệnh vẽ một lần trên luồng chính, sắp xếp theo trạng thái và front-to-back theo camera.
+	// Geometry và ShadowMap pass chia danh sách này để ghi song song vào secondary command buffer.
+
+	// Ghi lệnh trên CPU: cull theo frustum camera, ngưỡng khoảng cách/kích thước của MeshComponent và occluder
+	// để GeometryPass bỏ qua các proxy không nhìn thấy,
+	// và theo từng đèn để ShadowMapPass chỉ vẽ caster có bóng rơi vào màn hình.
+	// GPU-driven: GPUCullingPass cull trên GPU (frustum và Hi-Z hai pha), DrawList giữ mọi proxy.
+	const FrustumCuller* culler = nullptr;
+	if (!m_GPUDrivenRendering)
+	{
+		const glm::mat4 cameraViewProj = m_Geometry_Ubo.proj * m_Geometry_Ubo.view;
+		const glm::vec4 detailOrigin = FrustumCuller::BuildDetailOrigin(m_Geometry_Ubo.viewPos, m_Geometry_Ubo.proj);
+		m_FrustumCuller->Cull(*m_RenderProxyManager, cameraViewProj, detailOrigin, m_LightManager->GetAllGpuLights(m_CurrentFrame), m_SceneBVH);
+		if (m_OcclusionQueryCuller != nullptr)
+		{
+			// Kết quả query của lần sử dụng trước của frame này (GPU đã xong, không phải đợi).
+			m_OcclusionQueryCuller->BeginFrame(m_CurrentFrame, *m_RenderProxyManager, cameraViewProj, m_Geometry_Ubo.viewPos);
+			m_FrustumCuller->CullOccluded(*m_OcclusionQueryCuller, *m_RenderProxyManager);
+		}
+		else
+		{
+			m_OcclusionCuller->RasterizeOccluders(cameraViewProj);
+			m_FrustumCuller->CullOccluded(*m_OcclusionCuller, *m_RenderProxyManager);
+		}
+		culler = m_FrustumCuller;
+	}
+	m_DrawList->Build(*m_RenderProxyManager, m_Geometry_Ubo.view, culler);
+
+	// Ghi dữ liệu instance của DrawList và frustum của các view cho GPUScene.
+	UpdateGPUScene();
+
+	// --- 3. SUBMIT PHẦN SCENE ---
+	// Các submission này không dùng swapchain image, không cần đợi acquire.
+	const uint32_t presentSubmission = m_RenderGraph->GetPresentSubmission();
+	for (uint32_t submission = 0; submission < presentSubmission; ++submission)
+	{
+		SubmitRenderGraph(submission, m_CurrentFrame, 0, VK_NULL_HANDLE, VK_NULL_HANDLE);
+	}
+
+	// Ghi nhận ngay giá trị của phần scene: nếu phần present không được submit (swapchain OUT_OF_DATE),
+	// lần sử dụng sau của frame vẫn đợi phần đã submit trước khi ghi đè command buffer và dữ liệu tạm.
+	// PresentFrame thay bằng giá trị của submission cuối khi submit phần present.
+	if (presentSubmission > 0)
+	{
+		m_VulkanSyncManager->SetFrameTimelineValue(m_CurrentFrame, m_SubmissionSignalValues[m_CurrentFrame][presentSubmission - 1],
+			m_RenderGraph->GetSubmissionQueue(presentSubmission - 1));
+	}
+
+	// --- 4. PHẦN PRESENT ---
+	if (presentSubmission == 0)
+	{
+		PresentFrame(m_CurrentFrame);
+	}
+	else
+	{
+		// Phần scene của frame này đã nằm trong hàng đợi, giờ mới submit phần present của frame trước.
+		if (m_PendingPresentFrame != -1)
+		{
+			PresentFrame(m_PendingPresentFrame);
+		}
+		m_PendingPresentFrame = m_CurrentFrame;
+	}
+
+	// --- 5. CHUYỂN SANG FRAME TIẾP THEO ---
+	m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+/**
+ * @brief Lấy ảnh swapchain, submit phần present (từ submission dùng swapchain tới hết) của frame `frame`
+ * và trình chiếu kết quả lên màn hình.
+ */
+void Application::PresentFrame(int frame)
+{
+	// --- 1. LẤY ẢNH TIẾP THEO TỪ SWAPCHAIN ---
 	// `imageIndex` là chỉ số của ảnh trong swapchain mà chúng ta sẽ render tới.
 	// `imageAvailableSemaphore` sẽ được báo hiệu khi ảnh này sẵn sàng.
 	uint32_t imageIndex;
 	VkResult result = vkAcquireNextImageKHR(m_VulkanContext->getVulkanHandles().device, m_VulkanSwapchain->getHandles().swapchain, UINT64_MAX,
-		m_VulkanSyncManager->getCurrentImageAvailableSemaphore(m_CurrentFrame),
+		m_VulkanSyncManager->getCurrentImageAvailableSemaphore(frame),
 		VK_NULL_HANDLE, &imageIndex);
 
 	// Xử lý trường hợp swapchain không còn tương thích (ví dụ: cửa sổ bị resize).
 	if (result == VK_ERROR_OUT_OF_DATE_KHR)
 	{
-		// TODO: Implement lại swapchain.
+		// TODO: Implement lại swapchain (cần vkDeviceWaitIdle).
+		// Phần present của frame bị bỏ (DrawFrame thay m_PendingPresentFrame bằng frame mới, frame này không được
+		// present lại), phần scene đã submit vẫn được đợi qua giá trị ghi nhận trong DrawFrame.
 		return;
 	}
 	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
@@ -293,42 +435,23 @@ void Application::DrawFrame()
 		throw std::runtime_error("LỖI: Không thể lấy ảnh từ swapchain!");
 	}
 
-	// --- 3. CHUẨN BỊ CHO LẦN SUBMIT MỚI ---
-	// Reset fence về trạng thái "chưa báo hiệu" vì chúng ta sắp submit một command buffer mới và sẽ chờ nó.
-	vkResetFences(m_VulkanContext->getVulkanHandles().device, 1, &m_VulkanSyncManager->getCurrentFence(m_CurrentFrame));
-
-	// --- 4. CẬP NHẬT DỮ LIỆU ĐỘNG ---
-	// Cập nhật dữ liệu sẽ thay đổi mỗi frame, ví dụ như ma trận camera, vị trí đối tượng.
-	//Update();
-	Update_Geometry_Uniforms();
-
-
-	// --- 5. GHI COMMAND BUFFER ---
-	// Reset và ghi lại command buffer với các lệnh vẽ cho frame hiện tại.
-	vkResetCommandBuffer(m_VulkanCommandManager->getHandles().commandBuffers[m_CurrentFrame], 0);
-	RecordCommandBuffer(m_VulkanCommandManager->getHandles().commandBuffers[m_CurrentFrame], imageIndex);
-
-	// --- 6. SUBMIT COMMAND BUFFER LÊN HÀNG ĐỢI ---
-	VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &m_VulkanCommandManager->getHandles().commandBuffers[m_CurrentFrame];
-
-	// Chỉ định semaphore để đợi: đợi `imageAvailableSemaphore` trước khi thực thi giai đoạn ghi màu.
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = &m_VulkanSyncManager->getCurrentImageAvailableSemaphore(m_CurrentFrame);
-	submitInfo.pWaitDstStageMask = &waitStage;
-
-	// Chỉ định semaphore để báo hiệu: báo hiệu `renderFinishedSemaphore` khi command buffer thực thi xong.
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = &m_VulkanSyncManager->getCurrentRenderFinishedSemaphore(imageIndex);
+	// --- 2. SUBMIT PHẦN PRESENT ---
+	// Submission đầu tiên đợi `imageAvailableSemaphore` trước giai đoạn ghi màu,
+	// submission cuối báo hiệu `renderFinishedSemaphore` để present đợi.
+	const uint32_t presentSubmission = m_RenderGraph->GetPresentSubmission();
+	const uint32_t submissionCount = m_RenderGraph->GetSubmissionCount();
+	uint64_t frameTimelineValue = 0;
+	for (uint32_t submission = presentSubmission; submission < submissionCount; ++submission)
+	{
+		VkSemaphore waitSemaphore = (submission == presentSubmission) ? m_VulkanSyncManager->getCurrentImageAvailableSemaphore(frame) : VK_NULL_HANDLE;
+		VkSemaphore signalSemaphore = (submission + 1 == submissionCount) ? m_VulkanSyncManager->getCurrentRenderFinishedSemaphore(imageIndex) : VK_NULL_HANDLE;
+		frameTimelineValue = SubmitRenderGraph(submission, frame, imageIndex, waitSemaphore, signalSemaphore);
+	}
 
-	// Submit command buffer lên graphics queue, và báo hiệu `inFlightFence` khi hoàn tất.
-	VK_CHECK(vkQueueSubmit(m_VulkanContext->getVulkanHandles().graphicQueue, 1, &submitInfo, m_VulkanSyncManager->getCurrentFence(m_CurrentFrame)),
-		"LỖI: Submit command buffer thất bại!");
+	// Submission cuối luôn ở graphics queue, CPU sẽ chờ giá trị này ở lần sử dụng tiếp theo của frame.
+	m_VulkanSyncManager->SetFrameTimelineValue(frame, frameTimelineValue);
 
-	// --- 7. TRÌNH CHIẾU (PRESENT) ---
+	// --- 3. TRÌNH CHIẾU (PRESENT) ---
 	// Đưa ảnh đã render xong ra màn hình.
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -351,16 +474,36 @@ void Application::DrawFrame()
 	{
 		throw std::runtime_error("LỖI: Trình chiếu ảnh swapchain thất bại!");
 	}
+}
 
-	// --- 8. CHUYỂN SANG FRAME TIẾP THEO ---
-	m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+/**
+ * @brief Chép dữ liệu scene mà frame cần sang các bản sao của renderer.
+ * Chạy trong SimulationThread::Extract (simulation đứng giữa hai bước): đây là nơi duy nhất luồng render đọc registry.
+ * `alpha`: vị trí của thời điểm hiện tại giữa hai bước simulation gần nhất, dùng để nội suy camera.
+ */
+void Application::ExtractSceneData(float alpha)
+{
+	// Entity bị hủy trong các bước vừa chạy được hủy thật ở đây, trước khi renderer cập nhật theo thay đổi.
+	m_Scene->FlushDestroyedEntities();
+
+	Update_Geometry_Uniforms(alpha);
+
+	// Áp dụng các thay đổi transform/mesh của mọi bước từ lần Extract trước (tag được tích lũy qua các bước).
+	// SceneBVH đọc TransformChangedTag nên phải Sync trước RenderProxyManager (hàm này xóa tag).
+	m_SceneBVH->Sync();
+	m_RenderProxyManager->Sync();
+	if (!m_GPUDrivenRendering && m_OcclusionQueryCuller == nullptr)
+	{
+		m_OcclusionCuller->Sync();
+	}
 }
 
 /**
  * @brief Cập nhật Uniform Buffer Object (UBO) với ma trận camera hiện tại.
  * Dữ liệu này được sử dụng trong Geometry Pass để định vị camera trong không gian 3D.
+ * INTERPOLATE_CAMERA: camera chính được nội suy giữa hai bước simulation gần nhất theo `alpha`.
  */
-void Application::Update_Geometry_Uniforms()
+void Application::Update_Geometry_Uniforms(float alpha)
 {
 	auto view = m_Scene->GetRegistry().view<TransformComponent, CameraComponent>();
 	view.each([&](auto e, const TransformComponent& transform, const CameraComponent& camera) 
@@ -369,24 +512,56 @@ void Application::Update_Geometry_Uniforms()
 
 			m_Geometry_Ubo.view = camera.GetViewMatrix();
 			m_Geometry_Ubo.proj = camera.GetProjMatrix();
-			m_Geometry_Ubo.viewPos = transform.GetPosition();
-
-			m_Geometry_UniformBuffers[m_CurrentFrame]->UploadData(&m_Geometry_Ubo, sizeof(m_Geometry_Ubo), 0);
+			m_Geometry_Ubo.viewPos = transform.GetWorldPosition();
+
+			// Dựng view giống CameraSystem, từ vị trí và hướng nhìn đã nội suy.
+			if (INTERPOLATE_CAMERA && e == m_MainCamera)
+			{
+				const glm::vec3 position = glm::mix(m_PreviousCameraPose.position, m_CurrentCameraPose.position, alpha);
+				const glm::vec3 forward = glm::normalize(glm::mix(m_PreviousCameraPose.forward, m_CurrentCameraPose.forward, alpha));
+				m_Geometry_Ubo.view = glm::lookAt(position, position + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+				m_Geometry_Ubo.viewPos = position;
+			}
+
+			m_Geometry_UboOffsets[m_CurrentFrame] = m_FrameAllocator->Push(m_CurrentFrame, &m_Geometry_Ubo, sizeof(m_Geometry_Ubo));
 		});
 }
 
+/**
+ * @brief Ghi dữ liệu instance của frame vào GPUScene và khai báo các view cần cull:
+ * camera chính và mỗi đèn có bóng đổ. Phải gọi sau DrawList::Build và LightManager::UploadLightData.
+ */
+void Application::UpdateGPUScene()
+{
+	m_GPUScene->Upload(m_CurrentFrame, *m_DrawList);
+
+	// Đường ghi lệnh vẽ trên CPU chỉ dùng instance buffer, không cần frustum.
+	if (!m_GPUDrivenRendering) return;
+
+	m_GPUScene->SetView(m_CurrentFrame, GPUScene::CAMERA_VIEW, m_Geometry_Ubo.proj * m_Geometry_Ubo.view,
+		FrustumCuller::BuildDetailOrigin(m_Geometry_Ubo.viewPos, m_Geometry_Ubo.proj));
+
+	for (const auto& light : m_LightManager->GetAllGpuLights(m_CurrentFrame))
+	{
+		if (light.params.z != -1 && static_cast<LightType>(static_cast<int>(light.position.w)) != LightType::Point)
+		{
+			const ShadowCasterVolume volume = FrustumCuller::BuildShadowCasterVolume(light);
+			m_GPUScene->SetView(m_CurrentFrame, GPUScene::GetShadowView(static_cast<uint32_t>(light.params.z)), volume.planes, volume.extrusion);
+		}
+	}
+}
+
 /**
  * @brief Cập nhật transform (vị trí, xoay, tỷ lệ) của các đối tượng trong scene.
  * Hàm này dùng để tạo animation đơn giản cho các đối tượng.
  */
-void Application::UpdateRenderObjectTransforms()
+void Application::UpdateRenderObjectTransforms(float deltaTime)
 {	
-	// Cập nhật logic xoay cho các entity
-	auto& girl1Transform = m_Scene->GetRegistry().get<TransformComponent>(m_Girl1);
-	auto& girl2Transform = m_Scene->GetRegistry().get<TransformComponent>(m_Girl2);
-
-	girl1Transform.Rotate({ 0, Core::Time::GetDeltaTime() * MODEL_ROTATE_SPEED, 0 });
-	girl2Transform.Rotate({ 0, -Core::Time::GetDeltaTime() * MODEL_ROTATE_SPEED, 0 });
+	// Cập nhật logic xoay cho các entity (qua patch để TransformSystem biết entity vừa thay đổi).
+	// Xoay quanh trục Y của world bằng quaternion, không đi qua góc Euler.
+	const float angle = glm::radians(deltaTime * MODEL_ROTATE_SPEED);
+	m_Scene->GetRegistry().patch<TransformComponent>(m_Girl1, [&](TransformComponent& t) { t.Rotate(glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f))); });
+	m_Scene->GetRegistry().patch<TransformComponent>(m_Girl2, [&](TransformComponent& t) { t.Rotate(glm::angleAxis(-angle, glm::vec3(0.0f, 1.0f, 0.0f))); });
 	
 }
 
@@ -395,31 +570,98 @@ void Application::UpdateRenderObjectTransforms()
 // =================================================================================================
 
 /**
- * @brief Ghi lại tất cả các lệnh render vào một command buffer.
- * Đây là chuỗi render (post-processing pipeline) cho hiệu ứng bloom:
- * 1. Geometry Pass: Render scene 3D vào một texture (m_SceneImages).
- * 2. Bright Pass: Lọc ra các vùng sáng từ scene texture (-> m_BrightImages).
- * 3. BlurH Pass: Làm mờ ngang vùng sáng (-> m_TempBlurImages).
- * 4. BlurV Pass: Làm mờ dọc kết quả (-> m_BrightImages, ghi đè).
- * 5. Composite Pass: Tổng hợp scene texture gốc và texture đã làm mờ (bloom)
+ * @brief Ghi và submit một submission của Render Graph cho frame `frame`.
+ * Chuỗi render (post-processing pipeline) cho hiệu ứng bloom:
+ * 1. Geometry, ShadowMap, Lighting Pass (graphics queue): Render scene 3D vào một texture (-> LitScene).
+ * 2. Bright Pass (compute queue): Lọc ra các vùng sáng từ scene texture (-> Bright).
+ * 3. BlurH Pass (compute queue): Làm mờ ngang vùng sáng (-> TempBlur).
+ * 4. BlurV Pass (compute queue): Làm mờ dọc kết quả (-> Bright, ghi đè).
+ * 5. Composite Pass (graphics queue): Tổng hợp scene texture gốc và texture đã làm mờ (bloom)
  *    lên swapchain image để hiển thị.
+ * Đồng bộ:
+ *      - Submission 0 đợi lần upload gần nhất (mesh, texture) trên timeline của graphics queue.
+ *      - Submission i đợi giá trị timeline mà submission i - 1 của cùng frame đã báo hiệu (ở stage ALL_COMMANDS,
+ *        Render Graph tính barrier dựa trên giả định này).
+ *      - Mỗi submission báo hiệu một giá trị mới trên timeline của queue mà nó chạy.
+ * `imageAvailableSemaphore` / `renderFinishedSemaphore`: Binary semaphore cần đợi / báo hiệu thêm (VK_NULL_HANDLE nếu không có).
+ * Trả về: Giá trị timeline mà submission báo hiệu.
  */
-void Application::RecordCommandBuffer(const VkCommandBuffer& cmdBuffer, uint32_t imageIndex)
+uint64_t Application::SubmitRenderGraph(uint32_t submission, int frame, uint32_t imageIndex,
+	VkSemaphore imageAvailableSemaphore, VkSemaphore renderFinishedSemaphore)
 {
+	const QueueType queue = m_RenderGraph->GetSubmissionQueue(submission);
+	VkCommandBuffer cmdBuffer = m_VulkanCommandManager->GetFrameCmdBuffer(frame, submission, queue);
+
+	// --- 1. GHI COMMAND BUFFER ---
+	vkResetCommandBuffer(cmdBuffer, 0);
+
 	VkCommandBufferBeginInfo cmdBeginInfo{};
 	cmdBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	VK_CHECK(vkBeginCommandBuffer(cmdBuffer, &cmdBeginInfo), "LỖI: Bắt đầu ghi command buffer thất bại!");
 
-	// Thực thi tuần tự các render pass.
-	m_GeometryPass->Execute(&cmdBuffer, imageIndex, m_CurrentFrame);
-	m_ShadowMapPass->Execute(&cmdBuffer, imageIndex, m_CurrentFrame);
-	m_LightingPass->Execute(&cmdBuffer, imageIndex, m_CurrentFrame);
-	m_BrightFilterPass->Execute(&cmdBuffer, imageIndex, m_CurrentFrame);
-	m_BlurHPass->Execute(&cmdBuffer, imageIndex, m_CurrentFrame);
-	m_BlurVPass->Execute(&cmdBuffer, imageIndex, m_CurrentFrame);
-	m_CompositePass->Execute(&cmdBuffer, imageIndex, m_CurrentFrame);
+	// Thực thi tuần tự các pass của submission qua Render Graph: barrier đã gộp được ghi trước mỗi pass
+	// (primary được ghi theo thứ tự, phần vẽ nặng được ghi song song).
+	m_RenderGraph->ExecuteSubmission(submission, cmdBuffer, imageIndex, frame);
 
 	VK_CHECK(vkEndCommandBuffer(cmdBuffer), "LỖI: Kết thúc ghi command buffer thất bại!");
+
+	// --- 2. SEMAPHORE CẦN ĐỢI ---
+	std::array<VkSemaphore, 2> waitSemaphores{};
+	std::array<VkPipelineStageFlags, 2> waitStages{};
+	std::array<uint64_t, 2> waitValues{};	// Giá trị cho binary semaphore bị bỏ qua.
+	uint32_t waitCount = 0;
+
+	if (submission == 0)
+	{
+		waitSemaphores[waitCount] = m_VulkanSyncManager->getTimelineSemaphore(QueueType::Graphics);
+		waitValues[waitCount] = m_VulkanSyncManager->GetLastUploadValue();
+	}
+	else
+	{
+		waitSemaphores[waitCount] = m_VulkanSyncManager->getTimelineSemaphore(m_RenderGraph->GetSubmissionQueue(submission - 1));
+		waitValues[waitCount] = m_SubmissionSignalValues[frame][submission - 1];
+	}
+	waitStages[waitCount++] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	if (imageAvailableSemaphore != VK_NULL_HANDLE)
+	{
+		waitSemaphores[waitCount] = imageAvailableSemaphore;
+		waitStages[waitCount++] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	}
+
+	// --- 3. SEMAPHORE CẦN BÁO HIỆU ---
+	// Giá trị được cấp ngay trước khi submit để tăng dần theo thứ tự thực thi trên queue.
+	uint64_t signalValue = m_VulkanSyncManager->AcquireTimelineValue(queue);
+	m_SubmissionSignalValues[frame][submission] = signalValue;
+
+	std::array<VkSemaphore, 2> signalSemaphores = { m_VulkanSyncManager->getTimelineSemaphore(queue), renderFinishedSemaphore };
+	std::array<uint64_t, 2> signalValues = { signalValue, 0 };
+	uint32_t signalCount = (renderFinishedSemaphore != VK_NULL_HANDLE) ? 2 : 1;
+
+	// --- 4. SUBMIT ---
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = waitCount;
+	timelineInfo.pWaitSemaphoreValues = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = signalCount;
+	timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &cmdBuffer;
+	submitInfo.waitSemaphoreCount = waitCount;
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
+	submitInfo.signalSemaphoreCount = signalCount;
+	submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+	// Không cần fence, timeline semaphore đảm nhận việc đồng bộ CPU-GPU.
+	VK_CHECK(vkQueueSubmit(m_VulkanContext->getVulkanHandles().GetQueue(queue), 1, &submitInfo, VK_NULL_HANDLE),
+		"LỖI: Submit command buffer thất bại!");
+
+	return signalValue;
 }
 
    
@@ -446,18 +688,19 @@ void Application::ShowFps()
 // =================================================================================================
 
 /**
- * @brief Tạo tất cả các VulkanImage sẽ được dùng làm attachment cho các bước render.
- * Các image này là các framebuffer trung gian cho chuỗi post-processing.
+ * @brief Khai báo Render Graph của một frame: các attachment tạm, tài nguyên import và các pass.
+ * Mỗi pass khai báo image mà nó đọc/ghi theo đúng thứ tự thực thi. Sau khi Compile, RenderGraph đã:
+ * - loại bỏ các pass không đóng góp vào ảnh cuối cùng,
+ * - tạo các attachment tạm, cho các image không sống cùng lúc dùng chung vùng nhớ,
+ * - tính trước barrier giữa các pass (thay cho các lệnh TransitionLayout thủ công trong từng pass).
  */
-/**
- * @brief Tạo tất cả các VulkanImage sẽ được dùng làm attachment cho các render pass.
- * Hàm này thiết lập các framebuffer trung gian cho G-Buffer, pass chính và các bước hậu xử lý.
- */
-void Application::CreateFrameBufferImages()
+void Application::CreateRenderGraph()
 {
 	VkExtent2D swapchainExtent = m_VulkanSwapchain->getHandles().swapChainExtent;
 	VkFormat swapchainFormat = m_VulkanSwapchain->getHandles().swapchainSupportDetails.chosenFormat.format;
 
+	m_RenderGraph = new RenderGraph(m_VulkanContext->getVulkanHandles(), MAX_FRAMES_IN_FLIGHT);
+
 	// =================================================================================================
 	// I. TÀI NGUYÊN G-BUFFER (KHÔNG-MSAA)
 	// =================================================================================================
@@ -513,64 +756,17 @@ void Application::CreateFrameBufferImages()
 	gbufferDepthCVI.aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
 	gbufferDepthCVI.mipLevels = 1;
 
-	// Cấp phát bộ nhớ cho các vector chứa G-Buffer images
-	m_Geometry_AlbedoImages.resize(MAX_FRAMES_IN_FLIGHT);
-	m_Geometry_NormalImages.resize(MAX_FRAMES_IN_FLIGHT);
-	m_Geometry_PositionImages.resize(MAX_FRAMES_IN_FLIGHT);
-	m_Geometry_DepthStencilImage.resize(MAX_FRAMES_IN_FLIGHT);
-
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		m_Geometry_AlbedoImages[i] = new VulkanImage(m_VulkanContext->getVulkanHandles(), gbufferAlbedoCI, gbufferAlbedoCVI);
-		m_Geometry_NormalImages[i] = new VulkanImage(m_VulkanContext->getVulkanHandles(), gbufferHiPrecisionCI, gbufferHiPrecisionCVI);
-		m_Geometry_PositionImages[i] = new VulkanImage(m_VulkanContext->getVulkanHandles(), gbufferHiPrecisionCI, gbufferHiPrecisionCVI);
-		m_Geometry_DepthStencilImage[i] = new VulkanImage(m_VulkanContext->getVulkanHandles(), gbufferDepthCI, gbufferDepthCVI);
-	}
+	m_Geometry_AlbedoResource = m_RenderGraph->CreateImage("GBuffer_Albedo", gbufferAlbedoCI, gbufferAlbedoCVI);
+	m_Geometry_NormalResource = m_RenderGraph->CreateImage("GBuffer_Normal", gbufferHiPrecisionCI, gbufferHiPrecisionCVI);
+	m_Geometry_PositionResource = m_RenderGraph->CreateImage("GBuffer_Position", gbufferHiPrecisionCI, gbufferHiPrecisionCVI);
+	m_Geometry_DepthStencilResource = m_RenderGraph->CreateImage("GBuffer_DepthStencil", gbufferDepthCI, gbufferDepthCVI);
 
 	// =================================================================================================
-	// II. TÀI NGUYÊN CHO PASS CHÍNH (CÓ-MSAA)
+	// II. TÀI NGUYÊN HẬU XỬ LÝ (POST-PROCESSING, KHÔNG-MSAA)
 	// =================================================================================================
-	// Các attachment này sẽ được sử dụng trong Lighting Pass (hoặc Composite Pass hiện tại)
-	// để thực hiện tính toán ánh sáng và khử răng cưa.
-
-	// --- 4. Main Pass: Color (MSAA) ---
-	VulkanImageCreateInfo mainColorMSAA_CI{};
-	mainColorMSAA_CI.width = swapchainExtent.width;
-	mainColorMSAA_CI.height = swapchainExtent.height;
-	mainColorMSAA_CI.mipLevels = 1;
-	mainColorMSAA_CI.samples = MSAA_SAMPLES;
-	mainColorMSAA_CI.format = swapchainFormat;
-	mainColorMSAA_CI.imageUsageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-	mainColorMSAA_CI.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-
-	VulkanImageViewCreateInfo mainColorMSAA_CVI{};
-	mainColorMSAA_CVI.format = swapchainFormat;
-	mainColorMSAA_CVI.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
-	mainColorMSAA_CVI.mipLevels = 1;
-
-	m_Composite_ColorImage = new VulkanImage(m_VulkanContext->getVulkanHandles(), mainColorMSAA_CI, mainColorMSAA_CVI);
-
-	// --- 5. Main Pass: Depth/Stencil (MSAA) ---
-	VulkanImageCreateInfo mainDepthMSAA_CI{};
-	mainDepthMSAA_CI.width = swapchainExtent.width;
-	mainDepthMSAA_CI.height = swapchainExtent.height;
-	mainDepthMSAA_CI.mipLevels = 1;
-	mainDepthMSAA_CI.samples = MSAA_SAMPLES;
-	mainDepthMSAA_CI.format = VK_FORMAT_D32_SFLOAT_S8_UINT;
-	mainDepthMSAA_CI.imageUsageFlags = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-	mainDepthMSAA_CI.memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-
-	VulkanImageViewCreateInfo mainDepthMSAA_CVI{};
-	mainDepthMSAA_CVI.format = VK_FORMAT_D32_SFLOAT_S8_UINT;
-	mainDepthMSAA_CVI.aspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
-	mainDepthMSAA_CVI.mipLevels = 1;
 
-	// =================================================================================================
-	// III. TÀI NGUYÊN HẬU XỬ LÝ (POST-PROCESSING, KHÔNG-MSAA)
-	// =================================================================================================
-	
-	// --- 6. Post-Processing: Ảnh trung gian (Non-MSAA) ---
-	// Dùng cho hiệu ứng bloom (Bright Filter, Blur).
+	// --- 4. Post-Processing: Ảnh trung gian (Non-MSAA) ---
+	// Dùng cho ảnh đã chiếu sáng (Lighting Pass ghi làm color attachment).
 	VulkanImageCreateInfo postProcessingCI{};
 	postProcessingCI.width = swapchainExtent.width;
 	postProcessingCI.height = swapchainExtent.height;
@@ -585,15 +781,95 @@ void Application::CreateFrameBufferImages()
 	postProcessingCVI.aspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
 	postProcessingCVI.mipLevels = 1;
 
-	m_LitSceneImages.resize(MAX_FRAMES_IN_FLIGHT);
-	m_BrightImages.resize(MAX_FRAMES_IN_FLIGHT);
-	m_TempBlurImages.resize(MAX_FRAMES_IN_FLIGHT);
-	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+	// --- 5. Bloom: Ảnh do compute shader ghi (Bright Filter, Blur) ---
+	// Cần cờ USAGE_STORAGE_BIT để được ghi bằng imageStore.
+	VulkanImageCreateInfo bloomCI = postProcessingCI;
+	bloomCI.imageUsageFlags = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+	m_LitSceneResource = m_RenderGraph->CreateImage("LitScene", postProcessingCI, postProcessingCVI);
+	m_BrightResource = m_RenderGraph->CreateImage("Bright", bloomCI, postProcessingCVI);
+	m_TempBlurResource = m_RenderGraph->CreateImage("TempBlur", bloomCI, postProcessingCVI);
+
+	// =================================================================================================
+	// III. TÀI NGUYÊN IMPORT
+	// =================================================================================================
+	// Shadow map array do LightManager sở hữu, được lấy theo frame khi thực thi.
+	m_ShadowMapResource = m_RenderGraph->ImportImageList("ShadowMaps",
+		[this](uint32_t currentFrame) -> const std::vector<VulkanImage*>& { return m_LightManager->GetShadowMappingImage(currentFrame); },
+		VK_IMAGE_ASPECT_DEPTH_BIT);
+
+	// Swapchain image là output cuối cùng, được chuyển sang PRESENT_SRC sau pass cuối.
+	m_SwapchainResource = m_RenderGraph->ImportSwapchain("Swapchain", &m_VulkanSwapchain->getHandles().swapchainImages);
+	m_RenderGraph->MarkOutput(m_SwapchainResource, RenderGraphUsage::Present);
+
+	// =================================================================================================
+	// IV. CÁC PASS (THEO THỨ TỰ THỰC THI)
+	// =================================================================================================
+	// Culling chỉ ghi buffer lệnh vẽ (tự đồng bộ), không có image nào trong đồ thị nên phải được giữ lại thủ công.
+	if (m_GPUDrivenRendering)
+	{
+		m_GPUCullingNode = m_RenderGraph->AddPass("GPUCulling");
+		m_RenderGraph->MarkSideEffects(m_GPUCullingNode);
+	}
+
+	m_GeometryNode = m_RenderGraph->AddPass("Geometry");
+	m_RenderGraph->Write(m_GeometryNode, m_Geometry_AlbedoResource, RenderGraphUsage::ColorAttachment);
+	m_RenderGraph->Write(m_GeometryNode, m_Geometry_NormalResource, RenderGraphUsage::ColorAttachment);
+	m_RenderGraph->Write(m_GeometryNode, m_Geometry_PositionResource, RenderGraphUsage::ColorAttachment);
+	m_RenderGraph->Write(m_GeometryNode, m_Geometry_DepthStencilResource, RenderGraphUsage::DepthStencilAttachment);
+
+	// Occlusion culling hai pha: Geometry ở trên chỉ vẽ các đối tượng nhìn thấy ở frame trước. Depth của nó được
+	// thu nhỏ thành depth pyramid, các đối tượng còn lại được test với pyramid và vẽ tiếp lên cùng G-buffer.
+	// HiZ và GPUCullingLate chỉ ghi tài nguyên ngoài đồ thị (pyramid, buffer lệnh vẽ) nên được giữ lại thủ công.
+	if (m_GPUDrivenRendering)
 	{
-		m_LitSceneImages[i] = new VulkanImage(m_VulkanContext->getVulkanHandles(), postProcessingCI, postProcessingCVI);
-		m_BrightImages[i] = new VulkanImage(m_VulkanContext->getVulkanHandles(), postProcessingCI, postProcessingCVI);
-		m_TempBlurImages[i] = new VulkanImage(m_VulkanContext->getVulkanHandles(), postProcessingCI, postProcessingCVI);
-	} 
+		m_HiZNode = m_RenderGraph->AddPass("HiZ");
+		m_RenderGraph->Read(m_HiZNode, m_Geometry_DepthStencilResource, RenderGraphUsage::SampledCompute);
+		m_RenderGraph->MarkSideEffects(m_HiZNode);
+
+		m_GPUCullingLateNode = m_RenderGraph->AddPass("GPUCullingLate");
+		m_RenderGraph->MarkSideEffects(m_GPUCullingLateNode);
+
+		m_GeometryLateNode = m_RenderGraph->AddPass("GeometryLate");
+		m_RenderGraph->Write(m_GeometryLateNode, m_Geometry_AlbedoResource, RenderGraphUsage::ColorAttachmentLoad);
+		m_RenderGraph->Write(m_GeometryLateNode, m_Geometry_NormalResource, RenderGraphUsage::ColorAttachmentLoad);
+		m_RenderGraph->Write(m_GeometryLateNode, m_Geometry_PositionResource, RenderGraphUsage::ColorAttachmentLoad);
+		m_RenderGraph->Write(m_GeometryLateNode, m_Geometry_DepthStencilResource, RenderGraphUsage::DepthStencilAttachmentLoad);
+	}
+
+	m_ShadowMapNode = m_RenderGraph->AddPass("ShadowMap");
+	m_RenderGraph->Write(m_ShadowMapNode, m_ShadowMapResource, RenderGraphUsage::DepthAttachment);
+
+	m_LightingNode = m_RenderGraph->AddPass("Lighting");
+	m_RenderGraph->Read(m_LightingNode, m_Geometry_AlbedoResource, RenderGraphUsage::SampledFragment);
+	m_RenderGraph->Read(m_LightingNode, m_Geometry_NormalResource, RenderGraphUsage::SampledFragment);
+	m_RenderGraph->Read(m_LightingNode, m_Geometry_PositionResource, RenderGraphUsage::SampledFragment);
+	m_RenderGraph->Read(m_LightingNode, m_ShadowMapResource, RenderGraphUsage::SampledFragment);
+	m_RenderGraph->Write(m_LightingNode, m_LitSceneResource, RenderGraphUsage::ColorAttachment);
+
+	// Bloom chạy bằng compute shader trên compute queue (async compute): trong khi compute queue xử lý bloom
+	// của frame này, graphics queue đã có thể vẽ Geometry/ShadowMap của frame kế tiếp (xem DrawFrame).
+	m_BrightFilterNode = m_RenderGraph->AddPass("BrightFilter", QueueType::Compute);
+	m_RenderGraph->Read(m_BrightFilterNode, m_LitSceneResource, RenderGraphUsage::SampledCompute);
+	m_RenderGraph->Write(m_BrightFilterNode, m_BrightResource, RenderGraphUsage::StorageWriteCompute);
+
+	m_BlurHNode = m_RenderGraph->AddPass("BlurH", QueueType::Compute);
+	m_RenderGraph->Read(m_BlurHNode, m_BrightResource, RenderGraphUsage::SampledCompute);
+	m_RenderGraph->Write(m_BlurHNode, m_TempBlurResource, RenderGraphUsage::StorageWriteCompute);
+
+	m_BlurVNode = m_RenderGraph->AddPass("BlurV", QueueType::Compute);
+	m_RenderGraph->Read(m_BlurVNode, m_TempBlurResource, RenderGraphUsage::SampledCompute);
+	m_RenderGraph->Write(m_BlurVNode, m_BrightResource, RenderGraphUsage::StorageWriteCompute);
+
+	m_CompositeNode = m_RenderGraph->AddPass("Composite");
+	m_RenderGraph->Read(m_CompositeNode, m_LitSceneResource, RenderGraphUsage::SampledFragment);
+	m_RenderGraph->Read(m_CompositeNode, m_BrightResource, RenderGraphUsage::SampledFragment);
+	m_RenderGraph->Write(m_CompositeNode, m_SwapchainResource, RenderGraphUsage::ColorAttachment);
+
+	// Cull pass, tạo attachment (có aliasing), tính barrier và chia submission.
+	m_RenderGraph->Compile();
+
+	m_SubmissionSignalValues.assign(MAX_FRAMES_IN_FLIGHT, std::vector<uint64_t>(m_RenderGraph->GetSubmissionCount(), 0));
 }
  
 
@@ -639,26 +915,75 @@ void Application::CreateSceneLights()
  */
 void Application::CreateRenderPasses()
 {
+	// --- 0. GPU Culling Pass ---
+	// Cull instance của GPUScene theo frustum của từng view, sinh lệnh vẽ indirect cho Geometry và ShadowMap.
+	// View camera còn được cull theo occlusion hai pha, pha sau đọc depth pyramid do HiZ Pass dựng.
+	if (m_GPUDrivenRendering)
+	{
+		HiZPassCreateInfo hiZInfo{};
+		hiZInfo.vulkanHandles = &m_VulkanContext->getVulkanHandles();
+		hiZInfo.vulkanSwapchainHandles = &m_VulkanSwapchain->getHandles();
+		hiZInfo.vulkanSampler = m_VulkanSampler;
+		hiZInfo.MAX_FRAMES_IN_FLIGHT = MAX_FRAMES_IN_FLIGHT;
+		hiZInfo.depthStencilImages = &m_RenderGraph->GetImages(m_Geometry_DepthStencilResource);
+		hiZInfo.compShaderFilePath = "Shaders/HiZ_Shader.comp.spv";
+		m_HiZPass = new HiZPass(hiZInfo);
+
+		GPUCullingPassCreateInfo cullingInfo{};
+		cullingInfo.vulkanHandles = &m_VulkanContext->getVulkanHandles();
+		cullingInfo.gpuScene = m_GPUScene;
+		cullingInfo.MAX_FRAMES_IN_FLIGHT = MAX_FRAMES_IN_FLIGHT;
+		cullingInfo.hiZImages = &m_HiZPass->GetPyramidImages();
+		cullingInfo.vulkanSampler = m_VulkanSampler;
+		cullingInfo.compShaderFilePath = "Shaders/Cull_Shader.comp.spv";
+
+		cullingInfo.occlusionPhase = GPUCullPushConstantData::OCCLUSION_PHASE_EARLY;
+		m_GPUCullingPass = new GPUCullingPass(cullingInfo);
+
+		cullingInfo.occlusionPhase = GPUCullPushConstantData::OCCLUSION_PHASE_LATE;
+		m_GPUCullingLatePass = new GPUCullingPass(cullingInfo);
+	}
+
 	// --- 1. Geometry Pass ---
 	// Vẽ scene 3D vào một framebuffer trung gian (RTT).
 	GeometryPassCreateInfo geometryInfo{};
-	geometryInfo.albedoImages = &m_Geometry_AlbedoImages;
-	geometryInfo.normalImages = &m_Geometry_NormalImages;
-	geometryInfo.positionImages = &m_Geometry_PositionImages;
+	geometryInfo.albedoImages = &m_RenderGraph->GetImages(m_Geometry_AlbedoResource);
+	geometryInfo.normalImages = &m_RenderGraph->GetImages(m_Geometry_NormalResource);
+	geometryInfo.positionImages = &m_RenderGraph->GetImages(m_Geometry_PositionResource);
 	geometryInfo.textureManager = m_TextureManager;
 	geometryInfo.meshManager = m_MeshManager;
 	geometryInfo.materialManager = m_MaterialManager;
-	geometryInfo.depthStencilImages = &m_Geometry_DepthStencilImage;
+	geometryInfo.depthStencilImages = &m_RenderGraph->GetImages(m_Geometry_DepthStencilResource);
 	geometryInfo.BackgroundColor = BACKGROUND_COLOR;
 	geometryInfo.vulkanSwapchainHandles = &m_VulkanSwapchain->getHandles();
-	geometryInfo.scene = m_Scene;
+	geometryInfo.drawList = m_DrawList;
+	geometryInfo.commandManager = m_VulkanCommandManager;
+	geometryInfo.jobSystem = m_JobSystem;
 	geometryInfo.vulkanHandles = &m_VulkanContext->getVulkanHandles();
 	geometryInfo.MSAA_SAMPLES = MSAA_SAMPLES;
 	geometryInfo.fragShaderFilePath = "Shaders/Geometry_Shader.frag.spv";
 	geometryInfo.vertShaderFilePath = "Shaders/Geometry_Shader.vert.spv";
-	geometryInfo.uniformBuffers = &m_Geometry_UniformBuffers;
+	geometryInfo.frameAllocator = m_FrameAllocator;
+	geometryInfo.uniformOffsets = &m_Geometry_UboOffsets;
+	geometryInfo.gpuScene = m_GPUScene;
+	geometryInfo.gpuDrivenRendering = m_GPUDrivenRendering;
+	geometryInfo.gpuDrawList = GPUScene::DRAW_LIST_CAMERA;
+	geometryInfo.loadAttachments = false;
+	geometryInfo.storeDepth = m_GPUDrivenRendering; // HiZ Pass đọc depth.
+	geometryInfo.occlusionQueryCuller = m_OcclusionQueryCuller;
+	geometryInfo.queryFragShaderFilePath = "Shaders/OcclusionQuery_Shader.frag.spv";
+	geometryInfo.queryVertShaderFilePath = "Shaders/OcclusionQuery_Shader.vert.spv";
 	m_GeometryPass = new GeometryPass(geometryInfo);
 
+	// Pha sau của occlusion culling: vẽ tiếp các đối tượng vừa lộ ra lên G-buffer của Geometry Pass.
+	if (m_GPUDrivenRendering)
+	{
+		geometryInfo.gpuDrawList = GPUScene::DRAW_LIST_CAMERA_LATE;
+		geometryInfo.loadAttachments = true;
+		geometryInfo.storeDepth = false;
+		m_GeometryLatePass = new GeometryPass(geometryInfo);
+	}
+
 	// Shadow Map Pass
 	ShadowMapPassCreateInfo shadowInfo{};
 	shadowInfo.BackgroundColor = BACKGROUND_COLOR;
@@ -668,7 +993,11 @@ void Application::CreateRenderPasses()
 	shadowInfo.MAX_FRAMES_IN_FLIGHT = MAX_FRAMES_IN_FLIGHT;
 	shadowInfo.meshManager = m_MeshManager;
 	shadowInfo.MSAA_SAMPLES = VK_SAMPLE_COUNT_1_BIT;
-	shadowInfo.scene = m_Scene;
+	shadowInfo.drawList = m_DrawList;
+	shadowInfo.gpuScene = m_GPUScene;
+	shadowInfo.gpuDrivenRendering = m_GPUDrivenRendering;
+	shadowInfo.commandManager = m_VulkanCommandManager;
+	shadowInfo.jobSystem = m_JobSystem;
 	shadowInfo.vulkanHandles = &m_VulkanContext->getVulkanHandles();
 	shadowInfo.vulkanSwapchainHandles = &m_VulkanSwapchain->getHandles();
 
@@ -683,12 +1012,14 @@ void Application::CreateRenderPasses()
 	lightingInfo.fragShaderFilePath = "Shaders/Lighting_Shader.frag.spv";
 	lightingInfo.vertShaderFilePath = "Shaders/PostProcess_Shader.vert.spv";
 	lightingInfo.BackgroundColor = BACKGROUND_COLOR;
-	lightingInfo.outputImages = &m_LitSceneImages;
-	lightingInfo.gAlbedoTextures = &m_Geometry_AlbedoImages;
-	lightingInfo.gNormalTextures = &m_Geometry_NormalImages; 
-	lightingInfo.gPositionTextures = &m_Geometry_PositionImages;
+	lightingInfo.outputImages = &m_RenderGraph->GetImages(m_LitSceneResource);
+	lightingInfo.gAlbedoTextures = &m_RenderGraph->GetImages(m_Geometry_AlbedoResource);
+	lightingInfo.gNormalTextures = &m_RenderGraph->GetImages(m_Geometry_NormalResource);
+	lightingInfo.gPositionTextures = &m_RenderGraph->GetImages(m_Geometry_PositionResource);
 	lightingInfo.sceneLightDescriptors = &m_LightManager->GetDescriptors();
-	lightingInfo.uniformBuffers = &m_Geometry_UniformBuffers; // Pass camera UBO
+	lightingInfo.sceneLightOffsets = &m_LightManager->GetLightBufferOffsets();
+	lightingInfo.frameAllocator = m_FrameAllocator; // Pass camera UBO
+	lightingInfo.uniformOffsets = &m_Geometry_UboOffsets;
 	lightingInfo.vulkanSampler = m_VulkanSampler;
 	m_LightingPass = new LightingPass(lightingInfo);
 
@@ -697,13 +1028,10 @@ void Application::CreateRenderPasses()
 	BrightFilterPassCreateInfo brightFilterInfo{};
 	brightFilterInfo.vulkanHandles = &m_VulkanContext->getVulkanHandles();
 	brightFilterInfo.vulkanSwapchainHandles = &m_VulkanSwapchain->getHandles();
-	brightFilterInfo.MSAA_SAMPLES = VK_SAMPLE_COUNT_1_BIT; // Post-processing không cần MSAA.
 	brightFilterInfo.MAX_FRAMES_IN_FLIGHT = MAX_FRAMES_IN_FLIGHT;
-	brightFilterInfo.fragShaderFilePath = "Shaders/Bright_Shader.frag.spv";
-	brightFilterInfo.vertShaderFilePath = "Shaders/PostProcess_Shader.vert.spv"; // Dùng chung vertex shader vẽ quad.
-	brightFilterInfo.BackgroundColor = BACKGROUND_COLOR;
-	brightFilterInfo.outputImage = &m_BrightImages;
-	brightFilterInfo.inputTextures = &m_LitSceneImages; // Input là ảnh đã được chiếu sáng.
+	brightFilterInfo.compShaderFilePath = "Shaders/Bright_Shader.comp.spv";
+	brightFilterInfo.outputImage = &m_RenderGraph->GetImages(m_BrightResource);
+	brightFilterInfo.inputTextures = &m_RenderGraph->GetImages(m_LitSceneResource); // Input là ảnh đã được chiếu sáng.
 	brightFilterInfo.vulkanSampler = m_VulkanSampler;
 	m_BrightFilterPass = new BrightFilterPass(brightFilterInfo);
 
@@ -712,12 +1040,9 @@ void Application::CreateRenderPasses()
 	BlurPassCreateInfo blurHInfo{};
 	blurHInfo.vulkanHandles = &m_VulkanContext->getVulkanHandles();
 	blurHInfo.vulkanSwapchainHandles = &m_VulkanSwapchain->getHandles();
-	blurHInfo.MSAA_SAMPLES = VK_SAMPLE_COUNT_1_BIT;
-	blurHInfo.fragShaderFilePath = "Shaders/BlurH_Shader.frag.spv";
-	blurHInfo.vertShaderFilePath = "Shaders/PostProcess_Shader.vert.spv";
-	blurHInfo.BackgroundColor = BACKGROUND_COLOR;
-	blurHInfo.outputImages = &m_TempBlurImages; // Ghi kết quả vào ảnh tạm.
-	blurHInfo.inputTextures = &m_BrightImages; // Input là ảnh các vùng sáng.
+	blurHInfo.compShaderFilePath = "Shaders/BlurH_Shader.comp.spv";
+	blurHInfo.outputImages = &m_RenderGraph->GetImages(m_TempBlurResource); // Ghi kết quả vào ảnh tạm.
+	blurHInfo.inputTextures = &m_RenderGraph->GetImages(m_BrightResource); // Input là ảnh các vùng sáng.
 	blurHInfo.vulkanSampler = m_VulkanSampler;
 	m_BlurHPass = new BlurPass(blurHInfo);
 
@@ -726,12 +1051,9 @@ void Application::CreateRenderPasses()
 	BlurPassCreateInfo blurVInfo{};
 	blurVInfo.vulkanHandles = &m_VulkanContext->getVulkanHandles();
 	blurVInfo.vulkanSwapchainHandles = &m_VulkanSwapchain->getHandles();
-	blurVInfo.MSAA_SAMPLES = VK_SAMPLE_COUNT_1_BIT;
-	blurVInfo.fragShaderFilePath = "Shaders/BlurV_Shader.frag.spv";
-	blurVInfo.vertShaderFilePath = "Shaders/PostProcess_Shader.vert.spv";
-	blurVInfo.BackgroundColor = BACKGROUND_COLOR;
-	blurVInfo.outputImages = &m_BrightImages; // Ghi đè kết quả vào ảnh chứa vùng sáng.
-	blurVInfo.inputTextures = &m_TempBlurImages; // Input là ảnh đã blur ngang.
+	blurVInfo.compShaderFilePath = "Shaders/BlurV_Shader.comp.spv";
+	blurVInfo.outputImages = &m_RenderGraph->GetImages(m_BrightResource); // Ghi đè kết quả vào ảnh chứa vùng sáng.
+	blurVInfo.inputTextures = &m_RenderGraph->GetImages(m_TempBlurResource); // Input là ảnh đã blur ngang.
 	blurVInfo.vulkanSampler = m_VulkanSampler;
 	m_BlurVPass = new BlurPass(blurVInfo);
 
@@ -744,46 +1066,61 @@ void Application::CreateRenderPasses()
 	compositeInfo.fragShaderFilePath = "Shaders/Composite_Shader.frag.spv";
 	compositeInfo.vertShaderFilePath = "Shaders/PostProcess_Shader.vert.spv";
 	compositeInfo.BackgroundColor = BACKGROUND_COLOR;
-	compositeInfo.mainColorImage = m_Composite_ColorImage;
-	compositeInfo.inputTextures0 = &m_LitSceneImages;       // Input 1: Ảnh scene đã chiếu sáng.
-	compositeInfo.inputTextures1 = &m_BrightImages;        // Input 2: Ảnh bloom đã xử lý.
+	compositeInfo.inputTextures0 = &m_RenderGraph->GetImages(m_LitSceneResource);       // Input 1: Ảnh scene đã chiếu sáng.
+	compositeInfo.inputTextures1 = &m_RenderGraph->GetImages(m_BrightResource);        // Input 2: Ảnh bloom đã xử lý.
 	compositeInfo.vulkanSampler = m_VulkanSampler;
 	m_CompositePass = new CompositePass(compositeInfo);
+
+	// --- 7. Gắn các pass vào Render Graph ---
+	if (m_GPUDrivenRendering)
+	{
+		m_RenderGraph->SetPassExecutor(m_GPUCullingNode, m_GPUCullingPass);
+		m_RenderGraph->SetPassExecutor(m_HiZNode, m_HiZPass);
+		m_RenderGraph->SetPassExecutor(m_GPUCullingLateNode, m_GPUCullingLatePass);
+		m_RenderGraph->SetPassExecutor(m_GeometryLateNode, m_GeometryLatePass);
+	}
+	m_RenderGraph->SetPassExecutor(m_GeometryNode, m_GeometryPass);
+	m_RenderGraph->SetPassExecutor(m_ShadowMapNode, m_ShadowMapPass);
+	m_RenderGraph->SetPassExecutor(m_LightingNode, m_LightingPass);
+	m_RenderGraph->SetPassExecutor(m_BrightFilterNode, m_BrightFilterPass);
+	m_RenderGraph->SetPassExecutor(m_BlurHNode, m_BlurHPass);
+	m_RenderGraph->SetPassExecutor(m_BlurVNode, m_BlurVPass);
+	m_RenderGraph->SetPassExecutor(m_CompositeNode, m_CompositePass);
 }
 
 /**
- * @brief Tạo uniform buffers (UBO) cho Geometry pass.
- * Các buffer này chứa ma trận View-Projection (camera).
- * Tạo một UBO cho mỗi frame-in-flight để tránh xung đột dữ liệu khi CPU cập nhật và GPU đang đọc.
+ * @brief Tạo bộ cấp phát tuyến tính cho dữ liệu shader thay đổi mỗi frame.
+ * Thay vì một VulkanBuffer + descriptor set riêng cho mỗi loại dữ liệu và mỗi frame-in-flight,
+ * mọi dữ liệu tạm (camera UBO, light SSBO, ...) được cấp phát từ một buffer chung
+ * và được shader đọc thông qua dynamic offset.
  */
-void Application::CreateUniformBuffers()
+void Application::CreateFrameAllocator()
 {
-	m_Geometry_UniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-
-	VkBufferCreateInfo bufferInfo{};
-	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	bufferInfo.queueFamilyIndexCount = 1;
-	bufferInfo.pQueueFamilyIndices = &m_VulkanContext->getVulkanHandles().queueFamilyIndices.GraphicQueueIndex;
-	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	bufferInfo.size = sizeof(UniformBufferObject);
-	bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-
-	for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-	{
-		// Tạo buffer với VMA_MEMORY_USAGE_CPU_TO_GPU để CPU có thể ghi dữ liệu trực tiếp.
-		m_Geometry_UniformBuffers[i] = new VulkanBuffer(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager, bufferInfo, VMA_MEMORY_USAGE_CPU_TO_GPU);
-	}
+	m_FrameAllocator = new VulkanFrameAllocator(m_VulkanContext->getVulkanHandles(), m_VulkanCommandManager, FRAME_ALLOCATOR_SIZE, MAX_FRAMES_IN_FLIGHT);
+	m_Geometry_UboOffsets.resize(MAX_FRAMES_IN_FLIGHT, 0);
 }
 
-void Application::Update()
+/**
+ * @brief Một bước simulation (bước thời gian cố định `deltaTime`), chạy trên luồng của SimulationThread.
+ * Chỉ sửa registry và dữ liệu công bố cho render (tư thế camera). Không gọi GLFW (Input đọc bản chụp)
+ * và không dùng JobSystem của luồng render.
+ */
+void Application::Update(float deltaTime)
 {
-	CameraControlSystem::CameraTransformUpdate(m_Scene);
+	Input::BeginStep();
+
+	CameraControlSystem::CameraTransformUpdate(m_Scene, deltaTime);
 	CameraControlSystem::CameraRotateUpdate(m_Scene);
-	UpdateRenderObjectTransforms();
+	UpdateRenderObjectTransforms(deltaTime);
 
-	TransformSystem::UpdateTransformMatrix(m_Scene);
+	TransformSystem::UpdateTransformMatrix(m_Scene, m_SimulationJobSystem);
 	CameraSystem::UpdateCameraMatrix(m_Scene);
 
-	//Update_Geometry_Uniforms();
+	// Tư thế camera chính sau bước này và bước trước (bước đầu tiên: cả hai là tư thế hiện tại).
+	const TransformComponent& cameraTransform = m_Scene->GetRegistry().get<TransformComponent>(m_MainCamera);
+	const CameraPose pose{ cameraTransform.GetWorldPosition(), cameraTransform.GetForward() };
+	m_PreviousCameraPose = m_HasCameraPose ? m_CurrentCameraPose : pose;
+	m_CurrentCameraPose = pose;
+	m_HasCameraPose = true;
 }
 
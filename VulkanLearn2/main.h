@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Scene/LightData.h"
+#include "Renderer/RenderGraph.h"
 // --- Khai báo sớm (Forward Declarations) ---
 // Giảm thiểu sự phụ thuộc vào các file header và tăng tốc độ biên dịch.
 
@@ -11,6 +12,7 @@ class MaterialManager;
 class LightManager;
 class ShadowMapPass;
 class Scene;
+class SceneBVH;
 class Model;
 
 // Classes
@@ -23,6 +25,14 @@ class VulkanDescriptorManager;
 class VulkanPipeline;
 class VulkanSyncManager;
 class VulkanBuffer;
+class VulkanFrameAllocator;
+class JobSystem;
+class SimulationThread;
+class DrawList;
+class RenderProxyManager;
+class FrustumCuller;
+class OcclusionCuller;
+class OcclusionQueryCuller;
 class VulkanImage;
 class VulkanDescriptor;
 class MeshManager;
@@ -32,6 +42,9 @@ class BrightFilterPass;
 class CompositePass;
 class BlurPass;
 class LightingPass;
+class GPUScene;
+class GPUCullingPass;
+class HiZPass;
 
 
 /**
@@ -69,9 +82,19 @@ private:
 	const VkSampleCountFlagBits MSAA_SAMPLES = VK_SAMPLE_COUNT_1_BIT; // Mức độ khử răng cưa (MSAA)
 	const int MAX_FRAMES_IN_FLIGHT = 2; // Số lượng frame được xử lý đồng thời (double/triple buffering)
 	const uint32_t MODEL_ROTATE_SPEED = 30;
+	const VkDeviceSize FRAME_ALLOCATOR_SIZE = 4 * 1024 * 1024; // Dung lượng bộ cấp phát dữ liệu tạm thời cho mỗi frame (4MB)
+	const bool GPU_DRIVEN_RENDERING = true; // Cull và sinh lệnh vẽ trên GPU (cần drawIndirectCount), false: ghi lệnh vẽ trên CPU.
+	const uint32_t MAX_GPU_INSTANCES = 16384; // Số instance (mesh của entity) tối đa mỗi frame trong GPUScene.
+	const bool HARDWARE_OCCLUSION_QUERIES = false; // Ghi lệnh trên CPU: true dùng occlusion query phần cứng, false dùng occluder phần mềm.
+	const uint32_t MAX_OCCLUSION_QUERIES = 4096; // Số occlusion query tối đa mỗi frame.
+	const bool SIMULATION_THREAD = true; // Chạy simulation trên luồng riêng, song song với ghi lệnh và submit của frame.
+	const float SIMULATION_STEP_TIME = 1.0f / 60.0f; // Độ dài mỗi bước simulation (giây), không phụ thuộc FPS.
+	const bool INTERPOLATE_CAMERA = true; // Nội suy camera giữa hai bước simulation gần nhất (trễ thêm một bước).
 	
 	// --- Trạng thái Ứng dụng ---
 	int m_CurrentFrame = 0; // Index của frame hiện tại đang được xử lý (từ 0 đến MAX_FRAMES_IN_FLIGHT - 1)
+	int m_PendingPresentFrame = -1; // Frame đã submit phần scene nhưng chưa submit phần present (xem DrawFrame), -1 nếu không có.
+	bool m_GPUDrivenRendering = false; // GPU_DRIVEN_RENDERING và GPU hỗ trợ drawIndirectCount.
 	
 	// =================================================================================================
 	// SECTION: CÁC ĐỐI TƯỢNG QUẢN LÝ CỐT LÕI
@@ -87,6 +110,10 @@ private:
 	VulkanCommandManager* m_VulkanCommandManager;
 	VulkanSyncManager* m_VulkanSyncManager;
 	VulkanDescriptorManager* m_VulkanDescriptorManager;
+	VulkanFrameAllocator* m_FrameAllocator;	// Bump allocator cho dữ liệu thay đổi mỗi frame (UBO, SSBO), bind qua dynamic offset.
+	JobSystem* m_JobSystem;					// Thread pool dùng để ghi song song các secondary command buffer.
+	JobSystem* m_SimulationJobSystem;		// Thread pool của luồng simulation (là m_JobSystem nếu không có luồng riêng).
+	SimulationThread* m_Simulation;			// Chạy Update theo bước cố định, Extract chép dữ liệu cho mỗi frame.
 	MeshManager* m_MeshManager;
 	TextureManager* m_TextureManager;
 	MaterialManager* m_MaterialManager;
@@ -95,32 +122,54 @@ private:
 	Scene* m_Scene;
 
 	// =================================================================================================
-	// SECTION: TÀI NGUYÊN RENDER (FRAMEBUFFER ATTACHMENTS)
+	// SECTION: RENDER GRAPH VÀ TÀI NGUYÊN RENDER (FRAMEBUFFER ATTACHMENTS)
 	// =================================================================================================
-	// Các ảnh (VulkanImage) này đóng vai trò là các attachment (đầu ra) cho các render pass.
-	// Chúng được tạo cho mỗi frame-in-flight để tránh xung đột dữ liệu.
+	// Các attachment là image tạm do RenderGraph tạo (một bản cho mỗi frame-in-flight).
+	// Image có thời gian sống không chồng lấn dùng chung vùng nhớ, barrier giữa các pass được tính tự động.
 
-	// --- Geometry Pass (Vẽ scene 3D) ---
-	std::vector<VulkanImage*> m_Geometry_DepthStencilImage;	// Attachment depth/stencil (MSAA) cho Geometry Pass.
+	RenderGraph* m_RenderGraph;
+	std::vector<std::vector<uint64_t>> m_SubmissionSignalValues;	// [frame][submission]: Giá trị timeline mà mỗi submission đã báo hiệu, submission sau đợi giá trị này.
 
-	std::vector<VulkanImage*> m_Geometry_PositionImages;
-	std::vector<VulkanImage*> m_Geometry_AlbedoImages;
-	std::vector<VulkanImage*> m_Geometry_NormalImages;
-
-
-	// --- Composite Pass (Tổng hợp cuối cùng) ---
-	VulkanImage* m_Composite_ColorImage;						// Attachment màu (MSAA) cho Composite Pass.
+	// --- Geometry Pass (G-Buffer) ---
+	RenderGraphResource m_Geometry_DepthStencilResource;
+	RenderGraphResource m_Geometry_PositionResource;
+	RenderGraphResource m_Geometry_AlbedoResource;
+	RenderGraphResource m_Geometry_NormalResource;
 
 	// --- Post-Processing (Bloom Effect) ---
-	std::vector<VulkanImage*> m_LitSceneImages;
-	std::vector<VulkanImage*> m_BrightImages;			// Chứa các vùng sáng được lọc từ m_SceneImages. Cũng là output của bước blur dọc.
-	std::vector<VulkanImage*> m_TempBlurImages;			// Image tạm, là output của bước blur ngang và input cho bước blur dọc.
+	RenderGraphResource m_LitSceneResource;
+	RenderGraphResource m_BrightResource;			// Chứa các vùng sáng được lọc từ ảnh đã chiếu sáng. Cũng là output của bước blur dọc.
+	RenderGraphResource m_TempBlurResource;			// Image tạm, là output của bước blur ngang và input cho bước blur dọc.
+
+	// --- Tài nguyên import (do hệ thống khác sở hữu) ---
+	RenderGraphResource m_ShadowMapResource;		// Toàn bộ shadow map của LightManager.
+	RenderGraphResource m_SwapchainResource;		// Swapchain image, output cuối cùng của frame.
+
+	// --- Các node pass trong Render Graph (theo thứ tự thực thi) ---
+	RenderGraphPass m_GPUCullingNode;		// Chỉ được khai báo khi dùng GPU-driven rendering.
+	RenderGraphPass m_GeometryNode;
+	RenderGraphPass m_HiZNode;				// Pha sau của occlusion culling (chỉ khi GPU-driven): HiZ -> GPUCullingLate -> GeometryLate.
+	RenderGraphPass m_GPUCullingLateNode;
+	RenderGraphPass m_GeometryLateNode;
+	RenderGraphPass m_ShadowMapNode;
+	RenderGraphPass m_LightingNode;
+	RenderGraphPass m_BrightFilterNode;
+	RenderGraphPass m_BlurHNode;
+	RenderGraphPass m_BlurVNode;
+	RenderGraphPass m_CompositeNode;
 
 	// =================================================================================================
 	// SECTION: DỮ LIỆU SCENE VÀ SHADER
 	// =================================================================================================
 
 	// --- Dữ liệu Scene ---
+	RenderProxyManager* m_RenderProxyManager;	// Mảng RenderProxy phẳng của scene, cập nhật theo thay đổi.
+	SceneBVH* m_SceneBVH;						// Chỉ mục không gian (cây AABB động) của entity có mesh và đèn.
+	DrawList* m_DrawList;		// Danh sách lệnh vẽ của frame hiện tại, dùng chung cho Geometry và ShadowMap pass.
+	FrustumCuller* m_FrustumCuller;	// Frustum culling camera trên CPU (chỉ dùng khi không GPU-driven).
+	OcclusionCuller* m_OcclusionCuller;	// Occlusion culling phần mềm theo OccluderComponent (chỉ dùng khi không GPU-driven).
+	OcclusionQueryCuller* m_OcclusionQueryCuller = nullptr;	// Occlusion query phần cứng (không GPU-driven và HARDWARE_OCCLUSION_QUERIES).
+	GPUScene* m_GPUScene;		// Instance buffer và lệnh vẽ indirect của các view (camera, shadow map).
 	entt::entity m_MainCamera;
 	Model* m_AnimeGirlModel;	// Tài nguyên Model được tải một lần và dùng chung.
 	entt::entity m_Girl1;		// Entity đại diện cho cô gái 1.
@@ -132,16 +181,30 @@ private:
 	entt::entity m_Light1;
 	entt::entity m_Light2;
 
+	// --- Dữ liệu simulation công bố cho render (ghi trong bước simulation, đọc trong Extract) ---
+	struct CameraPose
+	{
+		glm::vec3 position{ 0.0f };
+		glm::vec3 forward{ 0.0f, 0.0f, -1.0f };
+	};
+	CameraPose m_PreviousCameraPose;	// Camera chính sau bước trước và bước gần nhất, để nội suy (INTERPOLATE_CAMERA).
+	CameraPose m_CurrentCameraPose;
+	bool m_HasCameraPose = false;
+
 	// --- Dữ liệu cho Shader ---
 	UniformBufferObject m_Geometry_Ubo{};					// Struct chứa dữ liệu cho Uniform Buffer (ma trận View, Projection).
-	std::vector<VulkanBuffer*> m_Geometry_UniformBuffers;	// Các uniform buffer cho camera, một buffer cho mỗi frame-in-flight.
+	std::vector<uint32_t> m_Geometry_UboOffsets;			// Dynamic offset của UBO camera trong FrameAllocator, một giá trị cho mỗi frame-in-flight.
 
 	// =================================================================================================
 	// SECTION: CÁC RENDER PASS
 	// =================================================================================================
 	// Mỗi pass là một bước trong chuỗi render pipeline.
 
+	GPUCullingPass* m_GPUCullingPass = nullptr;	// Pass 0: Frustum culling trên GPU, sinh lệnh vẽ indirect (chỉ khi GPU-driven).
 	GeometryPass* m_GeometryPass;			// Pass 1: Vẽ các đối tượng 3D vào một texture (render-to-texture).
+	HiZPass* m_HiZPass = nullptr;					// Pass 1a: Dựng depth pyramid từ depth của Geometry Pass (chỉ khi GPU-driven).
+	GPUCullingPass* m_GPUCullingLatePass = nullptr;	// Pass 1b: Cull với depth pyramid, sinh lệnh vẽ cho các đối tượng vừa lộ ra.
+	GeometryPass* m_GeometryLatePass = nullptr;		// Pass 1c: Vẽ tiếp các đối tượng đó lên G-buffer.
 	ShadowMapPass* m_ShadowMapPass;
 	LightingPass* m_LightingPass;
 	BrightFilterPass* m_BrightFilterPass;	// Pass 2: Lọc ra các vùng có độ sáng cao từ kết quả của Geometry Pass.
@@ -157,17 +220,22 @@ private:
 	// --- Nhóm hàm khởi tạo ---
 	void CreateSceneLights();
 	void CreateRenderPasses();
-	void CreateFrameBufferImages();
-	void CreateUniformBuffers();
+	void CreateRenderGraph();
+	void CreateFrameAllocator();
+
+	// --- Nhóm hàm simulation (luồng của SimulationThread) ---
+	void Update(float deltaTime);
+	void UpdateRenderObjectTransforms(float deltaTime);
 
 	// --- Nhóm hàm cập nhật mỗi frame ---
-	void Update();
-	void Update_Geometry_Uniforms();
-	void UpdateRenderObjectTransforms();
+	void ExtractSceneData(float alpha);
+	void Update_Geometry_Uniforms(float alpha);
+	void UpdateGPUScene();
 
 	// --- Nhóm hàm vẽ và ghi command buffer ---
 	void DrawFrame();
-	void RecordCommandBuffer(const VkCommandBuffer& cmdBuffer, uint32_t imageIndex);
+	void PresentFrame(int frame);
+	uint64_t SubmitRenderGraph(uint32_t submission, int frame, uint32_t imageIndex, VkSemaphore imageAvailableSemaphore, VkSemaphore renderFinishedSemaphore);
 
 	void ShowFps();
 };
\ No newline at end of file